@@ -14,7 +14,7 @@
 VkPhysicalDevice* BufferManager::m_pPhysicalDevice = nullptr;
 
 BufferManager::BufferManager() : m_pLogicalDevice(VulkanEngine::getInstance()->m_pLogicalDevice->getVkDevice()), m_pSurface(VulkanEngine::getInstance()->m_pVkSurface),
-m_pRenderPass(VulkanEngine::getInstance()->m_pGraphicsPipeline->getRenderPass()), m_pSwapchain(VulkanEngine::getInstance()->m_pSwapchain), m_pSettings(VulkanEngine::getInstance()->m_settings),
+m_pSwapchain(VulkanEngine::getInstance()->m_pSwapchain), m_pSettings(VulkanEngine::getInstance()->m_settings),
 m_MAX_FRAMES_IN_FLIGHT(VulkanEngine::getInstance()->m_MAX_FRAMES_IN_FLIGHT), m_pGraphicsPipeline(VulkanEngine::getInstance()->m_pGraphicsPipeline->getGraphicsPipeline()),
 m_pGraphicsQueue(VulkanEngine::getInstance()->m_pLogicalDevice->getGraphicsQueue()), m_pDescriptorSetLayout(VulkanEngine::getInstance()->m_pGraphicsPipeline->getDescriptorSetLayout()),
 m_pPipelineLayout(VulkanEngine::getInstance()->m_pGraphicsPipeline->getVkPipelineLayout()), m_pUtilities(Utilities::getInstance())
@@ -30,8 +30,6 @@ void BufferManager::initBuffers()
 	mDebugPrint("Initializing command buffers..."); m_pCommandBuffer = new CommandBuffer(this);
 
 	mDebugPrint("Initializing vertex buffer..."); m_pVertexBuffer = new VertexBuffer(this, std::vector<Vertex> {}, std::vector<uint32_t> {});
-	mDebugPrint("Initializing depth buffer..."); m_pDepthBuffer = new DepthBuffer(this);
-	mDebugPrint("Initializing framebuffer..."); m_pFramebuffer = new Framebuffer(this);
 	mDebugPrint("Initializing uniform buffers..."); m_pUniformBufferObject = new UniformBufferObject(this);
 	mDebugPrint("Initializing descriptor sets..."); m_pDescriptorSets = new DescriptorSets(this);
 
@@ -55,8 +53,15 @@ void BufferManager::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, Vk
 	VkMemoryRequirements memRequirements;
 	vkGetBufferMemoryRequirements(*m_pLogicalDevice, pBuffer, &memRequirements);
 
+	// Buffers read through device addresses need memory allocated with the device address flag
+	VkMemoryAllocateFlagsInfo allocFlagsInfo{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+		.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT
+	};
+
 	VkMemoryAllocateInfo allocInfo{
 		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		.pNext = (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) ? &allocFlagsInfo : nullptr,
 		.allocationSize = memRequirements.size,
 		.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties)
 	};
@@ -69,6 +74,16 @@ void BufferManager::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, Vk
 	vkBindBufferMemory(*m_pLogicalDevice, pBuffer, pBufferMemory, 0);
 };
 
+VkDeviceAddress BufferManager::getBufferDeviceAddress(VkBuffer buffer)
+{
+	VkBufferDeviceAddressInfo addressInfo{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+		.buffer = buffer
+	};
+
+	return vkGetBufferDeviceAddress(*m_pLogicalDevice, &addressInfo);
+}
+
 void BufferManager::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
 {
 	VkCommandBuffer commandBuffer = m_pCommandBuffer->beginSingleTimeCommands();
@@ -145,6 +160,12 @@ void CommandBuffer::createCommandPool()
 
 VkCommandBuffer CommandBuffer::beginSingleTimeCommands()
 {
+	if (m_uploadBatch != VK_NULL_HANDLE)
+	{
+		m_batchedCommands++;
+		return m_uploadBatch;
+	}
+
 	VkCommandBufferAllocateInfo allocInfo{
 		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
 		.commandPool = sm_commandPool,
@@ -167,6 +188,8 @@ VkCommandBuffer CommandBuffer::beginSingleTimeCommands()
 
 void CommandBuffer::endSingleTimeCommands(VkCommandBuffer commandBuffer)
 {
+	if (commandBuffer == m_uploadBatch) return; // Submitted by endUploadBatch
+
 	vkEndCommandBuffer(commandBuffer);
 
 	VkSubmitInfo submitInfo{
@@ -181,6 +204,46 @@ void CommandBuffer::endSingleTimeCommands(VkCommandBuffer commandBuffer)
 	vkFreeCommandBuffers(*m_pBufferManager->m_pLogicalDevice, sm_commandPool, 1, &commandBuffer);
 }
 
+void CommandBuffer::beginUploadBatch()
+{
+	if (m_uploadBatch != VK_NULL_HANDLE)
+	{
+		throw std::runtime_error("tried to begin an upload batch while one is open!");
+	}
+
+	m_uploadBatch = beginSingleTimeCommands();
+	m_batchedCommands = 0;
+}
+
+void CommandBuffer::endUploadBatch()
+{
+	VkCommandBuffer commandBuffer = m_uploadBatch;
+	m_uploadBatch = VK_NULL_HANDLE;
+	endSingleTimeCommands(commandBuffer);
+
+	mfDebugPrint(std::format("Submitted {} batched transfer command(s) at once, freeing {} staging buffer(s)", m_batchedCommands, m_stagingBuffers.size()));
+
+	for (auto& [buffer, memory] : m_stagingBuffers)
+	{
+		vkDestroyBuffer(*m_pBufferManager->m_pLogicalDevice, buffer, nullptr);
+		vkFreeMemory(*m_pBufferManager->m_pLogicalDevice, memory, nullptr);
+	}
+	m_stagingBuffers.clear();
+}
+
+void CommandBuffer::releaseStagingBuffer(VkBuffer buffer, VkDeviceMemory memory)
+{
+	// Still needed by copies waiting in the batch
+	if (m_uploadBatch != VK_NULL_HANDLE)
+	{
+		m_stagingBuffers.push_back({ buffer, memory });
+		return;
+	}
+
+	vkDestroyBuffer(*m_pBufferManager->m_pLogicalDevice, buffer, nullptr);
+	vkFreeMemory(*m_pBufferManager->m_pLogicalDevice, memory, nullptr);
+}
+
 void CommandBuffer::createCommandBuffers()
 {
 	mfDebugPrint("Creating command buffers...");
@@ -197,11 +260,68 @@ void CommandBuffer::createCommandBuffers()
 	if (vkAllocateCommandBuffers(*m_pBufferManager->m_pLogicalDevice, &allocInfo, sm_commandBuffers.data()) != VK_SUCCESS) {
 		throw std::runtime_error("failed to allocate command buffers!");
 	}
+
+	// Command pools can't be used from two threads at once, so every recording thread gets its own per frame
+	m_pRecordingThreads = new ThreadPool(m_pBufferManager->m_pSettings->graphicsSettings.recordingThreads, 2);
+	m_recordingSlots = m_pRecordingThreads->getThreadCount() + 1;
+	mfDebugPrint(std::format("Creating {} recording command pools for {} recording threads...", m_recordingSlots * m_pBufferManager->m_MAX_FRAMES_IN_FLIGHT, m_pRecordingThreads->getThreadCount()));
+
+	QueueFamilyIndices::sQueueFamilyIndices queueFamilyIndices = QueueFamilyIndices::findQueueFamilies(*m_pBufferManager->m_pPhysicalDevice, *m_pBufferManager->m_pSurface);
+	VkCommandPoolCreateInfo poolInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, // Reset as a whole every frame
+		.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value()
+	};
+
+	m_recordingPools.resize(static_cast<size_t>(m_recordingSlots) * m_pBufferManager->m_MAX_FRAMES_IN_FLIGHT);
+	for (sRecordingPool& recordingPool : m_recordingPools)
+	{
+		if (vkCreateCommandPool(*m_pBufferManager->m_pLogicalDevice, &poolInfo, nullptr, &recordingPool.pool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create recording command pool!");
+		}
+	}
+
+	// Indirect buffers are created on the first frame that merges draws, and grown when a frame needs more
+	m_indirectBuffers.resize(m_pBufferManager->m_MAX_FRAMES_IN_FLIGHT);
+	if (m_pBufferManager->m_pSettings->graphicsSettings.indirectDraws)
+	{
+		VkPhysicalDeviceFeatures features{};
+		vkGetPhysicalDeviceFeatures(*m_pBufferManager->m_pPhysicalDevice, &features);
+		VkPhysicalDeviceProperties properties{};
+		vkGetPhysicalDeviceProperties(*m_pBufferManager->m_pPhysicalDevice, &properties);
+		m_maxDrawIndirectCount = features.multiDrawIndirect ? properties.limits.maxDrawIndirectCount : 1;
+	}
+}
+
+void CommandBuffer::buildRenderGraph()
+{
+	RenderGraph* pRenderGraph = m_pBufferManager->m_pRenderGraph;
+	Swapchain* pSwapchain = m_pBufferManager->m_pSwapchain;
+	VkExtent2D extent = *pSwapchain->getSwapchainExtent();
+
+	// The swapchain image is swapped in every frame. Its old contents are never needed. Headless, the offscreen image is
+	// left ready to be copied out instead of presented
+	VkImageLayout backbufferLayout = pSwapchain->isHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	m_backbuffer = pRenderGraph->importImage("Backbuffer", *pSwapchain->getSwapchainImageFormat(), extent, VK_IMAGE_LAYOUT_UNDEFINED, backbufferLayout);
+	RenderGraph::ResourceHandle depth = pRenderGraph->createImage("Depth", {
+		.format = Image::findDepthFormat(m_pBufferManager->m_pPhysicalDevice),
+		.extent = extent
+	});
+
+	m_scenePass = pRenderGraph->addPass("Scene", [this](VkCommandBuffer commandBuffer, const RenderGraph::sPassContext& context) {
+		recordScenePass(commandBuffer, context);
+	});
+	pRenderGraph->write(m_scenePass, m_backbuffer, RenderGraph::eUsage::COLOR_ATTACHMENT, RenderGraph::eLoad::CLEAR, VkClearValue{{{0.0f, 0.0f, 0.0f, 1.0f}}});
+	pRenderGraph->write(m_scenePass, depth, RenderGraph::eUsage::DEPTH_ATTACHMENT, RenderGraph::eLoad::CLEAR, VkClearValue{{{1.0f, 0}}});
+
+	pRenderGraph->compile();
 }
 
-void CommandBuffer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+void CommandBuffer::recordCommandBuffer(const sFrameContext& frame, uint32_t imageIndex)
 {
+	VkCommandBuffer commandBuffer = frame.commandBuffer;
 	//mDebugPrint("Recording command buffer...");
+	auto recordStart = std::chrono::steady_clock::now();
 
 	VkCommandBufferBeginInfo beginInfo{
 		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
@@ -214,31 +334,252 @@ void CommandBuffer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
 		throw std::runtime_error("failed to begin recording command buffer!");
 	}
 
-	//mDebugPrint("Creating render pass...");
+	Swapchain* pSwapchain = m_pBufferManager->m_pSwapchain;
+	m_pBufferManager->m_pRenderGraph->setImportedImage(m_backbuffer, pSwapchain->getSwapchainImages()->at(imageIndex), pSwapchain->getSwapchainImageViews()->at(imageIndex));
+	m_pBufferManager->m_pRenderGraph->execute(commandBuffer, frame);
 
-	std::vector<VkFramebuffer> framebuffers = *m_pBufferManager->m_pFramebuffer->getFramebuffers();
-	VkClearValue clearColor = { {{0.0f, 0.0f, 0.0f, 1.0f}} };
-	std::array<VkClearValue, 2> clearValues{
-		VkClearValue{{{0.0f, 0.0f, 0.0f, 1.0f}}},
-		VkClearValue{{{1.0f, 0}}}
-	};
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to record command buffer!");
+	}
 
-	VkRenderPassBeginInfo renderPassInfo{
-		.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-		.renderPass = *m_pBufferManager->m_pRenderPass,
-		.framebuffer = framebuffers[imageIndex],
-		.renderArea {
-			.offset = { 0, 0 },
-			.extent = *m_pBufferManager->m_pSwapchain->getSwapchainExtent(),
-		},
-		.clearValueCount = static_cast<uint32_t>(clearValues.size()),
-		.pClearValues = clearValues.data()
-	};
+	m_recordTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - recordStart).count();
+}
+
+void CommandBuffer::recordScenePass(VkCommandBuffer commandBuffer, const RenderGraph::sPassContext& context)
+{
+	const sFrameContext& frame = *context.pFrame;
+
+	collectDraws();
+	if (m_pBufferManager->m_pSettings->graphicsSettings.indirectDraws) mergeIndirectDraws(frame.index);
+	m_batchCount = static_cast<uint32_t>((m_draws.size() + DRAWS_PER_BATCH - 1) / DRAWS_PER_BATCH);
+
+	if (m_batchCount <= 1)
+	{
+		// Not worth a secondary buffer
+		vkCmdBeginRenderPass(commandBuffer, &context.beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+		recordDraws(commandBuffer, frame.descriptorSet, 0, static_cast<uint32_t>(m_draws.size()));
+	}
+	else
+	{
+		// The GPU finished with this frame's secondaries before its fence was signalled, so they can all be reset
+		for (uint32_t slot = 0; slot < m_recordingSlots; slot++)
+		{
+			sRecordingPool& recordingPool = m_recordingPools[frame.index * m_recordingSlots + slot];
+			vkResetCommandPool(*m_pBufferManager->m_pLogicalDevice, recordingPool.pool, 0);
+			recordingPool.used = 0;
+		}
+
+		VkCommandBufferInheritanceInfo inheritanceInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+			.renderPass = context.renderPass,
+			.subpass = 0,
+			.framebuffer = context.framebuffer
+		};
+		VkCommandBufferBeginInfo secondaryBeginInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+			.pInheritanceInfo = &inheritanceInfo
+		};
+
+		// Batches keep their place in m_batches whichever thread records them, so draw order is preserved
+		m_batches.assign(m_batchCount, VK_NULL_HANDLE);
+		std::atomic<bool> failed = false;
+		auto recordBatches = [&](uint32_t begin, uint32_t end) {
+			uint32_t slot = static_cast<uint32_t>(ThreadPool::getWorkerIndex() + 1);
+			for (uint32_t batch = begin; batch < end; batch++)
+			{
+				VkCommandBuffer secondary = acquireSecondary(frame.index, slot);
+				if (secondary == VK_NULL_HANDLE || vkBeginCommandBuffer(secondary, &secondaryBeginInfo) != VK_SUCCESS)
+				{
+					failed = true;
+					return;
+				}
+				recordDraws(secondary, frame.descriptorSet, batch * DRAWS_PER_BATCH, std::min<uint32_t>((batch + 1) * DRAWS_PER_BATCH, static_cast<uint32_t>(m_draws.size())));
+				if (vkEndCommandBuffer(secondary) != VK_SUCCESS) failed = true;
+				m_batches[batch] = secondary;
+			}
+		};
+		if (m_parallelRecording) m_pRecordingThreads->parallelFor(m_batchCount, 1, recordBatches);
+		else recordBatches(0, m_batchCount);
+		if (failed) throw std::runtime_error("failed to record secondary command buffer!");
+
+		vkCmdBeginRenderPass(commandBuffer, &context.beginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+		vkCmdExecuteCommands(commandBuffer, m_batchCount, m_batches.data());
+	}
+
+	vkCmdEndRenderPass(commandBuffer);
+}
+
+void CommandBuffer::cleanup()
+{
+	delete m_pRecordingThreads;
+	m_pRecordingThreads = nullptr;
+
+	// Destroying the pools frees their secondary buffers too
+	for (sRecordingPool& recordingPool : m_recordingPools) vkDestroyCommandPool(*m_pBufferManager->m_pLogicalDevice, recordingPool.pool, nullptr);
+	m_recordingPools.clear();
+
+	for (sIndirectBuffer& indirectBuffer : m_indirectBuffers) destroyIndirectBuffer(indirectBuffer);
+	m_indirectBuffers.clear();
+
+	vkDestroyCommandPool(*m_pBufferManager->m_pLogicalDevice, sm_commandPool, nullptr);
+}
+
+
+
+void CommandBuffer::collectDraws()
+{
+	m_draws.clear();
+
+	// Blocks, frag.spv samples the block texture array instead of the bindless one
+	addMeshDraw(*m_pBufferManager->m_pGraphicsPipeline, m_pBufferManager->m_pVertexBuffer, 0);
+
+	FaceInstanceBuffer* pFaceInstanceBuffer = m_pBufferManager->m_pFaceInstanceBuffer;
+	if (pFaceInstanceBuffer != nullptr && m_faceInstancedTerrain)
+	{
+		// Terrain is drawn as one 6-vertex quad per face instance, the vertex shader builds the corners
+		if (pFaceInstanceBuffer->getInstanceCount() > 0)
+		{
+			for (uint32_t x = 0; x < m_chunkGridWidth; x++)
+				for (uint32_t y = 0; y < m_chunkGridWidth; y++)
+				{
+					m_draws.push_back({
+						.pipeline = *m_pBufferManager->m_pFaceInstancePipeline,
+						.vertexBuffer = *pFaceInstanceBuffer->getVkInstanceBuffer(),
+						.count = 6,
+						.instanceCount = pFaceInstanceBuffer->getInstanceCount(),
+						.pushDrawRecord = true,
+						.drawRecord = { .chunkOrigin = pFaceInstanceBuffer->getChunkOrigin() + glm::vec3(x * Chunk::SIZE, y * Chunk::SIZE, 0) }
+					});
+				}
+		}
+	}
+	else if (m_pBufferManager->m_pTerrainVertexBuffer != nullptr) addMeshDraw(*m_pBufferManager->m_pGraphicsPipeline, m_pBufferManager->m_pTerrainVertexBuffer, 0);
 
-	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+	// Each model reads its own texture from the bindless array, selected by the slot in its draw record
+	for (const BufferManager::sModelMesh& mesh : m_pBufferManager->m_modelMeshes)
+		addMeshDraw(*m_pBufferManager->m_pModelPipeline, mesh.pVertexBuffer, mesh.textureSlot);
+}
+
+void CommandBuffer::addMeshDraw(VkPipeline pipeline, VertexBuffer* pVertexBuffer, uint32_t textureIndex)
+{
+	uint32_t indexCount = static_cast<uint32_t>(pVertexBuffer->m_indices.size());
+
+	if (m_pBufferManager->m_pSettings->graphicsSettings.vertexPulling)
+	{
+		// Nothing to bind, the shader fetches index and vertex data through the addresses in the draw record
+		m_draws.push_back({
+			.pipeline = pipeline,
+			.count = indexCount,
+			.pushDrawRecord = true,
+			.drawRecord = {
+				.vertexAddress = pVertexBuffer->getVertexBufferAddress(),
+				.indexAddress = pVertexBuffer->getIndexBufferAddress(),
+				.textureIndex = textureIndex,
+				.baseVertex = 0
+			}
+		});
+	}
+	else
+	{
+		m_draws.push_back({
+			.pipeline = pipeline,
+			.vertexBuffer = *pVertexBuffer->getVkVertexBuffer(),
+			.indexBuffer = *pVertexBuffer->getVkIndexBuffer(),
+			.count = indexCount,
+			.pushDrawRecord = true,
+			.drawRecord = { .textureIndex = textureIndex }
+		});
+	}
+}
+
+void CommandBuffer::mergeIndirectDraws(uint32_t frameIndex)
+{
+	uint32_t pulledDraws = 0;
+	for (const sDraw& draw : m_draws) if (draw.drawRecord.vertexAddress != 0) pulledDraws++;
+	if (pulledDraws == 0) return;
+
+	// The frame's fence has signalled, so the GPU is done with its previous commands and records
+	sIndirectBuffer& indirectBuffer = m_indirectBuffers[frameIndex];
+	if (indirectBuffer.capacity < pulledDraws) createIndirectBuffer(indirectBuffer, std::max(pulledDraws, indirectBuffer.capacity * 2));
+	m_frameIndirectBuffer = indirectBuffer.buffer;
+
+	VkDrawIndirectCommand* pCommands = static_cast<VkDrawIndirectCommand*>(indirectBuffer.pMapped);
+	GraphicsPipeline::sIndirectDrawRecord* pRecords = reinterpret_cast<GraphicsPipeline::sIndirectDrawRecord*>(pCommands + indirectBuffer.capacity);
+
+	// Draws are compacted in place and keep their order. Each command's firstInstance is its record's index, which the shader
+	// reads back as gl_InstanceIndex
+	size_t merged = 0;
+	uint32_t command = 0;
+	for (size_t i = 0; i < m_draws.size(); i++)
+	{
+		sDraw draw = m_draws[i];
+		if (draw.drawRecord.vertexAddress == 0)
+		{
+			m_draws[merged++] = draw;
+			continue;
+		}
+
+		pCommands[command] = {
+			.vertexCount = draw.count,
+			.instanceCount = 1,
+			.firstVertex = 0,
+			.firstInstance = command
+		};
+		pRecords[command] = {
+			.vertexAddress = draw.drawRecord.vertexAddress,
+			.indexAddress = draw.drawRecord.indexAddress,
+			.textureIndex = draw.drawRecord.textureIndex,
+			.baseVertex = draw.drawRecord.baseVertex
+		};
+
+		// The texture index stays in the push constants for the fragment shader, so only draws sharing one can merge
+		sDraw* pPrevious = merged > 0 ? &m_draws[merged - 1] : nullptr;
+		if (pPrevious != nullptr && pPrevious->indirectCount > 0 && pPrevious->pipeline == draw.pipeline && pPrevious->drawRecord.textureIndex == draw.drawRecord.textureIndex)
+			pPrevious->indirectCount++;
+		else
+		{
+			m_draws[merged++] = {
+				.pipeline = draw.pipeline,
+				.pushDrawRecord = true,
+				.drawRecord = {
+					.textureIndex = draw.drawRecord.textureIndex,
+					.drawRecordsAddress = indirectBuffer.recordsAddress
+				},
+				.indirectCount = 1,
+				.firstIndirect = command
+			};
+		}
+		command++;
+	}
+	m_draws.resize(merged);
+}
+
+void CommandBuffer::createIndirectBuffer(sIndirectBuffer& indirectBuffer, uint32_t capacity)
+{
+	destroyIndirectBuffer(indirectBuffer);
 
-	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *m_pBufferManager->m_pGraphicsPipeline);
+	VkDeviceSize size = static_cast<VkDeviceSize>(capacity) * (sizeof(VkDrawIndirectCommand) + sizeof(GraphicsPipeline::sIndirectDrawRecord));
+	m_pBufferManager->createBuffer(size, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, indirectBuffer.buffer, indirectBuffer.memory);
+	vkMapMemory(*m_pBufferManager->m_pLogicalDevice, indirectBuffer.memory, 0, size, 0, &indirectBuffer.pMapped);
 
+	indirectBuffer.capacity = capacity;
+	indirectBuffer.recordsAddress = m_pBufferManager->getBufferDeviceAddress(indirectBuffer.buffer) + capacity * sizeof(VkDrawIndirectCommand);
+}
+
+void CommandBuffer::destroyIndirectBuffer(sIndirectBuffer& indirectBuffer)
+{
+	if (indirectBuffer.buffer == VK_NULL_HANDLE) return;
+
+	vkDestroyBuffer(*m_pBufferManager->m_pLogicalDevice, indirectBuffer.buffer, nullptr);
+	vkFreeMemory(*m_pBufferManager->m_pLogicalDevice, indirectBuffer.memory, nullptr);
+	indirectBuffer = {};
+}
+
+void CommandBuffer::recordDraws(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, uint32_t begin, uint32_t end)
+{
+	// Secondary buffers inherit no state, so every batch sets up its own
 	VkViewport viewport{
 		.x = 0.0f,
 		.y = 0.0f,
@@ -255,25 +596,69 @@ void CommandBuffer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
 	};
 	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-	VkBuffer vertexBuffers[] = { *m_pBufferManager->m_pVertexBuffer->getVkVertexBuffer() };
-	VkDeviceSize offsets[] = { 0 };
-	vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-	vkCmdBindIndexBuffer(commandBuffer, *m_pBufferManager->m_pVertexBuffer->getVkIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-	
-	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *m_pBufferManager->m_pPipelineLayout, 0, 1, &(*m_pBufferManager->m_pDescriptorSets->getVkDescriptorSets())[imageIndex], 0, nullptr);
-	vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(m_pBufferManager->m_pVertexBuffer->m_indices.size()), 1, 0, 0, 0);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *m_pBufferManager->m_pPipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
 
-	vkCmdEndRenderPass(commandBuffer);
+	// The bindless set is bound once per batch, draws select their texture with the push constant
+	if (m_pBufferManager->m_pBindlessDescriptorSet != nullptr)
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *m_pBufferManager->m_pPipelineLayout, 1, 1, m_pBufferManager->m_pBindlessDescriptorSet, 0, nullptr);
 
-	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
-		throw std::runtime_error("failed to record command buffer!");
+	VkPipeline boundPipeline = VK_NULL_HANDLE;
+	for (uint32_t i = begin; i < end; i++)
+	{
+		const sDraw& draw = m_draws[i];
+		if (draw.pipeline != boundPipeline)
+		{
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, draw.pipeline);
+			boundPipeline = draw.pipeline;
+		}
+
+		if (draw.pushDrawRecord)
+			vkCmdPushConstants(commandBuffer, *m_pBufferManager->m_pPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(draw.drawRecord), &draw.drawRecord);
+
+		if (draw.vertexBuffer != VK_NULL_HANDLE)
+		{
+			VkDeviceSize offset = 0;
+			vkCmdBindVertexBuffers(commandBuffer, 0, 1, &draw.vertexBuffer, &offset);
+		}
+
+		if (draw.indirectCount > 0)
+		{
+			// Split only when the device can't take them all in one call
+			for (uint32_t first = 0; first < draw.indirectCount; first += m_maxDrawIndirectCount)
+			{
+				VkDeviceSize offset = static_cast<VkDeviceSize>(draw.firstIndirect + first) * sizeof(VkDrawIndirectCommand);
+				vkCmdDrawIndirect(commandBuffer, m_frameIndirectBuffer, offset, std::min(m_maxDrawIndirectCount, draw.indirectCount - first), sizeof(VkDrawIndirectCommand));
+			}
+		}
+		else if (draw.indexBuffer != VK_NULL_HANDLE)
+		{
+			vkCmdBindIndexBuffer(commandBuffer, draw.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+			vkCmdDrawIndexed(commandBuffer, draw.count, draw.instanceCount, 0, 0, 0);
+		}
+		else vkCmdDraw(commandBuffer, draw.count, draw.instanceCount, 0, 0);
 	}
 }
 
-
-void CommandBuffer::cleanup()
+VkCommandBuffer CommandBuffer::acquireSecondary(uint32_t frameIndex, uint32_t slot)
 {
-	vkDestroyCommandPool(*m_pBufferManager->m_pLogicalDevice, sm_commandPool, nullptr);
+	sRecordingPool& recordingPool = m_recordingPools[frameIndex * m_recordingSlots + slot];
+
+	// Buffers are kept across frames and only allocated when a frame needs more than any before it
+	if (recordingPool.used == recordingPool.secondaries.size())
+	{
+		VkCommandBufferAllocateInfo allocInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool = recordingPool.pool,
+			.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+			.commandBufferCount = 1
+		};
+
+		VkCommandBuffer secondary;
+		if (vkAllocateCommandBuffers(*m_pBufferManager->m_pLogicalDevice, &allocInfo, &secondary) != VK_SUCCESS) return VK_NULL_HANDLE;
+		recordingPool.secondaries.push_back(secondary);
+	}
+
+	return recordingPool.secondaries[recordingPool.used++];
 }
 
 
@@ -336,12 +721,15 @@ void VertexBuffer::createVertexBuffer()
 	memcpy(data, m_vertices.data(), (size_t)bufferSize);
 	vkUnmapMemory(*m_pBufferManager->m_pLogicalDevice, stagingBufferMemory);
 
-	m_pBufferManager->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_vertexBuffer, m_vertexBufferMemory);
+	VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+	if (m_pBufferManager->m_pSettings->graphicsSettings.vertexPulling) usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+	m_pBufferManager->createBuffer(bufferSize, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_vertexBuffer, m_vertexBufferMemory);
+	if (m_pBufferManager->m_pSettings->graphicsSettings.vertexPulling) m_vertexBufferAddress = m_pBufferManager->getBufferDeviceAddress(m_vertexBuffer);
 
 	m_pBufferManager->copyBuffer(stagingBuffer, m_vertexBuffer, bufferSize);
 
-	vkDestroyBuffer(*m_pBufferManager->m_pLogicalDevice, stagingBuffer, nullptr);
-	vkFreeMemory(*m_pBufferManager->m_pLogicalDevice, stagingBufferMemory, nullptr);
+	m_pBufferManager->m_pCommandBuffer->releaseStagingBuffer(stagingBuffer, stagingBufferMemory);
 }
 
 void VertexBuffer::createIndexBuffer()
@@ -359,12 +747,15 @@ void VertexBuffer::createIndexBuffer()
 	memcpy(data, m_indices.data(), (size_t)bufferSize);
 	vkUnmapMemory(*m_pBufferManager->m_pLogicalDevice, stagingBufferMemory);
 
-	m_pBufferManager->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_indexBuffer, m_indexBufferMemory);
+	VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+	if (m_pBufferManager->m_pSettings->graphicsSettings.vertexPulling) usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+	m_pBufferManager->createBuffer(bufferSize, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_indexBuffer, m_indexBufferMemory);
+	if (m_pBufferManager->m_pSettings->graphicsSettings.vertexPulling) m_indexBufferAddress = m_pBufferManager->getBufferDeviceAddress(m_indexBuffer);
 
 	m_pBufferManager->copyBuffer(stagingBuffer, m_indexBuffer, bufferSize);
 
-	vkDestroyBuffer(*m_pBufferManager->m_pLogicalDevice, stagingBuffer, nullptr);
-	vkFreeMemory(*m_pBufferManager->m_pLogicalDevice, stagingBufferMemory, nullptr);
+	m_pBufferManager->m_pCommandBuffer->releaseStagingBuffer(stagingBuffer, stagingBufferMemory);
 }
 
 
@@ -385,101 +776,38 @@ void VertexBuffer::cleanup()
 
 
 //// ----------------------------------------------------- //
-/// -------------------- Depth Buffer ------------------- //
+/// --------------- Face Instance Buffer ---------------- //
 // ----------------------------------------------------- //
 
-void DepthBuffer::createDepthResources()
-{
-	VkExtent2D swapchainExtent = *m_pBufferManager->m_pSwapchain->getSwapchainExtent();
-
-	VkFormat depthFormat = findDepthFormat(m_pBufferManager->m_pPhysicalDevice);
-	Image::createImage(swapchainExtent.width, swapchainExtent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL,
-		VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_depthImage, m_depthImageMemory);
-
-	m_depthImageView = Image::createImageView(m_depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
-	Image::transitionImageLayout(m_depthImage, depthFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
-}
-
-VkFormat DepthBuffer::findDepthFormat(VkPhysicalDevice* pPhysicalDevice)
-{
-	return findSupportedFormat(pPhysicalDevice,
-		{ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
-		VK_IMAGE_TILING_OPTIMAL,
-		VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
-	);
-}
-
-VkFormat DepthBuffer::findSupportedFormat(VkPhysicalDevice* pPhysicalDevice, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features)
-{
-	for (VkFormat format : candidates)
-	{
-		VkFormatProperties props;
-		vkGetPhysicalDeviceFormatProperties(*pPhysicalDevice, format, &props);
-
-		if (tiling == VK_IMAGE_TILING_LINEAR && (props.linearTilingFeatures & features) == features)
-			return(format);
-		else if (tiling == VK_IMAGE_TILING_OPTIMAL && (props.optimalTilingFeatures & features) == features)
-			return(format);
-
-	}
-
-	throw std::runtime_error("Failed to find supported format!");
-}
-
-
 
-void DepthBuffer::cleanup()
+void FaceInstanceBuffer::createInstanceBuffer()
 {
-	vkDestroyImageView(*m_pBufferManager->m_pLogicalDevice, m_depthImageView, nullptr);
-	vkDestroyImage(*m_pBufferManager->m_pLogicalDevice, m_depthImage, nullptr);
-	vkFreeMemory(*m_pBufferManager->m_pLogicalDevice, m_depthImageMemory, nullptr);
-}
-
-
-
+	mfDebugPrint(std::format("Creating face instance buffer for {} faces...", m_faceInstances.size()));
 
+	if (m_faceInstances.empty()) return; // Nothing visible, the draw is skipped
 
+	VkDeviceSize bufferSize = sizeof(m_faceInstances[0]) * m_faceInstances.size();
 
-//// ----------------------------------------------------- //
-/// -------------------- Frame Buffer ------------------- //
-// ----------------------------------------------------- //
-
-void Framebuffer::createFramebuffers()
-{
-	Swapchain* pSwapchain = m_pBufferManager->m_pSwapchain;
-	std::vector<VkImageView> swapchainImageViews = *pSwapchain->getSwapchainImageViews();
-	VkExtent2D swapchainExtent = *pSwapchain->getSwapchainExtent();
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingBufferMemory;
+	m_pBufferManager->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
 
-	m_framebuffers.resize(swapchainImageViews.size());
+	void* data;
+	vkMapMemory(*m_pBufferManager->m_pLogicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
+	memcpy(data, m_faceInstances.data(), (size_t)bufferSize);
+	vkUnmapMemory(*m_pBufferManager->m_pLogicalDevice, stagingBufferMemory);
 
-	for (size_t i = 0; i < swapchainImageViews.size(); i++)
-	{
-		std::array<VkImageView, 2> attachments = {
-			swapchainImageViews[i],
-			*m_pBufferManager->m_pDepthBuffer->getVkImageView()
-		};
+	m_pBufferManager->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_instanceBuffer, m_instanceBufferMemory);
 
-		VkFramebufferCreateInfo framebufferInfo{
-			.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
-			.renderPass = *m_pBufferManager->m_pRenderPass,
-			.attachmentCount = static_cast<uint32_t>(attachments.size()),
-			.pAttachments = attachments.data(),
-			.width = swapchainExtent.width,
-			.height = swapchainExtent.height,
-			.layers = 1
-		};
+	m_pBufferManager->copyBuffer(stagingBuffer, m_instanceBuffer, bufferSize);
 
-		if (vkCreateFramebuffer(*m_pBufferManager->m_pLogicalDevice, &framebufferInfo, nullptr, &m_framebuffers[i]) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create framebuffer!");
-		}
-	}
+	m_pBufferManager->m_pCommandBuffer->releaseStagingBuffer(stagingBuffer, stagingBufferMemory);
 }
 
-void Framebuffer::cleanup()
+void FaceInstanceBuffer::cleanup()
 {
-	for (auto framebuffer : m_framebuffers) {
-		vkDestroyFramebuffer(*m_pBufferManager->m_pLogicalDevice, framebuffer, nullptr);
-	}
+	vkDestroyBuffer(*m_pBufferManager->m_pLogicalDevice, m_instanceBuffer, nullptr);
+	vkFreeMemory(*m_pBufferManager->m_pLogicalDevice, m_instanceBufferMemory, nullptr);
 }
 
 
@@ -7,9 +7,16 @@
 #include <array>
 #include <vector>
 #include <stdexcept>
+#include <atomic>
 
 #include "Vertex.h"
+#include "FaceInstance.h"
 #include "Swapchain.h"
+#include "GraphicsPipeline.h"
+#include "FrameContext.h"
+#include "RenderGraph.h"
+#include "DeletionQueue.h"
+#include "../Utilities/ThreadPool.h"
 
 
 #define mfDebugPrint(x) m_pBufferManager->m_pUtilities->debugPrint(x,this)
@@ -25,8 +32,7 @@
 
 class CommandBuffer;
 class VertexBuffer;
-class DepthBuffer;
-class Framebuffer;
+class FaceInstanceBuffer;
 class UniformBufferObject;
 class DescriptorSets;
 
@@ -34,12 +40,21 @@ class DescriptorSets;
 class BufferManager
 {
 public:
+	// A mesh drawn with the model pipeline, which samples its texture from the bindless array by slot.
+	struct sModelMesh
+	{
+		VertexBuffer* pVertexBuffer = nullptr;
+		uint32_t textureSlot = 0;
+	};
+
 	BufferManager();
 
 	// Don't use this, initialize each one individually to avoid nullptr errors.
 	void initBuffers();
 
 	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& pBuffer, VkDeviceMemory& pDeviceMemory);
+	// Buffer must have been created with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT.
+	VkDeviceAddress getBufferDeviceAddress(VkBuffer buffer);
 	void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
 	static uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
@@ -48,38 +63,43 @@ public:
 
 	CommandBuffer* getCommandBuffer() { return m_pCommandBuffer; }
 	VertexBuffer* getVertexBuffer() { return m_pVertexBuffer; }
-	DepthBuffer* getDepthBuffer() { return m_pDepthBuffer; }
-	Framebuffer* getFramebuffer() { return m_pFramebuffer; }
+	FaceInstanceBuffer* getFaceInstanceBuffer() { return m_pFaceInstanceBuffer; }
 	UniformBufferObject* getUniformBufferObject() { return m_pUniformBufferObject; }
 	DescriptorSets* getDescriptorSets() { return m_pDescriptorSets; }
+	RenderGraph* getRenderGraph() { return m_pRenderGraph; }
+	DeletionQueue* getDeletionQueue() { return m_pDeletionQueue; }
 
 private:
 	VkDevice* m_pLogicalDevice = nullptr;
 	static VkPhysicalDevice* m_pPhysicalDevice;
 	VkSurfaceKHR* m_pSurface = nullptr;
-	VkRenderPass* m_pRenderPass = nullptr;
 	Swapchain* m_pSwapchain = nullptr;
 	VkPipeline* m_pGraphicsPipeline = nullptr;
+	VkPipeline* m_pFaceInstancePipeline = nullptr;
+	VkPipeline* m_pModelPipeline = nullptr;
 	VkPipelineLayout* m_pPipelineLayout = nullptr;
 	Utilities* m_pUtilities = nullptr;
 	sSettings* m_pSettings = nullptr;
 	int m_MAX_FRAMES_IN_FLIGHT = 1;
 	VkQueue* m_pGraphicsQueue = nullptr;
 	VkDescriptorSetLayout* m_pDescriptorSetLayout = nullptr;
+	VkDescriptorSet* m_pBindlessDescriptorSet = nullptr; // Set 1, only present when bindless textures are enabled
 
 
 	CommandBuffer* m_pCommandBuffer = nullptr;
 	VertexBuffer* m_pVertexBuffer = nullptr;
-	DepthBuffer* m_pDepthBuffer = nullptr;
-	Framebuffer* m_pFramebuffer = nullptr;
+	FaceInstanceBuffer* m_pFaceInstanceBuffer = nullptr; // Only created when face-instanced terrain is enabled
+	VertexBuffer* m_pTerrainVertexBuffer = nullptr; // The same chunk as a Vertex/index mesh, for comparing the two paths
+	std::vector<sModelMesh> m_modelMeshes = {}; // Only filled when bindless textures are enabled
 	UniformBufferObject* m_pUniformBufferObject = nullptr;
 	DescriptorSets* m_pDescriptorSets = nullptr;
+	RenderGraph* m_pRenderGraph = nullptr;
+	DeletionQueue* m_pDeletionQueue = nullptr;
 
 	friend class VulkanEngine;
 	friend class CommandBuffer;
 	friend class VertexBuffer;
-	friend class DepthBuffer;
-	friend class Framebuffer;
+	friend class FaceInstanceBuffer;
 	friend class UniformBufferObject;
 	friend class DescriptorSets;
 };
@@ -111,9 +131,28 @@ protected:
 // ---------------------------------------------------- //
 
 
+// Frames are recorded through the render graph. The scene pass is a list of draws split into batches. Each batch goes
+// into a secondary command buffer, recorded by a worker thread from that thread's own pool for the frame, and the
+// primary buffer executes them in order. Frames with a single batch are recorded inline.
 class CommandBuffer
 {
 public:
+	// One draw call and the state it needs.
+	struct sDraw
+	{
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		VkBuffer vertexBuffer = VK_NULL_HANDLE; // Bound to binding 0, VK_NULL_HANDLE for none
+		VkBuffer indexBuffer = VK_NULL_HANDLE; // VK_NULL_HANDLE for a non-indexed draw
+		uint32_t count = 0; // Vertices, or indices for an indexed draw
+		uint32_t instanceCount = 1;
+		bool pushDrawRecord = false;
+		GraphicsPipeline::sDrawPushConstants drawRecord = {};
+		uint32_t indirectCount = 0; // Merged draws read from the frame's indirect buffer from firstIndirect on, 0 for a direct draw
+		uint32_t firstIndirect = 0;
+	};
+
+	static constexpr uint32_t DRAWS_PER_BATCH = 256;
+
 	/*
 	CommandBuffer(VkDevice* pLogicalDevice, VkPhysicalDevice* pPhysicalDevice, VkSurfaceKHR* pSurface, VkRenderPass* pRenderPass, Swapchain* pSwapchain, VkPipeline* pGraphicsPipeline)
 		: m_pLogicalDevice(pLogicalDevice), m_pPhysicalDevice(pPhysicalDevice), m_pSurface(pSurface), m_pRenderPass(pRenderPass), m_pSwapchain(pSwapchain), m_pGraphicsPipeline(pGraphicsPipeline),
@@ -130,19 +169,91 @@ public:
 	void createCommandPool();
 	VkCommandBuffer beginSingleTimeCommands();
 	void endSingleTimeCommands(VkCommandBuffer commandBuffer);
+	// While a batch is open, single-time commands all record into one command buffer that endUploadBatch submits and
+	// waits for once, instead of a submission and queue wait each.
+	void beginUploadBatch();
+	void endUploadBatch();
+	// Frees a staging buffer, or holds on to it until the open batch has been submitted and completed.
+	void releaseStagingBuffer(VkBuffer buffer, VkDeviceMemory memory);
+	// Also creates the recording threads and their per-frame pools.
 	void createCommandBuffers();
-	void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+	// Declares the frame's passes and compiles the graph. Needs the swapchain, call again whenever it is recreated.
+	void buildRenderGraph();
+	// Records the frame's command buffer. Its previous submission must have completed.
+	void recordCommandBuffer(const sFrameContext& frame, uint32_t imageIndex);
 
 	void cleanup();
 
 	VkCommandPool* getVkCommandPool() { return &sm_commandPool; }
 	std::vector<VkCommandBuffer>* getCommandBuffers() { return &sm_commandBuffers; }
+	// Seconds spent recording the last frame, and how many batches it was split into.
+	double getRecordTime() { return m_recordTime; }
+	uint32_t getBatchCount() { return m_batchCount; }
+	RenderGraph::PassHandle getScenePass() { return m_scenePass; }
+	// Draws the terrain chunk from its face instances, or from its Vertex mesh for comparison.
+	void setFaceInstancedTerrain(bool faceInstanced) { m_faceInstancedTerrain = faceInstanced; }
+	// Draws the face-instanced terrain chunk once per cell of a width x width grid, each copy a draw of its own, to load the
+	// recording path with many draws. 1 draws it once.
+	void setChunkGrid(uint32_t width) { m_chunkGridWidth = width; }
+	// Off records every batch on the render thread, for comparing against the recording threads.
+	void setParallelRecording(bool parallel) { m_parallelRecording = parallel; }
 
 private:
+	// Only ever used by one thread at a time, the one its slot belongs to
+	struct sRecordingPool
+	{
+		VkCommandPool pool = VK_NULL_HANDLE;
+		std::vector<VkCommandBuffer> secondaries = {};
+		uint32_t used = 0;
+	};
+
+	// Host-visible, so the render thread writes the frame's commands and draw records once the frame's fence has signalled.
+	// Holds capacity VkDrawIndirectCommands followed by as many sIndirectDrawRecords.
+	struct sIndirectBuffer
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		void* pMapped = nullptr;
+		VkDeviceAddress recordsAddress = 0;
+		uint32_t capacity = 0;
+	};
+
 	BufferManager* m_pBufferManager = nullptr;
 
 	static VkCommandPool sm_commandPool;
 	static std::vector<VkCommandBuffer> sm_commandBuffers;
+
+	ThreadPool* m_pRecordingThreads = nullptr;
+	uint32_t m_recordingSlots = 0; // Recording threads plus the render thread, which records too
+	std::vector<sRecordingPool> m_recordingPools = {}; // [frame * m_recordingSlots + slot]
+	std::vector<sDraw> m_draws = {};
+	std::vector<sIndirectBuffer> m_indirectBuffers = {}; // One per frame in flight, only used with indirect draws
+	VkBuffer m_frameIndirectBuffer = VK_NULL_HANDLE; // The recording frame's, read by recordDraws
+	uint32_t m_maxDrawIndirectCount = 1; // Commands per vkCmdDrawIndirect, 1 without multiDrawIndirect
+	std::vector<VkCommandBuffer> m_batches = {};
+	double m_recordTime = 0.0;
+	uint32_t m_batchCount = 0;
+	bool m_faceInstancedTerrain = true;
+	uint32_t m_chunkGridWidth = 1;
+	bool m_parallelRecording = true;
+	RenderGraph::ResourceHandle m_backbuffer = RenderGraph::INVALID_HANDLE;
+	RenderGraph::PassHandle m_scenePass = RenderGraph::INVALID_HANDLE;
+	VkCommandBuffer m_uploadBatch = VK_NULL_HANDLE;
+	uint32_t m_batchedCommands = 0;
+	std::vector<std::pair<VkBuffer, VkDeviceMemory>> m_stagingBuffers = {}; // Released while the batch is open
+
+
+	void recordScenePass(VkCommandBuffer commandBuffer, const RenderGraph::sPassContext& context);
+	void collectDraws();
+	// Draws the mesh from bound vertex and index buffers, or through its buffer addresses with vertex pulling.
+	void addMeshDraw(VkPipeline pipeline, VertexBuffer* pVertexBuffer, uint32_t textureIndex);
+	// Replaces runs of vertex-pulled draws with the same pipeline and texture by one indirect draw each, writing their
+	// commands and records to the frame's indirect buffer.
+	void mergeIndirectDraws(uint32_t frameIndex);
+	void createIndirectBuffer(sIndirectBuffer& indirectBuffer, uint32_t capacity);
+	void destroyIndirectBuffer(sIndirectBuffer& indirectBuffer);
+	void recordDraws(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, uint32_t begin, uint32_t end);
+	VkCommandBuffer acquireSecondary(uint32_t frameIndex, uint32_t slot);
 };
 
 
@@ -181,6 +292,9 @@ public:
 
 	VkBuffer* getVkVertexBuffer() { return &m_vertexBuffer; }
 	VkBuffer* getVkIndexBuffer() { return &m_indexBuffer; }
+	// Only valid when vertex pulling is enabled.
+	VkDeviceAddress getVertexBufferAddress() { return m_vertexBufferAddress; }
+	VkDeviceAddress getIndexBufferAddress() { return m_indexBufferAddress; }
 
 private:
 	BufferManager* m_pBufferManager = nullptr;
@@ -189,6 +303,8 @@ private:
 	VkDeviceMemory m_vertexBufferMemory = VK_NULL_HANDLE;
 	VkBuffer m_indexBuffer = VK_NULL_HANDLE;
 	VkDeviceMemory m_indexBufferMemory = VK_NULL_HANDLE;
+	VkDeviceAddress m_vertexBufferAddress = 0;
+	VkDeviceAddress m_indexBufferAddress = 0;
 };
 
 
@@ -198,58 +314,35 @@ private:
 
 
 //// ----------------------------------------------------- //
-/// -------------------- Depth Buffer ------------------- //
+/// --------------- Face Instance Buffer ---------------- //
 // ----------------------------------------------------- //
 
-class DepthBuffer
+
+// Per-instance vertex buffer of packed FaceInstance records for one chunk. Drawn with 6 vertices per instance.
+class FaceInstanceBuffer
 {
 public:
-	DepthBuffer(BufferManager* pBufferManager) : m_pBufferManager(pBufferManager)
+	FaceInstanceBuffer(BufferManager* pBufferManager, std::vector<FaceInstance> faceInstances, glm::vec3 chunkOrigin) : m_pBufferManager(pBufferManager), m_faceInstances(faceInstances), m_chunkOrigin(chunkOrigin)
 	{
-		createDepthResources();
+		createInstanceBuffer();
 	};
 
-	void createDepthResources();
-	static VkFormat findDepthFormat(VkPhysicalDevice* pPhysicalDevice);
-	static VkFormat findSupportedFormat(VkPhysicalDevice* pPhysicalDevice, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
+	void createInstanceBuffer();
 
 	void cleanup();
 
-	VkImageView* getVkImageView() { return &m_depthImageView; }
-private:
-	BufferManager* m_pBufferManager = nullptr;
-
-	VkImage m_depthImage = VK_NULL_HANDLE;
-	VkDeviceMemory m_depthImageMemory = VK_NULL_HANDLE;
-	VkImageView m_depthImageView = VK_NULL_HANDLE;
-};
-
-
-
-
-
-
-//// ----------------------------------------------------- //
-/// -------------------- Frame Buffer ------------------- //
-// ----------------------------------------------------- //
+	VkBuffer* getVkInstanceBuffer() { return &m_instanceBuffer; }
+	uint32_t getInstanceCount() { return static_cast<uint32_t>(m_faceInstances.size()); }
+	glm::vec3 getChunkOrigin() { return m_chunkOrigin; }
 
-
-class Framebuffer
-{
-public:
-	Framebuffer(BufferManager* pBufferManager) : m_pBufferManager(pBufferManager)
-	{
-		createFramebuffers();
-	};
-
-	void createFramebuffers();
-	void cleanup();
-
-	std::vector<VkFramebuffer>* getFramebuffers() { return &m_framebuffers; }
 private:
 	BufferManager* m_pBufferManager = nullptr;
 
-	std::vector<VkFramebuffer> m_framebuffers = {};
+	std::vector<FaceInstance> m_faceInstances;
+	glm::vec3 m_chunkOrigin;
+
+	VkBuffer m_instanceBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory m_instanceBufferMemory = VK_NULL_HANDLE;
 };
 
 
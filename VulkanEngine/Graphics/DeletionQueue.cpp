@@ -0,0 +1,40 @@
+#include "DeletionQueue.h"
+
+#include <algorithm>
+
+
+
+void DeletionQueue::retire(Deleter deleter)
+{
+	m_retired.push_back(sRetired{
+		.deleter = std::move(deleter),
+		.pendingFences = m_frameFences
+	});
+}
+
+void DeletionQueue::collect()
+{
+	if (m_retired.empty()) return;
+
+	// A fence seen signalled means its frame finished everything it recorded before the retirement. It may be reset
+	// and resubmitted before it is next checked, which only delays the deletion
+	std::vector<VkFence> signalled;
+	for (VkFence fence : m_frameFences)
+		if (vkGetFenceStatus(*m_pLogicalDevice, fence) == VK_SUCCESS) signalled.push_back(fence);
+
+	std::erase_if(m_retired, [&signalled](sRetired& retired) {
+		std::erase_if(retired.pendingFences, [&signalled](VkFence fence) { return std::find(signalled.begin(), signalled.end(), fence) != signalled.end(); });
+		if (!retired.pendingFences.empty()) return false;
+
+		retired.deleter();
+		return true;
+	});
+}
+
+void DeletionQueue::flush()
+{
+	if (!m_retired.empty()) mDebugPrint(std::format("Destroying {} retired object set(s)...", m_retired.size()));
+
+	for (sRetired& retired : m_retired) retired.deleter();
+	m_retired.clear();
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <vector>
+#include <functional>
+
+#include "../Utilities/Utilities.h"
+
+
+
+// Vulkan objects that frames still in flight may be using. Each retirement is keyed to the fences of the frames in
+// flight when it happened and destroyed once every one of them has been seen signalled, so replacing an object never
+// needs the device to go idle.
+class DeletionQueue
+{
+public:
+	using Deleter = std::function<void()>;
+
+	DeletionQueue(VkDevice* pLogicalDevice) : m_pLogicalDevice(pLogicalDevice), m_pUtilities(Utilities::getInstance()) {};
+
+	// The frame fences retirements wait on. Until they are set nothing counts as in flight.
+	void setFrameFences(const std::vector<VkFence>& fences) { m_frameFences = fences; };
+	void retire(Deleter deleter);
+	// Destroys whatever no frame can still be using. Never blocks, call once per frame.
+	void collect();
+	// Destroys everything. The device must be idle.
+	void flush();
+
+	size_t getPendingCount() { return m_retired.size(); }
+
+private:
+	struct sRetired
+	{
+		Deleter deleter = {};
+		std::vector<VkFence> pendingFences = {}; // Not yet seen signalled since the retirement
+	};
+
+	Utilities* m_pUtilities = nullptr;
+	VkDevice* m_pLogicalDevice = nullptr;
+
+	std::vector<VkFence> m_frameFences = {};
+	std::vector<sRetired> m_retired = {};
+};
\ No newline at end of file
@@ -45,13 +45,16 @@ bool PhysicalDevice::isDeviceSuitable(VkPhysicalDevice candidateDevice)
 {
 	mDebugPrint("Checking device suitability...");
 
+	// Headless runs have no surface, so any device that can render will do, software ones included
+	bool headless = *m_pSurface == VK_NULL_HANDLE;
+
 	QueueFamilyIndices::sQueueFamilyIndices indices = QueueFamilyIndices::findQueueFamilies(candidateDevice, *m_pSurface);
 	bool extensionsSupported = checkDeviceExtensionSupport(candidateDevice);
 
 	mDebugPrint("Extensions supported: " + std::to_string(extensionsSupported));
 
-	bool swapChainAdequate = false;
-	if (extensionsSupported)
+	bool swapChainAdequate = headless;
+	if (extensionsSupported && !headless)
 	{
 		SwapChainSupportDetails swapChainSupport = querySwapChainSupport(candidateDevice);
 		swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
@@ -60,7 +63,7 @@ bool PhysicalDevice::isDeviceSuitable(VkPhysicalDevice candidateDevice)
 	VkPhysicalDeviceFeatures supportedFeatures;
 	vkGetPhysicalDeviceFeatures(candidateDevice, &supportedFeatures);
 
-	bool finalResult = indices.isComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
+	bool finalResult = indices.isComplete(!headless) && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
 	mDebugPrint("Device suitable: " + std::to_string(finalResult));
 
 	return finalResult;
@@ -77,7 +80,8 @@ bool PhysicalDevice::checkDeviceExtensionSupport(VkPhysicalDevice candidateDevic
 	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
 	vkEnumerateDeviceExtensionProperties(candidateDevice, nullptr, &extensionCount, availableExtensions.data());
 
-	std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
+	std::set<std::string> requiredExtensions = {};
+	if (*m_pSurface != VK_NULL_HANDLE) requiredExtensions.insert(deviceExtensions.begin(), deviceExtensions.end());
 
 	for (const auto& extension : availableExtensions)
 	{
@@ -142,7 +146,10 @@ void LogicalDevice::createLogicalDevice()
 	QueueFamilyIndices::sQueueFamilyIndices indices = QueueFamilyIndices::findQueueFamilies(*VulkanEngine::getInstance()->m_pPhysicalDevice->getVkPhysicalDevice(), *m_pSurface);
 
 	std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-	std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value(), indices.presentFamily.value() };
+	// Headless there is no present family, and no swapchain to enable the extension for
+	bool headless = !indices.presentFamily.has_value();
+	std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value() };
+	if (!headless) uniqueQueueFamilies.insert(indices.presentFamily.value());
 
 	float queuePriority = 1.0f;
 	for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -156,12 +163,46 @@ void LogicalDevice::createLogicalDevice()
 		queueCreateInfos.push_back(queueCreateInfo);
 	}
 
+	// Vulkan 1.2 features, only chained in when a setting that needs them is enabled (see VulkanEngine::validateSettings)
+	VkPhysicalDeviceVulkan12Features features12{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES
+	};
+	bool useFeatures12 = false;
+
+	if (pSettings->graphicsSettings.bindlessTextures)
+	{
+		features12.descriptorIndexing = VK_TRUE;
+		features12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+		features12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		features12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		features12.descriptorBindingPartiallyBound = VK_TRUE;
+		features12.descriptorBindingVariableDescriptorCount = VK_TRUE;
+		features12.runtimeDescriptorArray = VK_TRUE;
+		useFeatures12 = true;
+	}
+
+	if (pSettings->graphicsSettings.vertexPulling)
+	{
+		features12.bufferDeviceAddress = VK_TRUE;
+		useFeatures12 = true;
+	}
+
+	if (pSettings->graphicsSettings.indirectDraws)
+	{
+		// Without multiDrawIndirect, CommandBuffer issues one vkCmdDrawIndirect per merged draw
+		VkPhysicalDeviceFeatures supportedFeatures{};
+		vkGetPhysicalDeviceFeatures(*VulkanEngine::getInstance()->m_pPhysicalDevice->getVkPhysicalDevice(), &supportedFeatures);
+		deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+		deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+	}
+
 	VkDeviceCreateInfo createInfo{
 		.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+		.pNext = useFeatures12 ? &features12 : nullptr,
 		.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
 		.pQueueCreateInfos = queueCreateInfos.data(),
-		.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size()),
-		.ppEnabledExtensionNames = deviceExtensions.data(),
+		.enabledExtensionCount = headless ? 0 : static_cast<uint32_t>(deviceExtensions.size()),
+		.ppEnabledExtensionNames = headless ? nullptr : deviceExtensions.data(),
 		.pEnabledFeatures = &deviceFeatures
 	};
 
@@ -183,7 +224,7 @@ void LogicalDevice::createLogicalDevice()
 	}
 
 	vkGetDeviceQueue(m_logicalDevice, indices.graphicsFamily.value(), 0, &m_graphicsQueue);
-	vkGetDeviceQueue(m_logicalDevice, indices.presentFamily.value(), 0, &m_presentQueue);
+	if (!headless) vkGetDeviceQueue(m_logicalDevice, indices.presentFamily.value(), 0, &m_presentQueue);
 }
 
 void LogicalDevice::cleanup()
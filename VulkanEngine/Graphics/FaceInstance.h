@@ -0,0 +1,58 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <array>
+#include <cstdint>
+
+
+
+// Compact per-face record for face-instanced terrain. One instance is drawn per visible block face and
+// the vertex shader (shaders/face.vert) expands it into a quad using gl_VertexIndex, so a face costs
+// 8 bytes instead of 4 Vertex structs and 6 indices.
+struct FaceInstance {
+	uint32_t positionFace; // Chunk-local x (bits 0-4), y (bits 5-9), z (bits 10-14), face direction (bits 15-17).
+	uint32_t layerAO; // Texture array layer (bits 0-15), ambient occlusion level for each corner, 2 bits each (bits 16-23).
+
+	static FaceInstance pack(uint32_t x, uint32_t y, uint32_t z, uint32_t face, uint32_t textureLayer, uint32_t ambientOcclusion)
+	{
+		return FaceInstance{
+			.positionFace = (x & 0x1F) | ((y & 0x1F) << 5) | ((z & 0x1F) << 10) | ((face & 0x7) << 15),
+			.layerAO = (textureLayer & 0xFFFF) | ((ambientOcclusion & 0xFF) << 16)
+		};
+	}
+
+	static VkVertexInputBindingDescription getBindingDescription()
+	{
+		VkVertexInputBindingDescription bindingDescription{
+			.binding = 0,
+			.stride = sizeof(FaceInstance),
+			.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE
+		};
+
+		return bindingDescription;
+	}
+
+	static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions()
+	{
+		std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{
+			VkVertexInputAttributeDescription{
+				.location = 0,
+				.binding = 0,
+				.format = VK_FORMAT_R32_UINT,
+				.offset = offsetof(FaceInstance, positionFace)
+			},
+			VkVertexInputAttributeDescription{
+				.location = 1,
+				.binding = 0,
+				.format = VK_FORMAT_R32_UINT,
+				.offset = offsetof(FaceInstance, layerAO)
+			}
+		};
+
+		return attributeDescriptions;
+	}
+};
+
+static_assert(sizeof(FaceInstance) == 8, "FaceInstance must stay 8 bytes");
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+
+
+
+// Everything one frame in flight owns, so every per-frame resource is picked by the same index. The CPU only
+// touches a context again once its fence has signalled, by which point the GPU is done with all of it.
+struct sFrameContext
+{
+	uint32_t index = 0; // Into the per-frame arrays of every owner (command buffers, UBOs, descriptor sets, recording pools)
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+	VkSemaphore imageAvailable = VK_NULL_HANDLE;
+	VkFence inFlight = VK_NULL_HANDLE;
+	void* pUniformBufferMapped = nullptr;
+	VkDescriptorSet descriptorSet = VK_NULL_HANDLE; // Set 0, pointing at this frame's uniform buffer
+	double cpuStartTime = 0.0; // When the frame read its input, 0 once its present latency has been measured
+};
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "FramePacer.h"
+
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+
+
+FramePacer::FramePacer()
+{
+#ifdef _WIN32
+	// The default 15.6 ms scheduler tick would push the margin to its cap and leave most of the wait spinning
+	timeBeginPeriod(1);
+#endif
+	m_nextFrame = Clock::now();
+	m_lastFrame = m_nextFrame;
+}
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::setTargetFrameTime(double seconds)
+{
+	m_targetFrameTime = std::max(seconds, 0.0);
+	m_nextFrame = Clock::now();
+}
+
+void FramePacer::waitForNextFrame(const std::function<void(double)>& sleep)
+{
+	if (m_targetFrameTime <= 0.0)
+	{
+		recordFrame(Clock::now());
+		return;
+	}
+
+	Clock::time_point deadline = m_nextFrame;
+	Clock::time_point now = Clock::now();
+	for (double remaining = std::chrono::duration<double>(deadline - now).count(); remaining > m_sleepMargin; remaining = std::chrono::duration<double>(deadline - now).count())
+	{
+		double requested = remaining - m_sleepMargin;
+		sleep(requested);
+		Clock::time_point woke = Clock::now();
+
+		// Only oversleeping says anything about the timer, early returns are the sleep function's choice
+		double overshoot = std::chrono::duration<double>(woke - now).count() - requested;
+		if (overshoot > 0.0) m_sleepMargin = std::clamp(std::max(m_sleepMargin * 0.99, overshoot * 1.25), MIN_SLEEP_MARGIN, MAX_SLEEP_MARGIN);
+		now = woke;
+	}
+	while (now < deadline)
+	{
+		std::this_thread::yield();
+		now = Clock::now();
+	}
+
+	double lateness = std::chrono::duration<double>(now - deadline).count();
+	m_pacedFrames++;
+	if (lateness <= ON_TIME_TOLERANCE) m_onTimeFrames++;
+	recordFrame(now);
+
+	// Keep to the original schedule so small errors don't accumulate, unless a whole frame was missed
+	m_nextFrame = deadline + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_targetFrameTime));
+	if (lateness > m_targetFrameTime) m_nextFrame = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_targetFrameTime));
+}
+
+FramePacer::sStats FramePacer::takeStats()
+{
+	sStats stats{ .frames = m_frames, .sleepMargin = m_sleepMargin };
+	if (m_frames > 0)
+	{
+		stats.averageFrameTime = m_frameTimeSum / m_frames;
+		stats.jitter = std::sqrt(std::max(m_frameTimeSquareSum / m_frames - stats.averageFrameTime * stats.averageFrameTime, 0.0));
+		stats.worstDeviation = m_worstDeviation;
+	}
+	if (m_pacedFrames > 0) stats.onTimeFraction = static_cast<double>(m_onTimeFrames) / m_pacedFrames;
+
+	m_frames = m_pacedFrames = m_onTimeFrames = 0;
+	m_frameTimeSum = m_frameTimeSquareSum = m_worstDeviation = 0.0;
+	return stats;
+}
+
+
+
+void FramePacer::recordFrame(Clock::time_point now)
+{
+	double frameTime = std::chrono::duration<double>(now - m_lastFrame).count();
+	m_lastFrame = now;
+
+	m_frames++;
+	m_frameTimeSum += frameTime;
+	m_frameTimeSquareSum += frameTime * frameTime;
+	if (m_targetFrameTime > 0.0) m_worstDeviation = std::max(m_worstDeviation, std::abs(frameTime - m_targetFrameTime));
+}
\ No newline at end of file
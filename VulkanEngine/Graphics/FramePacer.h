@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <cstdint>
+
+
+
+// Holds the render loop to a target frame time without burning a core. Most of the wait is spent in a coarse
+// sleep that ends a margin before the deadline; the remainder is spun out. The margin follows how late the
+// sleeps actually wake, so it stays small on systems with precise timers and grows where they are not.
+class FramePacer
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// Frame time statistics since the last takeStats().
+	struct sStats
+	{
+		uint32_t frames = 0;
+		double averageFrameTime = 0.0; // Seconds between frame starts
+		double jitter = 0.0; // Standard deviation of the frame time, seconds
+		double worstDeviation = 0.0; // Furthest any frame time was from the target, seconds
+		double onTimeFraction = 0.0; // Share of paced frames that started within ON_TIME_TOLERANCE of their deadline
+		double sleepMargin = 0.0; // Seconds currently left to the spin
+	};
+
+	static constexpr double ON_TIME_TOLERANCE = 0.0002;
+
+	FramePacer();
+	~FramePacer();
+
+	// 0 leaves frames unpaced.
+	void setTargetFrameTime(double seconds);
+	double getTargetFrameTime() { return m_targetFrameTime; }
+
+	// Returns once the next frame is due. `sleep` does the coarse waiting and may return early, for instance to
+	// handle window events; it is called again until only the margin is left.
+	void waitForNextFrame(const std::function<void(double)>& sleep);
+
+	sStats takeStats();
+
+private:
+	static constexpr double MIN_SLEEP_MARGIN = 0.0002;
+	static constexpr double MAX_SLEEP_MARGIN = 0.004;
+
+	double m_targetFrameTime = 0.0;
+	double m_sleepMargin = 0.001;
+	Clock::time_point m_nextFrame = {};
+	Clock::time_point m_lastFrame = {};
+
+	// Running sums for the current stats window
+	uint32_t m_frames = 0;
+	uint32_t m_pacedFrames = 0;
+	uint32_t m_onTimeFrames = 0;
+	double m_frameTimeSum = 0.0;
+	double m_frameTimeSquareSum = 0.0;
+	double m_worstDeviation = 0.0;
+
+
+	void recordFrame(Clock::time_point now);
+};
\ No newline at end of file
@@ -1,92 +1,22 @@
 #include "../VulkanEngine.h"
 #include "Buffers.h"
+#include "TextureRegistry.h"
 
 #include "GraphicsPipeline.h"
 
 
 GraphicsPipeline::GraphicsPipeline() : m_pLogicalDevice(VulkanEngine::getInstance()->m_pLogicalDevice->getVkDevice()), m_pPhysicalDevice(VulkanEngine::getInstance()->m_pPhysicalDevice->getVkPhysicalDevice()),
-m_pSwapchain(VulkanEngine::getInstance()->m_pSwapchain), m_pGraphicsSettings(&VulkanEngine::getInstance()->m_settings->graphicsSettings), m_pUtilities(Utilities::getInstance())
+m_pSwapchain(VulkanEngine::getInstance()->m_pSwapchain), m_pTextureRegistry(VulkanEngine::getInstance()->m_pTextureRegistry), m_pGraphicsSettings(&VulkanEngine::getInstance()->m_settings->graphicsSettings),
+m_pUtilities(Utilities::getInstance())
 {
-	createRenderPass();
+	// Pipelines only need a compatible render pass, and the graph's scene pass keeps the same formats across swapchain recreation
+	BufferManager* pBufferManager = VulkanEngine::getInstance()->m_pBufferManager;
+	m_renderPass = pBufferManager->getRenderGraph()->getRenderPass(pBufferManager->getCommandBuffer()->getScenePass());
+
 	createDescriptorSetLayout();
 	createGraphicsPipeline();
 };
 
-void GraphicsPipeline::createRenderPass()
-{
-	mDebugPrint("Creating render pass...");
-
-	// Attachment setup
-	VkAttachmentDescription colorAttachment{
-		.format = *m_pSwapchain->getSwapchainImageFormat(),
-		.samples = VK_SAMPLE_COUNT_1_BIT,
-		.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-		.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-		.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-		.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-		.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-		.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
-	};
-
-	VkAttachmentDescription depthAttachment{
-		.format = DepthBuffer::findDepthFormat(m_pPhysicalDevice),
-		.samples = VK_SAMPLE_COUNT_1_BIT,
-		.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-		.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE, // We don't need the depth buffer after drawing has finished
-		.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-		.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-		.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-		.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
-	};
-
-	// Attachment reference
-	VkAttachmentReference colorAttachmentRef{
-		.attachment = 0,
-		.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-	};
-
-	VkAttachmentReference depthAttachmentRef{
-		.attachment = 1,
-		.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
-	};
-
-	// Subpass
-	VkSubpassDescription subpass{
-		.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
-		.colorAttachmentCount = 1,
-		.pColorAttachments = &colorAttachmentRef,
-		.pDepthStencilAttachment = &depthAttachmentRef
-	};
-
-	// Subpass dependency
-	VkSubpassDependency dependency{
-		.srcSubpass = VK_SUBPASS_EXTERNAL,
-		.dstSubpass = 0,
-		.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-		.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-		.srcAccessMask = 0,
-		.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
-	};
-
-	// Render pass
-	std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
-	VkRenderPassCreateInfo renderPassInfo{
-		.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
-		.attachmentCount = static_cast<uint32_t>(attachments.size()),
-		.pAttachments = attachments.data(),
-		.subpassCount = 1,
-		.pSubpasses = &subpass,
-		.dependencyCount = 1,
-		.pDependencies = &dependency
-	};
-
-	if (vkCreateRenderPass(*m_pLogicalDevice, &renderPassInfo, nullptr, &m_renderPass) != VK_SUCCESS) {
-		throw std::runtime_error("failed to create render pass!");
-	}
-
-
-}
-
 void GraphicsPipeline::createDescriptorSetLayout()
 {
 	mDebugPrint("Creating uniform buffer descriptor set layout...");
@@ -132,11 +62,102 @@ void GraphicsPipeline::createDescriptorSetLayout()
 }
 
 void GraphicsPipeline::createGraphicsPipeline()
+{
+	createPipelineLayout();
+
+	auto bindingDescription = Vertex::getBindingDescription();
+	auto attributeDescriptions = Vertex::getAttributeDescriptions();
+
+	VkPipelineVertexInputStateCreateInfo vertexInputInfo{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+		.vertexBindingDescriptionCount = 1,
+		.pVertexBindingDescriptions = &bindingDescription,
+		.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size()),
+		.pVertexAttributeDescriptions = attributeDescriptions.data()
+	};
+	if (m_pGraphicsSettings->vertexPulling)
+	{
+		vertexInputInfo.vertexBindingDescriptionCount = 0;
+		vertexInputInfo.vertexAttributeDescriptionCount = 0;
+	}
+
+	// With indirect draws, pulling.vert reads each draw's record from the frame's indirect buffer instead of the push constants
+	VkBool32 indirectDraws = m_pGraphicsSettings->indirectDraws;
+	VkSpecializationMapEntry indirectDrawsEntry{
+		.constantID = 0,
+		.offset = 0,
+		.size = sizeof(VkBool32)
+	};
+	VkSpecializationInfo pullingSpecializationInfo{
+		.mapEntryCount = 1,
+		.pMapEntries = &indirectDrawsEntry,
+		.dataSize = sizeof(VkBool32),
+		.pData = &indirectDraws
+	};
+	const VkSpecializationInfo* pVertSpecializationInfo = m_pGraphicsSettings->vertexPulling ? &pullingSpecializationInfo : nullptr;
+
+	// Vertex pulling reads vertices through buffer device addresses, so it uses its own vertex shader and no vertex input
+	mDebugPrint("Creating graphics pipeline...");
+	m_graphicsPipeline = createPipeline(m_pGraphicsSettings->vertexPulling ? "shaders/pulling_vert.spv" : "shaders/vert.spv", "shaders/frag.spv", vertexInputInfo, pVertSpecializationInfo);
+
+	// Models take the same vertices, but sample their own texture from the bindless array (set 1) by the slot in the draw record
+	if (m_pTextureRegistry != nullptr)
+	{
+		mDebugPrint("Creating model pipeline...");
+		m_modelPipeline = createPipeline(m_pGraphicsSettings->vertexPulling ? "shaders/pulling_vert.spv" : "shaders/vert.spv", "shaders/model_frag.spv", vertexInputInfo, pVertSpecializationInfo);
+	}
+
+	// Face-instanced terrain expands one FaceInstance per quad in the vertex shader, with no index buffer
+	if (m_pGraphicsSettings->faceInstancedTerrain)
+	{
+		auto faceBindingDescription = FaceInstance::getBindingDescription();
+		auto faceAttributeDescriptions = FaceInstance::getAttributeDescriptions();
+
+		VkPipelineVertexInputStateCreateInfo faceInputInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+			.vertexBindingDescriptionCount = 1,
+			.pVertexBindingDescriptions = &faceBindingDescription,
+			.vertexAttributeDescriptionCount = static_cast<uint32_t>(faceAttributeDescriptions.size()),
+			.pVertexAttributeDescriptions = faceAttributeDescriptions.data()
+		};
+
+		mDebugPrint("Creating face instance pipeline...");
+		m_faceInstancePipeline = createPipeline("shaders/face_vert.spv", "shaders/frag.spv", faceInputInfo);
+	}
+}
+
+void GraphicsPipeline::createPipelineLayout()
 {
 	mDebugPrint("Creating graphics pipeline layout...");
 
-	auto vertShaderCode = m_pUtilities->readFile("shaders/vert.spv");
-	auto fragShaderCode = m_pUtilities->readFile("shaders/frag.spv");
+	// Set 0 holds the per-frame UBO and block texture array, set 1 the bindless texture array when enabled.
+	// The layout doesn't change when textures are added or removed, so pipelines never need rebuilding for it.
+	std::vector<VkDescriptorSetLayout> setLayouts = { m_descriptorSetLayout };
+	if (m_pTextureRegistry != nullptr) setLayouts.push_back(*m_pTextureRegistry->getDescriptorSetLayout());
+
+	VkPushConstantRange pushConstantRange{
+		.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+		.offset = 0,
+		.size = sizeof(sDrawPushConstants)
+	};
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.setLayoutCount = static_cast<uint32_t>(setLayouts.size()),
+		.pSetLayouts = setLayouts.data(),
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &pushConstantRange
+	};
+
+	if (vkCreatePipelineLayout(*m_pLogicalDevice, &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create pipeline layout!");
+	}
+}
+
+VkPipeline GraphicsPipeline::createPipeline(const std::string& vertShaderPath, const std::string& fragShaderPath, const VkPipelineVertexInputStateCreateInfo& vertexInputInfo, const VkSpecializationInfo* pVertSpecializationInfo)
+{
+	auto vertShaderCode = m_pUtilities->readFile(vertShaderPath);
+	auto fragShaderCode = m_pUtilities->readFile(fragShaderPath);
 
 	VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
 	VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
@@ -147,7 +168,8 @@ void GraphicsPipeline::createGraphicsPipeline()
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
 		.stage = VK_SHADER_STAGE_VERTEX_BIT,
 		.module = vertShaderModule,
-		.pName = "main"
+		.pName = "main",
+		.pSpecializationInfo = pVertSpecializationInfo
 	};
 
 	// Fragment shader stage
@@ -159,16 +181,6 @@ void GraphicsPipeline::createGraphicsPipeline()
 	};
 
 	VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
-	auto bindingDescription = Vertex::getBindingDescription();
-	auto attributeDescriptions = Vertex::getAttributeDescriptions();
-
-	VkPipelineVertexInputStateCreateInfo vertexInputInfo{
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-		.vertexBindingDescriptionCount = 1,
-		.pVertexBindingDescriptions = &bindingDescription,
-		.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size()),
-		.pVertexAttributeDescriptions = attributeDescriptions.data()
-	};
 
 	VkPipelineInputAssemblyStateCreateInfo inputAssembly{
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
@@ -293,20 +305,6 @@ void GraphicsPipeline::createGraphicsPipeline()
 		.pDynamicStates = dynamicStates.data()
 	};
 
-	VkPipelineLayoutCreateInfo pipelineLayoutInfo{
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-		.setLayoutCount = 1, // Optional
-		.pSetLayouts = &m_descriptorSetLayout,
-		.pushConstantRangeCount = 0, // Optional 
-		.pPushConstantRanges = nullptr // Optional
-	};
-
-	if (vkCreatePipelineLayout(*m_pLogicalDevice, &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
-		throw std::runtime_error("failed to create pipeline layout!");
-	}
-
-
-
 	// Pipeline
 	mDebugPrint("Creating pipeline...");
 	VkGraphicsPipelineCreateInfo pipelineInfo{
@@ -333,21 +331,25 @@ void GraphicsPipeline::createGraphicsPipeline()
 	};
 
 
-	if (vkCreateGraphicsPipelines(*m_pLogicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
+	VkPipeline pipeline;
+	if (vkCreateGraphicsPipelines(*m_pLogicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
 		throw std::runtime_error("failed to create graphics pipeline!");
 	}
 
 
 	vkDestroyShaderModule(*m_pLogicalDevice, vertShaderModule, nullptr);
 	vkDestroyShaderModule(*m_pLogicalDevice, fragShaderModule, nullptr);
+
+	return pipeline;
 }
 
 void GraphicsPipeline::cleanup()
 {
 	vkDestroyDescriptorSetLayout(*m_pLogicalDevice, m_descriptorSetLayout, nullptr);
 	vkDestroyPipeline(*m_pLogicalDevice, m_graphicsPipeline, nullptr);
+	if (m_faceInstancePipeline != VK_NULL_HANDLE) vkDestroyPipeline(*m_pLogicalDevice, m_faceInstancePipeline, nullptr);
+	if (m_modelPipeline != VK_NULL_HANDLE) vkDestroyPipeline(*m_pLogicalDevice, m_modelPipeline, nullptr);
 	vkDestroyPipelineLayout(*m_pLogicalDevice, m_pipelineLayout, nullptr);
-	vkDestroyRenderPass(*m_pLogicalDevice, m_renderPass, nullptr);
 }
 
 
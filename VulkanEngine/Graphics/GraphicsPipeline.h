@@ -7,24 +7,45 @@
 #include "Swapchain.h"
 #include "Devices.h"
 #include "Vertex.h"
+#include "FaceInstance.h"
 
 
 class Swapchain;
+class TextureRegistry;
 
 class GraphicsPipeline
 {
 public:
+	// Per-draw record pushed to the shaders. Keep in sync with the push_constant blocks in the shaders.
+	struct sDrawPushConstants
+	{
+		VkDeviceAddress vertexAddress = 0; // Start of the draw's vertices (vertex pulling only).
+		VkDeviceAddress indexAddress = 0; // Start of the draw's indices (vertex pulling only).
+		uint32_t textureIndex = 0; // Slot in the bindless texture array (set 1).
+		uint32_t baseVertex = 0; // Added to each index before fetching the vertex, like vertexOffset in vkCmdDrawIndexed.
+		alignas(16) glm::vec3 chunkOrigin = {}; // World position of the chunk being drawn (face-instanced terrain only).
+		VkDeviceAddress drawRecordsAddress = 0; // The frame's sIndirectDrawRecord array (indirect draws only).
+	};
+
+	// Per-draw record of a merged indirect draw. pulling.vert reads the one selected by the command's firstInstance.
+	struct sIndirectDrawRecord
+	{
+		VkDeviceAddress vertexAddress = 0;
+		VkDeviceAddress indexAddress = 0;
+		uint32_t textureIndex = 0;
+		uint32_t baseVertex = 0;
+	};
 
 	GraphicsPipeline();
 
-	void createRenderPass();
 	void createDescriptorSetLayout();
 	void createGraphicsPipeline();
 	void cleanup();
 
 	VkPipeline* getGraphicsPipeline() { return &m_graphicsPipeline; }
+	VkPipeline* getFaceInstancePipeline() { return &m_faceInstancePipeline; }
+	VkPipeline* getModelPipeline() { return &m_modelPipeline; }
 	VkPipelineLayout* getVkPipelineLayout() { return &m_pipelineLayout; }
-	VkRenderPass* getRenderPass() { return &m_renderPass; }
 	VkDescriptorSetLayout* getDescriptorSetLayout() { return &m_descriptorSetLayout; }
 
 private:
@@ -32,14 +53,19 @@ private:
 	VkDevice* m_pLogicalDevice = nullptr;
 	VkPhysicalDevice* m_pPhysicalDevice = nullptr;
 	Swapchain* m_pSwapchain = nullptr;
+	TextureRegistry* m_pTextureRegistry = nullptr;
 	sSettings::sGraphicsSettings* m_pGraphicsSettings = nullptr;
 
 	VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
 	VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
-	VkRenderPass m_renderPass = VK_NULL_HANDLE;
+	VkRenderPass m_renderPass = VK_NULL_HANDLE; // Owned by the render graph
 	VkPipeline m_graphicsPipeline = VK_NULL_HANDLE;
+	VkPipeline m_faceInstancePipeline = VK_NULL_HANDLE; // Only created when face-instanced terrain is enabled
+	VkPipeline m_modelPipeline = VK_NULL_HANDLE; // Only created when bindless textures are enabled
 
 
+	void createPipelineLayout();
+	VkPipeline createPipeline(const std::string& vertShaderPath, const std::string& fragShaderPath, const VkPipelineVertexInputStateCreateInfo& vertexInputInfo, const VkSpecializationInfo* pVertSpecializationInfo = nullptr);
 	VkShaderModule createShaderModule(const std::vector<char>& code);
 };
 
@@ -14,43 +14,95 @@ BufferManager* Image::m_pBufferManager = nullptr;
 sSettings::sGraphicsSettings* Image::m_pGraphicsSettings = nullptr;
 
 
-void Image::createTextureImage()
+void Image::decodeLayers()
 {
-	mDebugPrint("Creating texture image from path: " + m_imagePath);
+	if (m_layerPaths.empty())
+	{
+		throw std::runtime_error("Tried to create a texture image without any image paths!");
+	}
+
+	m_isArray ? mDebugPrint(std::format("Decoding texture array with {} layer(s)...", m_layerPaths.size())) : mDebugPrint("Decoding texture image from path: " + m_imagePath);
 
-	int texWidth, texHeight, texChannels;
-	stbi_uc* pixels = stbi_load(m_imagePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-	VkDeviceSize imageSize = static_cast<VkDeviceSize>(texWidth * texHeight * 4);
+	uint32_t layerCount = static_cast<uint32_t>(m_layerPaths.size());
+	std::vector<stbi_uc*> layerPixels(layerCount, nullptr);
 
-	if (!pixels)
+	for (uint32_t i = 0; i < layerCount; i++)
 	{
-		throw std::runtime_error("Failed to load texture image!");
+		int layerWidth, layerHeight, layerChannels;
+		layerPixels[i] = stbi_load(m_layerPaths[i].c_str(), &layerWidth, &layerHeight, &layerChannels, STBI_rgb_alpha);
+
+		if (!layerPixels[i])
+		{
+			for (auto pixels : layerPixels) stbi_image_free(pixels);
+			throw std::runtime_error("Failed to load texture image: " + m_layerPaths[i]);
+		}
+
+		// Every layer of an array texture shares the same extent
+		if (i == 0)
+		{
+			m_width = layerWidth;
+			m_height = layerHeight;
+		}
+		else if (layerWidth != m_width || layerHeight != m_height)
+		{
+			for (auto pixels : layerPixels) stbi_image_free(pixels);
+			throw std::runtime_error(std::format("Texture array layer {} ({}x{}) does not match layer 0 ({}x{})!", m_layerPaths[i], layerWidth, layerHeight, m_width, m_height));
+		}
 	}
 
+	m_layerPixels = layerPixels;
+}
+
+void Image::upload()
+{
+	createTextureImage();
+	createTextureImageView();
+	createTextureSampler();
+}
+
+void Image::createTextureImage()
+{
+	if (m_layerPixels.empty())
+	{
+		throw std::runtime_error("Tried to upload a texture image that hasn't been decoded!");
+	}
+
+	m_isArray ? mDebugPrint(std::format("Creating texture array with {} layer(s)...", m_layerPaths.size())) : mDebugPrint("Creating texture image from path: " + m_imagePath);
+
+	uint32_t layerCount = static_cast<uint32_t>(m_layerPixels.size());
+	VkDeviceSize layerSize = static_cast<VkDeviceSize>(m_width) * m_height * 4;
+	VkDeviceSize imageSize = layerSize * layerCount;
+
 	VkBuffer stagingBuffer;
 	VkDeviceMemory stagingBufferMemory;
 
 	m_pBufferManager->createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
 
+	// Layers are packed back to back, which is the layout vkCmdCopyBufferToImage expects for a multi-layer copy
 	void* data;
 	vkMapMemory(*m_pLogicalDevice, stagingBufferMemory, 0, imageSize, 0, &data);
-	memcpy(data, pixels, static_cast<size_t>(imageSize));
+	for (uint32_t i = 0; i < layerCount; i++)
+	{
+		memcpy(static_cast<stbi_uc*>(data) + layerSize * i, m_layerPixels[i], static_cast<size_t>(layerSize));
+		stbi_image_free(m_layerPixels[i]);
+	}
 	vkUnmapMemory(*m_pLogicalDevice, stagingBufferMemory);
+	m_layerPixels.clear();
 
-	stbi_image_free(pixels);
-
-	createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_textureImage, m_textureImageMemory);
-	transitionImageLayout(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	copyBufferToImage(stagingBuffer, m_textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-	transitionImageLayout(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	createImage(m_width, m_height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_textureImage, m_textureImageMemory, layerCount);
+	transitionImageLayout(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, layerCount);
+	copyBufferToImage(stagingBuffer, m_textureImage, static_cast<uint32_t>(m_width), static_cast<uint32_t>(m_height), layerCount);
+	transitionImageLayout(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, layerCount);
 
-	vkDestroyBuffer(*m_pLogicalDevice, stagingBuffer, nullptr);
-	vkFreeMemory(*m_pLogicalDevice, stagingBufferMemory, nullptr);
+	m_pBufferManager->getCommandBuffer()->releaseStagingBuffer(stagingBuffer, stagingBufferMemory);
 }
 
 void Image::createTextureImageView()
 {
-	m_textureImageView = createImageView(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+	if (m_isArray)
+		m_textureImageView = createImageView(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_VIEW_TYPE_2D_ARRAY, getLayerCount());
+	else
+		m_textureImageView = createImageView(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
 }
 
 void Image::createTextureSampler()
@@ -81,19 +133,19 @@ void Image::createTextureSampler()
 	}
 }
 
-VkImageView Image::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
+VkImageView Image::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkImageViewType viewType, uint32_t layerCount)
 {
 	VkImageViewCreateInfo viewInfo{
 		.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
 		.image = image,
-		.viewType = VK_IMAGE_VIEW_TYPE_2D,
+		.viewType = viewType,
 		.format = format,
 		.subresourceRange {
 			.aspectMask = aspectFlags,
 			.baseMipLevel = 0,
 			.levelCount = 1,
 			.baseArrayLayer = 0,
-			.layerCount = 1
+			.layerCount = layerCount
 		}
 	};
 
@@ -106,7 +158,7 @@ VkImageView Image::createImageView(VkImage image, VkFormat format, VkImageAspect
 	return imageView;
 }
 
-void Image::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory)
+void Image::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, uint32_t arrayLayers)
 {
 	VkImageCreateInfo imageInfo{
 		.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
@@ -119,7 +171,7 @@ void Image::createImage(uint32_t width, uint32_t height, VkFormat format, VkImag
 			.depth = 1,
 		},
 		.mipLevels = 1,
-		.arrayLayers = 1,
+		.arrayLayers = arrayLayers,
 		.samples = VK_SAMPLE_COUNT_1_BIT,
 		.tiling = tiling,
 		.usage = usage,
@@ -149,7 +201,7 @@ void Image::createImage(uint32_t width, uint32_t height, VkFormat format, VkImag
 	vkBindImageMemory(*m_pLogicalDevice, image, imageMemory, 0);
 }
 
-void Image::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout)
+void Image::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t layerCount)
 {
 	//Utilities::getInstance()->debugPrint("Transitioning image layout from " + std::to_string(oldLayout) + " to " + std::to_string(newLayout), "Image");
 
@@ -158,8 +210,8 @@ void Image::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout
 
 	VkImageMemoryBarrier barrier{
 		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-		.srcAccessMask = 0, //TODO
-		.dstAccessMask = 0, //TODO
+		.srcAccessMask = 0,
+		.dstAccessMask = 0,
 		.oldLayout = oldLayout,
 		.newLayout = newLayout,
 		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
@@ -170,48 +222,23 @@ void Image::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout
 			.baseMipLevel = 0,
 			.levelCount = 1,
 			.baseArrayLayer = 0,
-			.layerCount = 1
+			.layerCount = layerCount
 		}
 	};
 
+	// Each side waits on or blocks whatever can touch an image in that layout, so any pair of layouts works
 	VkPipelineStageFlags sourceStage;
 	VkPipelineStageFlags destinationStage;
+	getLayoutAccess(oldLayout, sourceStage, barrier.srcAccessMask);
+	getLayoutAccess(newLayout, destinationStage, barrier.dstAccessMask);
 
-	if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
+	if (isDepthFormat(format)) {
 		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
 
 		if (hasStencilComponent(format)) {
 			barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
 		}
 	}
-	else {
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	}
-
-	if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-		barrier.srcAccessMask = 0;
-		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-		sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-		destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-	}
-	else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-		sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-		destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-	}
-	else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-		barrier.srcAccessMask = 0;
-		barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-		sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-		destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-	}
-	else {
-		throw std::invalid_argument("unsupported layout transition!");
-	}
 
 	vkCmdPipelineBarrier(
 		imgCommandBuffer,
@@ -225,7 +252,7 @@ void Image::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout
 	pCommandBuffer->endSingleTimeCommands(imgCommandBuffer);
 }
 
-void Image::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
+void Image::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount)
 {
 	CommandBuffer* pCommandBuffer = m_pBufferManager->getCommandBuffer();
 	VkCommandBuffer imgCommandBuffer = pCommandBuffer->beginSingleTimeCommands();
@@ -238,7 +265,7 @@ void Image::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, ui
 			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
 			.mipLevel = 0,
 			.baseArrayLayer = 0,
-			.layerCount = 1
+			.layerCount = layerCount
 		},
 		.imageOffset {0,0,0},
 		.imageExtent {width,height,1}
@@ -254,8 +281,90 @@ bool Image::hasStencilComponent(VkFormat format)
 	return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
 }
 
+VkFormat Image::findDepthFormat(VkPhysicalDevice* pPhysicalDevice)
+{
+	return findSupportedFormat(pPhysicalDevice,
+		{ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
+		VK_IMAGE_TILING_OPTIMAL,
+		VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
+	);
+}
+
+VkFormat Image::findSupportedFormat(VkPhysicalDevice* pPhysicalDevice, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features)
+{
+	for (VkFormat format : candidates)
+	{
+		VkFormatProperties props;
+		vkGetPhysicalDeviceFormatProperties(*pPhysicalDevice, format, &props);
+
+		if (tiling == VK_IMAGE_TILING_LINEAR && (props.linearTilingFeatures & features) == features)
+			return(format);
+		else if (tiling == VK_IMAGE_TILING_OPTIMAL && (props.optimalTilingFeatures & features) == features)
+			return(format);
+
+	}
+
+	throw std::runtime_error("Failed to find supported format!");
+}
+
+bool Image::isDepthFormat(VkFormat format)
+{
+	return format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_X8_D24_UNORM_PACK32 || format == VK_FORMAT_D32_SFLOAT ||
+		format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+}
+
+void Image::getLayoutAccess(VkImageLayout layout, VkPipelineStageFlags& stages, VkAccessFlags& access)
+{
+	switch (layout)
+	{
+	case VK_IMAGE_LAYOUT_UNDEFINED:
+	case VK_IMAGE_LAYOUT_PREINITIALIZED:
+		stages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		access = 0;
+		break;
+	case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+		stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		access = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+		stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+		stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+		stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		access = VK_ACCESS_SHADER_READ_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+		stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		access = VK_ACCESS_TRANSFER_READ_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+		stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		access = VK_ACCESS_TRANSFER_WRITE_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+		// Presentation is ordered by the semaphore, not the barrier
+		stages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		access = 0;
+		break;
+	default:
+		// GENERAL and anything else can be used anywhere
+		stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		access = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+		break;
+	}
+}
+
 void Image::cleanup()
 {
+	// Decoded but never uploaded
+	for (auto pixels : m_layerPixels) stbi_image_free(pixels);
+	m_layerPixels.clear();
+
 	vkDestroySampler(*m_pLogicalDevice, m_textureSampler, nullptr);
 	vkDestroyImageView(*m_pLogicalDevice, m_textureImageView, nullptr);
 
@@ -16,29 +16,50 @@ class VulkanEngine;
 class Image
 {
 public:
-	Image(std::string imagePath) : m_imagePath(imagePath), m_pUtilities(Utilities::getInstance())
+	Image(std::string imagePath) : m_imagePath(imagePath), m_layerPaths({ imagePath }), m_pUtilities(Utilities::getInstance())
 	{
-		createTextureImage();
-		createTextureImageView();
-		createTextureSampler();
+		decodeLayers();
+		upload();
 	};
-
+	// Packs every image into one layer of a 2D array texture. All images must share the same dimensions.
+	Image(std::vector<std::string> layerPaths) : Image(layerPaths, true) {};
+	// Decodes an array texture without touching the device, so it can be done on a worker thread. upload() must be
+	// called before the image is used.
+	static Image* decodeArray(std::vector<std::string> layerPaths) { return new Image(layerPaths, false); };
+
+	// Reads and decodes every layer into memory. Safe on any thread.
+	void decodeLayers();
+	// Creates the image, its view and sampler from the decoded layers, then frees them. Records single-time commands,
+	// so it belongs on the thread that owns the command pool.
+	void upload();
 	void createTextureImage();
 	void createTextureImageView();
 	void createTextureSampler();
 
-	static VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
-	static void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
+	static VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D, uint32_t layerCount = 1);
+	static void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, uint32_t arrayLayers = 1);
 	static bool hasStencilComponent(VkFormat format);
-	static void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
-	void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
+	static bool isDepthFormat(VkFormat format);
+	static VkFormat findDepthFormat(VkPhysicalDevice* pPhysicalDevice);
+	static VkFormat findSupportedFormat(VkPhysicalDevice* pPhysicalDevice, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
+	// Stages and access that can use an image in the layout, for either side of a barrier.
+	static void getLayoutAccess(VkImageLayout layout, VkPipelineStageFlags& stages, VkAccessFlags& access);
+	static void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t layerCount = 1);
+	void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount = 1);
 
 	void cleanup();
 
 	VkImageView* getVkTextureImageView() { return &m_textureImageView; };
 	VkSampler* getVkTextureSampler() { return &m_textureSampler; };
+	uint32_t getLayerCount() { return static_cast<uint32_t>(m_layerPaths.size()); };
 
 private:
+	Image(std::vector<std::string> layerPaths, bool uploadNow) : m_imagePath(layerPaths.empty() ? "" : layerPaths[0]), m_layerPaths(layerPaths), m_isArray(true), m_pUtilities(Utilities::getInstance())
+	{
+		decodeLayers();
+		if (uploadNow) upload();
+	};
+
 	Utilities* m_pUtilities = nullptr;
 	static VkDevice* m_pLogicalDevice;
 	static BufferManager* m_pBufferManager;
@@ -46,6 +67,11 @@ private:
 
 
 	std::string m_imagePath = "";
+	std::vector<std::string> m_layerPaths = {};
+	bool m_isArray = false;
+	std::vector<unsigned char*> m_layerPixels = {}; // RGBA, one per layer until uploaded
+	int m_width = 0;
+	int m_height = 0;
 	VkImage m_textureImage = VK_NULL_HANDLE;
 	VkDeviceMemory m_textureImageMemory = VK_NULL_HANDLE;
 	VkImageView m_textureImageView = VK_NULL_HANDLE;
@@ -20,14 +20,14 @@ QueueFamilyIndices::sQueueFamilyIndices QueueFamilyIndices::findQueueFamilies(Vk
 		}
 
 		VkBool32 presentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+		if (surface != VK_NULL_HANDLE) vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
 
 		if (presentSupport)
 		{
 			indices.presentFamily = i;
 		}
 
-		if (indices.isComplete())
+		if (indices.isComplete(surface != VK_NULL_HANDLE))
 		{
 			break;
 		}
@@ -15,11 +15,13 @@ public:
 		std::optional<uint32_t> graphicsFamily;
 		std::optional<uint32_t> presentFamily;
 
-		bool isComplete() {
-			return graphicsFamily.has_value() && presentFamily.has_value();
+		// Without a surface there is nothing to present to, so only a graphics family is needed.
+		bool isComplete(bool needsPresent = true) {
+			return graphicsFamily.has_value() && (presentFamily.has_value() || !needsPresent);
 		}
 	};
 
+	// A null surface, when running headless, skips looking for a present family.
 	static sQueueFamilyIndices findQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surface);
 };
 
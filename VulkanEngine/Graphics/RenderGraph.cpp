@@ -0,0 +1,701 @@
+#include "../VulkanEngine.h"
+#include "Image.h"
+#include "Buffers.h"
+
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <format>
+
+
+
+static constexpr VkAccessFlags WRITE_ACCESS = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+	VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+
+RenderGraph::RenderGraph() : m_pLogicalDevice(VulkanEngine::getInstance()->m_pLogicalDevice->getVkDevice()), m_pDeletionQueue(VulkanEngine::getInstance()->m_pBufferManager->getDeletionQueue()),
+	m_pUtilities(Utilities::getInstance())
+{
+}
+
+RenderGraph::ResourceHandle RenderGraph::importImage(const std::string& name, VkFormat format, VkExtent2D extent, VkImageLayout initialLayout, VkImageLayout finalLayout)
+{
+	if (m_compiled) throw std::runtime_error("render graph changed after it was compiled!");
+
+	m_resources.push_back({
+		.name = name,
+		.imported = true,
+		.description = { .format = format, .extent = extent },
+		.initialLayout = initialLayout,
+		.finalLayout = finalLayout
+	});
+	return static_cast<ResourceHandle>(m_resources.size() - 1);
+}
+
+void RenderGraph::setImportedImage(ResourceHandle resource, VkImage image, VkImageView imageView)
+{
+	if (!m_resources[resource].imported) throw std::runtime_error("only imported images can be set!");
+
+	m_resources[resource].image = image;
+	m_resources[resource].imageView = imageView;
+}
+
+RenderGraph::ResourceHandle RenderGraph::createImage(const std::string& name, const sImageDescription& description)
+{
+	if (m_compiled) throw std::runtime_error("render graph changed after it was compiled!");
+
+	m_resources.push_back({ .name = name, .description = description });
+	return static_cast<ResourceHandle>(m_resources.size() - 1);
+}
+
+RenderGraph::PassHandle RenderGraph::addPass(const std::string& name, RecordFunction record)
+{
+	if (m_compiled) throw std::runtime_error("render graph changed after it was compiled!");
+
+	m_passes.push_back({ .name = name, .record = std::move(record) });
+	return static_cast<PassHandle>(m_passes.size() - 1);
+}
+
+void RenderGraph::read(PassHandle pass, ResourceHandle resource, eUsage usage)
+{
+	if (usage == eUsage::TRANSFER_DST) throw std::runtime_error("transfer destinations can't be read!");
+	for (const sAccess& access : m_passes[pass].accesses)
+		if (access.resource == resource) throw std::runtime_error("pass declared the same resource twice!");
+
+	m_passes[pass].accesses.push_back({ .resource = resource, .usage = usage });
+	m_passes[pass].graphics |= isAttachment(usage);
+}
+
+void RenderGraph::write(PassHandle pass, ResourceHandle resource, eUsage usage, eLoad load, VkClearValue clearValue)
+{
+	if (usage == eUsage::SAMPLED || usage == eUsage::DEPTH_READ || usage == eUsage::TRANSFER_SRC) throw std::runtime_error("read-only usage can't be written!");
+	for (const sAccess& access : m_passes[pass].accesses)
+		if (access.resource == resource) throw std::runtime_error("pass declared the same resource twice!");
+
+	m_passes[pass].accesses.push_back({ .resource = resource, .usage = usage, .write = true, .load = load, .clearValue = clearValue });
+	m_passes[pass].graphics |= isAttachment(usage);
+}
+
+
+
+void RenderGraph::compile()
+{
+	if (m_compiled) throw std::runtime_error("render graph compiled twice, clear it first!");
+
+	m_stats = { .passes = static_cast<uint32_t>(m_passes.size()) };
+
+	cullPasses();
+	orderPasses();
+	computeLifetimes();
+	createImages();
+	assignMemory();
+	allocateMemory();
+	computeBarriers();
+	createRenderPasses();
+
+	m_compiled = true;
+	mDebugPrint(std::format("Render graph compiled: {} of {} passes, {} barriers in {} batches, {} KiB transient memory ({} KiB unaliased).",
+		m_order.size(), m_stats.passes, m_stats.imageBarriers, m_stats.barrierBatches, m_stats.transientMemory / 1024, m_stats.unaliasedMemory / 1024));
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer, const sFrameContext& frame)
+{
+	if (!m_compiled) throw std::runtime_error("render graph executed before it was compiled!");
+
+	for (PassHandle passHandle : m_order)
+	{
+		sPass& pass = m_passes[passHandle];
+		recordBarriers(commandBuffer, pass.barriers);
+
+		sPassContext context{ .pFrame = &frame, .extent = pass.extent };
+		if (pass.renderPass != VK_NULL_HANDLE)
+		{
+			context.renderPass = pass.renderPass;
+			context.framebuffer = getFramebuffer(pass);
+			context.beginInfo = {
+				.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+				.renderPass = pass.renderPass,
+				.framebuffer = context.framebuffer,
+				.renderArea {
+					.offset = { 0, 0 },
+					.extent = pass.extent
+				},
+				.clearValueCount = static_cast<uint32_t>(pass.clearValues.size()),
+				.pClearValues = pass.clearValues.data()
+			};
+		}
+		pass.record(commandBuffer, context);
+	}
+
+	recordBarriers(commandBuffer, m_finalBarriers);
+}
+
+void RenderGraph::clear()
+{
+	std::vector<VkFramebuffer> framebuffers;
+	std::vector<VkRenderPass> renderPasses;
+	std::vector<VkImageView> imageViews;
+	std::vector<VkImage> images;
+	std::vector<VkDeviceMemory> memory;
+
+	for (sPass& pass : m_passes)
+	{
+		for (auto& [views, framebuffer] : pass.framebuffers) framebuffers.push_back(framebuffer);
+		if (pass.renderPass != VK_NULL_HANDLE) renderPasses.push_back(pass.renderPass);
+	}
+	for (sResource& resource : m_resources)
+	{
+		if (resource.imported) continue;
+		if (resource.imageView != VK_NULL_HANDLE) imageViews.push_back(resource.imageView);
+		if (resource.image != VK_NULL_HANDLE) images.push_back(resource.image);
+	}
+	for (sMemoryBlock& block : m_memoryBlocks)
+		if (block.memory != VK_NULL_HANDLE) memory.push_back(block.memory);
+
+	if (!framebuffers.empty() || !renderPasses.empty() || !images.empty())
+	{
+		VkDevice device = *m_pLogicalDevice;
+		m_pDeletionQueue->retire([=] {
+			for (VkFramebuffer framebuffer : framebuffers) vkDestroyFramebuffer(device, framebuffer, nullptr);
+			for (VkRenderPass renderPass : renderPasses) vkDestroyRenderPass(device, renderPass, nullptr);
+			for (VkImageView imageView : imageViews) vkDestroyImageView(device, imageView, nullptr);
+			for (VkImage image : images) vkDestroyImage(device, image, nullptr);
+			for (VkDeviceMemory block : memory) vkFreeMemory(device, block, nullptr);
+		});
+	}
+
+	m_passes.clear();
+	m_resources.clear();
+	m_order.clear();
+	m_finalBarriers.clear();
+	m_memoryBlocks.clear();
+	m_stats = {};
+	m_compiled = false;
+}
+
+
+
+bool RenderGraph::isAttachment(eUsage usage)
+{
+	return usage == eUsage::COLOR_ATTACHMENT || usage == eUsage::DEPTH_ATTACHMENT || usage == eUsage::DEPTH_READ;
+}
+
+RenderGraph::sUsageState RenderGraph::getUsageState(eUsage usage, bool write, bool graphics)
+{
+	VkPipelineStageFlags shaderStage = graphics ? VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+	switch (usage)
+	{
+	case eUsage::COLOR_ATTACHMENT:
+		return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | (write ? VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT : 0u) };
+	case eUsage::DEPTH_ATTACHMENT:
+		return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | (write ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT : 0u) };
+	case eUsage::DEPTH_READ:
+		return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT };
+	case eUsage::SAMPLED:
+		return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, shaderStage, VK_ACCESS_SHADER_READ_BIT };
+	case eUsage::STORAGE:
+		return { VK_IMAGE_LAYOUT_GENERAL, shaderStage, VK_ACCESS_SHADER_READ_BIT | (write ? VK_ACCESS_SHADER_WRITE_BIT : 0u) };
+	case eUsage::TRANSFER_SRC:
+		return { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT };
+	case eUsage::TRANSFER_DST:
+		return { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT };
+	}
+	return { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT };
+}
+
+void RenderGraph::cullPasses()
+{
+	// Walked backwards from the imported images, a resource is live while a later surviving pass still needs what's in it
+	std::vector<bool> live(m_resources.size());
+	for (size_t i = 0; i < m_resources.size(); i++) live[i] = m_resources[i].imported;
+
+	for (size_t i = m_passes.size(); i-- > 0;)
+	{
+		sPass& pass = m_passes[i];
+		pass.culled = std::none_of(pass.accesses.begin(), pass.accesses.end(), [&](const sAccess& access) { return access.write && live[access.resource]; });
+		if (pass.culled)
+		{
+			m_stats.culledPasses++;
+			continue;
+		}
+
+		// Overwriting the whole image ends the previous contents' lifetime, reading or loading it extends it
+		for (const sAccess& access : pass.accesses)
+			if (access.write && access.load != eLoad::LOAD) live[access.resource] = false;
+		for (const sAccess& access : pass.accesses)
+			if (!access.write || access.load == eLoad::LOAD) live[access.resource] = true;
+	}
+}
+
+void RenderGraph::orderPasses()
+{
+	// Declaration order defines what each pass sees, so every read waits for the last write before it and every
+	// write waits for the reads and write before it. Any order that keeps those edges gives the same frame.
+	std::vector<std::vector<PassHandle>> dependents(m_passes.size());
+	std::vector<uint32_t> pendingDependencies(m_passes.size(), 0);
+	std::vector<PassHandle> lastWriter(m_resources.size(), INVALID_HANDLE);
+	std::vector<std::vector<PassHandle>> readers(m_resources.size());
+
+	auto addDependency = [&](PassHandle from, PassHandle to) {
+		if (from == INVALID_HANDLE || from == to) return;
+		if (std::find(dependents[from].begin(), dependents[from].end(), to) != dependents[from].end()) return;
+		dependents[from].push_back(to);
+		pendingDependencies[to]++;
+	};
+
+	for (PassHandle i = 0; i < m_passes.size(); i++)
+	{
+		if (m_passes[i].culled) continue;
+
+		for (const sAccess& access : m_passes[i].accesses)
+		{
+			addDependency(lastWriter[access.resource], i);
+			if (access.write)
+				for (PassHandle reader : readers[access.resource]) addDependency(reader, i);
+		}
+		for (const sAccess& access : m_passes[i].accesses)
+		{
+			if (access.write)
+			{
+				lastWriter[access.resource] = i;
+				readers[access.resource].clear();
+			}
+			else readers[access.resource].push_back(i);
+		}
+	}
+
+	// Prefer a ready pass that doesn't depend on the one just scheduled, so the GPU has independent work to overlap with
+	// each barrier. Ties go to declaration order.
+	std::vector<PassHandle> ready = {};
+	for (PassHandle i = 0; i < m_passes.size(); i++)
+		if (!m_passes[i].culled && pendingDependencies[i] == 0) ready.push_back(i);
+
+	m_order.clear();
+	while (!ready.empty())
+	{
+		auto next = ready.begin();
+		if (!m_order.empty())
+		{
+			const std::vector<PassHandle>& previousDependents = dependents[m_order.back()];
+			auto independent = std::find_if(ready.begin(), ready.end(), [&](PassHandle pass) {
+				return std::find(previousDependents.begin(), previousDependents.end(), pass) == previousDependents.end();
+			});
+			if (independent != ready.end()) next = independent;
+		}
+
+		PassHandle pass = *next;
+		ready.erase(next);
+		m_order.push_back(pass);
+
+		for (PassHandle dependent : dependents[pass])
+			if (--pendingDependencies[dependent] == 0) ready.insert(std::upper_bound(ready.begin(), ready.end(), dependent), dependent);
+	}
+}
+
+void RenderGraph::computeLifetimes()
+{
+	for (uint32_t position = 0; position < m_order.size(); position++)
+	{
+		const sPass& pass = m_passes[m_order[position]];
+		for (const sAccess& access : pass.accesses)
+		{
+			sResource& resource = m_resources[access.resource];
+			if (resource.firstUse == INVALID_HANDLE) resource.firstUse = position;
+			resource.lastUse = position;
+			resource.lastState = getUsageState(access.usage, access.write, pass.graphics);
+
+			switch (access.usage)
+			{
+			case eUsage::COLOR_ATTACHMENT: resource.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT; break;
+			case eUsage::DEPTH_ATTACHMENT:
+			case eUsage::DEPTH_READ: resource.usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT; break;
+			case eUsage::SAMPLED: resource.usage |= VK_IMAGE_USAGE_SAMPLED_BIT; break;
+			case eUsage::STORAGE: resource.usage |= VK_IMAGE_USAGE_STORAGE_BIT; break;
+			case eUsage::TRANSFER_SRC: resource.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT; break;
+			case eUsage::TRANSFER_DST: resource.usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT; break;
+			}
+		}
+	}
+
+	for (sResource& resource : m_resources)
+	{
+		resource.aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		if (Image::isDepthFormat(resource.description.format))
+		{
+			resource.aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+			if (Image::hasStencilComponent(resource.description.format)) resource.aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+		}
+	}
+}
+
+void RenderGraph::createImages()
+{
+	for (sResource& resource : m_resources)
+	{
+		if (resource.imported || resource.firstUse == INVALID_HANDLE) continue;
+
+		VkImageCreateInfo imageInfo{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+			.imageType = VK_IMAGE_TYPE_2D,
+			.format = resource.description.format,
+			.extent {
+				.width = resource.description.extent.width,
+				.height = resource.description.extent.height,
+				.depth = 1
+			},
+			.mipLevels = 1,
+			.arrayLayers = 1,
+			.samples = VK_SAMPLE_COUNT_1_BIT,
+			.tiling = VK_IMAGE_TILING_OPTIMAL,
+			.usage = resource.usage,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+		};
+
+		if (vkCreateImage(*m_pLogicalDevice, &imageInfo, nullptr, &resource.image) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create render graph image!");
+		}
+		vkGetImageMemoryRequirements(*m_pLogicalDevice, resource.image, &resource.memoryRequirements);
+		m_stats.unaliasedMemory += resource.memoryRequirements.size;
+	}
+}
+
+void RenderGraph::assignMemory()
+{
+	// Largest first, each image goes into the smallest block it fits whose occupants are all dead or not yet born
+	// while it is in use. Blocks it doesn't fit in grow only when nothing else will take it.
+	std::vector<ResourceHandle> transients = {};
+	for (ResourceHandle i = 0; i < m_resources.size(); i++)
+		if (m_resources[i].image != VK_NULL_HANDLE && !m_resources[i].imported) transients.push_back(i);
+	std::stable_sort(transients.begin(), transients.end(), [&](ResourceHandle a, ResourceHandle b) {
+		return m_resources[a].memoryRequirements.size > m_resources[b].memoryRequirements.size;
+	});
+
+	for (ResourceHandle handle : transients)
+	{
+		sResource& resource = m_resources[handle];
+
+		uint32_t bestBlock = INVALID_HANDLE;
+		for (uint32_t i = 0; i < m_memoryBlocks.size(); i++)
+		{
+			const sMemoryBlock& block = m_memoryBlocks[i];
+			if ((block.memoryTypeBits & resource.memoryRequirements.memoryTypeBits) == 0) continue;
+
+			bool overlaps = std::any_of(block.occupants.begin(), block.occupants.end(), [&](ResourceHandle occupant) {
+				return m_resources[occupant].firstUse <= resource.lastUse && resource.firstUse <= m_resources[occupant].lastUse;
+			});
+			if (overlaps) continue;
+
+			if (bestBlock == INVALID_HANDLE) { bestBlock = i; continue; }
+			const sMemoryBlock& best = m_memoryBlocks[bestBlock];
+			bool fits = block.size >= resource.memoryRequirements.size;
+			bool bestFits = best.size >= resource.memoryRequirements.size;
+			if (fits != bestFits ? fits : (fits ? block.size < best.size : block.size > best.size)) bestBlock = i;
+		}
+
+		if (bestBlock == INVALID_HANDLE)
+		{
+			m_memoryBlocks.push_back({ .memoryTypeBits = resource.memoryRequirements.memoryTypeBits });
+			bestBlock = static_cast<uint32_t>(m_memoryBlocks.size() - 1);
+		}
+
+		sMemoryBlock& block = m_memoryBlocks[bestBlock];
+		block.size = std::max(block.size, resource.memoryRequirements.size);
+		block.memoryTypeBits &= resource.memoryRequirements.memoryTypeBits;
+		block.occupants.push_back(handle);
+		resource.memoryBlock = bestBlock;
+	}
+
+	// Each image's first barrier has to wait for whoever used the memory last, which for the first occupant is the
+	// last one in the frame before
+	for (sMemoryBlock& block : m_memoryBlocks)
+	{
+		std::sort(block.occupants.begin(), block.occupants.end(), [&](ResourceHandle a, ResourceHandle b) { return m_resources[a].firstUse < m_resources[b].firstUse; });
+		for (size_t i = 0; i < block.occupants.size(); i++)
+			m_resources[block.occupants[i]].previousOccupant = block.occupants[(i + block.occupants.size() - 1) % block.occupants.size()];
+	}
+}
+
+void RenderGraph::allocateMemory()
+{
+	for (sMemoryBlock& block : m_memoryBlocks)
+	{
+		// Allocations are aligned for anything the device needs, so every occupant can sit at offset 0
+		VkMemoryAllocateInfo allocInfo{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+			.allocationSize = block.size,
+			.memoryTypeIndex = BufferManager::findMemoryType(block.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+		};
+
+		if (vkAllocateMemory(*m_pLogicalDevice, &allocInfo, nullptr, &block.memory) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate render graph memory!");
+		}
+		m_stats.transientMemory += block.size;
+
+		for (ResourceHandle occupant : block.occupants)
+		{
+			sResource& resource = m_resources[occupant];
+			vkBindImageMemory(*m_pLogicalDevice, resource.image, block.memory, 0);
+			resource.imageView = Image::createImageView(resource.image, resource.description.format, resource.aspect & ~VK_IMAGE_ASPECT_STENCIL_BIT);
+		}
+	}
+}
+
+void RenderGraph::computeBarriers()
+{
+	// Where each image stands as the frame goes. Writes have to be made visible to each later stage that reads
+	// them, and nothing may overwrite or change the layout under an earlier reader.
+	struct sTracking
+	{
+		VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkPipelineStageFlags writeStages = 0;
+		VkAccessFlags writeAccess = 0;
+		VkPipelineStageFlags readStages = 0;
+		VkPipelineStageFlags visibleStages = 0;
+		VkAccessFlags visibleAccess = 0;
+	};
+
+	std::vector<sTracking> tracking(m_resources.size());
+	for (size_t i = 0; i < m_resources.size(); i++)
+	{
+		const sResource& resource = m_resources[i];
+		if (resource.imported)
+			tracking[i].layout = resource.initialLayout;
+		else if (resource.previousOccupant != INVALID_HANDLE)
+		{
+			// Contents are discarded, but the memory may still be in use by the previous occupant
+			const sUsageState& previous = m_resources[resource.previousOccupant].lastState;
+			tracking[i].writeStages = previous.stages;
+			tracking[i].writeAccess = previous.access & WRITE_ACCESS;
+		}
+	}
+
+	for (PassHandle passHandle : m_order)
+	{
+		sPass& pass = m_passes[passHandle];
+		pass.barriers.clear();
+
+		for (const sAccess& access : pass.accesses)
+		{
+			sTracking& state = tracking[access.resource];
+			sUsageState usage = getUsageState(access.usage, access.write, pass.graphics);
+
+			bool transition = state.layout != usage.layout;
+			bool hazard = transition || (access.write && (state.writeStages | state.readStages) != 0);
+			bool unseenWrite = !access.write && state.writeStages != 0 &&
+				((state.visibleStages & usage.stages) != usage.stages || (state.visibleAccess & usage.access) != usage.access);
+
+			if (hazard || unseenWrite)
+			{
+				VkPipelineStageFlags srcStages = hazard ? (state.writeStages | state.readStages) : state.writeStages;
+				// Nothing to wait for. Imported images wait at the stage of their first use, which is where the
+				// frame's semaphore wait is
+				if (srcStages == 0)
+					srcStages = m_resources[access.resource].imported ? usage.stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+
+				pass.barriers.push_back({
+					.resource = access.resource,
+					.oldLayout = state.layout,
+					.newLayout = usage.layout,
+					.srcStages = srcStages,
+					.dstStages = usage.stages,
+					.srcAccess = state.writeAccess,
+					.dstAccess = usage.access
+				});
+			}
+
+			if (transition)
+			{
+				// The transition counts as a write that is already visible to this usage
+				state = { .layout = usage.layout, .writeStages = usage.stages, .visibleStages = usage.stages, .visibleAccess = usage.access };
+			}
+			else if (hazard || unseenWrite)
+			{
+				state.visibleStages |= usage.stages;
+				state.visibleAccess |= usage.access;
+			}
+
+			if (access.write)
+			{
+				state.writeStages = usage.stages;
+				state.writeAccess = usage.access & WRITE_ACCESS;
+				state.readStages = 0;
+				state.visibleStages = 0;
+				state.visibleAccess = 0;
+			}
+			else state.readStages |= usage.stages;
+		}
+
+		m_stats.imageBarriers += static_cast<uint32_t>(pass.barriers.size());
+		if (!pass.barriers.empty()) m_stats.barrierBatches++;
+	}
+
+	m_finalBarriers.clear();
+	for (ResourceHandle i = 0; i < m_resources.size(); i++)
+	{
+		const sResource& resource = m_resources[i];
+		if (!resource.imported || resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || tracking[i].layout == resource.finalLayout) continue;
+
+		VkPipelineStageFlags dstStages;
+		VkAccessFlags dstAccess;
+		Image::getLayoutAccess(resource.finalLayout, dstStages, dstAccess);
+
+		VkPipelineStageFlags srcStages = tracking[i].writeStages | tracking[i].readStages;
+		m_finalBarriers.push_back({
+			.resource = i,
+			.oldLayout = tracking[i].layout,
+			.newLayout = resource.finalLayout,
+			.srcStages = srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			.dstStages = dstStages,
+			.srcAccess = tracking[i].writeAccess,
+			.dstAccess = dstAccess
+		});
+	}
+	m_stats.imageBarriers += static_cast<uint32_t>(m_finalBarriers.size());
+	if (!m_finalBarriers.empty()) m_stats.barrierBatches++;
+}
+
+void RenderGraph::createRenderPasses()
+{
+	for (uint32_t position = 0; position < m_order.size(); position++)
+	{
+		sPass& pass = m_passes[m_order[position]];
+
+		const sAccess* pDepthAccess = nullptr;
+		std::vector<const sAccess*> attachmentAccesses = {};
+		for (const sAccess& access : pass.accesses)
+		{
+			if (access.usage == eUsage::COLOR_ATTACHMENT) attachmentAccesses.push_back(&access);
+			else if (isAttachment(access.usage))
+			{
+				if (pDepthAccess != nullptr) throw std::runtime_error("pass has more than one depth attachment!");
+				pDepthAccess = &access;
+			}
+		}
+		uint32_t colorCount = static_cast<uint32_t>(attachmentAccesses.size());
+		if (pDepthAccess != nullptr) attachmentAccesses.push_back(pDepthAccess);
+		if (attachmentAccesses.empty()) continue;
+
+		std::vector<VkAttachmentDescription> attachments = {};
+		std::vector<VkAttachmentReference> references = {};
+		for (const sAccess* pAccess : attachmentAccesses)
+		{
+			const sResource& resource = m_resources[pAccess->resource];
+			if (pass.attachments.empty()) pass.extent = resource.description.extent;
+			else if (resource.description.extent.width != pass.extent.width || resource.description.extent.height != pass.extent.height)
+				throw std::runtime_error("pass attachments differ in size!");
+
+			// The graph's barriers do every layout change, so the render pass starts and ends in the layout it uses.
+			// Contents only need storing if a later pass or whoever imported the image looks at them.
+			VkImageLayout layout = getUsageState(pAccess->usage, pAccess->write, true).layout;
+			VkAttachmentLoadOp loadOp = !pAccess->write || pAccess->load == eLoad::LOAD ? VK_ATTACHMENT_LOAD_OP_LOAD :
+				pAccess->load == eLoad::CLEAR ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			VkAttachmentStoreOp storeOp = resource.imported || resource.lastUse > position ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			bool stencil = (resource.aspect & VK_IMAGE_ASPECT_STENCIL_BIT) != 0;
+
+			attachments.push_back({
+				.format = resource.description.format,
+				.samples = VK_SAMPLE_COUNT_1_BIT,
+				.loadOp = loadOp,
+				.storeOp = storeOp,
+				.stencilLoadOp = stencil ? loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+				.stencilStoreOp = stencil ? storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE,
+				.initialLayout = layout,
+				.finalLayout = layout
+			});
+			references.push_back({ .attachment = static_cast<uint32_t>(references.size()), .layout = layout });
+			pass.attachments.push_back(pAccess->resource);
+			pass.clearValues.push_back(pAccess->clearValue);
+		}
+
+		VkSubpassDescription subpass{
+			.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+			.colorAttachmentCount = colorCount,
+			.pColorAttachments = references.data(),
+			.pDepthStencilAttachment = pDepthAccess != nullptr ? &references.back() : nullptr
+		};
+
+		VkRenderPassCreateInfo renderPassInfo{
+			.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+			.attachmentCount = static_cast<uint32_t>(attachments.size()),
+			.pAttachments = attachments.data(),
+			.subpassCount = 1,
+			.pSubpasses = &subpass
+		};
+
+		if (vkCreateRenderPass(*m_pLogicalDevice, &renderPassInfo, nullptr, &pass.renderPass) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create render pass!");
+		}
+	}
+}
+
+VkFramebuffer RenderGraph::getFramebuffer(sPass& pass)
+{
+	// Imported images change from frame to frame, so there is one framebuffer per set of views seen so far
+	std::vector<VkImageView> views(pass.attachments.size());
+	for (size_t i = 0; i < pass.attachments.size(); i++)
+	{
+		views[i] = m_resources[pass.attachments[i]].imageView;
+		if (views[i] == VK_NULL_HANDLE) throw std::runtime_error("imported image was never set!");
+	}
+
+	for (auto& [cachedViews, framebuffer] : pass.framebuffers)
+		if (cachedViews == views) return framebuffer;
+
+	VkFramebufferCreateInfo framebufferInfo{
+		.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+		.renderPass = pass.renderPass,
+		.attachmentCount = static_cast<uint32_t>(views.size()),
+		.pAttachments = views.data(),
+		.width = pass.extent.width,
+		.height = pass.extent.height,
+		.layers = 1
+	};
+
+	VkFramebuffer framebuffer;
+	if (vkCreateFramebuffer(*m_pLogicalDevice, &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create framebuffer!");
+	}
+	pass.framebuffers.emplace_back(std::move(views), framebuffer);
+	return framebuffer;
+}
+
+void RenderGraph::recordBarriers(VkCommandBuffer commandBuffer, const std::vector<sBarrier>& barriers)
+{
+	if (barriers.empty()) return;
+
+	VkPipelineStageFlags srcStages = 0;
+	VkPipelineStageFlags dstStages = 0;
+	m_imageBarriers.clear();
+	for (const sBarrier& barrier : barriers)
+	{
+		const sResource& resource = m_resources[barrier.resource];
+		if (resource.image == VK_NULL_HANDLE) throw std::runtime_error("imported image was never set!");
+
+		srcStages |= barrier.srcStages;
+		dstStages |= barrier.dstStages;
+		m_imageBarriers.push_back({
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.srcAccessMask = barrier.srcAccess,
+			.dstAccessMask = barrier.dstAccess,
+			.oldLayout = barrier.oldLayout,
+			.newLayout = barrier.newLayout,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = resource.image,
+			.subresourceRange {
+				.aspectMask = resource.aspect,
+				.baseMipLevel = 0,
+				.levelCount = 1,
+				.baseArrayLayer = 0,
+				.layerCount = 1
+			}
+		});
+	}
+
+	vkCmdPipelineBarrier(commandBuffer, srcStages, dstStages, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(m_imageBarriers.size()), m_imageBarriers.data());
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+
+#include "../Utilities/Utilities.h"
+#include "FrameContext.h"
+#include "DeletionQueue.h"
+
+
+
+// The frame as a list of passes and the images each one reads and writes. compile() orders the passes, drops
+// any whose output nothing presented depends on, works out the barriers between them and packs transient
+// images into shared memory wherever their lifetimes don't overlap. execute() records the frame from that.
+//
+// Declare everything, compile, then execute every frame. After the swapchain changes, clear and declare again.
+class RenderGraph
+{
+public:
+	using ResourceHandle = uint32_t;
+	using PassHandle = uint32_t;
+	static constexpr uint32_t INVALID_HANDLE = UINT32_MAX;
+
+	// How a pass uses an image, which decides the layout, stages and access it is synchronised with. Shader access
+	// happens in the fragment shader in passes with attachments and in the compute shader in passes without.
+	enum class eUsage : uint8_t
+	{
+		COLOR_ATTACHMENT,
+		DEPTH_ATTACHMENT, // Depth test and write
+		DEPTH_READ, // Depth test only
+		SAMPLED,
+		STORAGE,
+		TRANSFER_SRC,
+		TRANSFER_DST
+	};
+
+	// What an attachment holds when its pass starts.
+	enum class eLoad : uint8_t
+	{
+		LOAD,
+		CLEAR,
+		DONT_CARE
+	};
+
+	struct sImageDescription
+	{
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		VkExtent2D extent = {};
+	};
+
+	// Handed to a pass when it records. Passes with attachments get their render pass and framebuffer ready but
+	// begin and end the render pass themselves, so they can pick inline or secondary contents.
+	struct sPassContext
+	{
+		const sFrameContext* pFrame = nullptr;
+		VkRenderPass renderPass = VK_NULL_HANDLE;
+		VkFramebuffer framebuffer = VK_NULL_HANDLE;
+		VkRenderPassBeginInfo beginInfo = {};
+		VkExtent2D extent = {};
+	};
+	using RecordFunction = std::function<void(VkCommandBuffer, const sPassContext&)>;
+
+	struct sStats
+	{
+		uint32_t passes = 0; // Declared
+		uint32_t culledPasses = 0;
+		uint32_t imageBarriers = 0; // Per frame
+		uint32_t barrierBatches = 0; // vkCmdPipelineBarrier calls per frame
+		VkDeviceSize transientMemory = 0; // Allocated for transient images
+		VkDeviceSize unaliasedMemory = 0; // What they would take with an allocation each
+	};
+
+	RenderGraph();
+
+	// An image owned elsewhere, such as a swapchain image. It is kept alive by culling and left in finalLayout at the
+	// end of the frame. Set the actual image with setImportedImage before executing.
+	ResourceHandle importImage(const std::string& name, VkFormat format, VkExtent2D extent, VkImageLayout initialLayout, VkImageLayout finalLayout);
+	void setImportedImage(ResourceHandle resource, VkImage image, VkImageView imageView);
+	// An image owned by the graph that only lives within a frame. Its contents don't survive between frames.
+	ResourceHandle createImage(const std::string& name, const sImageDescription& description);
+
+	PassHandle addPass(const std::string& name, RecordFunction record);
+	void read(PassHandle pass, ResourceHandle resource, eUsage usage);
+	// The load op is the attachment load op. For other usages, anything but LOAD tells the graph the pass overwrites
+	// the whole image and doesn't need what was there. A pass may declare each resource once.
+	void write(PassHandle pass, ResourceHandle resource, eUsage usage, eLoad load = eLoad::LOAD, VkClearValue clearValue = {});
+
+	void compile();
+	// Records every pass that survived culling into the command buffer, which must be recording.
+	void execute(VkCommandBuffer commandBuffer, const sFrameContext& frame);
+	// Retires everything compile created to the deletion queue and forgets every pass and resource. Frames still in
+	// flight keep what they recorded until they finish.
+	void clear();
+
+	// Valid once compiled, VK_NULL_HANDLE for culled passes and passes without attachments.
+	VkRenderPass getRenderPass(PassHandle pass) { return m_passes[pass].renderPass; }
+	bool isCulled(PassHandle pass) { return m_passes[pass].culled; }
+	const sStats& getStats() { return m_stats; }
+
+private:
+	struct sAccess
+	{
+		ResourceHandle resource = INVALID_HANDLE;
+		eUsage usage = eUsage::SAMPLED;
+		bool write = false;
+		eLoad load = eLoad::LOAD;
+		VkClearValue clearValue = {};
+	};
+
+	// Layout, stages and access of one use of an image.
+	struct sUsageState
+	{
+		VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkPipelineStageFlags stages = 0;
+		VkAccessFlags access = 0;
+	};
+
+	struct sBarrier
+	{
+		ResourceHandle resource = INVALID_HANDLE;
+		VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkImageLayout newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkPipelineStageFlags srcStages = 0;
+		VkPipelineStageFlags dstStages = 0;
+		VkAccessFlags srcAccess = 0;
+		VkAccessFlags dstAccess = 0;
+	};
+
+	struct sPass
+	{
+		std::string name = "";
+		RecordFunction record = {};
+		std::vector<sAccess> accesses = {};
+		bool graphics = false; // Has attachments
+
+		bool culled = false;
+		std::vector<sBarrier> barriers = {}; // Recorded as one batch before the pass
+		std::vector<ResourceHandle> attachments = {}; // Colour attachments in declaration order, then depth
+		std::vector<VkClearValue> clearValues = {};
+		VkExtent2D extent = {};
+		VkRenderPass renderPass = VK_NULL_HANDLE;
+		std::vector<std::pair<std::vector<VkImageView>, VkFramebuffer>> framebuffers = {}; // Keyed by attachment views
+	};
+
+	struct sResource
+	{
+		std::string name = "";
+		bool imported = false;
+		sImageDescription description = {};
+		VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED; // Imported images only
+
+		VkImage image = VK_NULL_HANDLE;
+		VkImageView imageView = VK_NULL_HANDLE;
+		VkImageUsageFlags usage = 0;
+		VkImageAspectFlags aspect = 0;
+		uint32_t firstUse = INVALID_HANDLE; // Positions in m_order, INVALID_HANDLE when no surviving pass uses it
+		uint32_t lastUse = INVALID_HANDLE;
+		sUsageState lastState = {}; // How the frame leaves it
+		VkMemoryRequirements memoryRequirements = {};
+		uint32_t memoryBlock = INVALID_HANDLE;
+		ResourceHandle previousOccupant = INVALID_HANDLE; // Last user of the memory before it, wrapping round to the previous frame
+	};
+
+	struct sMemoryBlock
+	{
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize size = 0;
+		uint32_t memoryTypeBits = 0;
+		std::vector<ResourceHandle> occupants = {}; // Sorted by first use
+	};
+
+	Utilities* m_pUtilities = nullptr;
+	VkDevice* m_pLogicalDevice = nullptr;
+	DeletionQueue* m_pDeletionQueue = nullptr;
+
+	std::vector<sPass> m_passes = {};
+	std::vector<sResource> m_resources = {};
+	std::vector<PassHandle> m_order = {}; // Passes that survived culling, in execution order
+	std::vector<sBarrier> m_finalBarriers = {}; // Hands imported images back in their final layout
+	std::vector<sMemoryBlock> m_memoryBlocks = {};
+	std::vector<VkImageMemoryBarrier> m_imageBarriers = {}; // Scratch for execute
+	sStats m_stats = {};
+	bool m_compiled = false;
+
+
+	static bool isAttachment(eUsage usage);
+	static sUsageState getUsageState(eUsage usage, bool write, bool graphics);
+	void cullPasses();
+	void orderPasses();
+	void computeLifetimes();
+	void createImages();
+	void assignMemory();
+	void allocateMemory();
+	void computeBarriers();
+	void createRenderPasses();
+	VkFramebuffer getFramebuffer(sPass& pass);
+	void recordBarriers(VkCommandBuffer commandBuffer, const std::vector<sBarrier>& barriers);
+};
\ No newline at end of file
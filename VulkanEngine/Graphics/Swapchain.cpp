@@ -4,6 +4,8 @@
 
 #include "Swapchain.h"
 
+#include <algorithm>
+
 //#define mDebugPrint(...) if(m_firstRun) {m_pUtilities->debugPrint(...,this)}
 
 
@@ -11,10 +13,13 @@
 
 
 Swapchain::Swapchain() : m_pLogicalDevice(VulkanEngine::getInstance()->m_pLogicalDevice->getVkDevice()), m_pPhysicalDevice(VulkanEngine::getInstance()->m_pPhysicalDevice), m_pWindow(VulkanEngine::getInstance()->m_pWindow->getWindow()),
-	m_pSurface(VulkanEngine::getInstance()->m_pVkSurface), m_pBufferManager(VulkanEngine::getInstance()->m_pBufferManager), m_pUtilities(Utilities::getInstance())
+	m_pSurface(VulkanEngine::getInstance()->m_pVkSurface), m_pBufferManager(VulkanEngine::getInstance()->m_pBufferManager), m_pUtilities(Utilities::getInstance()),
+	m_presentMode(getSettingsPresentMode(VulkanEngine::getInstance()->m_settings->graphicsSettings)), m_maxFramesInFlight(static_cast<uint32_t>(VulkanEngine::getInstance()->m_MAX_FRAMES_IN_FLIGHT)),
+	m_headless(VulkanEngine::getInstance()->m_pWindow->isHeadless())
 {
-	createSwapchain();
+	m_headless ? createOffscreenImages() : createSwapchain();
 	createImageViews();
+	if (!m_headless) createRenderFinishedSemaphores();
 };
 
 // TODO: Add ranking system to choose best swap chain format
@@ -36,23 +41,90 @@ VkSurfaceFormatKHR Swapchain::chooseSwapSurfaceFormat(const std::vector<VkSurfac
 	return availableFormats[0];
 }
 
+Swapchain::ePresentMode Swapchain::getSettingsPresentMode(const sSettings::sGraphicsSettings& settings)
+{
+	if (!settings.vsync) return ePresentMode::LOW_LATENCY;
+	return settings.tripleBuffering ? ePresentMode::THROUGHPUT : ePresentMode::VSYNC;
+}
+
+const char* Swapchain::getPresentModeName(ePresentMode mode)
+{
+	switch (mode)
+	{
+	case ePresentMode::LOW_LATENCY: return "low latency";
+	case ePresentMode::VSYNC: return "vsync";
+	case ePresentMode::THROUGHPUT: return "throughput";
+	}
+	return "unknown";
+}
+
+static const char* getVkPresentModeName(VkPresentModeKHR mode)
+{
+	switch (mode)
+	{
+	case VK_PRESENT_MODE_IMMEDIATE_KHR: return "IMMEDIATE";
+	case VK_PRESENT_MODE_MAILBOX_KHR: return "MAILBOX";
+	case VK_PRESENT_MODE_FIFO_KHR: return "FIFO";
+	case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FIFO_RELAXED";
+	default: return "other";
+	}
+}
+
 VkPresentModeKHR Swapchain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes)
 {
-	//mDebugPrint("Choosing swap present mode...");
+	// Best first. FIFO is the only mode every device supports, so it ends each list
+	std::vector<VkPresentModeKHR> preferredModes;
+	switch (m_presentMode)
+	{
+	case ePresentMode::LOW_LATENCY: preferredModes = { VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR }; break;
+	case ePresentMode::VSYNC: preferredModes = { VK_PRESENT_MODE_FIFO_KHR }; break;
+	case ePresentMode::THROUGHPUT: preferredModes = { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR }; break;
+	}
 
-	for (const auto& availablePresentMode : availablePresentModes)
+	for (VkPresentModeKHR preferredMode : preferredModes)
 	{
-		if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
-		{
-			//mDebugPrint("Swap present mode chosen!");
-			return availablePresentMode;
-		}
+		if (std::find(availablePresentModes.begin(), availablePresentModes.end(), preferredMode) != availablePresentModes.end())
+			return preferredMode;
 	}
 
-	//mDebugPrint("No optimal choices, choosing first result...");
 	return VK_PRESENT_MODE_FIFO_KHR;
 }
 
+uint32_t Swapchain::chooseImageCount(const VkSurfaceCapabilitiesKHR& capabilities)
+{
+	uint32_t imageCount = capabilities.minImageCount;
+	uint32_t framesInFlight = 1;
+
+	switch (m_presentMode)
+	{
+	case ePresentMode::LOW_LATENCY:
+		// A single frame in flight, so input is read as late as possible before each frame
+		imageCount = capabilities.minImageCount;
+		framesInFlight = 1;
+		break;
+	case ePresentMode::VSYNC:
+		// Every queued image is another refresh of latency under FIFO. The surface may need more than two images,
+		// so the CPU is kept at most two frames ahead by the frames in flight rather than by the image count
+		imageCount = std::max(capabilities.minImageCount, 2u);
+		framesInFlight = std::min({ m_maxFramesInFlight, 2u, imageCount - 1 });
+		break;
+	case ePresentMode::THROUGHPUT:
+		imageCount = std::max(capabilities.minImageCount + 1, m_maxFramesInFlight + 1);
+		framesInFlight = m_maxFramesInFlight;
+		break;
+	}
+
+	if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount)
+	{
+		imageCount = capabilities.maxImageCount;
+	}
+
+	// The CPU can hold every image but the one being shown, more frames than that would just block in acquire
+	m_framesInFlight = std::clamp(framesInFlight, 1u, std::max(imageCount - 1, 1u));
+
+	return imageCount;
+}
+
 VkExtent2D Swapchain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities)
 {
 	//mDebugPrint("Choosing swap extent...");
@@ -76,7 +148,7 @@ VkExtent2D Swapchain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilit
 	}
 }
 
-void Swapchain::createSwapchain()
+void Swapchain::createSwapchain(VkSwapchainKHR oldSwapchain)
 {
 	//mDebugPrint("Creating swap chain...");
 	SwapChainSupportDetails swapChainSupport = m_pPhysicalDevice->querySwapChainSupport(*m_pPhysicalDevice->getVkPhysicalDevice());
@@ -85,12 +157,7 @@ void Swapchain::createSwapchain()
 	VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
 	VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
 
-	uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
-
-	if (swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount)
-	{
-		imageCount = swapChainSupport.capabilities.maxImageCount;
-	}
+	uint32_t imageCount = chooseImageCount(swapChainSupport.capabilities);
 
 	VkSwapchainCreateInfoKHR createInfo{
 		.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
@@ -125,7 +192,7 @@ void Swapchain::createSwapchain()
 	createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 	createInfo.presentMode = presentMode;
 	createInfo.clipped = VK_TRUE;
-	createInfo.oldSwapchain = VK_NULL_HANDLE;
+	createInfo.oldSwapchain = oldSwapchain;
 
 	if (vkCreateSwapchainKHR(*m_pLogicalDevice, &createInfo, nullptr, &m_swapchain) != VK_SUCCESS)
 	{
@@ -138,6 +205,31 @@ void Swapchain::createSwapchain()
 
 	m_swapchainImageFormat = surfaceFormat.format;
 	m_swapchainExtent = extent;
+
+	mDebugPrint(std::format("Presenting {}x{} in {} mode: {}, {} images, {} frame(s) in flight", extent.width, extent.height, getPresentModeName(m_presentMode),
+		getVkPresentModeName(presentMode), imageCount, m_framesInFlight));
+}
+
+void Swapchain::createOffscreenImages()
+{
+	sSettings::sWindowSettings windowSettings = VulkanEngine::getInstance()->m_settings->windowSettings;
+
+	// The format the swapchain prefers, so the pipeline is built exactly as it would be for a window
+	m_swapchainImageFormat = VK_FORMAT_B8G8R8A8_SRGB;
+	m_swapchainExtent = { windowSettings.width, windowSettings.height };
+
+	// Nothing is held on screen, so every frame context can be in flight with an image of its own
+	m_framesInFlight = m_maxFramesInFlight;
+	m_swapchainImages.resize(m_maxFramesInFlight);
+	m_offscreenMemory.resize(m_maxFramesInFlight);
+
+	for (uint32_t i = 0; i < m_maxFramesInFlight; i++)
+	{
+		Image::createImage(m_swapchainExtent.width, m_swapchainExtent.height, m_swapchainImageFormat, VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_swapchainImages[i], m_offscreenMemory[i]);
+	}
+
+	mDebugPrint(std::format("Rendering {}x{} offscreen: {} images, {} frame(s) in flight", m_swapchainExtent.width, m_swapchainExtent.height, m_swapchainImages.size(), m_framesInFlight));
 }
 
 void Swapchain::createImageViews()
@@ -151,6 +243,20 @@ void Swapchain::createImageViews()
 	}
 }
 
+void Swapchain::createRenderFinishedSemaphores()
+{
+	VkSemaphoreCreateInfo semaphoreInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
+	};
+
+	m_renderFinishedSemaphores.resize(m_swapchainImages.size());
+	for (VkSemaphore& semaphore : m_renderFinishedSemaphores)
+	{
+		if (vkCreateSemaphore(*m_pLogicalDevice, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS)
+			throw std::runtime_error("failed to create a render finished semaphore!");
+	}
+}
+
 void Swapchain::recreateSwapchain(GLFWwindow* pWindow)
 {
 	int width = 0, height = 0;
@@ -160,14 +266,31 @@ void Swapchain::recreateSwapchain(GLFWwindow* pWindow)
 		glfwWaitEvents();
 	}
 
-	vkDeviceWaitIdle(*m_pLogicalDevice);
-
-	cleanup();
+	VkSwapchainKHR oldSwapchain = m_swapchain;
+	std::vector<VkImageView> oldImageViews = m_swapchainImageViews;
+	std::vector<VkSemaphore> oldSemaphores = m_renderFinishedSemaphores;
 
-	createSwapchain();
+	// The image count can change, and a pending present may still be waiting on an old semaphore
+	createSwapchain(oldSwapchain);
 	createImageViews();
-	m_pBufferManager->getDepthBuffer()->createDepthResources();
-	m_pBufferManager->getFramebuffer()->createFramebuffers();
+	createRenderFinishedSemaphores();
+
+	VkDevice device = *m_pLogicalDevice;
+	m_pBufferManager->getDeletionQueue()->retire([=] {
+		for (auto imageView : oldImageViews) vkDestroyImageView(device, imageView, nullptr);
+		vkDestroySwapchainKHR(device, oldSwapchain, nullptr);
+		for (auto semaphore : oldSemaphores) vkDestroySemaphore(device, semaphore, nullptr);
+	});
+
+	// Its framebuffers and transient images are sized for the swapchain
+	m_pBufferManager->getRenderGraph()->clear();
+	m_pBufferManager->getCommandBuffer()->buildRenderGraph();
+}
+
+void Swapchain::setPresentMode(ePresentMode mode, GLFWwindow* pWindow)
+{
+	m_presentMode = mode;
+	recreateSwapchain(pWindow);
 }
 
 
@@ -176,12 +299,25 @@ void Swapchain::recreateSwapchain(GLFWwindow* pWindow)
 
 void Swapchain::cleanup()
 {
-	m_pBufferManager->getFramebuffer()->cleanup();
-	m_pBufferManager->getDepthBuffer()->cleanup();
+	// Its framebuffers and transient images are sized for the swapchain
+	m_pBufferManager->getRenderGraph()->clear();
 
 	for (auto imageView : m_swapchainImageViews) {
 		vkDestroyImageView(*m_pLogicalDevice, imageView, nullptr);
 	}
 
+	if (m_headless)
+	{
+		for (size_t i = 0; i < m_swapchainImages.size(); i++)
+		{
+			vkDestroyImage(*m_pLogicalDevice, m_swapchainImages[i], nullptr);
+			vkFreeMemory(*m_pLogicalDevice, m_offscreenMemory[i], nullptr);
+		}
+		return;
+	}
+
 	vkDestroySwapchainKHR(*m_pLogicalDevice, m_swapchain, nullptr);
+	for (auto semaphore : m_renderFinishedSemaphores) {
+		vkDestroySemaphore(*m_pLogicalDevice, semaphore, nullptr);
+	}
 }
\ No newline at end of file
@@ -3,24 +3,56 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+#include <vector>
+
+#include "../Utilities/Utilities.h"
+
 class BufferManager;
 class PhysicalDevice;
 
 class Swapchain
 {
 public:
+	// How frames reach the screen. Each one picks the present mode, the number of swapchain images and how many frames
+	// the CPU may have in flight together, so the CPU never queues more frames than the swapchain can take.
+	enum class ePresentMode : uint8_t
+	{
+		LOW_LATENCY, // IMMEDIATE, or MAILBOX, with the fewest images and one frame in flight
+		VSYNC, // FIFO with the fewest images the surface allows and at most two frames in flight, so the CPU stays close behind the display
+		THROUGHPUT // MAILBOX, or FIFO, with an image for every frame in flight plus the one on screen
+	};
+
 	Swapchain();
 
+	// VSync off is LOW_LATENCY. With VSync on, triple buffering picks THROUGHPUT and no triple buffering VSYNC.
+	static ePresentMode getSettingsPresentMode(const sSettings::sGraphicsSettings& settings);
+	static const char* getPresentModeName(ePresentMode mode);
+
 	void cleanup();
 
-	void createSwapchain();
+	// Passing the swapchain being replaced lets the presentation engine hand its resources over.
+	void createSwapchain(VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
+	// Headless stand-in for the swapchain, one offscreen colour image per frame in flight sized from the window settings.
+	// They are left in TRANSFER_SRC_OPTIMAL at the end of each frame, ready to be read back.
+	void createOffscreenImages();
 	void createImageViews();
+	// One per swapchain image, signalled when its frame is rendered and waited on by the present.
+	void createRenderFinishedSemaphores();
+	// Replaces the swapchain without waiting for the device. The old one, its views and everything the render graph
+	// built for it are retired to the deletion queue until the frames using them finish.
 	void recreateSwapchain(GLFWwindow* pWindow);
+	void setPresentMode(ePresentMode mode, GLFWwindow* pWindow);
 
 	VkSwapchainKHR* getSwapchain() { return &m_swapchain; }
 	VkExtent2D* getSwapchainExtent() { return &m_swapchainExtent; }
 	VkFormat* getSwapchainImageFormat() { return &m_swapchainImageFormat; }
+	std::vector<VkImage>* getSwapchainImages() { return &m_swapchainImages; }
 	std::vector<VkImageView>* getSwapchainImageViews() { return &m_swapchainImageViews; }
+	VkSemaphore getRenderFinishedSemaphore(uint32_t imageIndex) { return m_renderFinishedSemaphores[imageIndex]; }
+	ePresentMode getPresentMode() { return m_presentMode; }
+	// Frames the CPU should keep in flight with the current swapchain, never more than were allocated.
+	uint32_t getFramesInFlight() { return m_framesInFlight; }
+	bool isHeadless() { return m_headless; }
 
 private:
 	Utilities* m_pUtilities = nullptr;
@@ -36,11 +68,19 @@ private:
 	VkFormat m_swapchainImageFormat = VK_FORMAT_UNDEFINED;
 	VkExtent2D m_swapchainExtent = {};
 	std::vector<VkImageView> m_swapchainImageViews = {};
+	std::vector<VkSemaphore> m_renderFinishedSemaphores = {}; // Windowed only
+	std::vector<VkDeviceMemory> m_offscreenMemory = {}; // Headless only, the swapchain owns its images' memory otherwise
+	bool m_headless = false;
+	ePresentMode m_presentMode = ePresentMode::VSYNC;
+	uint32_t m_maxFramesInFlight = 1; // Frame contexts allocated
+	uint32_t m_framesInFlight = 1;
 
 	bool m_firstRun = true;
 
 	VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
 	VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
 	VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
+	// Also works out m_framesInFlight, which the image count bounds.
+	uint32_t chooseImageCount(const VkSurfaceCapabilitiesKHR& capabilities);
 };
 
@@ -0,0 +1,174 @@
+#include "../VulkanEngine.h"
+
+#include "TextureRegistry.h"
+
+
+
+TextureRegistry::TextureRegistry() : m_pLogicalDevice(VulkanEngine::getInstance()->m_pLogicalDevice->getVkDevice()), m_MAX_FRAMES_IN_FLIGHT(VulkanEngine::getInstance()->m_MAX_FRAMES_IN_FLIGHT),
+	m_pUtilities(Utilities::getInstance())
+{
+	// Clamp the requested slot count to what the device can keep bound at once
+	VkPhysicalDeviceVulkan12Properties properties12{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES
+	};
+	VkPhysicalDeviceProperties2 properties{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+		.pNext = &properties12
+	};
+	vkGetPhysicalDeviceProperties2(*VulkanEngine::getInstance()->m_pVkPhysicalDevice, &properties);
+
+	m_capacity = VulkanEngine::getInstance()->m_settings->graphicsSettings.maxBindlessTextures;
+	m_capacity = std::min(m_capacity, properties12.maxPerStageDescriptorUpdateAfterBindSamplers);
+	m_capacity = std::min(m_capacity, properties12.maxPerStageDescriptorUpdateAfterBindSampledImages);
+	m_capacity = std::min(m_capacity, properties12.maxDescriptorSetUpdateAfterBindSamplers);
+	m_capacity = std::min(m_capacity, properties12.maxDescriptorSetUpdateAfterBindSampledImages);
+	mDebugPrint(std::format("Bindless texture slots: {}", m_capacity));
+
+	createDescriptorSetLayout();
+	createDescriptorPool();
+	allocateDescriptorSet();
+}
+
+void TextureRegistry::createDescriptorSetLayout()
+{
+	mDebugPrint("Creating bindless texture descriptor set layout...");
+
+	VkDescriptorSetLayoutBinding textureArrayBinding{
+		.binding = 0,
+		.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		.descriptorCount = m_capacity,
+		.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+		.pImmutableSamplers = nullptr
+	};
+
+	// Slots can be written while the set is bound, left empty, and the array is sized at allocation time
+	VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+		VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+		.bindingCount = 1,
+		.pBindingFlags = &bindingFlags
+	};
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.pNext = &bindingFlagsInfo,
+		.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+		.bindingCount = 1,
+		.pBindings = &textureArrayBinding
+	};
+
+	if (vkCreateDescriptorSetLayout(*m_pLogicalDevice, &layoutInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create bindless texture descriptor set layout!");
+	}
+}
+
+void TextureRegistry::createDescriptorPool()
+{
+	mDebugPrint("Creating bindless texture descriptor pool...");
+
+	VkDescriptorPoolSize poolSize{
+		.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		.descriptorCount = m_capacity
+	};
+
+	VkDescriptorPoolCreateInfo poolInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+		.maxSets = 1,
+		.poolSizeCount = 1,
+		.pPoolSizes = &poolSize
+	};
+
+	if (vkCreateDescriptorPool(*m_pLogicalDevice, &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create bindless texture descriptor pool!");
+	}
+}
+
+void TextureRegistry::allocateDescriptorSet()
+{
+	VkDescriptorSetVariableDescriptorCountAllocateInfo variableCountInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO,
+		.descriptorSetCount = 1,
+		.pDescriptorCounts = &m_capacity
+	};
+
+	VkDescriptorSetAllocateInfo allocInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.pNext = &variableCountInfo,
+		.descriptorPool = m_descriptorPool,
+		.descriptorSetCount = 1,
+		.pSetLayouts = &m_descriptorSetLayout
+	};
+
+	if (vkAllocateDescriptorSets(*m_pLogicalDevice, &allocInfo, &m_descriptorSet) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate bindless texture descriptor set!");
+	}
+}
+
+
+
+uint32_t TextureRegistry::allocateSlot(Image* pImage)
+{
+	uint32_t slot;
+	if (!m_freeSlots.empty())
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else if (m_nextUnusedSlot < m_capacity)
+	{
+		slot = m_nextUnusedSlot++;
+	}
+	else
+	{
+		throw std::runtime_error("Ran out of bindless texture slots!");
+	}
+
+	VkDescriptorImageInfo imageInfo{
+		.sampler = *pImage->getVkTextureSampler(),
+		.imageView = *pImage->getVkTextureImageView(),
+		.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+	};
+
+	VkWriteDescriptorSet descriptorWrite{
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.dstSet = m_descriptorSet,
+		.dstBinding = 0,
+		.dstArrayElement = slot,
+		.descriptorCount = 1,
+		.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		.pImageInfo = &imageInfo
+	};
+
+	vkUpdateDescriptorSets(*m_pLogicalDevice, 1, &descriptorWrite, 0, nullptr);
+
+	return slot;
+}
+
+void TextureRegistry::freeSlot(uint32_t slot)
+{
+	if (slot == INVALID_SLOT) return;
+	m_pendingSlots.push_back({ slot, m_frameNumber });
+}
+
+void TextureRegistry::advanceFrame()
+{
+	m_frameNumber++;
+
+	// A slot freed on frame N may still be sampled by frames up to N + MAX_FRAMES_IN_FLIGHT - 1
+	std::erase_if(m_pendingSlots, [this](const sPendingSlot& pending) {
+		if (m_frameNumber - pending.freedOnFrame < static_cast<uint64_t>(m_MAX_FRAMES_IN_FLIGHT)) return false;
+		m_freeSlots.push_back(pending.slot);
+		return true;
+	});
+}
+
+
+
+void TextureRegistry::cleanup()
+{
+	vkDestroyDescriptorPool(*m_pLogicalDevice, m_descriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(*m_pLogicalDevice, m_descriptorSetLayout, nullptr);
+}
\ No newline at end of file
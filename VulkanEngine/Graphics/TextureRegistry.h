@@ -0,0 +1,63 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <vector>
+#include <algorithm>
+
+#include "../Utilities/Utilities.h"
+#include "Image.h"
+
+
+
+// Bindless texture table. Owns a single update-after-bind descriptor set holding a large, partially bound
+// array of combined image samplers (set 1, binding 0). Textures are given a slot index that shaders use
+// to sample from the array, so adding or removing a texture never touches the pipeline layout or
+// requires rebinding descriptor sets.
+class TextureRegistry
+{
+public:
+	static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+	TextureRegistry();
+
+	// Writes the image into a free slot and returns its index.
+	uint32_t allocateSlot(Image* pImage);
+	// Returns the slot to the registry. It won't be reused until every frame that could still sample it has finished.
+	void freeSlot(uint32_t slot);
+	// Call once per frame after the frame's fence has been waited on.
+	void advanceFrame();
+
+	void cleanup();
+
+	VkDescriptorSetLayout* getDescriptorSetLayout() { return &m_descriptorSetLayout; }
+	VkDescriptorSet* getDescriptorSet() { return &m_descriptorSet; }
+	uint32_t getCapacity() { return m_capacity; }
+
+private:
+	struct sPendingSlot
+	{
+		uint32_t slot;
+		uint64_t freedOnFrame;
+	};
+
+	Utilities* m_pUtilities = nullptr;
+	VkDevice* m_pLogicalDevice = nullptr;
+	int m_MAX_FRAMES_IN_FLIGHT = 1;
+
+	VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
+	VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+	VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
+
+	uint32_t m_capacity = 0;
+	uint32_t m_nextUnusedSlot = 0;
+	std::vector<uint32_t> m_freeSlots = {};
+	std::vector<sPendingSlot> m_pendingSlots = {};
+	uint64_t m_frameNumber = 0;
+
+
+	void createDescriptorSetLayout();
+	void createDescriptorPool();
+	void allocateDescriptorSet();
+};
\ No newline at end of file
@@ -16,9 +16,10 @@ struct Vertex {
 	glm::vec3 color;
 	glm::vec2 texCoord;
 	glm::lowp_f32 colorBlendTex;
+	uint32_t texLayer = 0; // Layer of the block texture array to sample from.
 
 	bool operator==(const Vertex& other) const {
-		return pos == other.pos && color == other.color && texCoord == other.texCoord;
+		return pos == other.pos && color == other.color && texCoord == other.texCoord && texLayer == other.texLayer;
 	}
 
 	static VkVertexInputBindingDescription getBindingDescription()
@@ -32,9 +33,9 @@ struct Vertex {
 		return bindingDescription;
 	}
 
-	static std::array<VkVertexInputAttributeDescription, 4> getAttributeDescriptions()
+	static std::array<VkVertexInputAttributeDescription, 5> getAttributeDescriptions()
 	{
-		std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{
+		std::array<VkVertexInputAttributeDescription, 5> attributeDescriptions{
 			VkVertexInputAttributeDescription{
 				.location = 0,
 				.binding = 0,
@@ -58,6 +59,12 @@ struct Vertex {
 				.binding = 0,
 				.format = VK_FORMAT_R16_UNORM,
 				.offset = offsetof(Vertex, colorBlendTex)
+			},
+			VkVertexInputAttributeDescription{
+				.location = 4,
+				.binding = 0,
+				.format = VK_FORMAT_R32_UINT,
+				.offset = offsetof(Vertex, texLayer)
 			}
 		};
 
@@ -70,7 +77,7 @@ namespace std {
 		size_t operator()(Vertex const& vertex) const {
 			return ((hash<glm::vec3>()(vertex.pos) ^
 				(hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
-				(hash<glm::vec2>()(vertex.texCoord) << 1);
+				(hash<glm::vec2>()(vertex.texCoord) << 1) ^ (hash<uint32_t>()(vertex.texLayer) << 2);
 		}
 	};
 }
\ No newline at end of file
@@ -20,6 +20,14 @@ void Window::initWindow()
 
 	sSettings::sWindowSettings windowSettings = VulkanEngine::getInstance()->m_settings->windowSettings;
 
+	// Nothing from GLFW is touched headless, so it runs on machines without a display
+	m_headless = VulkanEngine::getInstance()->m_settings->debugSettings.headless;
+	if (m_headless)
+	{
+		mDebugPrint(std::format("Running headless, rendering {}x{} offscreen", windowSettings.width, windowSettings.height));
+		return;
+	}
+
 	glfwInit();
 
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
@@ -28,9 +36,11 @@ void Window::initWindow()
 	m_pWindow = glfwCreateWindow(windowSettings.width, windowSettings.height, windowSettings.title, nullptr, nullptr);
 	glfwSetWindowUserPointer(m_pWindow, this);
 	glfwSetFramebufferSizeCallback(m_pWindow, framebufferResizeCallback);
-
-	if (m_pGraphicsSettings->vsync) m_pGraphicsSettings->maxFramerate = 60; // TODO: Check for display's refresh rate
-	if (m_pGraphicsSettings->maxFramerate > 0) m_renderTargetDelta = (1.0f / (float)m_pGraphicsSettings->maxFramerate); else m_renderTargetDelta = 0.0f;
+	glfwSetWindowPosCallback(m_pWindow, windowPosCallback);
+	glfwSetKeyCallback(m_pWindow, keyCallback);
+	glfwSetMouseButtonCallback(m_pWindow, mouseButtonCallback);
+	glfwSetCursorPosCallback(m_pWindow, cursorPosCallback);
+	glfwSetScrollCallback(m_pWindow, scrollCallback);
 }
 
 void Window::framebufferResizeCallback(GLFWwindow* window, int width, int height)
@@ -40,9 +50,92 @@ void Window::framebufferResizeCallback(GLFWwindow* window, int width, int height
 	//app->drawFrame(); // Don't do this or it'll break the window when one of the coordinates is 0
 }
 
+void Window::windowPosCallback(GLFWwindow* window, int x, int y)
+{
+	auto app = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
+	app->m_frameTargetDirty = true;
+}
+
+void Window::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	auto app = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
+	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) glfwSetWindowShouldClose(window, GLFW_TRUE);
+	app->pushInput({ .type = Simulation::sInputEvent::KEY, .code = key, .action = action, .mods = mods });
+}
+
+void Window::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+{
+	auto app = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
+	app->pushInput({ .type = Simulation::sInputEvent::MOUSE_BUTTON, .code = button, .action = action, .mods = mods });
+}
+
+void Window::cursorPosCallback(GLFWwindow* window, double x, double y)
+{
+	auto app = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
+	app->pushInput({ .type = Simulation::sInputEvent::CURSOR, .value = glm::dvec2(x, y) });
+}
+
+void Window::scrollCallback(GLFWwindow* window, double x, double y)
+{
+	auto app = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
+	app->pushInput({ .type = Simulation::sInputEvent::SCROLL, .value = glm::dvec2(x, y) });
+}
+
+void Window::updateFrameTarget()
+{
+	m_frameTargetDirty = false;
+
+	// The frame cap, or the display's real refresh rate with VSync if that is slower
+	double target = (m_pGraphicsSettings->maxFramerate > 0) ? 1.0 / m_pGraphicsSettings->maxFramerate : 0.0;
+	int refreshRate = getRefreshRate();
+	if (m_pGraphicsSettings->vsync && refreshRate > 0) target = std::max(target, 1.0 / refreshRate);
+	if (target == m_framePacer.getTargetFrameTime()) return;
+
+	m_framePacer.setTargetFrameTime(target);
+	if (target > 0.0) mDebugPrint(std::format("Pacing frames to {:.3f} ms (display refresh rate {} Hz)", target * 1000, refreshRate));
+	else mDebugPrint("Frame rate unlimited");
+}
+
+int Window::getRefreshRate()
+{
+	int windowX, windowY, width, height;
+	glfwGetWindowPos(m_pWindow, &windowX, &windowY);
+	glfwGetWindowSize(m_pWindow, &width, &height);
+	int centreX = windowX + width / 2, centreY = windowY + height / 2;
+
+	int monitorCount;
+	GLFWmonitor** pMonitors = glfwGetMonitors(&monitorCount);
+	GLFWmonitor* pMonitor = glfwGetPrimaryMonitor();
+	for (int i = 0; i < monitorCount; i++)
+	{
+		int monitorX, monitorY;
+		glfwGetMonitorPos(pMonitors[i], &monitorX, &monitorY);
+		const GLFWvidmode* pMode = glfwGetVideoMode(pMonitors[i]);
+		if (pMode != nullptr && centreX >= monitorX && centreY >= monitorY && centreX < monitorX + pMode->width && centreY < monitorY + pMode->height)
+		{
+			pMonitor = pMonitors[i];
+			break;
+		}
+	}
+
+	const GLFWvidmode* pMode = (pMonitor != nullptr) ? glfwGetVideoMode(pMonitor) : nullptr;
+	return (pMode != nullptr) ? pMode->refreshRate : 0;
+}
+
+void Window::pushInput(Simulation::sInputEvent event)
+{
+	// Events only arrive from glfwPollEvents in the main loop, after the simulation exists
+	if (m_pSimulation == nullptr) return;
+
+	event.time = Simulation::Clock::now();
+	m_pSimulation->pushInput(event);
+}
+
 
 void Window::createSurface()
 {
+	if (m_headless) return;
+
 	mDebugPrint("Creating surface...");
 
 	if (glfwCreateWindowSurface(*m_pVkInstance, m_pWindow, nullptr, &m_surface) != VK_SUCCESS) {
@@ -60,11 +153,11 @@ void Window::createSyncObjects()
 	m_pSwapchain = VulkanEngine::getInstance()->m_pSwapchain;
 	m_pCommandBuffer = VulkanEngine::getInstance()->m_pBufferManager->getCommandBuffer();
 	m_pUniformBufferObject = VulkanEngine::getInstance()->m_pBufferManager->getUniformBufferObject();
+	m_pTextureRegistry = VulkanEngine::getInstance()->m_pTextureRegistry;
+	m_pSimulation = VulkanEngine::getInstance()->m_pSimulation;
 
-	// Resize the vectors to the correct size
-	m_imageAvailableSemaphores.resize(m_MAX_FRAMES_IN_FLIGHT);
-	m_renderFinishedSemaphores.resize(m_MAX_FRAMES_IN_FLIGHT);
-	m_inFlightFences.resize(m_MAX_FRAMES_IN_FLIGHT);
+	m_frames.resize(m_MAX_FRAMES_IN_FLIGHT);
+	m_activeFrames = m_pSwapchain->getFramesInFlight();
 
 	VkSemaphoreCreateInfo semaphoreInfo{
 		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
@@ -75,23 +168,50 @@ void Window::createSyncObjects()
 		.flags = VK_FENCE_CREATE_SIGNALED_BIT
 	};
 
-	for (size_t i = 0; i < m_MAX_FRAMES_IN_FLIGHT; i++)
+	// Gather each frame's resources from their owners under one index
+	DescriptorSets* pDescriptorSets = VulkanEngine::getInstance()->m_pBufferManager->getDescriptorSets();
+	for (uint32_t i = 0; i < m_MAX_FRAMES_IN_FLIGHT; i++)
 	{
-		if (vkCreateSemaphore(*m_pLogicalDevice, &semaphoreInfo, nullptr, &m_imageAvailableSemaphores[i]) != VK_SUCCESS ||
-			vkCreateSemaphore(*m_pLogicalDevice, &semaphoreInfo, nullptr, &m_renderFinishedSemaphores[i]) != VK_SUCCESS ||
-			vkCreateFence(*m_pLogicalDevice, &fenceInfo, nullptr, &m_inFlightFences[i]) != VK_SUCCESS)
+		sFrameContext& frame = m_frames[i];
+		frame.index = i;
+		frame.commandBuffer = (*m_pCommandBuffer->getCommandBuffers())[i];
+		frame.pUniformBufferMapped = (*m_pUniformBufferObject->getUniformBuffersMapped())[i];
+		frame.descriptorSet = (*pDescriptorSets->getVkDescriptorSets())[i];
+
+		if (vkCreateSemaphore(*m_pLogicalDevice, &semaphoreInfo, nullptr, &frame.imageAvailable) != VK_SUCCESS ||
+			vkCreateFence(*m_pLogicalDevice, &fenceInfo, nullptr, &frame.inFlight) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to create synchronization objects for a frame!");
 		}
 	}
+
+	// Retired objects wait on every frame's fence
+	std::vector<VkFence> fences;
+	for (const sFrameContext& frame : m_frames) fences.push_back(frame.inFlight);
+	m_pDeletionQueue = VulkanEngine::getInstance()->m_pBufferManager->getDeletionQueue();
+	m_pDeletionQueue->setFrameFences(fences);
 }
 
 
 void Window::mainLoop()
 {
+	if (VulkanEngine::getInstance()->m_settings->debugSettings.runFramesInFlightBenchmark) benchmarkFramesInFlight(1000);
+	if (VulkanEngine::getInstance()->m_settings->debugSettings.runPresentModeBenchmark) benchmarkPresentModes(500);
+	if (VulkanEngine::getInstance()->m_settings->debugSettings.runTerrainBenchmark) benchmarkTerrain(1000);
+	if (VulkanEngine::getInstance()->m_settings->debugSettings.runRecordingBenchmark) benchmarkRecording(500);
+
+	if (m_headless)
+	{
+		runHeadless(VulkanEngine::getInstance()->m_settings->debugSettings.headlessFrames);
+		return;
+	}
+
 	while (!glfwWindowShouldClose(m_pWindow))
 	{
+		// Sleep until the next frame is due, waking for window events so input isn't held back by the wait
+		m_framePacer.waitForNextFrame([](double seconds) { glfwWaitEventsTimeout(seconds); });
 		glfwPollEvents();
+		if (m_frameTargetDirty) updateFrameTarget();
 		drawFrame();
 
 		// Print FPS
@@ -102,62 +222,118 @@ void Window::mainLoop()
 	vkDeviceWaitIdle(*m_pLogicalDevice);
 }
 
+void Window::runHeadless(uint32_t frameCount)
+{
+	// Unpaced, so the numbers measure the renderer and not the frame cap
+	mDebugPrint(std::format("Rendering {} frames headless with {} frame(s) in flight...", frameCount, m_activeFrames));
+
+	std::vector<double> frameTimes;
+	frameTimes.reserve(frameCount);
+	double cpuWorkSum = 0.0;
+
+	double start = getTime();
+	double lastFrame = start;
+	for (uint32_t i = 0; i < frameCount; i++)
+	{
+		drawFrame();
+		cpuWorkSum += m_cpuWorkTime;
+		calculateFPS();
+
+		double now = getTime();
+		frameTimes.push_back(now - lastFrame);
+		lastFrame = now;
+	}
+	vkDeviceWaitIdle(*m_pLogicalDevice);
+	double wallTime = getTime() - start;
+
+	if (frameTimes.empty()) return;
+
+	double frameTimeSum = 0.0;
+	for (double frameTime : frameTimes) frameTimeSum += frameTime;
+	std::sort(frameTimes.begin(), frameTimes.end());
+
+	mDebugPrint(std::format("Headless: {} frames in {:.3f} s, {:.1f} FPS. Frame time (ms): {:.3f} avg, {:.3f} median, {:.3f} 99th percentile, {:.3f} worst. CPU work (ms): {:.3f} avg",
+		frameCount, wallTime, frameCount / wallTime, frameTimeSum / frameTimes.size() * 1000, frameTimes[frameTimes.size() / 2] * 1000,
+		frameTimes[std::min(frameTimes.size() - 1, frameTimes.size() * 99 / 100)] * 1000, frameTimes.back() * 1000, cpuWorkSum / frameCount * 1000));
+}
+
 
 void Window::drawFrame()
 {
-	double currentDelta = glfwGetTime() - m_renderLastTime;
-	if (currentDelta < m_renderTargetDelta) return;
-
 	uint32_t imageIndex;
+	sFrameContext& frame = m_frames[m_currentFrame];
 
-	std::vector<VkCommandBuffer> commandBuffers = *m_pCommandBuffer->getCommandBuffers();
-
-	double timeBeforeFences = glfwGetTime();
+	double timeBeforeFences = getTime();
 
-	vkWaitForFences(*m_pLogicalDevice, 1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
+	// Only waits for the GPU to finish the frame that last used this context, the others keep running
+	vkWaitForFences(*m_pLogicalDevice, 1, &frame.inFlight, VK_TRUE, UINT64_MAX);
 
-	m_gpuDrawTime = glfwGetTime() - timeBeforeFences;
-	double timeAfterFences = glfwGetTime();
+	m_gpuDrawTime = getTime() - timeBeforeFences;
+	measurePresentLatency();
 
-	VkResult result = vkAcquireNextImageKHR(*m_pLogicalDevice, *m_pSwapchain->getSwapchain(), UINT64_MAX, m_imageAvailableSemaphores[m_currentFrame], VK_NULL_HANDLE, &imageIndex);
+	// Recycle bindless texture slots that no in-flight frame can still be sampling
+	if (m_pTextureRegistry != nullptr) m_pTextureRegistry->advanceFrame();
+	m_pDeletionQueue->collect();
+	double timeAfterFences = getTime();
 
-	// Ensure swapchain quality
-	if (result == VK_ERROR_OUT_OF_DATE_KHR)
+	VkResult result = VK_SUCCESS;
+	if (m_headless)
 	{
-		m_pSwapchain->recreateSwapchain(m_pWindow);
-		return;
+		// Each frame context has its own offscreen image, and the fence above means it is free
+		imageIndex = m_currentFrame;
 	}
-	else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-		throw std::runtime_error("failed to acquire swap chain image!");
+	else
+	{
+		result = vkAcquireNextImageKHR(*m_pLogicalDevice, *m_pSwapchain->getSwapchain(), UINT64_MAX, frame.imageAvailable, VK_NULL_HANDLE, &imageIndex);
+
+		// Ensure swapchain quality
+		if (result == VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			recreateSwapchain();
+			return;
+		}
+		else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+			throw std::runtime_error("failed to acquire swap chain image!");
+		}
 	}
 
-	updateUniformBuffer(m_currentFrame); // Perform translations
+	frame.cpuStartTime = getTime();
+	updateUniformBuffer(frame); // Perform translations
 
-	vkResetFences(*m_pLogicalDevice, 1, &m_inFlightFences[m_currentFrame]);
+	vkResetFences(*m_pLogicalDevice, 1, &frame.inFlight);
 
-	vkResetCommandBuffer(commandBuffers[m_currentFrame], 0);
-	m_pCommandBuffer->recordCommandBuffer(commandBuffers[m_currentFrame],imageIndex);
+	vkResetCommandBuffer(frame.commandBuffer, 0);
+	m_pCommandBuffer->recordCommandBuffer(frame, imageIndex);
 
 
-	VkSemaphore waitSemaphores[] = { m_imageAvailableSemaphores[m_currentFrame] };
-	VkSemaphore signalSemaphores[] = { m_renderFinishedSemaphores[m_currentFrame] };
+	// Presenting holds the signal semaphore until the image comes back from the screen, which needn't happen in frame
+	// order, so it belongs to the swapchain image rather than the frame context
+	VkSemaphore waitSemaphores[] = { frame.imageAvailable };
+	VkSemaphore signalSemaphores[] = { m_headless ? VK_NULL_HANDLE : m_pSwapchain->getRenderFinishedSemaphore(imageIndex) };
 	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 
+	// Headless there is no image to wait for and no present to signal, the fence is all that's needed
 	VkSubmitInfo submitInfo{
 		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-		.waitSemaphoreCount = 1,
+		.waitSemaphoreCount = m_headless ? 0u : 1u,
 		.pWaitSemaphores = waitSemaphores,
 		.pWaitDstStageMask = waitStages,
 		.commandBufferCount = 1,
-		.pCommandBuffers = &commandBuffers[m_currentFrame],
-		.signalSemaphoreCount = 1,
+		.pCommandBuffers = &frame.commandBuffer,
+		.signalSemaphoreCount = m_headless ? 0u : 1u,
 		.pSignalSemaphores = signalSemaphores
 	};
 
-	if (vkQueueSubmit(*m_pGraphicsQueue, 1, &submitInfo, m_inFlightFences[m_currentFrame]) != VK_SUCCESS) {
+	if (vkQueueSubmit(*m_pGraphicsQueue, 1, &submitInfo, frame.inFlight) != VK_SUCCESS) {
 		throw std::runtime_error("failed to submit draw command buffer!");
 	}
 
+	if (m_headless)
+	{
+		finishFrame(timeAfterFences);
+		return;
+	}
+
 
 	VkSwapchainKHR swapChains[] = { *m_pSwapchain->getSwapchain() };
 
@@ -174,51 +350,242 @@ void Window::drawFrame()
 	result = vkQueuePresentKHR(*m_pGraphicsQueue, &presentInfo);
 
 	// Ensure swapchain quality
-	if (result == VK_ERROR_OUT_OF_DATE_KHR || result != VK_SUBOPTIMAL_KHR || m_framebufferResized)
+	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebufferResized)
 	{
 		m_framebufferResized = false;
-		m_pSwapchain->recreateSwapchain(m_pWindow);
+		recreateSwapchain();
 	}
 	else if (result != VK_SUCCESS) {
 		throw std::runtime_error("failed to present swap chain image!");
 	}
 
+	if (!m_firstFramePresented)
+	{
+		m_firstFramePresented = true;
+		mDebugPrint(std::format("First frame presented {:.2f} ms after startup", VulkanEngine::getInstance()->getStartupTime()));
+	}
+
+	measurePresentLatency();
+
+	finishFrame(timeAfterFences);
+}
+
+void Window::finishFrame(double timeAfterFences)
+{
 	m_frameCounter++;
-	m_currentFrame = (m_currentFrame + 1) % m_MAX_FRAMES_IN_FLIGHT;
+	m_currentFrame = (m_currentFrame + 1) % m_activeFrames;
+
+	m_cpuWorkTime = getTime() - timeAfterFences;
+}
 
-	m_cpuWorkTime = glfwGetTime() - timeAfterFences;
+double Window::getTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_timeOrigin).count();
+}
+
+void Window::recreateSwapchain()
+{
+	m_pSwapchain->recreateSwapchain(m_pWindow);
 
-	m_renderLastTime = glfwGetTime();
+	// The present mode decides how many frames can be in flight
+	m_activeFrames = m_pSwapchain->getFramesInFlight();
+	m_currentFrame %= m_activeFrames;
 }
 
-void Window::updateUniformBuffer(uint32_t currentImage)
+void Window::measurePresentLatency()
 {
-	using std::chrono::high_resolution_clock, std::chrono::duration, std::chrono::seconds;
+	double now = getTime();
 
-	static auto startTime = high_resolution_clock::now();
+	for (sFrameContext& frame : m_frames)
+	{
+		if (frame.cpuStartTime == 0.0 || vkGetFenceStatus(*m_pLogicalDevice, frame.inFlight) != VK_SUCCESS) continue;
 
-	auto currentTime = high_resolution_clock::now();
-	float time = duration<float, seconds::period>(currentTime - startTime).count();
+		double latency = now - frame.cpuStartTime;
+		m_latencySum += latency;
+		m_maxLatency = std::max(m_maxLatency, latency);
+		m_latencySamples++;
+		frame.cpuStartTime = 0.0;
+	}
+}
+
+void Window::updateUniformBuffer(const sFrameContext& frame)
+{
+	// Interpolate between the last two simulation ticks so motion stays smooth at any frame rate
+	Simulation::sSimulationState state = m_pSimulation->getInterpolatedState(Simulation::Clock::now());
 
 
 	VkExtent2D swapchainExtent = *m_pSwapchain->getSwapchainExtent();
 
 	UniformBufferObject::sUniformBufferObject ubo{
-		.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(120.0f), glm::vec3(1.0f, 0.0f, 1.0f)),
+		.model = glm::rotate(glm::mat4(1.0f), state.modelRotation, glm::vec3(1.0f, 0.0f, 1.0f)),
 		.view = glm::lookAt(glm::vec3(5.0f, /*(8.0f * glm::sin(time)) + 4.0f*/ -4.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
 		.proj = glm::perspective(glm::radians(70.0f), swapchainExtent.width / (float)swapchainExtent.height, 0.1f, 10.0f)
 	};
 	ubo.proj[1][1] *= -1; // Flip the y axis to account for Vulkan's inverted y axis
 
-	std::vector<void*> uniformBuffersMapped = *m_pUniformBufferObject->getUniformBuffersMapped(); // FUCK THIS PIECE OF CODE IN PARTICULAR
-	memcpy(uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+	memcpy(frame.pUniformBufferMapped, &ubo, sizeof(ubo));
+}
+
+
+void Window::benchmarkFramesInFlight(uint32_t frameCount)
+{
+	double frameRates[2] = {};
+	uint32_t frameCounts[2] = { 1, static_cast<uint32_t>(m_MAX_FRAMES_IN_FLIGHT) };
+
+	for (uint32_t run = 0; run < 2; run++)
+	{
+		vkDeviceWaitIdle(*m_pLogicalDevice);
+		m_activeFrames = frameCounts[run];
+		m_currentFrame = 0;
+
+		double start = getTime();
+		for (uint32_t i = 0; i < frameCount; i++)
+		{
+			if (!m_headless) glfwPollEvents();
+			drawFrame();
+		}
+		vkDeviceWaitIdle(*m_pLogicalDevice);
+		frameRates[run] = frameCount / (getTime() - start);
+	}
+
+	m_activeFrames = m_pSwapchain->getFramesInFlight();
+	m_currentFrame = 0;
+	m_frameCounter = 0;
+
+	mDebugPrint(std::format("Frames in flight: {:.1f} FPS with 1, {:.1f} FPS with {} ({:.2f}x){}", frameRates[0], frameRates[1], m_MAX_FRAMES_IN_FLIGHT, frameRates[1] / frameRates[0],
+		(m_pGraphicsSettings->vsync && !m_headless) ? ", capped by VSync" : ""));
+}
+
+
+void Window::benchmarkPresentModes(uint32_t frameCount)
+{
+	if (m_headless)
+	{
+		mDebugPrint("Skipping the present mode benchmark, nothing is presented headless");
+		return;
+	}
+
+	Swapchain::ePresentMode originalMode = m_pSwapchain->getPresentMode();
+	std::string results = "Present modes:";
+
+	for (Swapchain::ePresentMode mode : { Swapchain::ePresentMode::LOW_LATENCY, Swapchain::ePresentMode::VSYNC, Swapchain::ePresentMode::THROUGHPUT })
+	{
+		m_pSwapchain->setPresentMode(mode, m_pWindow);
+		m_activeFrames = m_pSwapchain->getFramesInFlight();
+		m_currentFrame = 0;
+		vkDeviceWaitIdle(*m_pLogicalDevice);
+		measurePresentLatency();
+		m_latencySum = 0.0;
+		m_maxLatency = 0.0;
+		m_latencySamples = 0;
+
+		double start = getTime();
+		for (uint32_t i = 0; i < frameCount; i++)
+		{
+			glfwPollEvents();
+			drawFrame();
+		}
+		vkDeviceWaitIdle(*m_pLogicalDevice);
+		double frameRate = frameCount / (getTime() - start);
+		measurePresentLatency();
+
+		results += std::format("\n  {:<12} {:>8.1f} FPS, latency {:.2f} ms avg, {:.2f} ms max ({} images, {} frame(s) in flight)", Swapchain::getPresentModeName(mode), frameRate,
+			m_latencySamples > 0 ? m_latencySum / m_latencySamples * 1000 : 0.0, m_maxLatency * 1000, m_pSwapchain->getSwapchainImages()->size(), m_activeFrames);
+	}
+
+	m_pSwapchain->setPresentMode(originalMode, m_pWindow);
+	m_activeFrames = m_pSwapchain->getFramesInFlight();
+	m_currentFrame = 0;
+	m_frameCounter = 0;
+	m_latencySum = 0.0;
+	m_maxLatency = 0.0;
+	m_latencySamples = 0;
+
+	mDebugPrint(results);
+}
+
+
+void Window::benchmarkTerrain(uint32_t frameCount)
+{
+	if (!m_pGraphicsSettings->faceInstancedTerrain)
+	{
+		mDebugPrint("Skipping the terrain benchmark, face-instanced terrain is disabled");
+		return;
+	}
+
+	std::string results = "Terrain:";
+	for (bool faceInstanced : { true, false })
+	{
+		m_pCommandBuffer->setFaceInstancedTerrain(faceInstanced);
+		vkDeviceWaitIdle(*m_pLogicalDevice);
+
+		double cpuWorkSum = 0.0;
+		double start = getTime();
+		for (uint32_t i = 0; i < frameCount; i++)
+		{
+			if (!m_headless) glfwPollEvents();
+			drawFrame();
+			cpuWorkSum += m_cpuWorkTime;
+		}
+		vkDeviceWaitIdle(*m_pLogicalDevice);
+		double frameTime = (getTime() - start) / frameCount;
+
+		results += std::format("\n  {:<15} {:.3f} ms per frame ({:.1f} FPS), CPU work {:.3f} ms", faceInstanced ? "Face instances" : "Vertex mesh", frameTime * 1000, 1.0 / frameTime,
+			cpuWorkSum / frameCount * 1000);
+	}
+
+	m_pCommandBuffer->setFaceInstancedTerrain(true);
+	m_frameCounter = 0;
+
+	mDebugPrint(results + ((m_pGraphicsSettings->vsync && !m_headless) ? "\n  Capped by VSync, run headless or with VSync off to compare" : ""));
+}
+
+
+void Window::benchmarkRecording(uint32_t frameCount)
+{
+	if (!m_pGraphicsSettings->faceInstancedTerrain)
+	{
+		mDebugPrint("Skipping the recording benchmark, it draws copies of the face-instanced terrain chunk");
+		return;
+	}
+
+	// Enough draws for every recording thread to get several batches
+	const uint32_t gridWidth = 64;
+	m_pCommandBuffer->setChunkGrid(gridWidth);
+
+	std::string results = std::format("Recording {} chunk draws:", gridWidth * gridWidth);
+	for (bool parallel : { false, true })
+	{
+		m_pCommandBuffer->setParallelRecording(parallel);
+		vkDeviceWaitIdle(*m_pLogicalDevice);
+
+		double recordTimeSum = 0.0;
+		double start = getTime();
+		for (uint32_t i = 0; i < frameCount; i++)
+		{
+			if (!m_headless) glfwPollEvents();
+			drawFrame();
+			recordTimeSum += m_pCommandBuffer->getRecordTime();
+		}
+		vkDeviceWaitIdle(*m_pLogicalDevice);
+		double frameTime = (getTime() - start) / frameCount;
+
+		results += std::format("\n  {:<9} {:.3f} ms recording {} batches, {:.3f} ms per frame", parallel ? "Parallel" : "Serial", recordTimeSum / frameCount * 1000,
+			m_pCommandBuffer->getBatchCount(), frameTime * 1000);
+	}
+
+	m_pCommandBuffer->setChunkGrid(1);
+	m_pCommandBuffer->setParallelRecording(true);
+	m_frameCounter = 0;
+
+	mDebugPrint(results);
 }
 
 
 void Window::calculateFPS()
 {
 	using std::string, std::to_string;
-	double current = glfwGetTime();
+	double current = getTime();
 	double delta = current - m_lastTime;
 
 	if (delta >= 1) // Wait 1 second
@@ -230,6 +597,24 @@ void Window::calculateFPS()
 		mDebugPrint(std::format("\x1b[36;49m{}", "FPS (current): " + fpsString.substr(0, fpsString.find(".") + 3)));
 		mDebugPrint(std::format("\x1b[33;49m{}", "CPU work (ms): " + cpuWaitString.substr(0, cpuWaitString.find(".") + 3)));
 		mDebugPrint(std::format("\x1b[33;49m{}", "GPU draw (us): " + gpuDrawString.substr(0, gpuDrawString.find(".") + 3)));
+		mDebugPrint(std::format("\x1b[33;49mCommand recording (us): {:.2f} for {} batches", m_pCommandBuffer->getRecordTime() * 1000000, m_pCommandBuffer->getBatchCount()));
+		mDebugPrint(std::format("\x1b[33;49mCPU-to-present latency (ms): {:.2f} avg, {:.2f} max in {} mode, {} frame(s) in flight", m_latencySamples > 0 ? m_latencySum / m_latencySamples * 1000 : 0.0,
+			m_maxLatency * 1000, m_headless ? "offscreen" : Swapchain::getPresentModeName(m_pSwapchain->getPresentMode()), m_activeFrames));
+		m_latencySum = 0.0;
+		m_maxLatency = 0.0;
+		m_latencySamples = 0;
+		FramePacer::sStats pacing = m_framePacer.takeStats();
+		mDebugPrint(std::format("\x1b[33;49mFrame time (ms): {:.3f} avg, {:.3f} jitter, {:.3f} worst deviation, {:.1f}% within {:.1f} ms, sleep margin {:.3f}", pacing.averageFrameTime * 1000,
+			pacing.jitter * 1000, pacing.worstDeviation * 1000, pacing.onTimeFraction * 100, FramePacer::ON_TIME_TOLERANCE * 1000, pacing.sleepMargin * 1000));
+		if (m_pSimulation != nullptr)
+		{
+			uint64_t ticks = m_pSimulation->getTickCount();
+			string tickString = to_string(m_pSimulation->getAverageTickTime()*1000000);
+			mDebugPrint(std::format("\x1b[35;49mUPS (current): {}, sim tick (us): {}, dropped ticks: {}", ticks - m_lastTickCount, tickString.substr(0, tickString.find(".") + 3), m_pSimulation->getDroppedTickCount()));
+			mDebugPrint(std::format("\x1b[35;49mInput latency (ms): {:.2f} avg, {:.2f} max, {:.2f} tick, dropped inputs: {}", m_pSimulation->getAverageInputLatency() * 1000,
+				m_pSimulation->takeMaxInputLatency() * 1000, m_pSimulation->getTickDelta() * 1000, m_pSimulation->getDroppedInputCount()));
+			m_lastTickCount = ticks;
+		}
 
 		m_frameCounter = 0;
 		m_lastTime = current;
@@ -241,20 +626,23 @@ void Window::calculateFPS()
 
 void Window::cleanupSyncObjects()
 {
-	for (size_t i = 0; i < m_MAX_FRAMES_IN_FLIGHT; i++) {
-		vkDestroySemaphore(*m_pLogicalDevice, m_renderFinishedSemaphores[i], nullptr);
-		vkDestroySemaphore(*m_pLogicalDevice, m_imageAvailableSemaphores[i], nullptr);
-		vkDestroyFence(*m_pLogicalDevice, m_inFlightFences[i], nullptr);
+	for (sFrameContext& frame : m_frames) {
+		vkDestroySemaphore(*m_pLogicalDevice, frame.imageAvailable, nullptr);
+		vkDestroyFence(*m_pLogicalDevice, frame.inFlight, nullptr);
 	}
 }
 
 void Window::cleanupSurface()
 {
+	if (m_headless) return;
+
 	vkDestroySurfaceKHR(*m_pVkInstance, m_surface, nullptr);
 }
 
 void Window::cleanupWindow()
 {
+	if (m_headless) return;
+
 	glfwDestroyWindow(m_pWindow);
 	glfwTerminate();
 }
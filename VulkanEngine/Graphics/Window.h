@@ -12,6 +12,9 @@
 
 #include "../Utilities/Utilities.h"
 #include "Swapchain.h"
+#include "FramePacer.h"
+#include "FrameContext.h"
+#include "../Simulation/Simulation.h"
 
 
 
@@ -20,6 +23,8 @@
 
 class CommandBuffer;
 class UniformBufferObject;
+class TextureRegistry;
+class DeletionQueue;
 
 class Window
 {
@@ -37,11 +42,19 @@ public:
 	void cleanupWindow();
 
 	static void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+	static void windowPosCallback(GLFWwindow* window, int x, int y);
+	// Input callbacks run on this window's thread during glfwPollEvents and forward to the simulation
+	static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+	static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+	static void cursorPosCallback(GLFWwindow* window, double x, double y);
+	static void scrollCallback(GLFWwindow* window, double x, double y);
 
 	GLFWwindow* getWindow() { return m_pWindow; }
 	VkSurfaceKHR* getSurface() { return &m_surface; }
 
 	bool m_framebufferResized = false;
+	// No window, surface or swapchain. Frames render into offscreen images and are never presented.
+	bool isHeadless() { return m_headless; }
 private:
 	VkInstance* m_pVkInstance = nullptr;
 	Utilities* m_pUtilities = nullptr;
@@ -50,27 +63,59 @@ private:
 	Swapchain* m_pSwapchain = nullptr;
 	CommandBuffer* m_pCommandBuffer = nullptr;
 	UniformBufferObject* m_pUniformBufferObject = nullptr;
+	TextureRegistry* m_pTextureRegistry = nullptr;
+	DeletionQueue* m_pDeletionQueue = nullptr;
+	Simulation* m_pSimulation = nullptr;
 	sSettings::sGraphicsSettings* m_pGraphicsSettings = nullptr;
 
-	GLFWwindow* m_pWindow = nullptr;
+	GLFWwindow* m_pWindow = nullptr; // nullptr when headless
 	VkSurfaceKHR m_surface = nullptr;
-	std::vector<VkSemaphore> m_imageAvailableSemaphores = {};
-	std::vector<VkSemaphore> m_renderFinishedSemaphores = {};
-	std::vector<VkFence> m_inFlightFences = {};
+	bool m_headless = false;
+	std::vector<sFrameContext> m_frames = {};
 	int m_MAX_FRAMES_IN_FLIGHT = 0;
+	uint32_t m_activeFrames = 0; // Contexts cycled through, as many as the present mode allows
 	uint32_t m_currentFrame = 0;
 
 	// Debug information
+	std::chrono::steady_clock::time_point m_timeOrigin = std::chrono::steady_clock::now(); // GLFW isn't initialised headless, so frames are timed from here
 	double m_lastTime = 0.0f;
 	int m_frameCounter = 0;
 	double m_cpuWorkTime = 0.0f;
 	double m_gpuDrawTime = 0.0f;
-	double m_renderTargetDelta = 0.0f;
-	double m_renderLastTime = 0.0f;
-
-
+	FramePacer m_framePacer = {};
+	bool m_frameTargetDirty = true; // Recheck the refresh rate, the window may have moved to another monitor
+	uint64_t m_lastTickCount = 0;
+	bool m_firstFramePresented = false; // Time to first frame is logged once
+	double m_latencySum = 0.0;
+	double m_maxLatency = 0.0;
+	uint32_t m_latencySamples = 0;
+
+
+	void pushInput(Simulation::sInputEvent event);
+	void updateFrameTarget();
+	// Refresh rate of the monitor under the centre of the window, 0 if unknown.
+	int getRefreshRate();
+	// Seconds since the window was created.
+	double getTime();
 	void drawFrame();
-	void updateUniformBuffer(uint32_t currentImage);
+	// Counts the frame and moves on to the next frame context.
+	void finishFrame(double timeAfterFences);
+	void recreateSwapchain();
+	// A frame counts as presented once its fence signals; the display adds up to a refresh on top. Fences are checked
+	// when a frame starts and after each present, so a sample can run long by the time between those.
+	void measurePresentLatency();
+	void updateUniformBuffer(const sFrameContext& frame);
+
+	// Renders frameCount unpaced frames offscreen through the normal frame path, then prints the frame time statistics.
+	void runHeadless(uint32_t frameCount);
+	// Renders the same unpaced burst of frames with one context and then all of them, and prints the throughput.
+	void benchmarkFramesInFlight(uint32_t frameCount);
+	// Renders the same unpaced burst of frames in every present mode, and prints the frame rate and latency of each.
+	void benchmarkPresentModes(uint32_t frameCount);
+	// Renders the same unpaced burst of frames with the terrain chunk face-instanced and then as a Vertex mesh, and prints the frame time of each.
+	void benchmarkTerrain(uint32_t frameCount);
+	// Renders the same unpaced burst of frames with a grid of per-chunk draws, recorded serially and then in parallel, and prints the recording time of each.
+	void benchmarkRecording(uint32_t frameCount);
 
 	// Calculates and prints the FPS
 	void calculateFPS();
@@ -1,44 +1,60 @@
 #include "Block.h"
 
+
+std::map<std::string, uint32_t> Block::sm_textureLayers = {};
+std::vector<std::string> Block::sm_texturePaths = {};
+
+
+uint32_t Block::registerTexture(const std::string& texturePath)
+{
+	auto it = sm_textureLayers.find(texturePath);
+	if (it != sm_textureLayers.end()) return it->second;
+
+	uint32_t layer = static_cast<uint32_t>(sm_texturePaths.size());
+	sm_textureLayers[texturePath] = layer;
+	sm_texturePaths.push_back(texturePath);
+	return layer;
+}
+
 void Block::buildModel() {
 	// Define the vertices and indices for the block
-	// Vertices are defined as {XYZ position, Vertex Color, UV texture position, color/texture blend}
+	// Vertices are defined as {XYZ position, Vertex Color, UV texture position, color/texture blend, texture array layer}
 	m_vertices = {
 		// Front face - Red
-		{{m_pos.x - 1.0f, -1.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 0.0f}, 0.5f},
-		{{m_pos.x + 1.0f, -1.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 0.0f}, 0.5f},
-		{{m_pos.x + 1.0f, 1.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f}, 0.5f},
-		{{m_pos.x - 1.0f, 1.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f}, 0.5f},
+		{{m_pos.x - 1.0f, -1.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 0.0f}, 0.5f, m_faceLayers[FRONT]},
+		{{m_pos.x + 1.0f, -1.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 0.0f}, 0.5f, m_faceLayers[FRONT]},
+		{{m_pos.x + 1.0f, 1.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f}, 0.5f, m_faceLayers[FRONT]},
+		{{m_pos.x - 1.0f, 1.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f}, 0.5f, m_faceLayers[FRONT]},
 
 		// Back face - Green
-		{{m_pos.x - 1.0f, -1.0f, -1.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f}, 0.5f},
-		{{m_pos.x - 1.0f, 1.0f, -1.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 1.0f}, 0.5f},
-		{{m_pos.x + 1.0f, 1.0f, -1.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 1.0f}, 0.5f},
-		{{m_pos.x + 1.0f, -1.0f, -1.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f}, 0.5f},
+		{{m_pos.x - 1.0f, -1.0f, -1.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f}, 0.5f, m_faceLayers[BACK]},
+		{{m_pos.x - 1.0f, 1.0f, -1.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 1.0f}, 0.5f, m_faceLayers[BACK]},
+		{{m_pos.x + 1.0f, 1.0f, -1.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 1.0f}, 0.5f, m_faceLayers[BACK]},
+		{{m_pos.x + 1.0f, -1.0f, -1.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f}, 0.5f, m_faceLayers[BACK]},
 
 		// Top face - Blue
-		{{m_pos.x + 1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 1.0f}, 0.5f},
-		{{m_pos.x + 1.0f, 1.0f, -1.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 0.0f}, 0.5f},
-		{{m_pos.x - 1.0f, 1.0f, -1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}, 0.5f},
-		{{m_pos.x - 1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f}, 0.5f},
+		{{m_pos.x + 1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 1.0f}, 0.5f, m_faceLayers[TOP]},
+		{{m_pos.x + 1.0f, 1.0f, -1.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 0.0f}, 0.5f, m_faceLayers[TOP]},
+		{{m_pos.x - 1.0f, 1.0f, -1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}, 0.5f, m_faceLayers[TOP]},
+		{{m_pos.x - 1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f}, 0.5f, m_faceLayers[TOP]},
 
 		// Bottom face - Yellow
-		{{m_pos.x - 1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 0.0f}, {1.0f, 0.0f}, 0.5f},
-		{{m_pos.x + 1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 0.0f}, {0.0f, 0.0f}, 0.5f},
-		{{m_pos.x + 1.0f, -1.0f, 1.0f}, {1.0f, 1.0f, 0.0f}, {0.0f, 1.0f}, 0.5f},
-		{{m_pos.x - 1.0f, -1.0f, 1.0f}, {1.0f, 1.0f, 0.0f}, {1.0f, 1.0f}, 0.5f},
+		{{m_pos.x - 1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 0.0f}, {1.0f, 0.0f}, 0.5f, m_faceLayers[BOTTOM]},
+		{{m_pos.x + 1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 0.0f}, {0.0f, 0.0f}, 0.5f, m_faceLayers[BOTTOM]},
+		{{m_pos.x + 1.0f, -1.0f, 1.0f}, {1.0f, 1.0f, 0.0f}, {0.0f, 1.0f}, 0.5f, m_faceLayers[BOTTOM]},
+		{{m_pos.x - 1.0f, -1.0f, 1.0f}, {1.0f, 1.0f, 0.0f}, {1.0f, 1.0f}, 0.5f, m_faceLayers[BOTTOM]},
 
 		// Right face - Magenta
-		{{m_pos.x + 1.0f, -1.0f, 1.0f}, {1.0f, 0.0f, 1.0f}, {0.0f, 1.0f}, 0.5f},
-		{{m_pos.x + 1.0f, -1.0f, -1.0f}, {1.0f, 0.0f, 1.0f}, {0.0f, 0.0f}, 0.5f},
-		{{m_pos.x + 1.0f, 1.0f, -1.0f}, {1.0f, 0.0f, 1.0f}, {1.0f, 0.0f}, 0.5f},
-		{{m_pos.x + 1.0f, 1.0f, 1.0f}, {1.0f, 0.0f, 1.0f}, {1.0f, 1.0f}, 0.5f},
+		{{m_pos.x + 1.0f, -1.0f, 1.0f}, {1.0f, 0.0f, 1.0f}, {0.0f, 1.0f}, 0.5f, m_faceLayers[RIGHT]},
+		{{m_pos.x + 1.0f, -1.0f, -1.0f}, {1.0f, 0.0f, 1.0f}, {0.0f, 0.0f}, 0.5f, m_faceLayers[RIGHT]},
+		{{m_pos.x + 1.0f, 1.0f, -1.0f}, {1.0f, 0.0f, 1.0f}, {1.0f, 0.0f}, 0.5f, m_faceLayers[RIGHT]},
+		{{m_pos.x + 1.0f, 1.0f, 1.0f}, {1.0f, 0.0f, 1.0f}, {1.0f, 1.0f}, 0.5f, m_faceLayers[RIGHT]},
 
 		// Left face - Cyan
-		{{m_pos.x - 1.0f, 1.0f, -1.0f}, {0.0f, 1.0f, 1.0f}, {0.0f, 0.0f}, 0.5f},
-		{{m_pos.x - 1.0f, -1.0f, -1.0f}, {0.0f, 1.0f, 1.0f}, {1.0f, 0.0f}, 0.5f},
-		{{m_pos.x - 1.0f, -1.0f, 1.0f}, {0.0f, 1.0f, 1.0f}, {1.0f, 1.0f}, 0.5f},
-		{{m_pos.x - 1.0f, 1.0f, 1.0f}, {0.0f, 1.0f, 1.0f}, {0.0f, 1.0f}, 0.5f},
+		{{m_pos.x - 1.0f, 1.0f, -1.0f}, {0.0f, 1.0f, 1.0f}, {0.0f, 0.0f}, 0.5f, m_faceLayers[LEFT]},
+		{{m_pos.x - 1.0f, -1.0f, -1.0f}, {0.0f, 1.0f, 1.0f}, {1.0f, 0.0f}, 0.5f, m_faceLayers[LEFT]},
+		{{m_pos.x - 1.0f, -1.0f, 1.0f}, {0.0f, 1.0f, 1.0f}, {1.0f, 1.0f}, 0.5f, m_faceLayers[LEFT]},
+		{{m_pos.x - 1.0f, 1.0f, 1.0f}, {0.0f, 1.0f, 1.0f}, {0.0f, 1.0f}, 0.5f, m_faceLayers[LEFT]},
 	};
 
 	m_indices = {
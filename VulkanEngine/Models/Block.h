@@ -4,6 +4,9 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 
+#include <array>
+#include <map>
+
 #include "../Utilities/Utilities.h"
 #include "../Graphics/Image.h"
 #include "../Graphics/Vertex.h"
@@ -13,7 +16,17 @@
 class Block
 {
 public:
-	Block(glm::vec3 pos, std::string texturePath) : m_pos(pos), m_pUtilities(Utilities::getInstance()) {};
+	// Face order used for per-face textures, matches the order faces are built in buildModel()
+	enum eFace { FRONT, BACK, TOP, BOTTOM, RIGHT, LEFT, FACE_COUNT };
+
+	Block(glm::vec3 pos, std::string texturePath) : m_pos(pos), m_pUtilities(Utilities::getInstance())
+	{
+		m_faceLayers.fill(registerTexture(texturePath));
+	};
+	Block(glm::vec3 pos, std::array<std::string, FACE_COUNT> faceTexturePaths) : m_pos(pos), m_pUtilities(Utilities::getInstance())
+	{
+		for (size_t i = 0; i < FACE_COUNT; i++) m_faceLayers[i] = registerTexture(faceTexturePaths[i]);
+	};
 
 	void buildModel();
 	void cleanup();
@@ -21,12 +34,20 @@ public:
 	std::vector<Vertex> getVertices() { return m_vertices; };
 	std::vector<uint32_t> getIndices() { return m_indices; };
 
+	// Returns the texture array layer for the given path, adding a new layer if it hasn't been seen before.
+	static uint32_t registerTexture(const std::string& texturePath);
+	// Paths of every registered block texture, ordered by layer. Used to build the block texture array.
+	static std::vector<std::string> getTexturePaths() { return sm_texturePaths; };
+
 private:
 	Utilities* m_pUtilities = nullptr;
 
 	glm::vec3 m_pos;
+	std::array<uint32_t, FACE_COUNT> m_faceLayers = {};
 
 	std::vector<Vertex> m_vertices;
 	std::vector<uint32_t> m_indices;
-	Image* m_pTextureImage = nullptr;
+
+	static std::map<std::string, uint32_t> sm_textureLayers;
+	static std::vector<std::string> sm_texturePaths;
 };
\ No newline at end of file
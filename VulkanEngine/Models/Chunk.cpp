@@ -0,0 +1,134 @@
+#include "Chunk.h"
+
+
+// Face directions in Block::eFace order. Each face is spanned by two tangent axes with u x v = normal, so
+// corners (0,0), (1,0), (1,1), (0,1) wind counter-clockwise when seen from outside.
+// Keep in sync with the tables in shaders/face.vert.
+static const glm::ivec3 sc_faceNormals[Block::FACE_COUNT] = { {0, 0, 1}, {0, 0, -1}, {0, 1, 0}, {0, -1, 0}, {1, 0, 0}, {-1, 0, 0} };
+static const glm::ivec3 sc_faceU[Block::FACE_COUNT] = { {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1} };
+static const glm::ivec3 sc_faceV[Block::FACE_COUNT] = { {0, 1, 0}, {1, 0, 0}, {1, 0, 0}, {0, 0, 1}, {0, 0, 1}, {0, 1, 0} };
+static const glm::ivec2 sc_quadCorners[4] = { {0, 0}, {1, 0}, {1, 1}, {0, 1} };
+
+
+void Chunk::setBlock(int x, int y, int z, uint16_t blockID)
+{
+	if (x < 0 || y < 0 || z < 0 || x >= SIZE || y >= SIZE || z >= SIZE)
+	{
+		throw std::out_of_range(std::format("Block position ({}, {}, {}) is outside the chunk!", x, y, z));
+	}
+
+	m_blocks[(z * SIZE + y) * SIZE + x] = blockID;
+}
+
+uint16_t Chunk::getBlock(int x, int y, int z)
+{
+	// Neighbouring chunks aren't known here, so their blocks count as air
+	if (x < 0 || y < 0 || z < 0 || x >= SIZE || y >= SIZE || z >= SIZE) return AIR;
+
+	return m_blocks[(z * SIZE + y) * SIZE + x];
+}
+
+uint32_t Chunk::calculateAmbientOcclusion(glm::ivec3 pos, int face)
+{
+	glm::ivec3 layer = pos + sc_faceNormals[face];
+	uint32_t packedAO = 0;
+
+	for (uint32_t corner = 0; corner < 4; corner++)
+	{
+		glm::ivec3 sideU = sc_faceU[face] * (sc_quadCorners[corner].x ? 1 : -1);
+		glm::ivec3 sideV = sc_faceV[face] * (sc_quadCorners[corner].y ? 1 : -1);
+
+		int side1 = isSolid(layer + sideU);
+		int side2 = isSolid(layer + sideV);
+		int diagonal = isSolid(layer + sideU + sideV);
+
+		uint32_t ao = (side1 && side2) ? 0 : 3 - (side1 + side2 + diagonal);
+		packedAO |= ao << (corner * 2);
+	}
+
+	return packedAO;
+}
+
+
+
+void Chunk::buildFaceInstances()
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	m_faceInstances.clear();
+
+	for (int z = 0; z < SIZE; z++)
+		for (int y = 0; y < SIZE; y++)
+			for (int x = 0; x < SIZE; x++)
+			{
+				uint16_t blockID = getBlock(x, y, z);
+				if (blockID == AIR) continue;
+
+				glm::ivec3 pos = { x, y, z };
+				for (int face = 0; face < Block::FACE_COUNT; face++)
+				{
+					if (isSolid(pos + sc_faceNormals[face])) continue;
+
+					m_faceInstances.push_back(FaceInstance::pack(x, y, z, face, blockID - 1, calculateAmbientOcclusion(pos, face)));
+				}
+			}
+
+	m_faceBuildTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void Chunk::buildVertices()
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	m_vertices.clear();
+	m_indices.clear();
+
+	glm::vec3 origin = getOrigin();
+
+	for (int z = 0; z < SIZE; z++)
+		for (int y = 0; y < SIZE; y++)
+			for (int x = 0; x < SIZE; x++)
+			{
+				uint16_t blockID = getBlock(x, y, z);
+				if (blockID == AIR) continue;
+
+				glm::ivec3 pos = { x, y, z };
+				for (int face = 0; face < Block::FACE_COUNT; face++)
+				{
+					if (isSolid(pos + sc_faceNormals[face])) continue;
+
+					uint32_t packedAO = calculateAmbientOcclusion(pos, face);
+					glm::ivec3 faceBase = pos + glm::max(sc_faceNormals[face], glm::ivec3(0));
+					uint32_t firstVertex = static_cast<uint32_t>(m_vertices.size());
+
+					for (uint32_t corner = 0; corner < 4; corner++)
+					{
+						glm::ivec3 cornerPos = faceBase + sc_faceU[face] * sc_quadCorners[corner].x + sc_faceV[face] * sc_quadCorners[corner].y;
+						float shade = 0.4f + 0.2f * ((packedAO >> (corner * 2)) & 0x3);
+
+						m_vertices.push_back(Vertex{
+							.pos = origin + glm::vec3(cornerPos),
+							.color = glm::vec3(shade),
+							.texCoord = glm::vec2(sc_quadCorners[corner]),
+							.colorBlendTex = 0.5f,
+							.texLayer = static_cast<uint32_t>(blockID - 1)
+						});
+					}
+
+					for (uint32_t index : { 0u, 1u, 2u, 2u, 3u, 0u }) m_indices.push_back(firstVertex + index);
+				}
+			}
+
+	m_vertexBuildTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void Chunk::printMeshStats()
+{
+	size_t faceBytes = m_faceInstances.size() * sizeof(FaceInstance);
+	size_t vertexBytes = m_vertices.size() * sizeof(Vertex) + m_indices.size() * sizeof(uint32_t);
+
+	mDebugPrint(std::format("Chunk ({}, {}, {}) mesh stats:", m_chunkPos.x, m_chunkPos.y, m_chunkPos.z));
+	mDebugPrint(std::format("Face instances: {} faces, {} bytes, built in {:.3f} ms", m_faceInstances.size(), faceBytes, m_faceBuildTime * 1000.0));
+	mDebugPrint(std::format("Vertex mesh: {} vertices + {} indices, {} bytes, built in {:.3f} ms", m_vertices.size(), m_indices.size(), vertexBytes, m_vertexBuildTime * 1000.0));
+	if (faceBytes > 0) mDebugPrint(std::format("Face instances use {:.1f}x less memory", static_cast<double>(vertexBytes) / faceBytes));
+}
\ No newline at end of file
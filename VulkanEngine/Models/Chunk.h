@@ -0,0 +1,62 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "../Utilities/Utilities.h"
+#include "../Graphics/Vertex.h"
+#include "../Graphics/FaceInstance.h"
+#include "Block.h"
+
+
+
+// A cubic section of the block world. Blocks are stored as IDs where 0 is air and any other ID is
+// (texture array layer + 1). The chunk can be meshed either into compact FaceInstance records for the
+// face-instanced renderer or into the conventional Vertex/index mesh used by Block::buildModel, so
+// both paths can be compared on the same data.
+class Chunk
+{
+public:
+	static constexpr int SIZE = 32; // Blocks per axis, FaceInstance packs 5 bits per coordinate.
+	static constexpr uint16_t AIR = 0;
+
+	Chunk(glm::ivec3 chunkPos) : m_chunkPos(chunkPos), m_blocks(SIZE * SIZE * SIZE, AIR), m_pUtilities(Utilities::getInstance()) {};
+
+	void setBlock(int x, int y, int z, uint16_t blockID);
+	// Returns AIR for positions outside the chunk.
+	uint16_t getBlock(int x, int y, int z);
+	static uint16_t blockIDFromTextureLayer(uint32_t textureLayer) { return static_cast<uint16_t>(textureLayer + 1); };
+
+	// Builds one FaceInstance for every face that borders air.
+	void buildFaceInstances();
+	// Builds the equivalent 4 vertices and 6 indices per visible face, for comparison with the face-instanced path.
+	void buildVertices();
+	// Prints the memory used by each mesh representation and how long each took to build.
+	void printMeshStats();
+
+	glm::vec3 getOrigin() { return glm::vec3(m_chunkPos * SIZE); };
+	std::vector<FaceInstance> getFaceInstances() { return m_faceInstances; };
+	std::vector<Vertex> getVertices() { return m_vertices; };
+	std::vector<uint32_t> getIndices() { return m_indices; };
+
+private:
+	Utilities* m_pUtilities = nullptr;
+
+	glm::ivec3 m_chunkPos;
+	std::vector<uint16_t> m_blocks;
+
+	std::vector<FaceInstance> m_faceInstances = {};
+	std::vector<Vertex> m_vertices = {};
+	std::vector<uint32_t> m_indices = {};
+
+	double m_faceBuildTime = 0.0;
+	double m_vertexBuildTime = 0.0;
+
+
+	bool isSolid(glm::ivec3 pos) { return getBlock(pos.x, pos.y, pos.z) != AIR; };
+	// Ambient occlusion level (0 = fully occluded, 3 = open) for each corner of a face, packed 2 bits per corner.
+	uint32_t calculateAmbientOcclusion(glm::ivec3 pos, int face);
+};
\ No newline at end of file
@@ -10,7 +10,7 @@
 
 void Model::createModel() {
 	mDebugPrint("Loading OBJ model from path: " + m_modelPath);
-	m_pTextureImage = new Image(m_texturePath);
+	createTexture();
 
 	tinyobj::attrib_t attrib;
 	std::vector<tinyobj::shape_t> shapes;
@@ -50,7 +50,23 @@ void Model::createModel() {
 	}
 }
 
+void Model::createTexture() {
+	m_pTextureImage = new Image(m_texturePath);
+
+	TextureRegistry* pTextureRegistry = VulkanEngine::getInstance()->getTextureRegistry();
+	if (pTextureRegistry != nullptr) m_textureSlot = pTextureRegistry->allocateSlot(m_pTextureImage);
+}
+
 void Model::cleanup() {
-	m_pTextureImage->cleanup();
-	delete m_pTextureImage;
+	TextureRegistry* pTextureRegistry = VulkanEngine::getInstance()->getTextureRegistry();
+	if (pTextureRegistry != nullptr) pTextureRegistry->freeSlot(m_textureSlot);
+	m_textureSlot = TextureRegistry::INVALID_SLOT;
+
+	// Frames in flight may still sample the image through the slot, so it goes once their fences have signalled
+	Image* pTextureImage = m_pTextureImage;
+	m_pTextureImage = nullptr;
+	VulkanEngine::getInstance()->m_pBufferManager->getDeletionQueue()->retire([pTextureImage] {
+		pTextureImage->cleanup();
+		delete pTextureImage;
+	});
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "../Utilities/Utilities.h"
 #include "../Graphics/Image.h"
+#include "../Graphics/TextureRegistry.h"
 #include "../Graphics/Vertex.h"
 
 class Model
@@ -13,10 +14,22 @@ public:
 	Model(std::string modelPath, std::string texturePath) : m_modelPath(modelPath), m_texturePath(texturePath), m_pUtilities(Utilities::getInstance()) {
 		createModel();
 	};
+	// Model from a mesh built in code rather than loaded from an OBJ file.
+	Model(std::vector<Vertex> vertices, std::vector<uint32_t> indices, std::string texturePath) : m_vertices(vertices), m_indices(indices), m_texturePath(texturePath), m_pUtilities(Utilities::getInstance()) {
+		createTexture();
+	};
 
 	void createModel();
+	// Uploads the texture and gives it a bindless slot. Records single-time commands, like Image::upload.
+	void createTexture();
 	void cleanup();
 
+	std::vector<Vertex> getVertices() { return m_vertices; };
+	std::vector<uint32_t> getIndices() { return m_indices; };
+
+	// Slot of this model's texture in the bindless texture array, INVALID_SLOT when bindless textures are disabled.
+	uint32_t getTextureSlot() { return m_textureSlot; };
+
 private:
 	Utilities* m_pUtilities = nullptr;
 	friend class VulkanEngine;
@@ -26,4 +39,5 @@ private:
 	std::string m_modelPath = "";
 	std::string m_texturePath = "";
 	Image* m_pTextureImage = nullptr;
+	uint32_t m_textureSlot = TextureRegistry::INVALID_SLOT;
 };
\ No newline at end of file
@@ -0,0 +1,316 @@
+#include "Belts.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+
+
+uint32_t BeltNetwork::createLine(uint32_t lengthTiles, uint16_t speed)
+{
+	if (lengthTiles == 0 || lengthTiles > MAX_LINE_TILES) throw std::runtime_error("belt line length out of range!");
+
+	sBeltLine line{
+		.length = lengthTiles * TILE_LENGTH,
+		.speed = speed,
+		.firstSlot = static_cast<uint32_t>(m_items.size()),
+		.capacity = lengthTiles * TILE_LENGTH / ITEM_SPACING + 1
+	};
+	m_items.resize(m_items.size() + line.capacity);
+	m_lines.push_back(line);
+	m_islands.addNode();
+	return static_cast<uint32_t>(m_lines.size() - 1);
+}
+
+void BeltNetwork::connect(uint32_t from, uint32_t to)
+{
+	setOutput(from, to, INVALID);
+}
+
+void BeltNetwork::sideLoad(uint32_t from, uint32_t to, uint32_t distanceFromEnd)
+{
+	if (distanceFromEnd > m_lines[to].length) throw std::runtime_error("side-load position is past the start of the belt line!");
+
+	setOutput(from, to, distanceFromEnd);
+}
+
+void BeltNetwork::disconnect(uint32_t line)
+{
+	setOutput(line, INVALID, INVALID);
+}
+
+uint32_t BeltNetwork::createSplitter(uint32_t inputA, uint32_t inputB, uint32_t outputA, uint32_t outputB)
+{
+	// The splitter does the hand-off for its inputs
+	for (uint32_t input : { inputA, inputB })
+		if (input != INVALID) disconnect(input);
+
+	uint32_t first = (inputA != INVALID) ? inputA : inputB;
+	for (uint32_t line : { inputB, outputA, outputB })
+		if (line != INVALID && line != first) m_islands.link(first, line);
+
+	m_splitters.push_back({ .inputs = { inputA, inputB }, .outputs = { outputA, outputB } });
+	m_scheduleVersion = UINT64_MAX; // The schedule lists splitters too, and this one may not have changed the islands
+	return static_cast<uint32_t>(m_splitters.size() - 1);
+}
+
+
+
+bool BeltNetwork::insertItem(uint32_t line, uint16_t itemID)
+{
+	if (!pushBack(m_lines[line], itemID)) return false;
+
+	m_itemCount++;
+	return true;
+}
+
+bool BeltNetwork::insertItemAt(uint32_t line, uint16_t itemID, uint32_t distanceFromEnd)
+{
+	if (!insertAt(m_lines[line], itemID, distanceFromEnd)) return false;
+
+	m_itemCount++;
+	return true;
+}
+
+bool BeltNetwork::takeItem(uint32_t line, uint16_t& itemID)
+{
+	sBeltLine& beltLine = m_lines[line];
+	if (beltLine.count == 0 || getItem(beltLine, 0).gap != 0) return false;
+
+	itemID = popFront(beltLine);
+	m_itemCount--;
+	return true;
+}
+
+uint64_t BeltNetwork::hashState()
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&hash](uint32_t value) { hash = (hash ^ value) * 1099511628211ull; };
+
+	for (sBeltLine& line : m_lines)
+	{
+		mix(line.count);
+		for (uint32_t i = 0; i < line.count; i++)
+		{
+			mix(getItem(line, i).gap);
+			mix(getItem(line, i).itemID);
+		}
+	}
+	for (sSplitter& splitter : m_splitters) mix(splitter.nextOutput);
+	return hash;
+}
+
+
+
+void BeltNetwork::tick(ThreadPool* pThreadPool)
+{
+	if (m_scheduleVersion != m_islands.getVersion()) rebuildSchedule();
+
+	uint32_t islandCount = static_cast<uint32_t>(m_schedule.size());
+	if (pThreadPool != nullptr)
+	{
+		// Several small islands per task so scheduling overhead doesn't swamp the work
+		uint32_t grainSize = std::max(1u, islandCount / ((pThreadPool->getThreadCount() + 1) * 8));
+		pThreadPool->parallelFor(islandCount, grainSize, [this](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++) tickIsland(m_schedule[i]);
+		});
+	}
+	else
+	{
+		for (sIslandSchedule& island : m_schedule) tickIsland(island);
+	}
+
+	m_itemsMovedLastTick = 0;
+	for (sIslandSchedule& island : m_schedule) m_itemsMovedLastTick += island.itemsMoved;
+}
+
+void BeltNetwork::rebuildSchedule()
+{
+	const std::vector<IslandGraph::sIsland>& islands = m_islands.getIslands();
+
+	m_schedule.clear();
+	m_schedule.resize(islands.size());
+	std::unordered_map<uint32_t, uint32_t> scheduleIndices;
+	for (uint32_t i = 0; i < islands.size(); i++)
+	{
+		m_schedule[i].lines = islands[i].nodes;
+		scheduleIndices[islands[i].id] = i;
+	}
+
+	for (uint32_t splitter = 0; splitter < m_splitters.size(); splitter++)
+	{
+		uint32_t input = (m_splitters[splitter].inputs[0] != INVALID) ? m_splitters[splitter].inputs[0] : m_splitters[splitter].inputs[1];
+		m_schedule[scheduleIndices[m_islands.getIsland(input)]].splitters.push_back(splitter);
+	}
+
+	m_scheduleVersion = m_islands.getVersion();
+}
+
+void BeltNetwork::tickIsland(sIslandSchedule& island)
+{
+	island.itemsMoved = 0;
+
+	for (uint32_t splitterIndex : island.splitters)
+	{
+		sSplitter& splitter = m_splitters[splitterIndex];
+		for (uint32_t input : splitter.inputs)
+		{
+			if (input == INVALID) continue;
+
+			// Try the preferred output first, then the other one
+			for (uint32_t attempt = 0; attempt < 2; attempt++)
+			{
+				uint32_t output = splitter.outputs[splitter.nextOutput];
+				if (output != INVALID && handOff(m_lines[input], output, INVALID))
+				{
+					splitter.nextOutput ^= 1;
+					break;
+				}
+				if (splitter.outputs[splitter.nextOutput ^ 1] == INVALID) break;
+				splitter.nextOutput ^= 1;
+			}
+		}
+	}
+
+	for (uint32_t lineIndex : island.lines)
+	{
+		sBeltLine& line = m_lines[lineIndex];
+		if (line.outputLine != INVALID) handOff(line, line.outputLine, line.outputDistance);
+		moveLine(line, island.itemsMoved);
+	}
+}
+
+void BeltNetwork::moveLine(sBeltLine& line, uint64_t& itemsMoved)
+{
+	bool frontMoving = line.count > 0 && getItem(line, 0).gap > 0;
+	if (line.activeIndex >= line.count && !frontMoving) return; // Fully compressed or empty
+
+	itemsMoved += frontMoving ? line.count : line.count - line.activeIndex;
+
+	// Shrinking the active item's gap moves it and everything behind it. If it closes up, the rest of the
+	// movement carries on into the gap behind it. The front item goes first, then the movement skips straight
+	// past the compressed items behind it rather than walking them.
+	uint32_t remaining = line.speed;
+	if (frontMoving && line.activeIndex > 0)
+	{
+		sBeltItem& front = getItem(line, 0);
+		if (front.gap > remaining)
+		{
+			front.gap -= static_cast<uint16_t>(remaining);
+			line.usedLength -= remaining;
+			return;
+		}
+
+		remaining -= front.gap;
+		line.usedLength -= front.gap;
+		front.gap = 0;
+	}
+	while (remaining > 0 && line.activeIndex < line.count)
+	{
+		sBeltItem& item = getItem(line, line.activeIndex);
+		if (item.gap > remaining)
+		{
+			item.gap -= static_cast<uint16_t>(remaining);
+			line.usedLength -= remaining;
+			return;
+		}
+
+		remaining -= item.gap;
+		line.usedLength -= item.gap;
+		item.gap = 0;
+		line.activeIndex++;
+	}
+}
+
+
+
+bool BeltNetwork::pushBack(sBeltLine& line, uint16_t itemID)
+{
+	uint32_t gap = line.length;
+	if (line.count > 0)
+	{
+		uint32_t freeLength = line.length - line.usedLength;
+		if (freeLength < ITEM_SPACING) return false;
+		gap = freeLength - ITEM_SPACING;
+	}
+
+	getItem(line, line.count) = { .gap = static_cast<uint16_t>(gap), .itemID = itemID };
+	line.count++;
+	line.usedLength = line.length;
+	if (line.activeIndex == line.count - 1 && gap == 0) line.activeIndex++;
+	return true;
+}
+
+bool BeltNetwork::insertAt(sBeltLine& line, uint16_t itemID, uint32_t distanceFromEnd)
+{
+	if (distanceFromEnd > line.length || line.count == line.capacity) return false;
+
+	// Find the first item behind the insertion point, checking there is room on both sides
+	uint32_t index = 0;
+	uint32_t distance = 0; // Of the item at `index`
+	uint32_t previousDistance = 0; // Of the item in front of `index`
+	for (; index < line.count; index++)
+	{
+		distance += (index == 0 ? 0 : ITEM_SPACING) + getItem(line, index).gap;
+		if (distance >= distanceFromEnd) break;
+		previousDistance = distance;
+	}
+
+	if (index > 0 && distanceFromEnd - previousDistance < ITEM_SPACING) return false;
+	if (index < line.count && distance - distanceFromEnd < ITEM_SPACING) return false;
+
+	uint32_t gap = (index == 0) ? distanceFromEnd : distanceFromEnd - previousDistance - ITEM_SPACING;
+	if (index < line.count) getItem(line, index).gap = static_cast<uint16_t>(distance - distanceFromEnd - ITEM_SPACING);
+	else line.usedLength = distanceFromEnd;
+
+	// Shift everything behind the insertion point back one slot
+	for (uint32_t i = line.count; i > index; i--) getItem(line, i) = getItem(line, i - 1);
+	getItem(line, index) = { .gap = static_cast<uint16_t>(gap), .itemID = itemID };
+	line.count++;
+
+	updateActiveIndex(line, std::min(line.activeIndex, index));
+	return true;
+}
+
+bool BeltNetwork::handOff(sBeltLine& line, uint32_t target, uint32_t targetDistance)
+{
+	if (line.count == 0 || getItem(line, 0).gap != 0) return false;
+
+	uint16_t itemID = getItem(line, 0).itemID;
+	bool accepted = (targetDistance == INVALID) ? pushBack(m_lines[target], itemID) : insertAt(m_lines[target], itemID, targetDistance);
+	if (!accepted) return false; // Back-pressure: the item waits at the end and the line compresses behind it
+
+	popFront(line);
+	return true;
+}
+
+uint16_t BeltNetwork::popFront(sBeltLine& line)
+{
+	uint16_t itemID = getItem(line, 0).itemID;
+
+	line.head = (line.head + 1 == line.capacity) ? 0 : line.head + 1;
+	line.count--;
+
+	// The new front item's gap now reaches all the way to the output end
+	if (line.count > 0) getItem(line, 0).gap += ITEM_SPACING;
+	else line.usedLength = 0;
+
+	// Everything that was compressed behind it still is, and moveLine closes the front gap first
+	if (line.activeIndex > 0) line.activeIndex--;
+	return itemID;
+}
+
+void BeltNetwork::updateActiveIndex(sBeltLine& line, uint32_t from)
+{
+	line.activeIndex = from;
+	while (line.activeIndex < line.count && getItem(line, line.activeIndex).gap == 0) line.activeIndex++;
+}
+
+void BeltNetwork::setOutput(uint32_t line, uint32_t target, uint32_t targetDistance)
+{
+	sBeltLine& beltLine = m_lines[line];
+	if (beltLine.outputLine != INVALID) m_islands.unlink(line, beltLine.outputLine);
+
+	beltLine.outputLine = target;
+	beltLine.outputDistance = targetDistance;
+	if (target != INVALID) m_islands.link(line, target);
+}
\ No newline at end of file
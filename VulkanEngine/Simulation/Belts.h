@@ -0,0 +1,145 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include "../Utilities/ThreadPool.h"
+#include "Islands.h"
+
+
+
+// Conveyor belt transport. Each belt line stores its items as a run of (gap, item) pairs ordered from the
+// output end backwards instead of absolute positions: moving the line only shrinks the gap in front of the
+// first item that can still move, so a tick is O(1) per line no matter how many items ride on it.
+// Distances are in fixed-point units of TILE_LENGTH per tile.
+// Lines joined by connections or splitters form islands that never touch each other within a tick, so
+// islands are ticked in parallel. Each island always runs in the same order, so the result doesn't depend
+// on the thread count.
+class BeltNetwork
+{
+public:
+	static constexpr uint32_t TILE_LENGTH = 256;
+	static constexpr uint32_t ITEM_SPACING = 64; // Minimum distance between two items, 4 per tile
+	static constexpr uint32_t MAX_LINE_TILES = 255; // Gaps are 16 bit
+	static constexpr uint32_t INVALID = UINT32_MAX;
+
+	// Creates a straight run of belt. Speed is in units per tick (8 = 1.875 tiles per second at 60 UPS).
+	uint32_t createLine(uint32_t lengthTiles, uint16_t speed);
+	// Items leaving `from` enter `to` at its start. Several lines may feed one line (merging).
+	void connect(uint32_t from, uint32_t to);
+	// Items leaving `from` are pushed onto the side of `to`, `distanceFromEnd` units before its output end.
+	void sideLoad(uint32_t from, uint32_t to, uint32_t distanceFromEnd);
+	// Removes the output connection of a line, items stop at its end.
+	void disconnect(uint32_t line);
+	// Alternates items from the inputs between the outputs, falling back to the other output when one is backed up.
+	// inputB and outputB may be INVALID.
+	uint32_t createSplitter(uint32_t inputA, uint32_t inputB, uint32_t outputA, uint32_t outputB);
+
+	// Places an item at the start of a line. Fails if the start is occupied.
+	bool insertItem(uint32_t line, uint16_t itemID);
+	// Places an item `distanceFromEnd` units before the line's output end. Fails if there isn't room.
+	bool insertItemAt(uint32_t line, uint16_t itemID, uint32_t distanceFromEnd);
+	// Removes the item waiting at the output end of a line, if there is one.
+	bool takeItem(uint32_t line, uint16_t& itemID);
+
+	// Ticks every island, spread over the pool's threads if one is given.
+	void tick(ThreadPool* pThreadPool = nullptr);
+
+	// Calls function(itemID, distanceFromEnd) for every item on a line, front to back. O(items), for rendering and debugging.
+	template<typename F>
+	void forEachItem(uint32_t line, F&& function)
+	{
+		sBeltLine& beltLine = m_lines[line];
+		uint32_t distance = 0;
+		for (uint32_t i = 0; i < beltLine.count; i++)
+		{
+			distance += (i == 0 ? 0 : ITEM_SPACING) + getItem(beltLine, i).gap;
+			function(getItem(beltLine, i).itemID, distance);
+		}
+	}
+
+	uint32_t getLineItemCount(uint32_t line) { return m_lines[line].count; }
+	uint64_t getItemCount() { return m_itemCount; }
+	// Items that moved during the last tick.
+	uint64_t getItemsMovedLastTick() { return m_itemsMovedLastTick; }
+	size_t getIslandCount() { return m_islands.getIslands().size(); }
+	// FNV-1a hash over every line's contents, for checking determinism.
+	uint64_t hashState();
+
+private:
+	struct sBeltItem
+	{
+		uint16_t gap = 0; // Free space in front of this item: to the output end for the first item, to the previous item otherwise
+		uint16_t itemID = 0;
+	};
+
+	struct sBeltLine
+	{
+		uint32_t length = 0;
+		uint16_t speed = 0;
+
+		// Items live in a fixed-size ring inside m_items, the front (output end) at `head`
+		uint32_t firstSlot = 0;
+		uint32_t capacity = 0;
+		uint32_t head = 0;
+		uint32_t count = 0;
+
+		uint32_t usedLength = 0; // Distance from the output end to the last item
+		// First item that can still move; everything in front of it is compressed, except that the front item opens a
+		// gap whenever one leaves the line
+		uint32_t activeIndex = 0;
+
+		uint32_t outputLine = INVALID;
+		uint32_t outputDistance = INVALID; // INVALID to enter at the start of outputLine, otherwise a side-load position
+	};
+
+	struct sSplitter
+	{
+		uint32_t inputs[2] = { INVALID, INVALID };
+		uint32_t outputs[2] = { INVALID, INVALID };
+		uint8_t nextOutput = 0;
+	};
+
+	std::vector<sBeltLine> m_lines = {};
+	std::vector<sBeltItem> m_items = {};
+	std::vector<sSplitter> m_splitters = {};
+
+	// Lines are the island nodes. Each island's splitters and lines, in the order they tick.
+	struct sIslandSchedule
+	{
+		std::vector<uint32_t> lines = {};
+		std::vector<uint32_t> splitters = {};
+		uint64_t itemsMoved = 0;
+	};
+
+	IslandGraph m_islands = {};
+	std::vector<sIslandSchedule> m_schedule = {};
+	uint64_t m_scheduleVersion = UINT64_MAX;
+
+	uint64_t m_itemCount = 0;
+	uint64_t m_itemsMovedLastTick = 0;
+
+
+	sBeltItem& getItem(sBeltLine& line, uint32_t index)
+	{
+		uint32_t slot = line.head + index;
+		if (slot >= line.capacity) slot -= line.capacity;
+		return m_items[line.firstSlot + slot];
+	}
+
+	// Item placement without touching the shared item count, safe to call from an island's tick.
+	bool pushBack(sBeltLine& line, uint16_t itemID);
+	bool insertAt(sBeltLine& line, uint16_t itemID, uint32_t distanceFromEnd);
+	// Removes the front item, which must be at the output end.
+	uint16_t popFront(sBeltLine& line);
+	// Hands the front item to another line if it has reached the output end and the target has room.
+	bool handOff(sBeltLine& line, uint32_t target, uint32_t targetDistance);
+	void moveLine(sBeltLine& line, uint64_t& itemsMoved);
+
+	void setOutput(uint32_t line, uint32_t target, uint32_t targetDistance);
+	void rebuildSchedule();
+	void tickIsland(sIslandSchedule& island);
+	// Skips the active index past any items that can't move.
+	void updateActiveIndex(sBeltLine& line, uint32_t from);
+};
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "ECS.h"
+
+
+
+std::vector<size_t> ComponentTypes::sm_sizes = {};
+
+uint32_t ComponentTypes::registerType(size_t size)
+{
+	if (sm_sizes.size() >= MAX_COMPONENTS) throw std::runtime_error("too many component types registered!");
+
+	sm_sizes.push_back(size);
+	return static_cast<uint32_t>(sm_sizes.size() - 1);
+}
+
+
+
+Archetype::Archetype(ComponentMask mask) : m_mask(mask)
+{
+	m_columnIndices.fill(-1);
+	for (uint32_t typeID = 0; typeID < ComponentTypes::MAX_COMPONENTS; typeID++)
+	{
+		if (!mask.test(typeID)) continue;
+
+		m_columnIndices[typeID] = static_cast<int32_t>(m_columns.size());
+		m_columns.push_back({ .typeID = typeID, .elementSize = ComponentTypes::getSize(typeID) });
+	}
+}
+
+uint32_t Archetype::addRow(Entity entity)
+{
+	for (sColumn& column : m_columns) column.data.resize(column.data.size() + column.elementSize);
+	m_entities.push_back(entity);
+	return static_cast<uint32_t>(m_entities.size() - 1);
+}
+
+Entity Archetype::removeRow(uint32_t row)
+{
+	uint32_t last = static_cast<uint32_t>(m_entities.size() - 1);
+	Entity moved = {};
+
+	if (row != last)
+	{
+		for (sColumn& column : m_columns)
+			std::memcpy(column.data.data() + row * column.elementSize, column.data.data() + last * column.elementSize, column.elementSize);
+		m_entities[row] = m_entities[last];
+		moved = m_entities[row];
+	}
+
+	for (sColumn& column : m_columns) column.data.resize(column.data.size() - column.elementSize);
+	m_entities.pop_back();
+	return moved;
+}
+
+uint64_t Archetype::hashState() const
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * 1099511628211ull; };
+
+	mix(m_mask.to_ullong());
+	for (const Entity& entity : m_entities)
+	{
+		mix(entity.index);
+		mix(entity.generation);
+	}
+	// Rows start zeroed, so padding bytes can only change the same way on every run of a build
+	for (const sColumn& column : m_columns)
+		for (std::byte value : column.data) mix(static_cast<uint64_t>(value));
+	return hash;
+}
+
+
+
+Entity World::allocateEntity()
+{
+	if (!m_freeIndices.empty())
+	{
+		uint32_t index = m_freeIndices.back();
+		m_freeIndices.pop_back();
+		return { .index = index, .generation = m_records[index].generation };
+	}
+
+	m_records.push_back({});
+	return { .index = static_cast<uint32_t>(m_records.size() - 1), .generation = 0 };
+}
+
+void World::destroyEntity(Entity entity)
+{
+	if (!isAlive(entity)) return;
+
+	sEntityRecord& record = m_records[entity.index];
+	Entity moved = m_archetypes[record.archetype].removeRow(record.row);
+	if (moved.index != UINT32_MAX) m_records[moved.index].row = record.row;
+
+	record.archetype = UINT32_MAX;
+	record.generation++;
+	m_freeIndices.push_back(entity.index);
+}
+
+uint64_t World::hashState() const
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * 1099511628211ull; };
+
+	for (const sEntityRecord& record : m_records)
+	{
+		mix(record.archetype);
+		mix(record.row);
+		mix(record.generation);
+	}
+	for (const Archetype& archetype : m_archetypes) mix(archetype.hashState());
+	return hash;
+}
+
+uint32_t World::getOrCreateArchetype(ComponentMask mask)
+{
+	auto it = m_archetypeLookup.find(mask.to_ullong());
+	if (it != m_archetypeLookup.end()) return it->second;
+
+	m_archetypes.emplace_back(mask);
+	uint32_t index = static_cast<uint32_t>(m_archetypes.size() - 1);
+	m_archetypeLookup[mask.to_ullong()] = index;
+	return index;
+}
+
+const std::vector<uint32_t>& World::getMatchingArchetypes(ComponentMask mask)
+{
+	sQueryCache& query = m_queryCache[mask.to_ullong()];
+	for (; query.archetypesChecked < m_archetypes.size(); query.archetypesChecked++)
+	{
+		if ((m_archetypes[query.archetypesChecked].getMask() & mask) == mask)
+			query.matches.push_back(static_cast<uint32_t>(query.archetypesChecked));
+	}
+	return query.matches;
+}
+
+void World::moveEntity(Entity entity, uint32_t targetArchetype)
+{
+	sEntityRecord& record = m_records[entity.index];
+	Archetype& source = m_archetypes[record.archetype];
+	Archetype& target = m_archetypes[targetArchetype];
+
+	uint32_t newRow = target.addRow(entity);
+	ComponentMask shared = source.getMask() & target.getMask();
+	for (uint32_t typeID = 0; typeID < ComponentTypes::MAX_COMPONENTS; typeID++)
+	{
+		if (shared.test(typeID))
+			std::memcpy(target.getElement(typeID, newRow), source.getElement(typeID, record.row), ComponentTypes::getSize(typeID));
+	}
+
+	Entity moved = source.removeRow(record.row);
+	if (moved.index != UINT32_MAX) m_records[moved.index].row = record.row;
+
+	record.archetype = targetArchetype;
+	record.row = newRow;
+}
\ No newline at end of file
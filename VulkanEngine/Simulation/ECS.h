@@ -0,0 +1,211 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <tuple>
+#include <stdexcept>
+
+
+
+// Archetype-based entity-component system for factory entities.
+// Every unique set of component types gets one Archetype table holding a tightly packed array per component
+// (structure of arrays), so a system that only needs two components streams through exactly those two arrays.
+// Components must be trivially copyable: rows are moved between tables with memcpy.
+
+struct Entity
+{
+	uint32_t index = UINT32_MAX;
+	uint32_t generation = 0; // Bumped whenever the index is recycled, so stale handles are detectable
+
+	bool operator==(const Entity& other) const = default;
+};
+
+using ComponentMask = std::bitset<64>;
+
+
+// Assigns every component type a small ID on first use and remembers its size.
+// IDs are handed out lazily, so register component types from one thread (the first createEntity/query does it).
+class ComponentTypes
+{
+public:
+	static constexpr uint32_t MAX_COMPONENTS = 64;
+
+	template<typename T>
+	static uint32_t getID()
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Components must be trivially copyable");
+		static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Component alignment exceeds column alignment");
+		static const uint32_t id = registerType(sizeof(T));
+		return id;
+	}
+
+	template<typename... Ts>
+	static ComponentMask getMask()
+	{
+		ComponentMask mask;
+		(mask.set(getID<Ts>()), ...);
+		return mask;
+	}
+
+	static size_t getSize(uint32_t id) { return sm_sizes[id]; }
+
+private:
+	static std::vector<size_t> sm_sizes;
+
+	static uint32_t registerType(size_t size);
+};
+
+
+// One table per unique component set. Rows are entities, columns are contiguous component arrays.
+class Archetype
+{
+public:
+	Archetype(ComponentMask mask);
+
+	ComponentMask getMask() const { return m_mask; }
+	size_t size() const { return m_entities.size(); }
+	const std::vector<Entity>& getEntities() const { return m_entities; }
+	bool hasColumn(uint32_t typeID) const { return m_columnIndices[typeID] >= 0; }
+
+	void* getColumn(uint32_t typeID) { return m_columns[m_columnIndices[typeID]].data.data(); }
+	template<typename T>
+	T* getColumn() { return reinterpret_cast<T*>(getColumn(ComponentTypes::getID<T>())); }
+	void* getElement(uint32_t typeID, uint32_t row) { return static_cast<std::byte*>(getColumn(typeID)) + row * m_columns[m_columnIndices[typeID]].elementSize; }
+
+	// Appends a zeroed row and returns its index.
+	uint32_t addRow(Entity entity);
+	// Removes a row by moving the last row into its place. Returns the entity that moved, or an invalid Entity if none did.
+	Entity removeRow(uint32_t row);
+	// FNV-1a hash over the entities and raw component bytes, for checking determinism.
+	uint64_t hashState() const;
+
+private:
+	struct sColumn
+	{
+		uint32_t typeID = 0;
+		size_t elementSize = 0;
+		std::vector<std::byte> data = {};
+	};
+
+	ComponentMask m_mask;
+	std::vector<Entity> m_entities = {};
+	std::vector<sColumn> m_columns = {};
+	std::array<int32_t, ComponentTypes::MAX_COMPONENTS> m_columnIndices = {};
+};
+
+
+// Owns every entity and archetype table. Not thread safe: structural changes (create, destroy, add, remove)
+// must not happen while a query is iterating.
+class World
+{
+public:
+	template<typename... Ts>
+	Entity createEntity(const Ts&... components)
+	{
+		Entity entity = allocateEntity();
+		uint32_t archetype = getOrCreateArchetype(ComponentTypes::getMask<Ts...>());
+		sEntityRecord& record = m_records[entity.index];
+		record.archetype = archetype;
+		record.row = m_archetypes[archetype].addRow(entity);
+		((*reinterpret_cast<Ts*>(m_archetypes[archetype].getElement(ComponentTypes::getID<Ts>(), record.row)) = components), ...);
+		return entity;
+	}
+
+	void destroyEntity(Entity entity);
+	bool isAlive(Entity entity) const { return entity.index < m_records.size() && m_records[entity.index].generation == entity.generation && m_records[entity.index].archetype != UINT32_MAX; }
+
+	template<typename T>
+	bool hasComponent(Entity entity)
+	{
+		return isAlive(entity) && m_archetypes[m_records[entity.index].archetype].hasColumn(ComponentTypes::getID<T>());
+	}
+
+	template<typename T>
+	T& getComponent(Entity entity)
+	{
+		if (!hasComponent<T>(entity)) throw std::runtime_error("entity does not have the requested component!");
+		const sEntityRecord& record = m_records[entity.index];
+		return *reinterpret_cast<T*>(m_archetypes[record.archetype].getElement(ComponentTypes::getID<T>(), record.row));
+	}
+
+	template<typename T>
+	void addComponent(Entity entity, const T& component)
+	{
+		if (!isAlive(entity)) throw std::runtime_error("tried to add a component to a dead entity!");
+		uint32_t typeID = ComponentTypes::getID<T>();
+		ComponentMask mask = m_archetypes[m_records[entity.index].archetype].getMask();
+		if (!mask.test(typeID)) moveEntity(entity, getOrCreateArchetype(mask.set(typeID)));
+		getComponent<T>(entity) = component;
+	}
+
+	template<typename T>
+	void removeComponent(Entity entity)
+	{
+		if (!hasComponent<T>(entity)) return;
+		ComponentMask mask = m_archetypes[m_records[entity.index].archetype].getMask();
+		moveEntity(entity, getOrCreateArchetype(mask.reset(ComponentTypes::getID<T>())));
+	}
+
+	// Calls function(Ts&...) for every entity that has all of Ts.
+	template<typename... Ts, typename F>
+	void each(F&& function)
+	{
+		for (uint32_t archetypeIndex : getMatchingArchetypes(ComponentTypes::getMask<Ts...>()))
+		{
+			Archetype& archetype = m_archetypes[archetypeIndex];
+			size_t count = archetype.size();
+			std::tuple<Ts*...> columns = { archetype.getColumn<Ts>()... };
+			for (size_t i = 0; i < count; i++) function(std::get<Ts*>(columns)[i]...);
+		}
+	}
+
+	// Calls function(count, Ts*...) once per matching archetype with the raw column arrays, for batched kernels.
+	template<typename... Ts, typename F>
+	void eachArchetype(F&& function)
+	{
+		for (uint32_t archetypeIndex : getMatchingArchetypes(ComponentTypes::getMask<Ts...>()))
+		{
+			Archetype& archetype = m_archetypes[archetypeIndex];
+			if (archetype.size() > 0) function(archetype.size(), archetype.getColumn<Ts>()...);
+		}
+	}
+
+	size_t getEntityCount() const { return m_records.size() - m_freeIndices.size(); }
+	size_t getArchetypeCount() const { return m_archetypes.size(); }
+	// FNV-1a hash over every entity record and archetype table, for checking determinism.
+	uint64_t hashState() const;
+
+private:
+	struct sEntityRecord
+	{
+		uint32_t archetype = UINT32_MAX; // UINT32_MAX while the index is on the free list
+		uint32_t row = 0;
+		uint32_t generation = 0;
+	};
+
+	// Archetypes are only ever appended, so a cached query just picks up the ones added since it last ran.
+	struct sQueryCache
+	{
+		size_t archetypesChecked = 0;
+		std::vector<uint32_t> matches = {};
+	};
+
+	std::vector<sEntityRecord> m_records = {};
+	std::vector<uint32_t> m_freeIndices = {};
+	std::vector<Archetype> m_archetypes = {};
+	std::unordered_map<unsigned long long, uint32_t> m_archetypeLookup = {};
+	std::unordered_map<unsigned long long, sQueryCache> m_queryCache = {};
+
+
+	Entity allocateEntity();
+	uint32_t getOrCreateArchetype(ComponentMask mask);
+	const std::vector<uint32_t>& getMatchingArchetypes(ComponentMask mask);
+	// Moves an entity's row to another archetype, carrying over every component both tables share.
+	void moveEntity(Entity entity, uint32_t targetArchetype);
+};
\ No newline at end of file
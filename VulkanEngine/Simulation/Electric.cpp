@@ -0,0 +1,368 @@
+#include "Electric.h"
+
+#include <algorithm>
+#include <bit>
+
+
+
+uint32_t ElectricNetwork::addPole()
+{
+	uint32_t pole = static_cast<uint32_t>(m_parent.size());
+	m_parent.push_back(pole);
+	m_rank.push_back(0);
+	m_poleAlive.push_back(true);
+	m_wires.emplace_back();
+	m_visitEpoch.push_back(0);
+	m_poleGenerators.emplace_back();
+	m_poleConsumers.emplace_back();
+	m_poleAccumulators.emplace_back();
+
+	// A new pole is a network of its own
+	uint32_t slot = allocateSlot();
+	m_slotPoles[slot].push_back(pole);
+	m_rootSlot.push_back(slot);
+	return pole;
+}
+
+void ElectricNetwork::removePole(uint32_t pole)
+{
+	if (!m_poleAlive[pole]) return;
+
+	while (!m_wires[pole].empty()) disconnect(pole, m_wires[pole].back());
+
+	// Now alone in its network, which goes with it
+	uint32_t slot = m_rootSlot[find(pole)];
+	m_poleAlive[pole] = false;
+	moveToSlot({ pole }, 0);
+	freeSlot(slot);
+}
+
+void ElectricNetwork::connect(uint32_t poleA, uint32_t poleB)
+{
+	if (poleA == poleB || !m_poleAlive[poleA] || !m_poleAlive[poleB]) throw std::runtime_error("tried to wire an invalid pole!");
+
+	m_wires[poleA].push_back(poleB);
+	m_wires[poleB].push_back(poleA);
+	uint32_t slotA = m_rootSlot[find(poleA)];
+	uint32_t slotB = m_rootSlot[find(poleB)];
+	if (slotA == slotB) return;
+
+	// The smaller network's entities move over to the larger one's slot
+	unite(poleA, poleB);
+	if (m_slotPoles[slotA].size() < m_slotPoles[slotB].size()) std::swap(slotA, slotB);
+	moveToSlot(m_slotPoles[slotB], slotA);
+	m_slotPoles[slotA].insert(m_slotPoles[slotA].end(), m_slotPoles[slotB].begin(), m_slotPoles[slotB].end());
+	freeSlot(slotB);
+	m_rootSlot[find(poleA)] = slotA;
+}
+
+void ElectricNetwork::disconnect(uint32_t poleA, uint32_t poleB)
+{
+	for (auto [from, to] : { std::pair(poleA, poleB), std::pair(poleB, poleA) })
+	{
+		std::vector<uint32_t>& wires = m_wires[from];
+		auto it = std::find(wires.begin(), wires.end(), to);
+		if (it == wires.end()) throw std::runtime_error("tried to disconnect poles that aren't wired!");
+		*it = wires.back();
+		wires.pop_back();
+	}
+
+	// Union-find can't split, so rebuild just the two halves of this network if the wire was a bridge
+	std::vector<uint32_t> sideA;
+	if (search(poleA, poleB, sideA)) return;
+
+	std::vector<uint32_t> sideB;
+	search(poleB, INVALID, sideB);
+	uint32_t slot = m_rootSlot[find(poleA)];
+	rebuildTree(sideA);
+	rebuildTree(sideB);
+
+	// The larger half keeps the slot, the smaller one's entities move to a new one
+	if (sideA.size() < sideB.size()) std::swap(sideA, sideB);
+	uint32_t newSlot = allocateSlot();
+	m_rootSlot[sideA.front()] = slot;
+	m_rootSlot[sideB.front()] = newSlot;
+	moveToSlot(sideB, newSlot);
+	m_slotPoles[slot] = std::move(sideA);
+	m_slotPoles[newSlot] = std::move(sideB);
+}
+
+
+
+uint32_t ElectricNetwork::addGenerator(uint32_t pole, float maxOutput)
+{
+	uint32_t row = allocateRow(m_generators.freeRows, m_generators.pole);
+	setRow(m_generators.pole, row, pole);
+	setRow(m_generators.network, row, getSlot(pole));
+	if (pole != INVALID) m_poleGenerators[pole].push_back(row);
+	setRow(m_generators.maxOutput, row, maxOutput);
+	setRow(m_generators.load, row, 0.0f);
+	return row;
+}
+
+uint32_t ElectricNetwork::addConsumer(uint32_t pole, float demand)
+{
+	uint32_t row = allocateRow(m_consumers.freeRows, m_consumers.pole);
+	setRow(m_consumers.pole, row, pole);
+	setRow(m_consumers.network, row, getSlot(pole));
+	if (pole != INVALID) m_poleConsumers[pole].push_back(row);
+	setRow(m_consumers.demand, row, demand);
+	setRow(m_consumers.satisfaction, row, 0.0f);
+	return row;
+}
+
+uint32_t ElectricNetwork::addAccumulator(uint32_t pole, float capacity, float maxPower)
+{
+	uint32_t row = allocateRow(m_accumulators.freeRows, m_accumulators.pole);
+	setRow(m_accumulators.pole, row, pole);
+	setRow(m_accumulators.network, row, getSlot(pole));
+	if (pole != INVALID) m_poleAccumulators[pole].push_back(row);
+	setRow(m_accumulators.capacity, row, capacity);
+	setRow(m_accumulators.maxPower, row, maxPower);
+	setRow(m_accumulators.energy, row, 0.0f);
+	setRow(m_accumulators.chargeRate, row, 0.0f);
+	setRow(m_accumulators.dischargeRate, row, 0.0f);
+	return row;
+}
+
+void ElectricNetwork::removeGenerator(uint32_t generator)
+{
+	if (m_generators.pole[generator] != INVALID) detachRow(m_poleGenerators[m_generators.pole[generator]], generator);
+	m_generators.pole[generator] = INVALID;
+	m_generators.network[generator] = 0;
+	m_generators.maxOutput[generator] = 0.0f;
+	m_generators.freeRows.push_back(generator);
+}
+
+void ElectricNetwork::removeConsumer(uint32_t consumer)
+{
+	if (m_consumers.pole[consumer] != INVALID) detachRow(m_poleConsumers[m_consumers.pole[consumer]], consumer);
+	m_consumers.pole[consumer] = INVALID;
+	m_consumers.network[consumer] = 0;
+	m_consumers.demand[consumer] = 0.0f;
+	m_consumers.freeRows.push_back(consumer);
+}
+
+void ElectricNetwork::removeAccumulator(uint32_t accumulator)
+{
+	if (m_accumulators.pole[accumulator] != INVALID) detachRow(m_poleAccumulators[m_accumulators.pole[accumulator]], accumulator);
+	m_accumulators.pole[accumulator] = INVALID;
+	m_accumulators.network[accumulator] = 0;
+	m_accumulators.capacity[accumulator] = 0.0f;
+	m_accumulators.maxPower[accumulator] = 0.0f;
+	m_accumulators.energy[accumulator] = 0.0f;
+	m_accumulators.freeRows.push_back(accumulator);
+}
+
+
+
+void ElectricNetwork::tick(float tickDelta)
+{
+	sNetworks& networks = m_networks;
+	size_t networkCount = networks.supply.size();
+	std::fill(networks.supply.begin(), networks.supply.end(), 0.0f);
+	std::fill(networks.demand.begin(), networks.demand.end(), 0.0f);
+	std::fill(networks.chargeCapacity.begin(), networks.chargeCapacity.end(), 0.0f);
+	std::fill(networks.dischargeCapacity.begin(), networks.dischargeCapacity.end(), 0.0f);
+
+	// Sum supply, demand and storage headroom per network
+	const uint32_t* generatorNetwork = m_generators.network.data();
+	const float* maxOutput = m_generators.maxOutput.data();
+	for (size_t i = 0; i < m_generators.network.size(); i++) networks.supply[generatorNetwork[i]] += maxOutput[i];
+
+	const uint32_t* consumerNetwork = m_consumers.network.data();
+	const float* demand = m_consumers.demand.data();
+	for (size_t i = 0; i < m_consumers.network.size(); i++) networks.demand[consumerNetwork[i]] += demand[i];
+
+	sAccumulators& accumulators = m_accumulators;
+	float inverseDelta = 1.0f / tickDelta;
+	for (size_t i = 0; i < accumulators.network.size(); i++)
+	{
+		accumulators.chargeRate[i] = std::min(accumulators.maxPower[i], (accumulators.capacity[i] - accumulators.energy[i]) * inverseDelta);
+		accumulators.dischargeRate[i] = std::min(accumulators.maxPower[i], accumulators.energy[i] * inverseDelta);
+		networks.chargeCapacity[accumulators.network[i]] += accumulators.chargeRate[i];
+		networks.dischargeCapacity[accumulators.network[i]] += accumulators.dischargeRate[i];
+	}
+
+	// Balance each network: surplus charges accumulators, a deficit drains them before consumers go short
+	for (size_t n = 1; n < networkCount; n++)
+	{
+		float surplus = networks.supply[n] - networks.demand[n];
+		if (surplus >= 0.0f)
+		{
+			networks.chargeFraction[n] = networks.chargeCapacity[n] > 0.0f ? std::min(1.0f, surplus / networks.chargeCapacity[n]) : 0.0f;
+			networks.dischargeFraction[n] = 0.0f;
+			networks.satisfaction[n] = 1.0f;
+			networks.load[n] = networks.supply[n] > 0.0f ? (networks.demand[n] + networks.chargeFraction[n] * networks.chargeCapacity[n]) / networks.supply[n] : 0.0f;
+		}
+		else
+		{
+			networks.chargeFraction[n] = 0.0f;
+			networks.dischargeFraction[n] = networks.dischargeCapacity[n] > 0.0f ? std::min(1.0f, -surplus / networks.dischargeCapacity[n]) : 0.0f;
+			networks.satisfaction[n] = (networks.supply[n] + networks.dischargeFraction[n] * networks.dischargeCapacity[n]) / networks.demand[n];
+			networks.load[n] = networks.supply[n] > 0.0f ? 1.0f : 0.0f;
+		}
+	}
+
+	// Write the results back out
+	for (size_t i = 0; i < accumulators.network.size(); i++)
+	{
+		uint32_t n = accumulators.network[i];
+		accumulators.energy[i] += (networks.chargeFraction[n] * accumulators.chargeRate[i] - networks.dischargeFraction[n] * accumulators.dischargeRate[i]) * tickDelta;
+	}
+
+	float* satisfaction = m_consumers.satisfaction.data();
+	for (size_t i = 0; i < m_consumers.network.size(); i++) satisfaction[i] = networks.satisfaction[consumerNetwork[i]];
+
+	float* load = m_generators.load.data();
+	for (size_t i = 0; i < m_generators.network.size(); i++) load[i] = networks.load[generatorNetwork[i]];
+}
+
+ElectricNetwork::sNetworkStats ElectricNetwork::getNetworkStats(uint32_t pole)
+{
+	uint32_t slot = getSlot(pole);
+	if (slot == 0 || slot >= m_networks.supply.size()) return {};
+
+	return sNetworkStats{
+		.supply = m_networks.supply[slot],
+		.demand = m_networks.demand[slot],
+		.satisfaction = m_networks.satisfaction[slot],
+		.load = m_networks.load[slot]
+	};
+}
+
+uint64_t ElectricNetwork::hashState()
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&hash](uint32_t value) { hash = (hash ^ value) * 1099511628211ull; };
+
+	// The wiring decides the networks, so the union-find trees themselves are left out
+	for (uint32_t pole = 0; pole < m_wires.size(); pole++)
+	{
+		mix(m_poleAlive[pole]);
+		mix(static_cast<uint32_t>(m_wires[pole].size()));
+		for (uint32_t neighbour : m_wires[pole]) mix(neighbour);
+	}
+	for (size_t row = 0; row < m_generators.pole.size(); row++)
+	{
+		mix(m_generators.pole[row]);
+		mix(std::bit_cast<uint32_t>(m_generators.maxOutput[row]));
+		mix(std::bit_cast<uint32_t>(m_generators.load[row]));
+	}
+	for (size_t row = 0; row < m_consumers.pole.size(); row++)
+	{
+		mix(m_consumers.pole[row]);
+		mix(std::bit_cast<uint32_t>(m_consumers.demand[row]));
+		mix(std::bit_cast<uint32_t>(m_consumers.satisfaction[row]));
+	}
+	for (size_t row = 0; row < m_accumulators.pole.size(); row++)
+	{
+		mix(m_accumulators.pole[row]);
+		mix(std::bit_cast<uint32_t>(m_accumulators.capacity[row]));
+		mix(std::bit_cast<uint32_t>(m_accumulators.energy[row]));
+	}
+	return hash;
+}
+
+
+
+uint32_t ElectricNetwork::find(uint32_t pole)
+{
+	// Path halving
+	while (m_parent[pole] != pole)
+	{
+		m_parent[pole] = m_parent[m_parent[pole]];
+		pole = m_parent[pole];
+	}
+	return pole;
+}
+
+void ElectricNetwork::unite(uint32_t poleA, uint32_t poleB)
+{
+	uint32_t rootA = find(poleA);
+	uint32_t rootB = find(poleB);
+	if (rootA == rootB) return;
+
+	if (m_rank[rootA] < m_rank[rootB]) std::swap(rootA, rootB);
+	m_parent[rootB] = rootA;
+	if (m_rank[rootA] == m_rank[rootB]) m_rank[rootA]++;
+}
+
+bool ElectricNetwork::search(uint32_t from, uint32_t to, std::vector<uint32_t>& visited)
+{
+	m_epoch++;
+	m_visitEpoch[from] = m_epoch;
+	visited.push_back(from);
+
+	for (size_t i = 0; i < visited.size(); i++)
+	{
+		for (uint32_t neighbour : m_wires[visited[i]])
+		{
+			if (neighbour == to) return true;
+			if (m_visitEpoch[neighbour] == m_epoch) continue;
+
+			m_visitEpoch[neighbour] = m_epoch;
+			visited.push_back(neighbour);
+		}
+	}
+	return false;
+}
+
+void ElectricNetwork::rebuildTree(const std::vector<uint32_t>& poles)
+{
+	uint32_t root = poles.front();
+	for (uint32_t pole : poles)
+	{
+		m_parent[pole] = root;
+		m_rank[pole] = 0;
+	}
+	m_rank[root] = poles.size() > 1 ? 1 : 0;
+}
+
+uint32_t ElectricNetwork::allocateSlot()
+{
+	if (!m_freeSlots.empty())
+	{
+		uint32_t slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+		return slot;
+	}
+
+	uint32_t slot = static_cast<uint32_t>(m_slotPoles.size());
+	m_slotPoles.emplace_back();
+	for (std::vector<float>* column : { &m_networks.supply, &m_networks.demand, &m_networks.chargeCapacity, &m_networks.dischargeCapacity,
+										&m_networks.satisfaction, &m_networks.load, &m_networks.chargeFraction, &m_networks.dischargeFraction })
+		column->push_back(0.0f);
+	return slot;
+}
+
+void ElectricNetwork::freeSlot(uint32_t slot)
+{
+	// Its totals are recalculated every tick, so they can be left as they are until the slot is reused
+	m_slotPoles[slot].clear();
+	m_freeSlots.push_back(slot);
+}
+
+void ElectricNetwork::moveToSlot(const std::vector<uint32_t>& poles, uint32_t slot)
+{
+	for (uint32_t pole : poles)
+	{
+		for (uint32_t row : m_poleGenerators[pole]) m_generators.network[row] = slot;
+		for (uint32_t row : m_poleConsumers[pole]) m_consumers.network[row] = slot;
+		for (uint32_t row : m_poleAccumulators[pole]) m_accumulators.network[row] = slot;
+	}
+}
+
+uint32_t ElectricNetwork::getSlot(uint32_t pole)
+{
+	if (pole == INVALID || !m_poleAlive[pole]) return 0;
+
+	return m_rootSlot[find(pole)];
+}
+
+void ElectricNetwork::detachRow(std::vector<uint32_t>& rows, uint32_t row)
+{
+	auto it = std::find(rows.begin(), rows.end(), row);
+	*it = rows.back();
+	rows.pop_back();
+}
\ No newline at end of file
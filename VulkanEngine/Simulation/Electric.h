@@ -0,0 +1,136 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+
+
+// Electric power simulation. Poles joined by wires form networks, tracked with union-find so connecting
+// is near O(1); cutting a wire re-splits only the network it belonged to. Generators, consumers and
+// accumulators hang off poles and live in flat arrays, so a tick is a few linear passes over those arrays
+// plus one pass over the networks, however often the wiring changes in between. Each network keeps a slot
+// in the per-network arrays. Joining or splitting networks only moves the smaller side's entities to another slot.
+class ElectricNetwork
+{
+public:
+	static constexpr uint32_t INVALID = UINT32_MAX;
+
+	struct sNetworkStats
+	{
+		float supply = 0.0f; // W the generators can provide
+		float demand = 0.0f; // W the consumers want
+		float satisfaction = 0.0f; // 0-1 of demand met
+		float load = 0.0f; // 0-1 of generator capacity used
+	};
+
+	uint32_t addPole();
+	// Disconnects every wire and detaches the pole. Pole IDs are not reused.
+	void removePole(uint32_t pole);
+	void connect(uint32_t poleA, uint32_t poleB);
+	void disconnect(uint32_t poleA, uint32_t poleB);
+	bool isConnected(uint32_t poleA, uint32_t poleB) { return m_poleAlive[poleA] && m_poleAlive[poleB] && find(poleA) == find(poleB); }
+
+	// Entity IDs are reused after removal. `pole` may be INVALID for an unpowered entity.
+	uint32_t addGenerator(uint32_t pole, float maxOutput);
+	uint32_t addConsumer(uint32_t pole, float demand);
+	uint32_t addAccumulator(uint32_t pole, float capacity, float maxPower);
+	void removeGenerator(uint32_t generator);
+	void removeConsumer(uint32_t consumer);
+	void removeAccumulator(uint32_t accumulator);
+
+	void setDemand(uint32_t consumer, float demand) { m_consumers.demand[consumer] = demand; }
+	float getSatisfaction(uint32_t consumer) { return m_consumers.satisfaction[consumer]; }
+	float getLoad(uint32_t generator) { return m_generators.load[generator]; }
+	float getStoredEnergy(uint32_t accumulator) { return m_accumulators.energy[accumulator]; }
+
+	void tick(float tickDelta);
+
+	// Stats from the last tick for the network a pole belongs to.
+	sNetworkStats getNetworkStats(uint32_t pole);
+	// Networks with at least one pole, as of the last tick.
+	uint32_t getNetworkCount() { return static_cast<uint32_t>(m_slotPoles.size() - m_freeSlots.size()) - 1; }
+	// FNV-1a hash over the wiring and every entity's settings and results, for checking determinism.
+	uint64_t hashState();
+
+private:
+	// Each entity type is a set of parallel arrays. Free rows are zeroed and left on the "no network" slot 0.
+	struct sGenerators
+	{
+		std::vector<uint32_t> pole, network;
+		std::vector<float> maxOutput, load;
+		std::vector<uint32_t> freeRows;
+	};
+
+	struct sConsumers
+	{
+		std::vector<uint32_t> pole, network;
+		std::vector<float> demand, satisfaction;
+		std::vector<uint32_t> freeRows;
+	};
+
+	struct sAccumulators
+	{
+		std::vector<uint32_t> pole, network;
+		std::vector<float> capacity, maxPower, energy;
+		std::vector<float> chargeRate, dischargeRate; // W this accumulator can take or give this tick
+		std::vector<uint32_t> freeRows;
+	};
+
+	// Per-network totals, indexed by network slot. Slot 0 collects everything not attached to a live pole.
+	struct sNetworks
+	{
+		std::vector<float> supply = { 0.0f }, demand = { 0.0f }, chargeCapacity = { 0.0f }, dischargeCapacity = { 0.0f };
+		std::vector<float> satisfaction = { 0.0f }, load = { 0.0f }, chargeFraction = { 0.0f }, dischargeFraction = { 0.0f };
+	};
+
+	// Poles
+	std::vector<uint32_t> m_parent = {};
+	std::vector<uint8_t> m_rank = {};
+	std::vector<bool> m_poleAlive = {};
+	std::vector<std::vector<uint32_t>> m_wires = {};
+	std::vector<uint32_t> m_rootSlot = {}; // Network slot of each root pole
+	std::vector<std::vector<uint32_t>> m_slotPoles = { {} }; // Poles in each network slot, empty for slot 0 and free slots
+	std::vector<uint32_t> m_freeSlots = {};
+	// Entity rows attached to each pole, so a network's entities can be moved to another slot without a full pass
+	std::vector<std::vector<uint32_t>> m_poleGenerators = {};
+	std::vector<std::vector<uint32_t>> m_poleConsumers = {};
+	std::vector<std::vector<uint32_t>> m_poleAccumulators = {};
+	std::vector<uint32_t> m_visitEpoch = {}; // Search marks, so a search never has to clear a per-pole array
+	uint32_t m_epoch = 0;
+
+	sGenerators m_generators = {};
+	sConsumers m_consumers = {};
+	sAccumulators m_accumulators = {};
+	sNetworks m_networks = {};
+
+
+	uint32_t find(uint32_t pole);
+	void unite(uint32_t poleA, uint32_t poleB);
+	// Collects every pole reachable from `from` over wires, stopping early if it reaches `to`. Returns whether it did.
+	bool search(uint32_t from, uint32_t to, std::vector<uint32_t>& visited);
+	// Makes the given poles one flat union-find tree rooted at the first.
+	void rebuildTree(const std::vector<uint32_t>& poles);
+
+	uint32_t allocateSlot();
+	void freeSlot(uint32_t slot);
+	// Points the entities on the given poles at a network slot.
+	void moveToSlot(const std::vector<uint32_t>& poles, uint32_t slot);
+	uint32_t getSlot(uint32_t pole);
+	static void detachRow(std::vector<uint32_t>& rows, uint32_t row);
+
+	template<typename T>
+	static uint32_t allocateRow(std::vector<uint32_t>& freeRows, std::vector<T>& firstColumn)
+	{
+		if (freeRows.empty()) return static_cast<uint32_t>(firstColumn.size());
+		uint32_t row = freeRows.back();
+		freeRows.pop_back();
+		return row;
+	}
+	template<typename T>
+	static void setRow(std::vector<T>& column, uint32_t row, T value)
+	{
+		if (row == column.size()) column.push_back(value);
+		else column[row] = value;
+	}
+};
\ No newline at end of file
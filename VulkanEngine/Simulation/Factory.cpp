@@ -0,0 +1,33 @@
+#include "Factory.h"
+
+
+
+void FactorySystems::updateCrafters(World& world, float tickDelta)
+{
+	world.eachArchetype<sCrafter, sPowerConsumer>([tickDelta](size_t count, sCrafter* crafters, sPowerConsumer* power)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			crafters[i].progress += crafters[i].speed * power[i].satisfaction * tickDelta;
+			if (crafters[i].progress >= 1.0f)
+			{
+				crafters[i].progress -= 1.0f;
+				crafters[i].craftsCompleted++;
+			}
+		}
+	});
+}
+
+void FactorySystems::updatePower(World& world, ElectricNetwork& electricity)
+{
+	world.eachArchetype<sPowerConsumer>([&electricity](size_t count, sPowerConsumer* power)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			if (power[i].electricConsumer == ElectricNetwork::INVALID) continue;
+
+			electricity.setDemand(power[i].electricConsumer, power[i].demand);
+			power[i].satisfaction = electricity.getSatisfaction(power[i].electricConsumer);
+		}
+	});
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "ECS.h"
+#include "Electric.h"
+
+
+
+// Components for factory entities. Keep them small and split by access pattern: a system should be able
+// to run over exactly the arrays it needs.
+
+struct sTransform
+{
+	glm::ivec3 position = {};
+	uint8_t rotation = 0; // Quarter turns
+};
+
+struct sCrafter
+{
+	float progress = 0.0f; // 0-1 through the current craft
+	float speed = 1.0f; // Crafts per second at full power
+	uint32_t craftsCompleted = 0;
+};
+
+struct sPowerConsumer
+{
+	float demand = 0.0f; // Watts
+	float satisfaction = 1.0f; // 0-1, set by the electric network
+	uint32_t electricConsumer = ElectricNetwork::INVALID; // Consumer ID in the ElectricNetwork, INVALID if not wired up
+};
+
+
+// Per-tick factory systems. Each one is a linear pass over the archetypes that match its components.
+class FactorySystems
+{
+public:
+	// Advances every crafter by its speed scaled by power satisfaction. Touches only sCrafter and sPowerConsumer.
+	static void updateCrafters(World& world, float tickDelta);
+	// Hands every wired consumer's demand to the electric network and takes back its satisfaction.
+	static void updatePower(World& world, ElectricNetwork& electricity);
+};
\ No newline at end of file
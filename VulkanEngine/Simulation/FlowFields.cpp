@@ -0,0 +1,351 @@
+#include "FlowFields.h"
+
+#include <cmath>
+#include <algorithm>
+#include <bit>
+
+
+
+// Orthogonal first, so ties prefer straight moves
+const std::array<glm::ivec2, 8> FlowFields::sm_offsets = { glm::ivec2(1, 0), glm::ivec2(-1, 0), glm::ivec2(0, 1), glm::ivec2(0, -1), glm::ivec2(1, 1), glm::ivec2(-1, 1), glm::ivec2(1, -1), glm::ivec2(-1, -1) };
+
+
+
+FlowFields::FlowFields(NavigationGrid* pGrid) : m_pGrid(pGrid)
+{
+	m_blocked.assign(m_pGrid->getBlockedData(), m_pGrid->getBlockedData() + static_cast<size_t>(m_pGrid->getWidth()) * m_pGrid->getHeight());
+	m_gridVersion = m_pGrid->getVersion();
+}
+
+uint32_t FlowFields::acquireField(glm::ivec2 min, glm::ivec2 max)
+{
+	if (min.x > max.x || min.y > max.y) throw std::runtime_error("tried to acquire a flow field with an empty target!");
+
+	for (uint32_t field = 0; field < m_fields.size(); field++)
+	{
+		sField& existing = m_fields[field];
+		if (existing.references > 0 && existing.min == min && existing.max == max)
+		{
+			existing.references++;
+			return field;
+		}
+	}
+
+	uint32_t field;
+	if (!m_freeFields.empty())
+	{
+		field = m_freeFields.back();
+		m_freeFields.pop_back();
+	}
+	else
+	{
+		field = static_cast<uint32_t>(m_fields.size());
+		m_fields.emplace_back();
+	}
+
+	m_fields[field].min = min;
+	m_fields[field].max = max;
+	m_fields[field].references = 1;
+	build(m_fields[field]);
+	return field;
+}
+
+void FlowFields::releaseField(uint32_t field)
+{
+	if (m_fields[field].references == 0 || --m_fields[field].references > 0) return;
+
+	m_fields[field] = {};
+	m_freeFields.push_back(field);
+}
+
+void FlowFields::update()
+{
+	if (m_gridVersion == m_pGrid->getVersion()) return;
+
+	// Find the individual tiles that changed in the chunks that did
+	std::vector<uint32_t> chunks;
+	m_pGrid->getChangedChunks(m_gridVersion, chunks);
+	m_gridVersion = m_pGrid->getVersion();
+
+	std::vector<uint32_t> changedTiles;
+	const uint8_t* pBlocked = m_pGrid->getBlockedData();
+	for (uint32_t chunk : chunks)
+	{
+		glm::ivec2 origin = m_pGrid->getChunkOrigin(chunk);
+		for (int32_t y = 0; y < NavigationGrid::CHUNK_SIZE; y++)
+		{
+			uint32_t index = m_pGrid->getTileIndex(origin + glm::ivec2(0, y));
+			for (int32_t x = 0; x < NavigationGrid::CHUNK_SIZE; x++, index++)
+			{
+				if (m_blocked[index] == pBlocked[index]) continue;
+				m_blocked[index] = pBlocked[index];
+				changedTiles.push_back(index);
+			}
+		}
+	}
+
+	m_repairedTiles = 0;
+	for (sField& field : m_fields)
+	{
+		if (field.references > 0) repair(field, changedTiles);
+	}
+}
+
+
+
+void FlowFields::build(sField& field)
+{
+	const int32_t width = m_pGrid->getWidth();
+	const int32_t height = m_pGrid->getHeight();
+	field.integration.assign(static_cast<size_t>(width) * height, UNREACHABLE);
+	field.directions.assign(static_cast<size_t>(width) * height, NO_DIRECTION);
+
+	// Breadth-first from every open target tile at once
+	m_queue.clear();
+	for (int32_t y = std::max(field.min.y, 0); y <= std::min(field.max.y, height - 1); y++)
+	{
+		for (int32_t x = std::max(field.min.x, 0); x <= std::min(field.max.x, width - 1); x++)
+		{
+			if (m_pGrid->isBlocked(glm::ivec2(x, y))) continue;
+			field.integration[m_pGrid->getTileIndex(glm::ivec2(x, y))] = 0;
+			m_queue.push_back(m_pGrid->getTileIndex(glm::ivec2(x, y)));
+		}
+	}
+
+	for (size_t head = 0; head < m_queue.size(); head++)
+	{
+		uint32_t index = m_queue[head];
+		glm::ivec2 tile(static_cast<int32_t>(index % width), static_cast<int32_t>(index / width));
+		for (uint32_t direction = 0; direction < 4; direction++)
+		{
+			glm::ivec2 next = tile + sm_offsets[direction];
+			if (m_pGrid->isBlocked(next)) continue;
+
+			uint32_t nextIndex = m_pGrid->getTileIndex(next);
+			if (field.integration[nextIndex] != UNREACHABLE) continue;
+			field.integration[nextIndex] = field.integration[index] + 1;
+			m_queue.push_back(nextIndex);
+		}
+	}
+
+	for (uint32_t index : m_queue) updateDirection(field, glm::ivec2(static_cast<int32_t>(index % width), static_cast<int32_t>(index / width)));
+}
+
+void FlowFields::repair(sField& field, const std::vector<uint32_t>& changedTiles)
+{
+	const int32_t width = m_pGrid->getWidth();
+	std::vector<uint32_t>& distance = field.integration;
+	auto tileOf = [width](uint32_t index) { return glm::ivec2(static_cast<int32_t>(index % width), static_cast<int32_t>(index / width)); };
+	auto greater = [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) { return a > b; };
+	auto open = [this, &greater](uint32_t index, uint32_t value) {
+		m_open.push_back({ value, index });
+		std::push_heap(m_open.begin(), m_open.end(), greater);
+	};
+
+	// Raise: a newly blocked tile invalidates every tile that was only reachable through it. A tile survives
+	// if another neighbour still sits one step closer to the target.
+	m_raised.clear();
+	m_changedDistances.clear();
+	for (uint32_t index : changedTiles)
+	{
+		m_changedDistances.push_back(index);
+		if (!m_blocked[index] || distance[index] == UNREACHABLE) continue;
+		m_raised.push_back({ index, distance[index] });
+		distance[index] = UNREACHABLE;
+	}
+	for (size_t head = 0; head < m_raised.size(); head++)
+	{
+		auto [index, previous] = m_raised[head];
+		glm::ivec2 tile = tileOf(index);
+		for (uint32_t direction = 0; direction < 4; direction++)
+		{
+			glm::ivec2 next = tile + sm_offsets[direction];
+			if (m_pGrid->isBlocked(next)) continue;
+
+			uint32_t nextIndex = m_pGrid->getTileIndex(next);
+			if (distance[nextIndex] == UNREACHABLE || distance[nextIndex] != previous + 1) continue;
+
+			bool supported = false;
+			for (uint32_t support = 0; support < 4 && !supported; support++)
+			{
+				glm::ivec2 neighbour = next + sm_offsets[support];
+				supported = !m_pGrid->isBlocked(neighbour) && distance[m_pGrid->getTileIndex(neighbour)] == distance[nextIndex] - 1;
+			}
+			if (supported) continue;
+
+			m_raised.push_back({ nextIndex, distance[nextIndex] });
+			distance[nextIndex] = UNREACHABLE;
+			m_changedDistances.push_back(nextIndex);
+		}
+	}
+
+	// Lower: flood back in from the valid tiles bordering the invalidated ones and the newly opened ones
+	m_open.clear();
+	auto seedAround = [&](uint32_t index) {
+		glm::ivec2 tile = tileOf(index);
+		for (uint32_t direction = 0; direction < 4; direction++)
+		{
+			glm::ivec2 next = tile + sm_offsets[direction];
+			if (!m_pGrid->isBlocked(next) && distance[m_pGrid->getTileIndex(next)] != UNREACHABLE) open(m_pGrid->getTileIndex(next), distance[m_pGrid->getTileIndex(next)]);
+		}
+	};
+	for (const auto& [index, previous] : m_raised) seedAround(index);
+	for (uint32_t index : changedTiles)
+	{
+		if (m_blocked[index]) continue;
+		if (isTarget(field, tileOf(index)))
+		{
+			distance[index] = 0;
+			open(index, 0);
+		}
+		else seedAround(index);
+	}
+
+	while (!m_open.empty())
+	{
+		std::pop_heap(m_open.begin(), m_open.end(), greater);
+		auto [value, index] = m_open.back();
+		m_open.pop_back();
+		if (value != distance[index]) continue;
+
+		glm::ivec2 tile = tileOf(index);
+		for (uint32_t direction = 0; direction < 4; direction++)
+		{
+			glm::ivec2 next = tile + sm_offsets[direction];
+			if (m_pGrid->isBlocked(next)) continue;
+
+			uint32_t nextIndex = m_pGrid->getTileIndex(next);
+			if (value + 1 >= distance[nextIndex]) continue;
+			distance[nextIndex] = value + 1;
+			open(nextIndex, value + 1);
+			m_changedDistances.push_back(nextIndex);
+		}
+	}
+
+	// Directions depend on the neighbours' distances, so refresh around every tile that changed
+	for (uint32_t index : m_changedDistances)
+	{
+		glm::ivec2 tile = tileOf(index);
+		updateDirection(field, tile);
+		for (const glm::ivec2& offset : sm_offsets)
+		{
+			if (m_pGrid->isInside(tile + offset)) updateDirection(field, tile + offset);
+		}
+	}
+	m_repairedTiles += m_changedDistances.size();
+}
+
+void FlowFields::updateDirection(sField& field, glm::ivec2 tile)
+{
+	uint32_t index = m_pGrid->getTileIndex(tile);
+	uint32_t best = field.integration[index];
+	uint8_t bestDirection = NO_DIRECTION;
+	if (best != UNREACHABLE && best != 0)
+	{
+		for (uint8_t direction = 0; direction < 8; direction++)
+		{
+			glm::ivec2 next = tile + sm_offsets[direction];
+			if (m_pGrid->isBlocked(next)) continue;
+			// No cutting corners past a blocked tile
+			if (direction >= 4 && (m_pGrid->isBlocked(glm::ivec2(next.x, tile.y)) || m_pGrid->isBlocked(glm::ivec2(tile.x, next.y)))) continue;
+
+			uint32_t value = field.integration[m_pGrid->getTileIndex(next)];
+			if (value < best)
+			{
+				best = value;
+				bestDirection = direction;
+			}
+		}
+	}
+	field.directions[index] = bestDirection;
+}
+
+
+
+uint32_t Crowd::addUnit(glm::vec2 position, glm::ivec2 targetMin, glm::ivec2 targetMax, float speed)
+{
+	uint32_t unit;
+	if (!m_freeIDs.empty())
+	{
+		unit = m_freeIDs.back();
+		m_freeIDs.pop_back();
+	}
+	else
+	{
+		unit = static_cast<uint32_t>(m_unitRows.size());
+		m_unitRows.push_back(INVALID);
+	}
+
+	m_unitRows[unit] = static_cast<uint32_t>(m_positions.size());
+	m_positions.push_back(position);
+	m_fields.push_back(m_pFields->acquireField(targetMin, targetMax));
+	m_speeds.push_back(speed);
+	m_rowUnits.push_back(unit);
+	return unit;
+}
+
+void Crowd::removeUnit(uint32_t unit)
+{
+	uint32_t row = m_unitRows[unit];
+	if (row == INVALID) return;
+
+	// Swap-remove the row and patch the unit that moved into it
+	m_pFields->releaseField(m_fields[row]);
+	auto swapRemove = [row](auto& column) {
+		column[row] = column.back();
+		column.pop_back();
+	};
+	swapRemove(m_positions);
+	swapRemove(m_fields);
+	swapRemove(m_speeds);
+	swapRemove(m_rowUnits);
+	if (row < m_rowUnits.size()) m_unitRows[m_rowUnits[row]] = row;
+
+	m_unitRows[unit] = INVALID;
+	m_freeIDs.push_back(unit);
+}
+
+void Crowd::tick(float tickDelta, ThreadPool* pThreadPool)
+{
+	uint32_t count = getUnitCount();
+	if (pThreadPool != nullptr)
+	{
+		pThreadPool->parallelFor(count, 1024, [this, tickDelta](uint32_t begin, uint32_t end) { tickRange(tickDelta, begin, end); });
+	}
+	else
+	{
+		tickRange(tickDelta, 0, count);
+	}
+}
+
+void Crowd::tickRange(float tickDelta, uint32_t begin, uint32_t end)
+{
+	for (uint32_t i = begin; i < end; i++)
+	{
+		// Head for the centre of the tile the field points at
+		glm::vec2& position = m_positions[i];
+		glm::ivec2 tile(static_cast<int32_t>(std::floor(position.x)), static_cast<int32_t>(std::floor(position.y)));
+		uint8_t direction = m_pFields->getDirection(m_fields[i], tile);
+		if (direction == FlowFields::NO_DIRECTION) continue;
+
+		glm::ivec2 nextTile = tile + FlowFields::getOffset(direction);
+		glm::vec2 target(nextTile.x + 0.5f, nextTile.y + 0.5f);
+		glm::vec2 toTarget = target - position;
+		float distance = glm::length(toTarget);
+		float step = m_speeds[i] * tickDelta;
+		position = (distance <= step) ? target : position + toTarget * (step / distance);
+	}
+}
+
+uint64_t Crowd::hashState()
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&hash](uint32_t value) { hash = (hash ^ value) * 1099511628211ull; };
+
+	for (const glm::vec2& position : m_positions)
+	{
+		mix(std::bit_cast<uint32_t>(position.x));
+		mix(std::bit_cast<uint32_t>(position.y));
+	}
+	return hash;
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include <glm/glm.hpp>
+
+#include "../Utilities/ThreadPool.h"
+#include "Navigation.h"
+
+
+
+// Flow fields over a NavigationGrid, one per target region and shared by every unit heading there. The
+// integration field holds each tile's walking distance to the target; the direction field points every tile
+// at its lowest neighbour, so a unit steers with a single lookup. Blocking or opening tiles repairs only the
+// distances that depended on them rather than rebuilding whole fields.
+class FlowFields
+{
+public:
+	static constexpr uint32_t INVALID = UINT32_MAX;
+	static constexpr uint32_t UNREACHABLE = UINT32_MAX;
+	static constexpr uint8_t NO_DIRECTION = 8; // At the target, or no way to it
+
+	FlowFields(NavigationGrid* pGrid);
+
+	// Returns the field leading to any open tile in [min, max], building it if no unit is using one already.
+	uint32_t acquireField(glm::ivec2 min, glm::ivec2 max);
+	// Frees the field once every acquire has been released.
+	void releaseField(uint32_t field);
+
+	// Catches up with changes to the grid. Must not run at the same time as any lookup.
+	void update();
+
+	uint32_t getDistance(uint32_t field, glm::ivec2 tile) { return m_pGrid->isInside(tile) ? m_fields[field].integration[m_pGrid->getTileIndex(tile)] : UNREACHABLE; }
+	uint8_t getDirection(uint32_t field, glm::ivec2 tile) { return m_pGrid->isInside(tile) ? m_fields[field].directions[m_pGrid->getTileIndex(tile)] : NO_DIRECTION; }
+	static glm::ivec2 getOffset(uint8_t direction) { return sm_offsets[direction]; }
+
+	size_t getFieldCount() { return m_fields.size() - m_freeFields.size(); }
+	// Tiles whose distance changed in the last update, over every field.
+	uint64_t getRepairedTileCount() { return m_repairedTiles; }
+
+private:
+	struct sField
+	{
+		glm::ivec2 min = {};
+		glm::ivec2 max = {};
+		uint32_t references = 0;
+		std::vector<uint32_t> integration = {}; // Row-major, UNREACHABLE for blocked tiles
+		std::vector<uint8_t> directions = {}; // Row-major, index into sm_offsets or NO_DIRECTION
+	};
+
+	NavigationGrid* m_pGrid = nullptr;
+	uint64_t m_gridVersion = 0;
+	std::vector<uint8_t> m_blocked = {}; // The grid as of the last update, to find which tiles changed
+
+	std::vector<sField> m_fields = {};
+	std::vector<uint32_t> m_freeFields = {};
+	uint64_t m_repairedTiles = 0;
+
+	// Scratch
+	std::vector<uint32_t> m_queue = {};
+	std::vector<std::pair<uint32_t, uint32_t>> m_raised = {}; // (tile, distance before it was invalidated)
+	std::vector<std::pair<uint32_t, uint32_t>> m_open = {}; // (distance, tile), a min-heap
+	std::vector<uint32_t> m_changedDistances = {};
+
+	static const std::array<glm::ivec2, 8> sm_offsets;
+
+
+	void build(sField& field);
+	void repair(sField& field, const std::vector<uint32_t>& changedTiles);
+	void updateDirection(sField& field, glm::ivec2 tile);
+	bool isTarget(const sField& field, glm::ivec2 tile) { return tile.x >= field.min.x && tile.y >= field.min.y && tile.x <= field.max.x && tile.y <= field.max.y; }
+};
+
+
+// Units steering along flow fields: each tick costs one direction lookup per unit, however many share a field.
+class Crowd
+{
+public:
+	static constexpr uint32_t INVALID = UINT32_MAX;
+
+	Crowd(FlowFields* pFields) : m_pFields(pFields) {};
+
+	// The unit holds a reference to the field until it is removed.
+	uint32_t addUnit(glm::vec2 position, glm::ivec2 targetMin, glm::ivec2 targetMax, float speed);
+	void removeUnit(uint32_t unit);
+
+	// Moves every unit along its field, spread over the pool's threads if one is given.
+	void tick(float tickDelta, ThreadPool* pThreadPool = nullptr);
+
+	glm::vec2 getPosition(uint32_t unit) { return m_positions[m_unitRows[unit]]; }
+	uint32_t getUnitCount() { return static_cast<uint32_t>(m_positions.size()); }
+	// FNV-1a hash over every unit's position, for checking determinism.
+	uint64_t hashState();
+
+private:
+	FlowFields* m_pFields = nullptr;
+
+	// Dense rows, swap-removed
+	std::vector<glm::vec2> m_positions = {};
+	std::vector<uint32_t> m_fields = {};
+	std::vector<float> m_speeds = {};
+	std::vector<uint32_t> m_rowUnits = {};
+
+	std::vector<uint32_t> m_unitRows = {}; // Indexed by unit ID
+	std::vector<uint32_t> m_freeIDs = {};
+
+
+	void tickRange(float tickDelta, uint32_t begin, uint32_t end);
+};
\ No newline at end of file
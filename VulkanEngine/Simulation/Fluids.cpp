@@ -0,0 +1,288 @@
+#include "Fluids.h"
+
+#include <algorithm>
+#include <cmath>
+#include <bit>
+
+
+
+uint32_t FluidNetwork::addSegment(float capacity)
+{
+	if (capacity <= 0.0f) throw std::runtime_error("fluid segment capacity must be positive!");
+
+	m_capacity.push_back(capacity);
+	m_amount.push_back(0.0f);
+	m_fluid.push_back(NO_FLUID);
+	m_pipes.emplace_back();
+	m_segmentSystem.push_back(INVALID);
+	m_segmentPumps.emplace_back();
+	m_segmentSources.emplace_back();
+	m_segmentConsumers.emplace_back();
+
+	uint32_t segment = m_islands.addNode();
+	m_dirtySegments.push_back(segment);
+	return segment;
+}
+
+void FluidNetwork::connect(uint32_t segmentA, uint32_t segmentB)
+{
+	m_pipes[segmentA].push_back(segmentB);
+	m_pipes[segmentB].push_back(segmentA);
+	m_islands.link(segmentA, segmentB);
+
+	// Even without a merge the adjacency arrays are stale
+	m_dirtySegments.push_back(segmentA);
+	m_dirtySegments.push_back(segmentB);
+}
+
+void FluidNetwork::disconnect(uint32_t segmentA, uint32_t segmentB)
+{
+	for (auto [from, to] : { std::pair(segmentA, segmentB), std::pair(segmentB, segmentA) })
+	{
+		std::vector<uint32_t>& pipes = m_pipes[from];
+		auto it = std::find(pipes.begin(), pipes.end(), to);
+		if (it == pipes.end()) throw std::runtime_error("tried to disconnect fluid segments that aren't connected!");
+		*it = pipes.back();
+		pipes.pop_back();
+	}
+	m_islands.unlink(segmentA, segmentB);
+
+	// Even without a split the adjacency arrays are stale
+	m_dirtySegments.push_back(segmentA);
+	m_dirtySegments.push_back(segmentB);
+}
+
+uint32_t FluidNetwork::addPump(uint32_t from, uint32_t to, float rate)
+{
+	uint32_t pump = static_cast<uint32_t>(m_pumps.size());
+	m_pumps.push_back({ .from = from, .to = to, .rate = rate });
+	m_segmentPumps[from].push_back(pump);
+	m_islands.link(from, to);
+	m_dirtySegments.push_back(from);
+	m_dirtySegments.push_back(to);
+	return pump;
+}
+
+uint32_t FluidNetwork::addSource(uint32_t segment, uint16_t fluid, float rate)
+{
+	if (fluid == NO_FLUID) throw std::runtime_error("fluid sources need a fluid!");
+
+	uint32_t source = static_cast<uint32_t>(m_sources.size());
+	m_sources.push_back({ .segment = segment, .fluid = fluid, .rate = rate });
+	m_segmentSources[segment].push_back(source);
+	m_dirtySegments.push_back(segment);
+	return source;
+}
+
+uint32_t FluidNetwork::addConsumer(uint32_t segment, float rate)
+{
+	uint32_t consumer = static_cast<uint32_t>(m_consumers.size());
+	m_consumers.push_back({ .segment = segment, .rate = rate });
+	m_segmentConsumers[segment].push_back(consumer);
+	m_dirtySegments.push_back(segment);
+	return consumer;
+}
+
+void FluidNetwork::setPumpRate(uint32_t pump, float rate)
+{
+	m_pumps[pump].rate = rate;
+	wakeSegment(m_pumps[pump].from);
+}
+
+void FluidNetwork::setSourceRate(uint32_t source, float rate)
+{
+	m_sources[source].rate = rate;
+	wakeSegment(m_sources[source].segment);
+}
+
+void FluidNetwork::setConsumerRate(uint32_t consumer, float rate)
+{
+	m_consumers[consumer].rate = rate;
+	wakeSegment(m_consumers[consumer].segment);
+}
+
+size_t FluidNetwork::getSystemCount()
+{
+	return std::count_if(m_systems.begin(), m_systems.end(), [](const sFluidSystem& system) { return !system.segments.empty(); });
+}
+
+uint64_t FluidNetwork::hashState()
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&hash](uint32_t value) { hash = (hash ^ value) * 1099511628211ull; };
+
+	for (size_t segment = 0; segment < m_amount.size(); segment++)
+	{
+		mix(std::bit_cast<uint32_t>(m_amount[segment]));
+		mix(m_fluid[segment]);
+	}
+	return hash;
+}
+
+
+
+void FluidNetwork::tick(ThreadPool* pThreadPool)
+{
+	if (!m_dirtySegments.empty()) rebuildDirtySystems();
+
+	// Systems share no segments, so they can run in any order or at the same time
+	uint32_t awakeCount = static_cast<uint32_t>(m_awakeSystems.size());
+	auto tickRange = [this](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++)
+		{
+			sFluidSystem& system = m_systems[m_awakeSystems[i]];
+			if (tickSystem(system)) system.settledTicks = 0;
+			else if (++system.settledTicks >= SLEEP_TICKS) system.asleep = true;
+		}
+	};
+
+	if (pThreadPool != nullptr) pThreadPool->parallelFor(awakeCount, std::max(1u, awakeCount / ((pThreadPool->getThreadCount() + 1) * 4)), tickRange);
+	else tickRange(0, awakeCount);
+
+	std::erase_if(m_awakeSystems, [this](uint32_t system) { return m_systems[system].asleep; });
+}
+
+bool FluidNetwork::tickSystem(sFluidSystem& system)
+{
+	float activity = 0.0f;
+
+	for (uint32_t sourceIndex : system.sources)
+	{
+		sEndpoint& source = m_sources[sourceIndex];
+		if (m_fluid[source.segment] != NO_FLUID && m_fluid[source.segment] != source.fluid) { source.satisfaction = 0.0f; continue; }
+
+		float added = std::min(source.rate, m_capacity[source.segment] - m_amount[source.segment]);
+		m_amount[source.segment] += added;
+		if (added > 0.0f) m_fluid[source.segment] = source.fluid;
+		source.satisfaction = source.rate > 0.0f ? added / source.rate : 1.0f;
+		activity = std::max(activity, added);
+	}
+
+	for (uint32_t consumerIndex : system.consumers)
+	{
+		sEndpoint& consumer = m_consumers[consumerIndex];
+		float taken = std::min(consumer.rate, m_amount[consumer.segment]);
+		m_amount[consumer.segment] -= taken;
+		if (m_amount[consumer.segment] <= 0.0f) m_fluid[consumer.segment] = NO_FLUID;
+		consumer.satisfaction = consumer.rate > 0.0f ? taken / consumer.rate : 1.0f;
+		activity = std::max(activity, taken);
+	}
+
+	for (uint32_t pumpIndex : system.pumps)
+	{
+		sPump& pump = m_pumps[pumpIndex];
+		activity = std::max(activity, transfer(pump.from, pump.to, std::min(pump.rate, m_capacity[pump.to] - m_amount[pump.to])));
+	}
+
+	// Relax levels across every connection, moving part of the way towards equal fill
+	for (size_t i = 0; i < system.segments.size(); i++)
+	{
+		uint32_t a = system.segments[i];
+		for (uint32_t e = system.edgeOffsets[i]; e < system.edgeOffsets[i + 1]; e++)
+		{
+			uint32_t b = system.edgeTargets[e];
+			float levelDifference = m_amount[a] / m_capacity[a] - m_amount[b] / m_capacity[b];
+			float equalisingFlow = levelDifference / (1.0f / m_capacity[a] + 1.0f / m_capacity[b]);
+			float flow = FLOW_RATE * equalisingFlow;
+			if (std::abs(flow) < SLEEP_THRESHOLD) continue; // Dead band, so tiny residual gradients don't keep a system awake forever
+
+			float moved = flow >= 0.0f ? transfer(a, b, flow) : transfer(b, a, -flow);
+			activity = std::max(activity, moved);
+		}
+	}
+
+	return activity >= SLEEP_THRESHOLD;
+}
+
+float FluidNetwork::transfer(uint32_t from, uint32_t to, float amount)
+{
+	if (amount <= 0.0f || m_fluid[from] == NO_FLUID) return 0.0f;
+	if (m_fluid[to] != NO_FLUID && m_fluid[to] != m_fluid[from]) return 0.0f; // Different fluids don't mix
+
+	amount = std::min(amount, m_amount[from]);
+	m_amount[from] -= amount;
+	m_amount[to] += amount;
+	m_fluid[to] = m_fluid[from];
+	if (m_amount[from] <= 0.0f) m_fluid[from] = NO_FLUID;
+	return amount;
+}
+
+
+
+void FluidNetwork::rebuildDirtySystems()
+{
+	// A system can only gain or lose segments through a link change at a dirty segment, so clearing the systems
+	// the dirty segments were in and rebuilding the islands they are in now covers every stale system
+	std::vector<uint32_t> oldSystems;
+	std::vector<uint32_t> newIslands;
+	for (uint32_t segment : m_dirtySegments)
+	{
+		if (m_segmentSystem[segment] != INVALID) oldSystems.push_back(m_segmentSystem[segment]);
+		newIslands.push_back(m_islands.getIsland(segment));
+	}
+	std::sort(newIslands.begin(), newIslands.end());
+	newIslands.erase(std::unique(newIslands.begin(), newIslands.end()), newIslands.end());
+
+	// A cleared system stays in the awake list until it settles, which an empty system does on its own
+	for (uint32_t systemIndex : oldSystems)
+	{
+		sFluidSystem& system = m_systems[systemIndex];
+		system.segments.clear();
+		system.edgeOffsets.assign(1, 0);
+		system.edgeTargets.clear();
+		system.pumps.clear();
+		system.sources.clear();
+		system.consumers.clear();
+	}
+	for (uint32_t island : newIslands) rebuildSystem(island);
+
+	m_dirtySegments.clear();
+}
+
+void FluidNetwork::rebuildSystem(uint32_t island)
+{
+	if (island >= m_systems.size()) m_systems.resize(island + 1);
+
+	sFluidSystem& system = m_systems[island];
+	system.segments = m_islands.getIslandNodes(island);
+	std::sort(system.segments.begin(), system.segments.end());
+	system.edgeOffsets.clear();
+	system.edgeOffsets.reserve(system.segments.size() + 1);
+	system.edgeTargets.clear();
+	system.pumps.clear();
+	system.sources.clear();
+	system.consumers.clear();
+	for (uint32_t segment : system.segments)
+	{
+		m_segmentSystem[segment] = island;
+		system.edgeOffsets.push_back(static_cast<uint32_t>(system.edgeTargets.size()));
+		for (uint32_t neighbour : m_pipes[segment])
+			if (neighbour > segment) system.edgeTargets.push_back(neighbour);
+
+		system.pumps.insert(system.pumps.end(), m_segmentPumps[segment].begin(), m_segmentPumps[segment].end());
+		system.sources.insert(system.sources.end(), m_segmentSources[segment].begin(), m_segmentSources[segment].end());
+		system.consumers.insert(system.consumers.end(), m_segmentConsumers[segment].begin(), m_segmentConsumers[segment].end());
+	}
+	system.edgeOffsets.push_back(static_cast<uint32_t>(system.edgeTargets.size()));
+
+	// Endpoints run in the order they were added, as before
+	std::sort(system.pumps.begin(), system.pumps.end());
+	std::sort(system.sources.begin(), system.sources.end());
+	std::sort(system.consumers.begin(), system.consumers.end());
+
+	wakeSegment(system.segments.front());
+}
+
+void FluidNetwork::wakeSegment(uint32_t segment)
+{
+	uint32_t systemIndex = m_segmentSystem[segment];
+	if (systemIndex == INVALID) return; // Built and woken next tick anyway
+
+	sFluidSystem& system = m_systems[systemIndex];
+	system.settledTicks = 0;
+	if (system.asleep)
+	{
+		system.asleep = false;
+		m_awakeSystems.push_back(systemIndex);
+	}
+}
\ No newline at end of file
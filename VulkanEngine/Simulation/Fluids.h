@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include "../Utilities/ThreadPool.h"
+#include "Islands.h"
+
+
+
+// Fluid transport. Pipes and tanks are segments with a capacity; connected segments form fluid systems.
+// Every tick each awake system runs sources, consumers and pumps, then relaxes fill levels across its pipe
+// connections, walking a compact adjacency array. A system that has settled goes to sleep and costs nothing
+// until one of its endpoints or its piping changes. Changing the piping only rebuilds and wakes the systems it touches.
+class FluidNetwork
+{
+public:
+	static constexpr uint32_t INVALID = UINT32_MAX;
+	static constexpr uint16_t NO_FLUID = 0;
+	static constexpr float PIPE_CAPACITY = 100.0f;
+	static constexpr float FLOW_RATE = 0.5f; // Fraction of the level difference equalised per tick across a connection
+	static constexpr float SLEEP_THRESHOLD = 0.01f; // Units per tick below which a system counts as settled
+	static constexpr uint32_t SLEEP_TICKS = 30; // Settled ticks before a system sleeps
+
+	uint32_t addSegment(float capacity = PIPE_CAPACITY);
+	void connect(uint32_t segmentA, uint32_t segmentB);
+	void disconnect(uint32_t segmentA, uint32_t segmentB);
+
+	// Moves up to `rate` units per tick from one segment to the other, regardless of fill level.
+	uint32_t addPump(uint32_t from, uint32_t to, float rate);
+	// Adds fluid to a segment at up to `rate` units per tick, e.g. an offshore pump.
+	uint32_t addSource(uint32_t segment, uint16_t fluid, float rate);
+	// Takes fluid from a segment at up to `rate` units per tick, e.g. a machine.
+	uint32_t addConsumer(uint32_t segment, float rate);
+	void setPumpRate(uint32_t pump, float rate);
+	void setSourceRate(uint32_t source, float rate);
+	void setConsumerRate(uint32_t consumer, float rate);
+	// 0-1 of the requested rate the consumer got last tick.
+	float getConsumerSatisfaction(uint32_t consumer) { return m_consumers[consumer].satisfaction; }
+
+	float getAmount(uint32_t segment) { return m_amount[segment]; }
+	uint16_t getFluid(uint32_t segment) { return m_fluid[segment]; }
+
+	// Ticks every awake system, spread over the pool's threads if one is given.
+	void tick(ThreadPool* pThreadPool = nullptr);
+
+	size_t getSystemCount();
+	size_t getAwakeSystemCount() { return m_awakeSystems.size(); }
+	// FNV-1a hash over every segment's contents, for checking determinism.
+	uint64_t hashState();
+
+private:
+	struct sPump
+	{
+		uint32_t from = INVALID;
+		uint32_t to = INVALID;
+		float rate = 0.0f;
+	};
+
+	struct sEndpoint
+	{
+		uint32_t segment = INVALID;
+		uint16_t fluid = NO_FLUID; // Sources only
+		float rate = 0.0f;
+		float satisfaction = 0.0f;
+	};
+
+	struct sFluidSystem
+	{
+		std::vector<uint32_t> segments = {}; // Ascending
+		// Pipe connections as compressed rows: segment i connects to edgeTargets[edgeOffsets[i]..edgeOffsets[i + 1]],
+		// each connection stored once, from the lower segment ID
+		std::vector<uint32_t> edgeOffsets = {};
+		std::vector<uint32_t> edgeTargets = {};
+		std::vector<uint32_t> pumps = {};
+		std::vector<uint32_t> sources = {};
+		std::vector<uint32_t> consumers = {};
+
+		bool asleep = true; // Awake systems are listed in m_awakeSystems
+		uint32_t settledTicks = 0;
+	};
+
+	// Segments
+	std::vector<float> m_capacity = {};
+	std::vector<float> m_amount = {};
+	std::vector<uint16_t> m_fluid = {};
+	std::vector<std::vector<uint32_t>> m_pipes = {};
+	std::vector<uint32_t> m_segmentSystem = {}; // As of the last rebuild
+	std::vector<std::vector<uint32_t>> m_segmentPumps = {}; // Pumps pulling from the segment
+	std::vector<std::vector<uint32_t>> m_segmentSources = {};
+	std::vector<std::vector<uint32_t>> m_segmentConsumers = {};
+
+	std::vector<sPump> m_pumps = {};
+	std::vector<sEndpoint> m_sources = {};
+	std::vector<sEndpoint> m_consumers = {};
+
+	IslandGraph m_islands = {};
+	std::vector<sFluidSystem> m_systems = {}; // Indexed by island ID, empty for unused IDs
+	std::vector<uint32_t> m_awakeSystems = {};
+	std::vector<uint32_t> m_dirtySegments = {}; // Segments whose piping or endpoints changed since the last tick
+
+
+	// Regroups the segments of every system a dirty segment was or now is in. The rebuilt systems start awake.
+	void rebuildDirtySystems();
+	void rebuildSystem(uint32_t island);
+	void wakeSegment(uint32_t segment);
+	// Returns whether anything moved enough to keep the system awake.
+	bool tickSystem(sFluidSystem& system);
+	// Moves up to `amount` units from one segment to another if the fluids are compatible. Returns what moved.
+	float transfer(uint32_t from, uint32_t to, float amount);
+};
\ No newline at end of file
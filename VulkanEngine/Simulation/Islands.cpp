@@ -0,0 +1,139 @@
+#include "Islands.h"
+
+#include <algorithm>
+
+
+
+uint32_t IslandGraph::addNode()
+{
+	uint32_t node = static_cast<uint32_t>(m_nodes.size());
+	uint32_t island = createIsland();
+
+	m_nodes.push_back({ .island = island });
+	m_islandMembers[island].push_back(node);
+	m_version++;
+	return node;
+}
+
+void IslandGraph::removeNode(uint32_t node)
+{
+	while (!m_nodes[node].neighbours.empty()) unlink(node, m_nodes[node].neighbours.back());
+
+	// The node is now alone on its island
+	uint32_t island = m_nodes[node].island;
+	m_islandMembers[island].clear();
+	m_freeIslands.push_back(island);
+	m_nodes[node].island = INVALID;
+	m_version++;
+}
+
+
+
+void IslandGraph::link(uint32_t a, uint32_t b)
+{
+	m_nodes[a].neighbours.push_back(b);
+	m_nodes[b].neighbours.push_back(a);
+
+	// Owners schedule over the links as well as the islands, so this counts as a change even without a merge
+	m_version++;
+
+	uint32_t islandA = m_nodes[a].island;
+	uint32_t islandB = m_nodes[b].island;
+	if (islandA == islandB) return;
+
+	// Merge the smaller island into the larger one
+	if (m_islandMembers[islandA].size() < m_islandMembers[islandB].size()) std::swap(islandA, islandB);
+	for (uint32_t node : m_islandMembers[islandB])
+	{
+		m_nodes[node].island = islandA;
+		m_islandMembers[islandA].push_back(node);
+	}
+	m_islandMembers[islandB].clear();
+	m_freeIslands.push_back(islandB);
+}
+
+void IslandGraph::unlink(uint32_t a, uint32_t b)
+{
+	removeLink(a, b);
+	removeLink(b, a);
+	m_version++;
+
+	std::vector<uint32_t> visited;
+	if (search(a, b, visited)) return;
+
+	// a's side is now its own island
+	uint32_t oldIsland = m_nodes[a].island;
+	uint32_t newIsland = createIsland();
+	for (uint32_t node : visited) m_nodes[node].island = newIsland;
+	m_islandMembers[newIsland] = std::move(visited);
+
+	std::vector<uint32_t>& oldMembers = m_islandMembers[oldIsland];
+	oldMembers.erase(std::remove_if(oldMembers.begin(), oldMembers.end(), [this, oldIsland](uint32_t node) { return m_nodes[node].island != oldIsland; }), oldMembers.end());
+}
+
+const std::vector<IslandGraph::sIsland>& IslandGraph::getIslands()
+{
+	if (m_islandsVersion == m_version) return m_islands;
+
+	m_islands.clear();
+	for (uint32_t island = 0; island < m_islandMembers.size(); island++)
+	{
+		if (m_islandMembers[island].empty()) continue;
+
+		sIsland& entry = m_islands.emplace_back(sIsland{ .id = island, .nodes = m_islandMembers[island] });
+		std::sort(entry.nodes.begin(), entry.nodes.end());
+	}
+	std::sort(m_islands.begin(), m_islands.end(), [](const sIsland& a, const sIsland& b) { return a.nodes.front() < b.nodes.front(); });
+
+	m_islandsVersion = m_version;
+	return m_islands;
+}
+
+
+
+uint32_t IslandGraph::createIsland()
+{
+	if (!m_freeIslands.empty())
+	{
+		uint32_t island = m_freeIslands.back();
+		m_freeIslands.pop_back();
+		return island;
+	}
+
+	m_islandMembers.emplace_back();
+	return static_cast<uint32_t>(m_islandMembers.size() - 1);
+}
+
+void IslandGraph::removeLink(uint32_t from, uint32_t to)
+{
+	std::vector<uint32_t>& neighbours = m_nodes[from].neighbours;
+	auto it = std::find(neighbours.begin(), neighbours.end(), to);
+	if (it == neighbours.end()) throw std::runtime_error("tried to unlink nodes that aren't linked!");
+
+	*it = neighbours.back();
+	neighbours.pop_back();
+}
+
+bool IslandGraph::search(uint32_t from, uint32_t to, std::vector<uint32_t>& visited)
+{
+	// Mark visited nodes by temporarily moving them to an invalid island, restored before returning
+	uint32_t island = m_nodes[from].island;
+	visited.push_back(from);
+	m_nodes[from].island = INVALID;
+
+	bool found = (from == to);
+	for (size_t i = 0; i < visited.size() && !found; i++)
+	{
+		for (uint32_t neighbour : m_nodes[visited[i]].neighbours)
+		{
+			if (m_nodes[neighbour].island == INVALID) continue;
+
+			if (neighbour == to) { found = true; break; }
+			m_nodes[neighbour].island = INVALID;
+			visited.push_back(neighbour);
+		}
+	}
+
+	for (uint32_t node : visited) m_nodes[node].island = island;
+	return found;
+}
\ No newline at end of file
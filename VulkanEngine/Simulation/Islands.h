@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+
+
+// Tracks which simulation nodes are connected, directly or through others, so that disconnected parts of the
+// factory ("islands") can be ticked independently. Linking two islands relabels the smaller one into the
+// larger; unlinking only searches the island the link belonged to and splits it if the two ends no longer
+// reach each other.
+class IslandGraph
+{
+public:
+	static constexpr uint32_t INVALID = UINT32_MAX;
+
+	struct sIsland
+	{
+		uint32_t id = INVALID;
+		std::vector<uint32_t> nodes = {}; // Ascending
+	};
+
+	uint32_t addNode();
+	// Unlinks the node from everything and removes it from its island. Node indices are not reused.
+	void removeNode(uint32_t node);
+
+	// Links may be added more than once; the nodes stay connected until every copy is unlinked.
+	void link(uint32_t a, uint32_t b);
+	void unlink(uint32_t a, uint32_t b);
+
+	uint32_t getIsland(uint32_t node) { return m_nodes[node].island; }
+	// The nodes of one island, unordered.
+	const std::vector<uint32_t>& getIslandNodes(uint32_t island) { return m_islandMembers[island]; }
+	// Every island, ordered by lowest node. Rebuilt only after the topology changes.
+	const std::vector<sIsland>& getIslands();
+	// Changes whenever a node or link is added or removed, so users can cache anything derived from the topology.
+	uint64_t getVersion() { return m_version; }
+
+private:
+	struct sNode
+	{
+		std::vector<uint32_t> neighbours = {};
+		uint32_t island = INVALID;
+	};
+
+	std::vector<sNode> m_nodes = {};
+	std::vector<std::vector<uint32_t>> m_islandMembers = {}; // Indexed by island ID, unordered
+	std::vector<uint32_t> m_freeIslands = {};
+
+	std::vector<sIsland> m_islands = {};
+	uint64_t m_version = 0;
+	uint64_t m_islandsVersion = UINT64_MAX;
+
+
+	uint32_t createIsland();
+	void removeLink(uint32_t from, uint32_t to);
+	// Returns whether `to` can be reached from `from`, collecting every node visited on the way.
+	bool search(uint32_t from, uint32_t to, std::vector<uint32_t>& visited);
+};
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "LOD.h"
+
+#include <cmath>
+#include <algorithm>
+
+
+
+void SimulationLOD::addMachine(uint32_t machine, glm::ivec3 position)
+{
+	glm::ivec2 coordinates = getChunkCoordinates(position);
+	auto [it, inserted] = m_chunkIndices.try_emplace(getChunkKey(coordinates), static_cast<uint32_t>(m_chunks.size()));
+	if (inserted) m_chunks.push_back({ .coordinates = coordinates });
+
+	// A machine joining changes the chunk, so it has to prove itself steady again
+	sChunk& chunk = m_chunks[it->second];
+	if (chunk.suspended) resume(chunk);
+	chunk.machines.push_back(machine);
+	chunk.steadyWindows = 0;
+
+	if (m_machineChunks.size() <= machine)
+	{
+		m_machineChunks.resize(machine + 1, UINT32_MAX);
+		m_machineFlows.resize(machine + 1);
+	}
+	m_machineChunks[machine] = it->second;
+	resetFlow(machine);
+}
+
+void SimulationLOD::removeMachine(uint32_t machine)
+{
+	if (machine >= m_machineChunks.size() || m_machineChunks[machine] == UINT32_MAX) return;
+
+	sChunk& chunk = m_chunks[m_machineChunks[machine]];
+	if (chunk.suspended) resume(chunk);
+	auto it = std::find(chunk.machines.begin(), chunk.machines.end(), machine);
+	*it = chunk.machines.back();
+	chunk.machines.pop_back();
+	chunk.steadyWindows = 0;
+	m_machineChunks[machine] = UINT32_MAX;
+}
+
+void SimulationLOD::setFocus(glm::ivec3 position)
+{
+	m_focus = getChunkCoordinates(position);
+	for (sChunk& chunk : m_chunks)
+	{
+		if (chunk.suspended && isNearFocus(chunk.coordinates)) resume(chunk);
+	}
+}
+
+void SimulationLOD::resumeAll()
+{
+	for (sChunk& chunk : m_chunks)
+	{
+		if (chunk.suspended) resume(chunk);
+	}
+}
+
+bool SimulationLOD::isSuspended(glm::ivec3 position)
+{
+	auto it = m_chunkIndices.find(getChunkKey(getChunkCoordinates(position)));
+	return it != m_chunkIndices.end() && m_chunks[it->second].suspended;
+}
+
+
+
+void SimulationLOD::tick()
+{
+	m_tick++;
+
+	// Each chunk is sampled once per window, staggered so the work is spread over every tick
+	for (size_t i = m_tick % WINDOW_TICKS; i < m_chunks.size(); i += WINDOW_TICKS) sample(m_chunks[i]);
+}
+
+void SimulationLOD::sample(sChunk& chunk)
+{
+	if (chunk.suspended)
+	{
+		// The machines still model themselves exactly, but only while they're fed and drained the way they were
+		// when the chunk was measured. Anything else and the chunk has to prove itself steady again.
+		bool withinBand = true;
+		for (uint32_t machine : chunk.machines)
+		{
+			sMachineFlow& flow = m_machineFlows[machine];
+			uint64_t inserted = m_pMachines->getItemsInserted(machine);
+			uint64_t taken = m_pMachines->getItemsTaken(machine);
+			withinBand &= isWithinBand(inserted - flow.inserted, flow.inRate) && isWithinBand(taken - flow.taken, flow.outRate);
+			flow.inserted = inserted;
+			flow.taken = taken;
+		}
+		if (!withinBand || isNearFocus(chunk.coordinates)) resume(chunk);
+		return;
+	}
+
+	// Counts are compared against a band rather than exactly: machines started together finish together and beat
+	// against the window
+	bool steady = true;
+	for (uint32_t machine : chunk.machines)
+	{
+		sMachineFlow& flow = m_machineFlows[machine];
+		uint64_t crafts = m_pMachines->getCraftsCompleted(machine);
+		uint64_t inserted = m_pMachines->getItemsInserted(machine);
+		uint64_t taken = m_pMachines->getItemsTaken(machine);
+
+		uint64_t craftRate = crafts - flow.crafts;
+		uint64_t inRate = inserted - flow.inserted;
+		uint64_t outRate = taken - flow.taken;
+		steady &= isWithinBand(craftRate, flow.craftRate) && isWithinBand(inRate, flow.inRate) && isWithinBand(outRate, flow.outRate);
+
+		flow = { .crafts = crafts, .inserted = inserted, .taken = taken, .craftRate = craftRate, .inRate = inRate, .outRate = outRate };
+	}
+
+	chunk.steadyWindows = steady ? chunk.steadyWindows + 1 : 0;
+	if (chunk.steadyWindows >= STEADY_WINDOWS && !isNearFocus(chunk.coordinates)) suspend(chunk);
+}
+
+void SimulationLOD::suspend(sChunk& chunk)
+{
+	for (uint32_t machine : chunk.machines) m_pMachines->suspend(machine);
+	chunk.suspended = true;
+	m_suspendedCount++;
+}
+
+void SimulationLOD::resume(sChunk& chunk)
+{
+	for (uint32_t machine : chunk.machines)
+	{
+		m_pMachines->resume(machine);
+		resetFlow(machine);
+	}
+
+	chunk.suspended = false;
+	chunk.steadyWindows = 0;
+	m_suspendedCount--;
+}
+
+void SimulationLOD::resetFlow(uint32_t machine)
+{
+	// Measuring starts over from the current totals, so the first window after this never counts as steady
+	m_machineFlows[machine] = {
+		.crafts = m_pMachines->getCraftsCompleted(machine),
+		.inserted = m_pMachines->getItemsInserted(machine),
+		.taken = m_pMachines->getItemsTaken(machine),
+		.craftRate = UINT64_MAX,
+		.inRate = UINT64_MAX,
+		.outRate = UINT64_MAX
+	};
+}
+
+
+
+glm::ivec2 SimulationLOD::getChunkCoordinates(glm::ivec3 position)
+{
+	// Floor division, so tiles at negative coordinates land in the right chunk
+	auto floorDivide = [](int32_t value) { return (value >= 0 ? value : value - CHUNK_SIZE + 1) / CHUNK_SIZE; };
+	return glm::ivec2(floorDivide(position.x), floorDivide(position.y));
+}
+
+uint64_t SimulationLOD::getChunkKey(glm::ivec2 coordinates)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(coordinates.x)) << 32) | static_cast<uint32_t>(coordinates.y);
+}
+
+bool SimulationLOD::isNearFocus(glm::ivec2 coordinates)
+{
+	return std::abs(coordinates.x - m_focus.x) <= m_fullRadius && std::abs(coordinates.y - m_focus.y) <= m_fullRadius;
+}
+
+bool SimulationLOD::isWithinBand(uint64_t measured, uint64_t modelled)
+{
+	uint64_t difference = measured > modelled ? measured - modelled : modelled - measured;
+	return difference <= std::max(static_cast<uint64_t>(static_cast<float>(modelled) * FLOW_TOLERANCE), FLOW_TOLERANCE_ITEMS);
+}
\ No newline at end of file
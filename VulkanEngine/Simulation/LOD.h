@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+#include "Recipes.h"
+
+
+
+// Level of detail for the simulation. Machines are bucketed into chunks, and every machine's craft, input and output
+// rates are measured over sample windows. A chunk away from the focus whose rates have all stayed within a band for a
+// few windows is suspended: its machines come off the timer wheel and cost nothing per tick, only catching up on the
+// crafts they'd have finished when items go in or out (see CraftingMachines::suspend). So a belt-fed chunk stays
+// suspended as long as its belts keep feeding and draining it at the rates it was suspended on. If the flow in or
+// out of a machine leaves that band, or the focus comes near, the chunk rejoins the full simulation.
+class SimulationLOD
+{
+public:
+	static constexpr int32_t CHUNK_SIZE = 32; // Tiles
+	static constexpr uint32_t WINDOW_TICKS = 300; // Ticks between samples of a chunk
+	static constexpr uint32_t STEADY_WINDOWS = 3; // Consecutive matching samples before a chunk is suspended
+	static constexpr float FLOW_TOLERANCE = 0.1f; // Fraction a window's flow may differ from the modelled one
+	static constexpr uint64_t FLOW_TOLERANCE_ITEMS = 2; // Absolute allowance, for slow machines whose counts beat against the window
+
+	SimulationLOD(CraftingMachines* pMachines, int32_t fullRadius) : m_pMachines(pMachines), m_fullRadius(fullRadius) {};
+
+	void addMachine(uint32_t machine, glm::ivec3 position);
+	void removeMachine(uint32_t machine);
+
+	// Chunks within fullRadius chunks of this tile always run the full simulation.
+	void setFocus(glm::ivec3 position);
+	// Brings every chunk back to the full simulation, e.g. before inspecting or saving the whole factory.
+	void resumeAll();
+
+	void tick();
+
+	uint32_t getChunkCount() { return static_cast<uint32_t>(m_chunks.size()); }
+	uint32_t getSuspendedChunkCount() { return m_suspendedCount; }
+	bool isSuspended(glm::ivec3 position);
+
+private:
+	struct sChunk
+	{
+		glm::ivec2 coordinates = {};
+		std::vector<uint32_t> machines = {};
+		bool suspended = false;
+		uint32_t steadyWindows = 0;
+	};
+
+	struct sMachineFlow
+	{
+		// Running totals at the last sample
+		uint64_t crafts = 0;
+		uint64_t inserted = 0;
+		uint64_t taken = 0;
+		// Per window, as measured over the last one; frozen while the machine's chunk is suspended
+		uint64_t craftRate = 0;
+		uint64_t inRate = 0;
+		uint64_t outRate = 0;
+	};
+
+	CraftingMachines* m_pMachines = nullptr;
+	int32_t m_fullRadius = 0;
+
+	std::vector<sChunk> m_chunks = {};
+	std::unordered_map<uint64_t, uint32_t> m_chunkIndices = {};
+	std::vector<uint32_t> m_machineChunks = {}; // Indexed by machine ID
+	std::vector<sMachineFlow> m_machineFlows = {}; // Indexed by machine ID
+	glm::ivec2 m_focus = {};
+	uint64_t m_tick = 0;
+	uint32_t m_suspendedCount = 0;
+
+
+	static glm::ivec2 getChunkCoordinates(glm::ivec3 position);
+	static uint64_t getChunkKey(glm::ivec2 coordinates);
+	bool isNearFocus(glm::ivec2 coordinates);
+	static bool isWithinBand(uint64_t measured, uint64_t modelled);
+	void resetFlow(uint32_t machine);
+	void sample(sChunk& chunk);
+	void suspend(sChunk& chunk);
+	void resume(sChunk& chunk);
+};
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "Navigation.h"
+
+
+
+NavigationGrid::NavigationGrid(uint32_t chunksX, uint32_t chunksY) : m_chunksX(chunksX), m_chunksY(chunksY)
+{
+	// Tile coordinates have to fit in 16 bits for the path cache keys
+	if (chunksX == 0 || chunksY == 0 || chunksX * CHUNK_SIZE > UINT16_MAX || chunksY * CHUNK_SIZE > UINT16_MAX) throw std::runtime_error("invalid navigation grid size!");
+
+	m_width = static_cast<int32_t>(chunksX) * CHUNK_SIZE;
+	m_height = static_cast<int32_t>(chunksY) * CHUNK_SIZE;
+	m_blocked.resize(static_cast<size_t>(m_width) * m_height, 0);
+	m_chunkVersions.resize(static_cast<size_t>(chunksX) * chunksY, 0);
+}
+
+void NavigationGrid::setBlocked(glm::ivec2 tile, bool blocked)
+{
+	if (!isInside(tile)) throw std::runtime_error("tried to change a tile outside the navigation grid!");
+
+	uint8_t& stored = m_blocked[getTileIndex(tile)];
+	if (stored == static_cast<uint8_t>(blocked)) return;
+
+	stored = static_cast<uint8_t>(blocked);
+	m_chunkVersions[getChunkOf(tile)] = ++m_version;
+}
+
+void NavigationGrid::getChangedChunks(uint64_t sinceVersion, std::vector<uint32_t>& chunks)
+{
+	if (sinceVersion == m_version) return;
+
+	for (uint32_t chunk = 0; chunk < m_chunkVersions.size(); chunk++)
+	{
+		if (m_chunkVersions[chunk] > sinceVersion) chunks.push_back(chunk);
+	}
+}
\ No newline at end of file
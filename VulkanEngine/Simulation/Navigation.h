@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include <glm/glm.hpp>
+
+
+
+// Walkable tiles of the factory floor, split into chunks the same size as the block world's. Each chunk
+// remembers the grid version it last changed at, so navigation structures built on top can rebuild only
+// the chunks that changed since they last looked.
+class NavigationGrid
+{
+public:
+	static constexpr int32_t CHUNK_SIZE = 32; // Tiles
+
+	NavigationGrid(uint32_t chunksX, uint32_t chunksY);
+
+	// Tiles outside the grid are always blocked.
+	void setBlocked(glm::ivec2 tile, bool blocked);
+	bool isBlocked(glm::ivec2 tile) { return !isInside(tile) || m_blocked[getTileIndex(tile)]; }
+	bool isInside(glm::ivec2 tile) { return tile.x >= 0 && tile.y >= 0 && tile.x < m_width && tile.y < m_height; }
+
+	int32_t getWidth() { return m_width; }
+	int32_t getHeight() { return m_height; }
+	uint32_t getChunksX() { return m_chunksX; }
+	uint32_t getChunksY() { return m_chunksY; }
+	uint32_t getChunkCount() { return m_chunksX * m_chunksY; }
+	uint32_t getChunkOf(glm::ivec2 tile) { return static_cast<uint32_t>(tile.y / CHUNK_SIZE) * m_chunksX + static_cast<uint32_t>(tile.x / CHUNK_SIZE); }
+	glm::ivec2 getChunkOrigin(uint32_t chunk) { return glm::ivec2((chunk % m_chunksX) * CHUNK_SIZE, (chunk / m_chunksX) * CHUNK_SIZE); }
+	uint32_t getTileIndex(glm::ivec2 tile) { return static_cast<uint32_t>(tile.y) * m_width + static_cast<uint32_t>(tile.x); }
+	// Row-major, 1 for blocked tiles.
+	const uint8_t* getBlockedData() { return m_blocked.data(); }
+
+	// Bumped by every change to any tile.
+	uint64_t getVersion() { return m_version; }
+	uint64_t getChunkVersion(uint32_t chunk) { return m_chunkVersions[chunk]; }
+	// Appends every chunk that changed after the given grid version.
+	void getChangedChunks(uint64_t sinceVersion, std::vector<uint32_t>& chunks);
+
+private:
+	uint32_t m_chunksX = 0;
+	uint32_t m_chunksY = 0;
+	int32_t m_width = 0;
+	int32_t m_height = 0;
+
+	std::vector<uint8_t> m_blocked = {}; // Row-major
+	std::vector<uint64_t> m_chunkVersions = {};
+	uint64_t m_version = 0;
+};
\ No newline at end of file
@@ -0,0 +1,421 @@
+#include "Pathfinding.h"
+
+#include <algorithm>
+
+
+
+thread_local HierarchicalPathfinder::sSearchScratch HierarchicalPathfinder::sm_scratch;
+
+
+
+HierarchicalPathfinder::HierarchicalPathfinder(NavigationGrid* pGrid) : m_pGrid(pGrid)
+{
+	uint32_t chunkCount = m_pGrid->getChunkCount();
+	m_chunkNodes.resize(chunkCount);
+	m_borderNodes.resize(static_cast<size_t>(chunkCount) * 2);
+
+	for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+	{
+		rebuildBorder(chunk, 0);
+		rebuildBorder(chunk, 1);
+	}
+	for (uint32_t chunk = 0; chunk < chunkCount; chunk++) rebuildChunkEdges(chunk);
+	m_gridVersion = m_pGrid->getVersion();
+}
+
+void HierarchicalPathfinder::update()
+{
+	if (m_gridVersion == m_pGrid->getVersion()) return;
+
+	std::vector<uint32_t> changed;
+	m_pGrid->getChangedChunks(m_gridVersion, changed);
+	m_gridVersion = m_pGrid->getVersion();
+
+	// A changed chunk owns its +x and +y borders and shares the others with its -x and -y neighbours. The
+	// portals on all four change the node sets of the chunk and its neighbours, so all of those get new edges.
+	uint32_t chunksX = m_pGrid->getChunksX();
+	std::vector<uint8_t> bordersToRebuild(m_borderNodes.size(), 0);
+	std::vector<uint8_t> chunksToRebuild(m_chunkNodes.size(), 0);
+	for (uint32_t chunk : changed)
+	{
+		uint32_t x = chunk % chunksX;
+		uint32_t y = chunk / chunksX;
+		bordersToRebuild[chunk * 2] = 1;
+		bordersToRebuild[chunk * 2 + 1] = 1;
+		if (x > 0) bordersToRebuild[(chunk - 1) * 2] = 1;
+		if (y > 0) bordersToRebuild[(chunk - chunksX) * 2 + 1] = 1;
+
+		chunksToRebuild[chunk] = 1;
+		if (x > 0) chunksToRebuild[chunk - 1] = 1;
+		if (y > 0) chunksToRebuild[chunk - chunksX] = 1;
+		if (x + 1 < chunksX) chunksToRebuild[chunk + 1] = 1;
+		if (y + 1 < m_pGrid->getChunksY()) chunksToRebuild[chunk + chunksX] = 1;
+	}
+
+	for (uint32_t border = 0; border < bordersToRebuild.size(); border++)
+	{
+		if (bordersToRebuild[border]) rebuildBorder(border / 2, border % 2);
+	}
+	for (uint32_t chunk = 0; chunk < chunksToRebuild.size(); chunk++)
+	{
+		if (chunksToRebuild[chunk]) rebuildChunkEdges(chunk);
+	}
+}
+
+void HierarchicalPathfinder::rebuildBorder(uint32_t chunk, uint32_t direction)
+{
+	uint32_t border = chunk * 2 + direction;
+	for (uint32_t node : m_borderNodes[border])
+	{
+		std::vector<uint32_t>& chunkNodes = m_chunkNodes[m_nodes[node].chunk];
+		chunkNodes.erase(std::find(chunkNodes.begin(), chunkNodes.end(), node));
+		m_nodes[node] = {};
+		m_freeNodes.push_back(node);
+	}
+	m_borderNodes[border].clear();
+
+	uint32_t x = chunk % m_pGrid->getChunksX();
+	uint32_t y = chunk / m_pGrid->getChunksX();
+	if ((direction == 0 && x + 1 >= m_pGrid->getChunksX()) || (direction == 1 && y + 1 >= m_pGrid->getChunksY())) return;
+
+	// Walk along the border, collecting runs of tiles that are open on both sides
+	const int32_t size = NavigationGrid::CHUNK_SIZE;
+	glm::ivec2 origin = m_pGrid->getChunkOrigin(chunk);
+	glm::ivec2 along = (direction == 0) ? glm::ivec2(0, 1) : glm::ivec2(1, 0);
+	glm::ivec2 across = (direction == 0) ? glm::ivec2(1, 0) : glm::ivec2(0, 1);
+	glm::ivec2 first = origin + across * (size - 1);
+
+	int32_t runStart = -1;
+	for (int32_t i = 0; i <= size; i++)
+	{
+		glm::ivec2 inside = first + along * i;
+		bool open = i < size && !m_pGrid->isBlocked(inside) && !m_pGrid->isBlocked(inside + across);
+		if (open && runStart < 0) runStart = i;
+		if (open || runStart < 0) continue;
+
+		int32_t runEnd = i - 1;
+		if (runEnd - runStart + 1 <= MAX_ENTRANCE_WIDTH)
+		{
+			glm::ivec2 middle = first + along * ((runStart + runEnd) / 2);
+			addPortal(border, middle, middle + across);
+		}
+		else
+		{
+			addPortal(border, first + along * runStart, first + along * runStart + across);
+			addPortal(border, first + along * runEnd, first + along * runEnd + across);
+		}
+		runStart = -1;
+	}
+}
+
+void HierarchicalPathfinder::addPortal(uint32_t border, glm::ivec2 inside, glm::ivec2 outside)
+{
+	uint32_t nodes[2];
+	glm::ivec2 tiles[2] = { inside, outside };
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		if (!m_freeNodes.empty())
+		{
+			nodes[i] = m_freeNodes.back();
+			m_freeNodes.pop_back();
+		}
+		else
+		{
+			nodes[i] = static_cast<uint32_t>(m_nodes.size());
+			m_nodes.emplace_back();
+		}
+
+		sNode& node = m_nodes[nodes[i]];
+		node.tile = tiles[i];
+		node.chunk = m_pGrid->getChunkOf(tiles[i]);
+		m_chunkNodes[node.chunk].push_back(nodes[i]);
+		m_borderNodes[border].push_back(nodes[i]);
+	}
+	m_nodes[nodes[0]].partner = nodes[1];
+	m_nodes[nodes[1]].partner = nodes[0];
+}
+
+void HierarchicalPathfinder::rebuildChunkEdges(uint32_t chunk)
+{
+	const std::vector<uint32_t>& chunkNodes = m_chunkNodes[chunk];
+	for (uint32_t node : chunkNodes)
+	{
+		sNode& from = m_nodes[node];
+		from.edges.clear();
+		searchChunk(chunk, from.tile, glm::ivec2(-1));
+		for (uint32_t other : chunkNodes)
+		{
+			if (other == node) continue;
+			uint32_t distance = getChunkDistance(chunk, m_nodes[other].tile);
+			if (distance != INVALID) from.edges.push_back({ .target = other, .cost = distance });
+		}
+	}
+}
+
+
+
+bool HierarchicalPathfinder::findPath(glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& path)
+{
+	path.clear();
+	if (m_pGrid->isBlocked(start) || m_pGrid->isBlocked(goal)) return false;
+	if (start == goal)
+	{
+		path.push_back(start);
+		return true;
+	}
+
+	uint64_t key = getCacheKey(start, goal);
+	if (lookupCache(key, path)) return true;
+	m_cacheMisses.fetch_add(1, std::memory_order_relaxed);
+
+	// Within one chunk, try the direct route before going through the portals
+	uint32_t chunk = m_pGrid->getChunkOf(start);
+	bool found = false;
+	if (chunk == m_pGrid->getChunkOf(goal) && searchChunk(chunk, start, goal))
+	{
+		path.push_back(start);
+		appendChunkPath(chunk, goal, path);
+		found = true;
+	}
+	else
+	{
+		found = searchAbstract(start, goal, path);
+	}
+
+	if (found) storeCache(key, path);
+	return found;
+}
+
+void HierarchicalPathfinder::findPaths(std::span<sPathRequest> requests, ThreadPool* pThreadPool)
+{
+	auto answer = [this, requests](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++) findPath(requests[i].start, requests[i].goal, requests[i].path);
+	};
+
+	if (pThreadPool != nullptr) pThreadPool->parallelFor(static_cast<uint32_t>(requests.size()), 8, answer);
+	else answer(0, static_cast<uint32_t>(requests.size()));
+}
+
+bool HierarchicalPathfinder::searchAbstract(glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& path)
+{
+	sSearchScratch& scratch = sm_scratch;
+	const uint32_t START = static_cast<uint32_t>(m_nodes.size());
+	const uint32_t GOAL = START + 1;
+	if (scratch.stamp.size() < GOAL + 1)
+	{
+		scratch.stamp.resize(GOAL + 1, 0);
+		scratch.cost.resize(GOAL + 1, 0);
+		scratch.parent.resize(GOAL + 1, 0);
+		scratch.goalStamp.resize(GOAL + 1, 0);
+		scratch.goalCost.resize(GOAL + 1, 0);
+	}
+	uint32_t generation = ++scratch.generation;
+	auto heuristic = [goal](glm::ivec2 tile) { return static_cast<uint32_t>(std::abs(tile.x - goal.x) + std::abs(tile.y - goal.y)); };
+	auto greater = [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) { return a > b; };
+	auto push = [&scratch, generation, &greater](uint32_t node, uint32_t cost, uint32_t parent, uint32_t estimate) {
+		if (scratch.stamp[node] == generation && scratch.cost[node] <= cost) return;
+		scratch.stamp[node] = generation;
+		scratch.cost[node] = cost;
+		scratch.parent[node] = parent;
+		scratch.open.push_back({ estimate, node });
+		std::push_heap(scratch.open.begin(), scratch.open.end(), greater);
+	};
+
+	// Temporary start and goal nodes, linked to the portals of their chunks they can reach
+	uint32_t goalChunk = m_pGrid->getChunkOf(goal);
+	searchChunk(goalChunk, goal, glm::ivec2(-1));
+	for (uint32_t node : m_chunkNodes[goalChunk])
+	{
+		uint32_t distance = getChunkDistance(goalChunk, m_nodes[node].tile);
+		if (distance == INVALID) continue;
+		scratch.goalStamp[node] = generation;
+		scratch.goalCost[node] = distance;
+	}
+
+	scratch.open.clear();
+	uint32_t startChunk = m_pGrid->getChunkOf(start);
+	searchChunk(startChunk, start, glm::ivec2(-1));
+	for (uint32_t node : m_chunkNodes[startChunk])
+	{
+		uint32_t distance = getChunkDistance(startChunk, m_nodes[node].tile);
+		if (distance != INVALID) push(node, distance, START, distance + heuristic(m_nodes[node].tile));
+	}
+
+	// A* over the portal graph
+	bool found = false;
+	while (!scratch.open.empty())
+	{
+		std::pop_heap(scratch.open.begin(), scratch.open.end(), greater);
+		auto [estimate, node] = scratch.open.back();
+		scratch.open.pop_back();
+		if (node == GOAL)
+		{
+			found = true;
+			break;
+		}
+
+		const sNode& current = m_nodes[node];
+		uint32_t cost = scratch.cost[node];
+		if (estimate > cost + heuristic(current.tile)) continue; // Stale entry
+
+		if (scratch.goalStamp[node] == generation) push(GOAL, cost + scratch.goalCost[node], node, cost + scratch.goalCost[node]);
+		if (current.partner != INVALID) push(current.partner, cost + 1, node, cost + 1 + heuristic(m_nodes[current.partner].tile));
+		for (const sEdge& edge : current.edges) push(edge.target, cost + edge.cost, node, cost + edge.cost + heuristic(m_nodes[edge.target].tile));
+	}
+	if (!found) return false;
+
+	scratch.route.clear();
+	for (uint32_t node = scratch.parent[GOAL]; node != START; node = scratch.parent[node]) scratch.route.push_back(node);
+	std::reverse(scratch.route.begin(), scratch.route.end());
+
+	// Refine every hop into tiles: a step across a border, or a search inside one chunk
+	path.push_back(start);
+	glm::ivec2 current = start;
+	for (uint32_t node : scratch.route)
+	{
+		const sNode& next = m_nodes[node];
+		if (std::abs(next.tile.x - current.x) + std::abs(next.tile.y - current.y) == 1) path.push_back(next.tile);
+		else if (current != next.tile)
+		{
+			searchChunk(next.chunk, current, next.tile);
+			appendChunkPath(next.chunk, next.tile, path);
+		}
+		current = next.tile;
+	}
+	searchChunk(goalChunk, current, goal);
+	appendChunkPath(goalChunk, goal, path);
+	return true;
+}
+
+bool HierarchicalPathfinder::searchChunk(uint32_t chunk, glm::ivec2 from, glm::ivec2 to)
+{
+	sSearchScratch& scratch = sm_scratch;
+	const int32_t size = NavigationGrid::CHUNK_SIZE;
+	glm::ivec2 origin = m_pGrid->getChunkOrigin(chunk);
+	uint32_t generation = ++scratch.localGeneration;
+
+	// Work on chunk-local indices, so neighbours are plain offsets
+	const uint8_t* pRow = m_pGrid->getBlockedData() + m_pGrid->getTileIndex(origin);
+	for (int32_t y = 0; y < size; y++, pRow += m_pGrid->getWidth()) std::copy(pRow, pRow + size, scratch.localBlocked.begin() + y * size);
+	bool hasTarget = to.x >= origin.x && to.y >= origin.y && to.x < origin.x + size && to.y < origin.y + size;
+	uint16_t target = hasTarget ? static_cast<uint16_t>((to.y - origin.y) * size + (to.x - origin.x)) : UINT16_MAX;
+
+	uint16_t fromIndex = static_cast<uint16_t>((from.y - origin.y) * size + (from.x - origin.x));
+	scratch.localStamp[fromIndex] = generation;
+	scratch.localDistance[fromIndex] = 0;
+	scratch.localParent[fromIndex] = fromIndex;
+	scratch.localQueue.clear();
+	scratch.localQueue.push_back(fromIndex);
+
+	auto visit = [&scratch, generation](uint16_t index, uint16_t next) {
+		if (scratch.localBlocked[next] || scratch.localStamp[next] == generation) return;
+		scratch.localStamp[next] = generation;
+		scratch.localDistance[next] = scratch.localDistance[index] + 1;
+		scratch.localParent[next] = index;
+		scratch.localQueue.push_back(next);
+	};
+
+	for (size_t head = 0; head < scratch.localQueue.size(); head++)
+	{
+		uint16_t index = scratch.localQueue[head];
+		if (index == target) return true;
+
+		int32_t x = index % size;
+		if (x + 1 < size) visit(index, index + 1);
+		if (x > 0) visit(index, index - 1);
+		if (index + size < size * size) visit(index, index + size);
+		if (index >= size) visit(index, index - size);
+	}
+	return false;
+}
+
+void HierarchicalPathfinder::appendChunkPath(uint32_t chunk, glm::ivec2 to, std::vector<glm::ivec2>& path)
+{
+	sSearchScratch& scratch = sm_scratch;
+	const int32_t size = NavigationGrid::CHUNK_SIZE;
+	glm::ivec2 origin = m_pGrid->getChunkOrigin(chunk);
+
+	size_t first = path.size();
+	uint16_t index = static_cast<uint16_t>((to.y - origin.y) * size + (to.x - origin.x));
+	while (scratch.localParent[index] != index)
+	{
+		path.push_back(origin + glm::ivec2(index % size, index / size));
+		index = scratch.localParent[index];
+	}
+	std::reverse(path.begin() + first, path.end());
+}
+
+uint32_t HierarchicalPathfinder::getChunkDistance(uint32_t chunk, glm::ivec2 tile)
+{
+	sSearchScratch& scratch = sm_scratch;
+	glm::ivec2 origin = m_pGrid->getChunkOrigin(chunk);
+	uint32_t index = static_cast<uint32_t>((tile.y - origin.y) * NavigationGrid::CHUNK_SIZE + (tile.x - origin.x));
+	return scratch.localStamp[index] == scratch.localGeneration ? scratch.localDistance[index] : INVALID;
+}
+
+
+
+uint64_t HierarchicalPathfinder::getCacheKey(glm::ivec2 start, glm::ivec2 goal)
+{
+	// NavigationGrid keeps coordinates within 16 bits
+	return static_cast<uint64_t>(start.x) | (static_cast<uint64_t>(start.y) << 16) | (static_cast<uint64_t>(goal.x) << 32) | (static_cast<uint64_t>(goal.y) << 48);
+}
+
+bool HierarchicalPathfinder::lookupCache(uint64_t key, std::vector<glm::ivec2>& path)
+{
+	std::lock_guard<std::mutex> lock(m_cacheMutex);
+	auto it = m_cache.find(key);
+	if (it == m_cache.end()) return false;
+
+	// A change to any chunk the path crosses may have blocked it
+	std::list<sCachedPath>::iterator entry = it->second;
+	for (const auto& [chunk, version] : entry->chunkVersions)
+	{
+		if (m_pGrid->getChunkVersion(chunk) != version)
+		{
+			m_cacheEntries.erase(entry);
+			m_cache.erase(it);
+			return false;
+		}
+	}
+
+	m_cacheEntries.splice(m_cacheEntries.begin(), m_cacheEntries, entry);
+	path = entry->path;
+	m_cacheHits.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+void HierarchicalPathfinder::storeCache(uint64_t key, const std::vector<glm::ivec2>& path)
+{
+	sCachedPath entry = { .key = key, .path = path };
+	for (const glm::ivec2& tile : path)
+	{
+		uint32_t chunk = m_pGrid->getChunkOf(tile);
+		if (entry.chunkVersions.empty() || entry.chunkVersions.back().first != chunk) entry.chunkVersions.push_back({ chunk, m_pGrid->getChunkVersion(chunk) });
+	}
+
+	std::lock_guard<std::mutex> lock(m_cacheMutex);
+	auto it = m_cache.find(key);
+	if (it != m_cache.end())
+	{
+		// Another thread found the same path first
+		*it->second = std::move(entry);
+		m_cacheEntries.splice(m_cacheEntries.begin(), m_cacheEntries, it->second);
+		return;
+	}
+
+	while (m_cache.size() >= CACHE_CAPACITY)
+	{
+		m_cache.erase(m_cacheEntries.back().key);
+		m_cacheEntries.pop_back();
+	}
+	m_cacheEntries.push_front(std::move(entry));
+	m_cache.emplace(key, m_cacheEntries.begin());
+}
+
+void HierarchicalPathfinder::clearCache()
+{
+	std::lock_guard<std::mutex> lock(m_cacheMutex);
+	m_cache.clear();
+	m_cacheEntries.clear();
+}
\ No newline at end of file
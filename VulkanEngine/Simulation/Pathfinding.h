@@ -0,0 +1,125 @@
+#pragma once
+
+#include <span>
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+#include "../Utilities/ThreadPool.h"
+#include "Navigation.h"
+
+
+
+// HPA*-style hierarchical pathfinder over a NavigationGrid. Every opening in the border between two chunks gets
+// a portal: a pair of nodes facing each other across the border. Nodes in the same chunk are linked by the
+// length of the shortest path between them inside it. A query searches this small abstract graph, then refines
+// each hop into tiles with a search confined to one chunk. Changing a tile only rebuilds the portals and edges
+// around its chunk. Paths are 4-connected and near-optimal rather than optimal.
+class HierarchicalPathfinder
+{
+public:
+	static constexpr uint32_t INVALID = UINT32_MAX;
+	static constexpr int32_t MAX_ENTRANCE_WIDTH = 6; // Wider openings get a portal at each end instead of one in the middle
+	static constexpr size_t CACHE_CAPACITY = 4096; // Paths
+
+	struct sPathRequest
+	{
+		glm::ivec2 start = {};
+		glm::ivec2 goal = {};
+		std::vector<glm::ivec2> path = {}; // Filled in, start and goal inclusive; empty if there is no path
+	};
+
+	HierarchicalPathfinder(NavigationGrid* pGrid);
+
+	// Catches up with changes to the grid. Must not run at the same time as any query.
+	void update();
+
+	// Queries are thread-safe between calls to update().
+	bool findPath(glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& path);
+	// Answers every request, spread over the pool's threads if one is given.
+	void findPaths(std::span<sPathRequest> requests, ThreadPool* pThreadPool = nullptr);
+
+	size_t getNodeCount() { return m_nodes.size() - m_freeNodes.size(); }
+	uint64_t getCacheHits() { return m_cacheHits.load(std::memory_order_relaxed); }
+	uint64_t getCacheMisses() { return m_cacheMisses.load(std::memory_order_relaxed); }
+	void clearCache();
+
+private:
+	struct sEdge
+	{
+		uint32_t target = 0;
+		uint32_t cost = 0;
+	};
+
+	struct sNode
+	{
+		glm::ivec2 tile = {};
+		uint32_t chunk = 0;
+		uint32_t partner = INVALID; // Node across the border, one step away
+		std::vector<sEdge> edges = {}; // To the other nodes of the chunk
+	};
+
+	// Per-thread search state, so queries can run in parallel. Stamps save clearing the arrays between searches.
+	struct sSearchScratch
+	{
+		std::vector<uint32_t> localStamp = std::vector<uint32_t>(NavigationGrid::CHUNK_SIZE * NavigationGrid::CHUNK_SIZE, 0);
+		std::vector<uint32_t> localDistance = std::vector<uint32_t>(NavigationGrid::CHUNK_SIZE * NavigationGrid::CHUNK_SIZE, 0);
+		std::vector<uint16_t> localParent = std::vector<uint16_t>(NavigationGrid::CHUNK_SIZE * NavigationGrid::CHUNK_SIZE, 0);
+		std::vector<uint8_t> localBlocked = std::vector<uint8_t>(NavigationGrid::CHUNK_SIZE * NavigationGrid::CHUNK_SIZE, 0);
+		std::vector<uint16_t> localQueue = {};
+		uint32_t localGeneration = 0;
+
+		std::vector<uint32_t> stamp = {};
+		std::vector<uint32_t> cost = {};
+		std::vector<uint32_t> parent = {};
+		std::vector<uint32_t> goalStamp = {};
+		std::vector<uint32_t> goalCost = {};
+		std::vector<std::pair<uint32_t, uint32_t>> open = {}; // (estimated total cost, node), a min-heap
+		std::vector<uint32_t> route = {};
+		uint32_t generation = 0;
+	};
+
+	struct sCachedPath
+	{
+		uint64_t key = 0;
+		std::vector<glm::ivec2> path = {};
+		std::vector<std::pair<uint32_t, uint64_t>> chunkVersions = {}; // Every chunk the path crosses, as it was
+	};
+
+	NavigationGrid* m_pGrid = nullptr;
+	uint64_t m_gridVersion = 0;
+
+	std::vector<sNode> m_nodes = {};
+	std::vector<uint32_t> m_freeNodes = {};
+	std::vector<std::vector<uint32_t>> m_chunkNodes = {};
+	std::vector<std::vector<uint32_t>> m_borderNodes = {}; // Index = chunk * 2 + 0 for its east border, 1 for its south
+
+	std::mutex m_cacheMutex;
+	std::list<sCachedPath> m_cacheEntries = {}; // Most recently used first, guarded by m_cacheMutex
+	std::unordered_map<uint64_t, std::list<sCachedPath>::iterator> m_cache = {}; // Guarded by m_cacheMutex
+	std::atomic<uint64_t> m_cacheHits = 0;
+	std::atomic<uint64_t> m_cacheMisses = 0;
+
+	static thread_local sSearchScratch sm_scratch;
+
+
+	void rebuildBorder(uint32_t chunk, uint32_t direction);
+	void rebuildChunkEdges(uint32_t chunk);
+	void addPortal(uint32_t border, glm::ivec2 inside, glm::ivec2 outside);
+
+	bool searchAbstract(glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& path);
+	// Breadth-first search that never leaves the chunk, from `from` until `to` is reached or the chunk is exhausted.
+	bool searchChunk(uint32_t chunk, glm::ivec2 from, glm::ivec2 to);
+	// Appends the path to `to` found by the last searchChunk, excluding its first tile.
+	void appendChunkPath(uint32_t chunk, glm::ivec2 to, std::vector<glm::ivec2>& path);
+	uint32_t getChunkDistance(uint32_t chunk, glm::ivec2 tile);
+
+	static uint64_t getCacheKey(glm::ivec2 start, glm::ivec2 goal);
+	bool lookupCache(uint64_t key, std::vector<glm::ivec2>& path);
+	void storeCache(uint64_t key, const std::vector<glm::ivec2>& path);
+};
\ No newline at end of file
@@ -0,0 +1,541 @@
+#include "Recipes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <bit>
+
+
+
+uint16_t RecipeBook::registerItem(const std::string& name, uint16_t stackSize)
+{
+	auto it = m_itemIDs.find(name);
+	if (it != m_itemIDs.end()) return it->second;
+	if (m_itemNames.size() >= NO_ITEM) throw std::runtime_error("too many item types registered!");
+
+	uint16_t item = static_cast<uint16_t>(m_itemNames.size());
+	m_itemNames.push_back(name);
+	m_stackSizes.push_back(stackSize);
+	m_itemIDs[name] = item;
+	return item;
+}
+
+uint32_t RecipeBook::addRecipe(const std::string& name, const std::vector<sIngredient>& inputs, const std::vector<sIngredient>& outputs, float craftTime)
+{
+	if (m_compiled) throw std::runtime_error("recipes can't be added after the recipe book is compiled!");
+	if (m_recipeIDs.contains(name)) throw std::runtime_error("recipe \"" + name + "\" registered twice!");
+
+	m_definitions.push_back({ .name = name, .inputs = inputs, .outputs = outputs, .craftTime = craftTime });
+	m_recipeIDs[name] = static_cast<uint32_t>(m_definitions.size() - 1);
+	return static_cast<uint32_t>(m_definitions.size() - 1);
+}
+
+void RecipeBook::compile()
+{
+	m_recipes.clear();
+	for (const sRecipeDefinition& definition : m_definitions)
+	{
+		if (definition.inputs.size() > MAX_INPUTS || definition.outputs.size() > MAX_OUTPUTS)
+			throw std::runtime_error("recipe \"" + definition.name + "\" uses too many item slots!");
+		if (definition.craftTime <= 0.0f)
+			throw std::runtime_error("recipe \"" + definition.name + "\" has no craft time!");
+
+		sCompiledRecipe recipe{ .craftTime = definition.craftTime };
+		recipe.inputItems.fill(NO_ITEM);
+		recipe.outputItems.fill(NO_ITEM);
+		for (size_t i = 0; i < definition.inputs.size(); i++)
+		{
+			recipe.inputItems[i] = getItemID(definition.inputs[i].item);
+			recipe.inputCounts[i] = definition.inputs[i].count;
+			if (recipe.inputCounts[i] > getStackSize(recipe.inputItems[i]))
+				throw std::runtime_error("recipe \"" + definition.name + "\" takes more " + definition.inputs[i].item + " than fits in a stack!");
+		}
+		for (size_t i = 0; i < definition.outputs.size(); i++)
+		{
+			recipe.outputItems[i] = getItemID(definition.outputs[i].item);
+			recipe.outputCounts[i] = definition.outputs[i].count;
+
+			// The output could never be reserved, leaving every machine on the recipe waiting for space forever
+			if (recipe.outputCounts[i] > getStackSize(recipe.outputItems[i]))
+				throw std::runtime_error("recipe \"" + definition.name + "\" makes more " + definition.outputs[i].item + " than fits in a stack!");
+		}
+		m_recipes.push_back(recipe);
+	}
+	m_compiled = true;
+}
+
+void RecipeBook::registerDefaults(uint16_t stackSize)
+{
+	for (const char* item : { "iron-ore", "copper-ore", "iron-plate", "copper-plate", "copper-cable", "iron-gear", "electronic-circuit", "electric-motor" })
+		registerItem(item, stackSize);
+
+	addRecipe("iron-plate", { { "iron-ore", 1 } }, { { "iron-plate", 1 } }, 3.2f);
+	addRecipe("copper-plate", { { "copper-ore", 1 } }, { { "copper-plate", 1 } }, 3.2f);
+	addRecipe("copper-cable", { { "copper-plate", 1 } }, { { "copper-cable", 2 } }, 0.5f);
+	addRecipe("iron-gear", { { "iron-plate", 2 } }, { { "iron-gear", 1 } }, 0.5f);
+	addRecipe("electronic-circuit", { { "iron-plate", 1 }, { "copper-cable", 3 } }, { { "electronic-circuit", 1 } }, 0.5f);
+	addRecipe("electric-motor", { { "iron-gear", 1 }, { "copper-cable", 6 }, { "iron-plate", 1 } }, { { "electric-motor", 1 } }, 2.0f);
+}
+
+uint16_t RecipeBook::getItemID(const std::string& name)
+{
+	auto it = m_itemIDs.find(name);
+	if (it == m_itemIDs.end()) throw std::runtime_error("unknown item \"" + name + "\"!");
+	return it->second;
+}
+
+uint32_t RecipeBook::getRecipeID(const std::string& name)
+{
+	auto it = m_recipeIDs.find(name);
+	if (it == m_recipeIDs.end()) throw std::runtime_error("unknown recipe \"" + name + "\"!");
+	return it->second;
+}
+
+
+
+uint32_t CraftingMachines::addMachine(uint32_t recipe, float craftingSpeed)
+{
+	if (recipe >= m_pRecipes->getRecipeCount()) throw std::runtime_error("tried to add a machine with an invalid recipe!");
+	if (!(craftingSpeed > 0.0f)) throw std::runtime_error("tried to add a machine with no crafting speed!");
+	if (m_groups.size() < m_pRecipes->getRecipeCount()) m_groups.resize(m_pRecipes->getRecipeCount());
+
+	uint32_t machine;
+	if (!m_freeIDs.empty())
+	{
+		machine = m_freeIDs.back();
+		m_freeIDs.pop_back();
+	}
+	else
+	{
+		machine = static_cast<uint32_t>(m_machines.size());
+		m_machines.emplace_back();
+	}
+
+	// The ticket carries over from the ID's previous owner, so that machine's timer can't fire for this one
+	sRecipeGroup& group = m_groups[recipe];
+	uint32_t row = static_cast<uint32_t>(group.machineIDs.size());
+	m_machines[machine].recipe = recipe;
+	m_machines[machine].row = row;
+	group.progress.push_back(0.0f);
+	group.rate.push_back(0.0f);
+	group.startTick.push_back(0);
+	group.speed.push_back(craftingSpeed);
+	group.power.push_back(1.0f);
+	for (std::vector<uint16_t>& column : group.inputs) column.push_back(0);
+	for (std::vector<uint16_t>& column : group.outputs) column.push_back(0);
+	group.holdingCraft.push_back(0);
+	group.waitReason.push_back(WAIT_INPUT);
+	group.craftsCompleted.push_back(0);
+	group.itemsInserted.push_back(0);
+	group.itemsTaken.push_back(0);
+	group.machineIDs.push_back(machine);
+
+	tryStart(recipe, row);
+	return machine;
+}
+
+void CraftingMachines::removeMachine(uint32_t machine)
+{
+	sMachineRef& ref = m_machines[machine];
+	if (ref.recipe == INVALID) return;
+
+	// Swap-remove the row and patch the machine that moved into it
+	sRecipeGroup& group = m_groups[ref.recipe];
+	if (group.waitReason[ref.row] == WAIT_NONE) m_craftingCount--;
+	auto swapRemove = [row = ref.row](auto& column) {
+		column[row] = column.back();
+		column.pop_back();
+	};
+	swapRemove(group.progress);
+	swapRemove(group.rate);
+	swapRemove(group.startTick);
+	swapRemove(group.speed);
+	swapRemove(group.power);
+	for (std::vector<uint16_t>& column : group.inputs) swapRemove(column);
+	for (std::vector<uint16_t>& column : group.outputs) swapRemove(column);
+	swapRemove(group.holdingCraft);
+	swapRemove(group.waitReason);
+	swapRemove(group.craftsCompleted);
+	swapRemove(group.itemsInserted);
+	swapRemove(group.itemsTaken);
+	swapRemove(group.machineIDs);
+	if (ref.row < group.machineIDs.size()) m_machines[group.machineIDs[ref.row]].row = ref.row;
+
+	ref = { .recipe = INVALID, .row = 0, .ticket = ref.ticket + 1 };
+	m_freeIDs.push_back(machine);
+}
+
+uint16_t CraftingMachines::insertItem(uint32_t machine, uint16_t item, uint16_t count)
+{
+	// Unused input slots hold NO_ITEM, which would otherwise match and has no stack size
+	if (item == RecipeBook::NO_ITEM) return 0;
+
+	sMachineRef ref = m_machines[machine];
+	sRecipeGroup& group = m_groups[ref.recipe];
+	const RecipeBook::sCompiledRecipe& recipe = m_pRecipes->getRecipe(ref.recipe);
+
+	for (uint32_t slot = 0; slot < RecipeBook::MAX_INPUTS; slot++)
+	{
+		if (recipe.inputItems[slot] != item) continue;
+
+		// A suspended machine's buffers have to be current before anything is added to them
+		bool suspended = group.waitReason[ref.row] & WAIT_SUSPENDED;
+		if (suspended) advanceSuspended(ref.recipe, ref.row);
+
+		uint16_t& stored = group.inputs[slot][ref.row];
+		uint16_t accepted = std::min<uint16_t>(count, m_pRecipes->getStackSize(item) - std::min(stored, m_pRecipes->getStackSize(item)));
+		stored += accepted;
+		group.itemsInserted[ref.row] += accepted;
+		if (accepted > 0 && suspended) startSuspended(ref.recipe, ref.row);
+		else if (accepted > 0 && (group.waitReason[ref.row] & WAIT_INPUT)) tryStart(ref.recipe, ref.row);
+		return accepted;
+	}
+	return 0;
+}
+
+uint16_t CraftingMachines::takeOutput(uint32_t machine, uint32_t slot, uint16_t maxCount)
+{
+	sMachineRef ref = m_machines[machine];
+	sRecipeGroup& group = m_groups[ref.recipe];
+	bool suspended = group.waitReason[ref.row] & WAIT_SUSPENDED;
+	if (suspended) advanceSuspended(ref.recipe, ref.row);
+
+	uint16_t& stored = group.outputs[slot][ref.row];
+	uint16_t taken = std::min(stored, maxCount);
+	stored -= taken;
+	group.itemsTaken[ref.row] += taken;
+	if (taken > 0 && suspended) startSuspended(ref.recipe, ref.row);
+	else if (taken > 0 && (group.waitReason[ref.row] & WAIT_OUTPUT)) tryStart(ref.recipe, ref.row);
+	return taken;
+}
+
+void CraftingMachines::setPowerSatisfaction(uint32_t machine, float satisfaction)
+{
+	sMachineRef ref = m_machines[machine];
+	sRecipeGroup& group = m_groups[ref.recipe];
+	if (group.power[ref.row] == satisfaction) return;
+
+	if (group.waitReason[ref.row] & WAIT_SUSPENDED)
+	{
+		// Finish what the old rate got through and bank the craft in hand, then carry on at the new rate
+		advanceSuspended(ref.recipe, ref.row);
+		uint64_t now = m_timers.getCurrentTick();
+		if (group.holdingCraft[ref.row]) group.progress[ref.row] = std::min(1.0f, group.progress[ref.row] + static_cast<float>(now - group.startTick[ref.row]) * group.rate[ref.row]);
+		group.power[ref.row] = satisfaction;
+		group.rate[ref.row] = getCraftRate(ref.recipe, ref.row);
+		group.startTick[ref.row] = now;
+		startSuspended(ref.recipe, ref.row);
+		return;
+	}
+
+	group.power[ref.row] = satisfaction;
+	if (group.waitReason[ref.row] == WAIT_NONE)
+	{
+		// Bank the progress made at the old rate and carry on at the new one
+		pause(ref.recipe, ref.row);
+		tryStart(ref.recipe, ref.row);
+	}
+	else if (group.waitReason[ref.row] & WAIT_POWER)
+	{
+		tryStart(ref.recipe, ref.row);
+	}
+}
+
+void CraftingMachines::suspend(uint32_t machine)
+{
+	sMachineRef ref = m_machines[machine];
+	sRecipeGroup& group = m_groups[ref.recipe];
+	if (group.waitReason[ref.row] & WAIT_SUSPENDED) return;
+
+	// A running craft keeps its start tick and progress, so it finishes on the tick its timer was set for. Anything
+	// else carries on from now once it can.
+	if (group.waitReason[ref.row] == WAIT_NONE)
+	{
+		m_machines[machine].ticket++;
+		m_craftingCount--;
+	}
+	else
+	{
+		group.rate[ref.row] = getCraftRate(ref.recipe, ref.row);
+		group.startTick[ref.row] = m_timers.getCurrentTick();
+	}
+	group.waitReason[ref.row] = WAIT_SUSPENDED;
+}
+
+void CraftingMachines::resume(uint32_t machine)
+{
+	sMachineRef ref = m_machines[machine];
+	sRecipeGroup& group = m_groups[ref.recipe];
+	if (!(group.waitReason[ref.row] & WAIT_SUSPENDED)) return;
+
+	advanceSuspended(ref.recipe, ref.row);
+
+	// A craft in hand goes back on the timer wheel due on the same tick as before, anything else waits as usual
+	if (group.holdingCraft[ref.row] && group.rate[ref.row] > 0.0f) schedule(ref.recipe, ref.row);
+	else tryStart(ref.recipe, ref.row);
+}
+
+void CraftingMachines::advanceSuspended(uint32_t recipeID, uint32_t row)
+{
+	sRecipeGroup& group = m_groups[recipeID];
+	if (!group.holdingCraft[row] || group.rate[row] <= 0.0f) return;
+
+	uint64_t now = m_timers.getCurrentTick();
+	uint64_t finish = getFinishTick(group, row);
+	if (finish > now) return;
+
+	// The craft in hand finishes when it was due and each following one starts as the last finishes, taking as many
+	// ticks as tryStart would schedule, for as long as the inputs and output space last. Its output space was
+	// reserved when it started, so only the following crafts are limited by the buffers.
+	const RecipeBook::sCompiledRecipe& recipe = m_pRecipes->getRecipe(recipeID);
+	uint64_t craftTicks = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(1.0f / group.rate[row] - 1e-3f)));
+	uint64_t following = (now - finish) / craftTicks;
+	for (uint32_t slot = 0; slot < RecipeBook::MAX_INPUTS; slot++)
+	{
+		if (recipe.inputItems[slot] == RecipeBook::NO_ITEM) continue;
+		following = std::min<uint64_t>(following, group.inputs[slot][row] / recipe.inputCounts[slot]);
+	}
+	for (uint32_t slot = 0; slot < RecipeBook::MAX_OUTPUTS; slot++)
+	{
+		if (recipe.outputItems[slot] == RecipeBook::NO_ITEM) continue;
+		uint16_t space = m_pRecipes->getStackSize(recipe.outputItems[slot]) - std::min(group.outputs[slot][row], m_pRecipes->getStackSize(recipe.outputItems[slot]));
+		uint64_t outputCrafts = space / recipe.outputCounts[slot];
+		following = std::min(following, outputCrafts - std::min<uint64_t>(outputCrafts, 1));
+	}
+
+	uint64_t crafts = following + 1;
+	for (uint32_t slot = 0; slot < RecipeBook::MAX_INPUTS; slot++)
+	{
+		if (recipe.inputItems[slot] != RecipeBook::NO_ITEM) group.inputs[slot][row] -= static_cast<uint16_t>(following * recipe.inputCounts[slot]);
+	}
+	for (uint32_t slot = 0; slot < RecipeBook::MAX_OUTPUTS; slot++)
+	{
+		if (recipe.outputItems[slot] != RecipeBook::NO_ITEM) group.outputs[slot][row] += static_cast<uint16_t>(crafts * recipe.outputCounts[slot]);
+	}
+	group.craftsCompleted[row] += crafts;
+	group.holdingCraft[row] = 0;
+	group.progress[row] = 0.0f;
+
+	// If time rather than the buffers ran out, the next craft started on the tick the last one finished
+	group.startTick[row] = finish + following * craftTicks;
+	if (getBlockers(recipeID, row) == WAIT_NONE) takeInputs(recipeID, row);
+}
+
+void CraftingMachines::startSuspended(uint32_t recipeID, uint32_t row)
+{
+	sRecipeGroup& group = m_groups[recipeID];
+	if (group.holdingCraft[row] || getBlockers(recipeID, row) != WAIT_NONE) return;
+
+	takeInputs(recipeID, row);
+	group.rate[row] = getCraftRate(recipeID, row);
+	group.startTick[row] = m_timers.getCurrentTick();
+}
+
+uint64_t CraftingMachines::hashState()
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * 1099511628211ull; };
+
+	for (const sRecipeGroup& group : m_groups)
+	{
+		for (size_t row = 0; row < group.machineIDs.size(); row++)
+		{
+			mix(group.machineIDs[row]);
+			mix(std::bit_cast<uint32_t>(group.progress[row]));
+			mix(group.startTick[row]);
+			mix(group.waitReason[row]);
+			mix(group.craftsCompleted[row]);
+			for (const std::vector<uint16_t>& column : group.inputs) mix(column[row]);
+			for (const std::vector<uint16_t>& column : group.outputs) mix(column[row]);
+		}
+	}
+	return hash;
+}
+
+float CraftingMachines::getProgress(uint32_t machine)
+{
+	sMachineRef ref = m_machines[machine];
+	return getCurrentProgress(m_groups[ref.recipe], ref.row);
+}
+
+uint64_t CraftingMachines::getCraftsCompleted(uint32_t machine)
+{
+	sMachineRef ref = m_machines[machine];
+	if (m_groups[ref.recipe].waitReason[ref.row] & WAIT_SUSPENDED) advanceSuspended(ref.recipe, ref.row);
+	return m_groups[ref.recipe].craftsCompleted[ref.row];
+}
+
+uint64_t CraftingMachines::getItemsInserted(uint32_t machine)
+{
+	sMachineRef ref = m_machines[machine];
+	return m_groups[ref.recipe].itemsInserted[ref.row];
+}
+
+uint64_t CraftingMachines::getItemsTaken(uint32_t machine)
+{
+	sMachineRef ref = m_machines[machine];
+	return m_groups[ref.recipe].itemsTaken[ref.row];
+}
+
+uint8_t CraftingMachines::getWaitReason(uint32_t machine)
+{
+	sMachineRef ref = m_machines[machine];
+	return m_groups[ref.recipe].waitReason[ref.row];
+}
+
+uint16_t CraftingMachines::getInputCount(uint32_t machine, uint32_t slot)
+{
+	sMachineRef ref = m_machines[machine];
+	if (m_groups[ref.recipe].waitReason[ref.row] & WAIT_SUSPENDED) advanceSuspended(ref.recipe, ref.row);
+	return m_groups[ref.recipe].inputs[slot][ref.row];
+}
+
+uint16_t CraftingMachines::getOutputCount(uint32_t machine, uint32_t slot)
+{
+	sMachineRef ref = m_machines[machine];
+	if (m_groups[ref.recipe].waitReason[ref.row] & WAIT_SUSPENDED) advanceSuspended(ref.recipe, ref.row);
+	return m_groups[ref.recipe].outputs[slot][ref.row];
+}
+
+
+
+void CraftingMachines::tick()
+{
+	m_dueTimers.clear();
+	m_timers.advance(m_dueTimers);
+
+	// Sort the due crafts into their recipe groups, dropping timers made stale by a pause or removal
+	for (const TimerWheel::sTimer& timer : m_dueTimers)
+	{
+		sMachineRef ref = m_machines[timer.id];
+		if (ref.recipe == INVALID || ref.ticket != timer.ticket) continue;
+		m_groups[ref.recipe].dueRows.push_back(ref.row);
+	}
+
+	m_craftsCompletedLastTick = 0;
+	for (uint32_t recipe = 0; recipe < m_groups.size(); recipe++)
+	{
+		if (m_groups[recipe].dueRows.empty()) continue;
+		completeGroup(recipe);
+	}
+}
+
+void CraftingMachines::completeGroup(uint32_t recipeID)
+{
+	sRecipeGroup& group = m_groups[recipeID];
+	const RecipeBook::sCompiledRecipe& recipe = m_pRecipes->getRecipe(recipeID);
+	const uint32_t* rows = group.dueRows.data();
+	size_t count = group.dueRows.size();
+
+	// Produce every finished craft's outputs in one pass per slot. Output space was reserved when each
+	// craft started, so nothing here can overflow a stack.
+	for (uint32_t slot = 0; slot < RecipeBook::MAX_OUTPUTS; slot++)
+	{
+		if (recipe.outputItems[slot] == RecipeBook::NO_ITEM) continue;
+
+		uint16_t* stored = group.outputs[slot].data();
+		const uint16_t produced = recipe.outputCounts[slot];
+		for (size_t i = 0; i < count; i++) stored[rows[i]] += produced;
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		group.progress[rows[i]] = 0.0f;
+		group.holdingCraft[rows[i]] = 0;
+		group.waitReason[rows[i]] = WAIT_INPUT;
+		group.craftsCompleted[rows[i]]++;
+	}
+	m_craftingCount -= static_cast<uint32_t>(count);
+	m_craftsCompletedLastTick += count;
+
+	// Start the next craft where possible; the rest go to sleep until an event wakes them
+	for (size_t i = 0; i < count; i++) tryStart(recipeID, rows[i]);
+	group.dueRows.clear();
+}
+
+void CraftingMachines::tryStart(uint32_t recipeID, uint32_t row)
+{
+	sRecipeGroup& group = m_groups[recipeID];
+
+	uint8_t reason = getBlockers(recipeID, row);
+	group.waitReason[row] = reason;
+	if (reason != WAIT_NONE) return;
+
+	if (!group.holdingCraft[row]) takeInputs(recipeID, row);
+	group.rate[row] = getCraftRate(recipeID, row);
+	group.startTick[row] = m_timers.getCurrentTick();
+	schedule(recipeID, row);
+}
+
+uint8_t CraftingMachines::getBlockers(uint32_t recipeID, uint32_t row)
+{
+	sRecipeGroup& group = m_groups[recipeID];
+	const RecipeBook::sCompiledRecipe& recipe = m_pRecipes->getRecipe(recipeID);
+
+	// A craft that already holds its inputs only needs power to resume
+	uint8_t reason = WAIT_NONE;
+	if (!group.holdingCraft[row])
+	{
+		for (uint32_t slot = 0; slot < RecipeBook::MAX_INPUTS; slot++)
+		{
+			if (recipe.inputItems[slot] != RecipeBook::NO_ITEM && group.inputs[slot][row] < recipe.inputCounts[slot]) reason |= WAIT_INPUT;
+		}
+		for (uint32_t slot = 0; slot < RecipeBook::MAX_OUTPUTS; slot++)
+		{
+			if (recipe.outputItems[slot] == RecipeBook::NO_ITEM) continue;
+			if (group.outputs[slot][row] + recipe.outputCounts[slot] > m_pRecipes->getStackSize(recipe.outputItems[slot])) reason |= WAIT_OUTPUT;
+		}
+	}
+	if (group.power[row] <= 0.0f) reason |= WAIT_POWER;
+	return reason;
+}
+
+void CraftingMachines::takeInputs(uint32_t recipeID, uint32_t row)
+{
+	sRecipeGroup& group = m_groups[recipeID];
+	const RecipeBook::sCompiledRecipe& recipe = m_pRecipes->getRecipe(recipeID);
+
+	for (uint32_t slot = 0; slot < RecipeBook::MAX_INPUTS; slot++)
+	{
+		if (recipe.inputItems[slot] != RecipeBook::NO_ITEM) group.inputs[slot][row] -= recipe.inputCounts[slot];
+	}
+	group.holdingCraft[row] = 1;
+	group.progress[row] = 0.0f;
+}
+
+void CraftingMachines::schedule(uint32_t recipeID, uint32_t row)
+{
+	sRecipeGroup& group = m_groups[recipeID];
+	group.waitReason[row] = WAIT_NONE;
+
+	uint32_t machine = group.machineIDs[row];
+	m_timers.schedule(getFinishTick(group, row), machine, ++m_machines[machine].ticket);
+	m_craftingCount++;
+}
+
+void CraftingMachines::pause(uint32_t recipeID, uint32_t row)
+{
+	sRecipeGroup& group = m_groups[recipeID];
+	group.progress[row] = getCurrentProgress(group, row);
+	group.waitReason[row] = WAIT_POWER;
+	m_machines[group.machineIDs[row]].ticket++;
+	m_craftingCount--;
+}
+
+float CraftingMachines::getCraftRate(uint32_t recipeID, uint32_t row)
+{
+	const sRecipeGroup& group = m_groups[recipeID];
+	return m_tickDelta * group.speed[row] * group.power[row] / m_pRecipes->getRecipe(recipeID).craftTime;
+}
+
+uint64_t CraftingMachines::getFinishTick(const sRecipeGroup& group, uint32_t row)
+{
+	// The small bias stops float error from turning an exact 30-tick craft into 31
+	return group.startTick[row] + std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil((1.0f - group.progress[row]) / group.rate[row] - 1e-3f)));
+}
+
+float CraftingMachines::getCurrentProgress(const sRecipeGroup& group, uint32_t row)
+{
+	if (group.waitReason[row] != WAIT_NONE) return group.progress[row];
+
+	float elapsed = static_cast<float>(m_timers.getCurrentTick() - group.startTick[row]);
+	return std::min(1.0f, group.progress[row] + elapsed * group.rate[row]);
+}
\ No newline at end of file
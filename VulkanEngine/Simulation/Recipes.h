@@ -0,0 +1,190 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "TimerWheel.h"
+
+
+
+// Recipe definitions, registered by name at load time and then compiled into dense tables indexed by item
+// and recipe ID. Nothing after compile() touches a string or a hash map.
+class RecipeBook
+{
+public:
+	static constexpr uint32_t MAX_INPUTS = 4;
+	static constexpr uint32_t MAX_OUTPUTS = 2;
+	static constexpr uint16_t NO_ITEM = UINT16_MAX;
+
+	struct sIngredient
+	{
+		std::string item = "";
+		uint16_t count = 1;
+	};
+
+	// Unused slots have NO_ITEM and a count of 0, so kernels can always loop over every slot.
+	struct sCompiledRecipe
+	{
+		std::array<uint16_t, MAX_INPUTS> inputItems = {};
+		std::array<uint16_t, MAX_INPUTS> inputCounts = {};
+		std::array<uint16_t, MAX_OUTPUTS> outputItems = {};
+		std::array<uint16_t, MAX_OUTPUTS> outputCounts = {};
+		float craftTime = 1.0f; // Seconds at crafting speed 1
+	};
+
+	uint16_t registerItem(const std::string& name, uint16_t stackSize = 100);
+	uint32_t addRecipe(const std::string& name, const std::vector<sIngredient>& inputs, const std::vector<sIngredient>& outputs, float craftTime);
+	// Resolves every recipe's item names. Throws if a recipe uses an unregistered item, too many slots or more of an item than fits in a stack.
+	void compile();
+	// Adds the built-in items and recipes.
+	void registerDefaults(uint16_t stackSize = 100);
+
+	// Load-time lookups
+	uint16_t getItemID(const std::string& name);
+	uint32_t getRecipeID(const std::string& name);
+
+	bool isCompiled() const { return m_compiled; }
+	uint32_t getRecipeCount() const { return static_cast<uint32_t>(m_recipes.size()); }
+	const sCompiledRecipe& getRecipe(uint32_t recipe) const { return m_recipes[recipe]; }
+	uint16_t getStackSize(uint16_t item) const { return m_stackSizes[item]; }
+	const std::string& getItemName(uint16_t item) const { return m_itemNames[item]; }
+
+private:
+	struct sRecipeDefinition
+	{
+		std::string name = "";
+		std::vector<sIngredient> inputs = {};
+		std::vector<sIngredient> outputs = {};
+		float craftTime = 1.0f;
+	};
+
+	std::vector<std::string> m_itemNames = {};
+	std::vector<uint16_t> m_stackSizes = {};
+	std::unordered_map<std::string, uint16_t> m_itemIDs = {};
+
+	std::vector<sRecipeDefinition> m_definitions = {};
+	std::unordered_map<std::string, uint32_t> m_recipeIDs = {};
+	std::vector<sCompiledRecipe> m_recipes = {};
+	bool m_compiled = false;
+};
+
+
+// Crafting machines, grouped by the recipe they run, with each group's state kept in parallel arrays.
+// A machine consumes its inputs when a craft starts and then sits in a timer wheel until the craft finishes,
+// untouched in between. A machine that can't start waits for the event that would unblock it (inputs arriving,
+// output space freed, power restored) instead of being polled, so a tick only costs the crafts finishing on it.
+class CraftingMachines
+{
+public:
+	static constexpr uint32_t INVALID = UINT32_MAX;
+
+	// Why a machine isn't crafting, as bit flags.
+	enum eWaitReason : uint8_t
+	{
+		WAIT_NONE = 0, // Crafting
+		WAIT_INPUT = 1 << 0,
+		WAIT_OUTPUT = 1 << 1,
+		WAIT_POWER = 1 << 2,
+		WAIT_SUSPENDED = 1 << 3, // Taken off the timer wheel, see suspend()
+	};
+
+	CraftingMachines(const RecipeBook* pRecipes, float tickDelta) : m_pRecipes(pRecipes), m_tickDelta(tickDelta) {};
+
+	uint32_t addMachine(uint32_t recipe, float craftingSpeed);
+	void removeMachine(uint32_t machine);
+
+	// Puts items into the matching input slot and wakes the machine if it was waiting for them. Returns how many were accepted.
+	uint16_t insertItem(uint32_t machine, uint16_t item, uint16_t count);
+	// Takes up to maxCount items from an output slot and wakes the machine if it was waiting for space. Returns how many were taken.
+	uint16_t takeOutput(uint32_t machine, uint32_t slot, uint16_t maxCount);
+	// Restoring power wakes the machine; any other change to a running machine reschedules its craft.
+	void setPowerSatisfaction(uint32_t machine, float satisfaction);
+
+	// Takes the machine off the timer wheel. It costs nothing per tick while suspended and is only brought up to date
+	// when items go in or out, its buffers or craft count are read, its power changes or it resumes, finishing in one
+	// step every craft the timer wheel would have finished in between, on the same ticks and limited by its buffers in
+	// the same way.
+	void suspend(uint32_t machine);
+	// Brings a suspended machine up to date and puts it back on the timer wheel.
+	void resume(uint32_t machine);
+
+	float getProgress(uint32_t machine);
+	uint64_t getCraftsCompleted(uint32_t machine);
+	// Running totals of the items that went into the machine and came out of it, for measuring its flow.
+	uint64_t getItemsInserted(uint32_t machine);
+	uint64_t getItemsTaken(uint32_t machine);
+	uint8_t getWaitReason(uint32_t machine);
+	uint16_t getInputCount(uint32_t machine, uint32_t slot);
+	uint16_t getOutputCount(uint32_t machine, uint32_t slot);
+	uint64_t getCraftsCompletedLastTick() { return m_craftsCompletedLastTick; }
+	uint32_t getMachineCount() { return static_cast<uint32_t>(m_machines.size() - m_freeIDs.size()); }
+	uint32_t getCraftingMachineCount() { return m_craftingCount; }
+	uint64_t getCurrentTick() { return m_timers.getCurrentTick(); }
+	bool isMachine(uint32_t machine) { return machine < m_machines.size() && m_machines[machine].recipe != INVALID; }
+	// FNV-1a hash over every machine's state, for checking determinism.
+	uint64_t hashState();
+
+	// Finishes the crafts due this tick, batched per recipe.
+	void tick();
+
+private:
+	struct sRecipeGroup
+	{
+		std::vector<float> progress = {}; // At startTick
+		std::vector<float> rate = {}; // Progress per tick since startTick
+		std::vector<uint64_t> startTick = {};
+		std::vector<float> speed = {};
+		std::vector<float> power = {};
+		std::array<std::vector<uint16_t>, RecipeBook::MAX_INPUTS> inputs = {};
+		std::array<std::vector<uint16_t>, RecipeBook::MAX_OUTPUTS> outputs = {};
+		std::vector<uint8_t> holdingCraft = {}; // 1 once a craft's inputs are consumed, until its outputs are produced
+		std::vector<uint8_t> waitReason = {};
+		std::vector<uint64_t> craftsCompleted = {};
+		std::vector<uint64_t> itemsInserted = {};
+		std::vector<uint64_t> itemsTaken = {};
+		std::vector<uint32_t> machineIDs = {};
+		std::vector<uint32_t> dueRows = {}; // Scratch: rows whose craft finishes this tick
+	};
+
+	struct sMachineRef
+	{
+		uint32_t recipe = INVALID;
+		uint32_t row = 0;
+		uint32_t ticket = 0; // Bumped whenever the machine's pending timer becomes stale
+	};
+
+	const RecipeBook* m_pRecipes = nullptr;
+	float m_tickDelta = 0.0f;
+	std::vector<sRecipeGroup> m_groups = {}; // Indexed by recipe ID
+	std::vector<sMachineRef> m_machines = {};
+	std::vector<uint32_t> m_freeIDs = {};
+
+	TimerWheel m_timers = {};
+	std::vector<TimerWheel::sTimer> m_dueTimers = {};
+	uint32_t m_craftingCount = 0;
+	uint64_t m_craftsCompletedLastTick = 0;
+
+
+	// Starts or resumes a craft if the machine can run, otherwise records what it is waiting for.
+	void tryStart(uint32_t recipe, uint32_t row);
+	// What stops the machine starting or resuming a craft right now, WAIT_NONE if nothing.
+	uint8_t getBlockers(uint32_t recipe, uint32_t row);
+	// Consumes the inputs of a new craft.
+	void takeInputs(uint32_t recipe, uint32_t row);
+	// Puts a machine holding a craft on the timer wheel, due when its progress since startTick reaches 1.
+	void schedule(uint32_t recipe, uint32_t row);
+	// Stops a running machine's craft where it is, leaving its timer stale.
+	void pause(uint32_t recipe, uint32_t row);
+	void completeGroup(uint32_t recipe);
+	// Finishes the crafts a suspended machine's timer would have finished up to now.
+	void advanceSuspended(uint32_t recipe, uint32_t row);
+	// Starts a suspended machine's next craft now if it isn't holding one and can, as a running one would on the event.
+	void startSuspended(uint32_t recipe, uint32_t row);
+	float getCraftRate(uint32_t recipe, uint32_t row);
+	uint64_t getFinishTick(const sRecipeGroup& group, uint32_t row);
+	float getCurrentProgress(const sRecipeGroup& group, uint32_t row);
+};
\ No newline at end of file
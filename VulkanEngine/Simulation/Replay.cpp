@@ -0,0 +1,175 @@
+#include "Replay.h"
+
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+
+
+
+void Replay::record(uint64_t tick, const sPlayerCommand& command)
+{
+	if (!m_commandTicks.empty() && tick < m_commandTicks.back().tick) throw std::runtime_error("replay commands recorded out of order!");
+
+	if (m_commandTicks.empty() || m_commandTicks.back().tick != tick) m_commandTicks.push_back({ .tick = tick, .first = static_cast<uint32_t>(m_commands.size()) });
+	m_commandTicks.back().count++;
+	m_commands.push_back(command);
+}
+
+void Replay::recordHash(uint64_t tick, uint64_t hash)
+{
+	if (tick != m_firstTick + m_hashes.size()) throw std::runtime_error("replay hashes recorded out of order!");
+	m_hashes.push_back(hash);
+}
+
+std::span<const sPlayerCommand> Replay::getCommands(uint64_t tick)
+{
+	auto it = std::lower_bound(m_commandTicks.begin(), m_commandTicks.end(), tick, [](const sCommandTick& entry, uint64_t value) { return entry.tick < value; });
+	if (it == m_commandTicks.end() || it->tick != tick) return {};
+	return std::span<const sPlayerCommand>(m_commands.data() + it->first, it->count);
+}
+
+
+
+void Replay::save(const std::string& path)
+{
+	std::vector<uint8_t> bytes;
+	writeVarint(bytes, MAGIC);
+	writeVarint(bytes, VERSION);
+	writeVarint(bytes, m_ticksPerSecond);
+	writeVarint(bytes, m_firstTick);
+	writeVarint(bytes, m_hashes.size());
+	writeVarint(bytes, m_commandTicks.size());
+
+	uint64_t previousTick = 0;
+	for (const sCommandTick& entry : m_commandTicks)
+	{
+		writeVarint(bytes, entry.tick - previousTick);
+		writeVarint(bytes, entry.count);
+		previousTick = entry.tick;
+
+		for (uint32_t i = entry.first; i < entry.first + entry.count; i++)
+		{
+			const sPlayerCommand& command = m_commands[i];
+			bytes.push_back(command.type);
+			switch (command.type)
+			{
+			case sPlayerCommand::ADD_MACHINE:
+				writeVarint(bytes, command.target);
+				writeVarint(bytes, command.count);
+				[[fallthrough]];
+			case sPlayerCommand::SET_FOCUS:
+				writeVarint(bytes, zigzag(command.position.x));
+				writeVarint(bytes, zigzag(command.position.y));
+				writeVarint(bytes, zigzag(command.position.z));
+				break;
+			case sPlayerCommand::REMOVE_MACHINE:
+				writeVarint(bytes, command.target);
+				break;
+			default:
+				writeVarint(bytes, command.target);
+				writeVarint(bytes, command.item);
+				writeVarint(bytes, command.count);
+				break;
+			}
+		}
+	}
+
+	// Hashes are effectively random, so they go in raw rather than as varints
+	for (uint64_t hash : m_hashes)
+	{
+		for (uint32_t shift = 0; shift < 64; shift += 8) bytes.push_back(static_cast<uint8_t>(hash >> shift));
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) throw std::runtime_error("failed to open replay file for writing!");
+	file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	if (!file) throw std::runtime_error("failed to write replay file!");
+}
+
+Replay Replay::load(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) throw std::runtime_error("failed to open replay file!");
+	std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	size_t offset = 0;
+	if (readVarint(bytes, offset) != MAGIC) throw std::runtime_error("not a replay file!");
+	uint64_t version = readVarint(bytes, offset);
+	if (version == 0 || version > VERSION) throw std::runtime_error("unsupported replay version!");
+
+	// Version 1 recordings always started at tick 1
+	uint32_t ticksPerSecond = static_cast<uint32_t>(readVarint(bytes, offset));
+	if (ticksPerSecond == 0) throw std::runtime_error("malformed replay tick rate!");
+	uint64_t firstTick = (version >= 2) ? readVarint(bytes, offset) : 1;
+	if (firstTick == 0) throw std::runtime_error("malformed replay first tick!");
+	Replay replay(ticksPerSecond, firstTick);
+	uint64_t tickCount = readVarint(bytes, offset);
+	uint64_t commandTickCount = readVarint(bytes, offset);
+
+	uint64_t tick = 0;
+	for (uint64_t i = 0; i < commandTickCount; i++)
+	{
+		tick += readVarint(bytes, offset);
+		uint64_t count = readVarint(bytes, offset);
+		for (uint64_t j = 0; j < count; j++)
+		{
+			if (offset >= bytes.size() || bytes[offset] >= sPlayerCommand::TYPE_COUNT) throw std::runtime_error("malformed replay command!");
+
+			sPlayerCommand command{ .type = static_cast<sPlayerCommand::eType>(bytes[offset++]) };
+			switch (command.type)
+			{
+			case sPlayerCommand::ADD_MACHINE:
+				command.target = static_cast<uint32_t>(readVarint(bytes, offset));
+				command.count = static_cast<uint32_t>(readVarint(bytes, offset));
+				[[fallthrough]];
+			case sPlayerCommand::SET_FOCUS:
+				command.position.x = unzigzag(readVarint(bytes, offset));
+				command.position.y = unzigzag(readVarint(bytes, offset));
+				command.position.z = unzigzag(readVarint(bytes, offset));
+				break;
+			case sPlayerCommand::REMOVE_MACHINE:
+				command.target = static_cast<uint32_t>(readVarint(bytes, offset));
+				break;
+			default:
+				command.target = static_cast<uint32_t>(readVarint(bytes, offset));
+				command.item = static_cast<uint32_t>(readVarint(bytes, offset));
+				command.count = static_cast<uint32_t>(readVarint(bytes, offset));
+				break;
+			}
+			replay.record(tick, command);
+		}
+	}
+
+	if (bytes.size() - offset != tickCount * 8) throw std::runtime_error("replay file is truncated!");
+	for (uint64_t t = firstTick; t < firstTick + tickCount; t++)
+	{
+		uint64_t hash = 0;
+		for (uint32_t shift = 0; shift < 64; shift += 8) hash |= static_cast<uint64_t>(bytes[offset++]) << shift;
+		replay.recordHash(t, hash);
+	}
+	return replay;
+}
+
+void Replay::writeVarint(std::vector<uint8_t>& bytes, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		bytes.push_back(static_cast<uint8_t>(value) | 0x80);
+		value >>= 7;
+	}
+	bytes.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t Replay::readVarint(const std::vector<uint8_t>& bytes, size_t& offset)
+{
+	uint64_t value = 0;
+	for (uint32_t shift = 0; shift < 64; shift += 7)
+	{
+		if (offset >= bytes.size()) throw std::runtime_error("replay file is truncated!");
+
+		uint8_t byte = bytes[offset++];
+		value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) return value;
+	}
+	throw std::runtime_error("malformed varint in replay file!");
+}
\ No newline at end of file
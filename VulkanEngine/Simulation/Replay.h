@@ -0,0 +1,80 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include <glm/glm.hpp>
+
+
+
+// A player action, applied by the simulation at the start of a tick. Every change a player makes to the factory
+// goes through one of these, so recording them per tick is enough to reproduce a session exactly.
+struct sPlayerCommand
+{
+	enum eType : uint8_t
+	{
+		ADD_MACHINE, // target = recipe, count = crafting speed in thousandths, position
+		REMOVE_MACHINE, // target = machine
+		INSERT_ITEM, // target = machine, item, count
+		TAKE_OUTPUT, // target = machine, item = output slot, count
+		SET_FOCUS, // position
+		TYPE_COUNT
+	};
+
+	eType type = ADD_MACHINE;
+	uint32_t target = 0;
+	uint32_t item = 0;
+	uint32_t count = 0;
+	glm::ivec3 position = {};
+};
+
+
+// Player commands per tick, plus a hash of the simulation state after every tick. Saved as a compact binary
+// file: commands are varint-encoded with only the fields their type uses, and ticks without any cost nothing.
+class Replay
+{
+public:
+	static constexpr uint32_t MAGIC = 0x50524c45; // "ELRP"
+	static constexpr uint32_t VERSION = 2;
+
+	// A recording started partway through a session begins at a later tick.
+	Replay(uint32_t ticksPerSecond, uint64_t firstTick = 1) : m_ticksPerSecond(ticksPerSecond), m_firstTick(firstTick) {};
+
+	// Ticks must be recorded in order, starting at the first tick.
+	void record(uint64_t tick, const sPlayerCommand& command);
+	void recordHash(uint64_t tick, uint64_t hash);
+
+	// Both throw on I/O errors or a malformed file.
+	void save(const std::string& path);
+	static Replay load(const std::string& path);
+
+	std::span<const sPlayerCommand> getCommands(uint64_t tick);
+	uint64_t getHash(uint64_t tick) { return m_hashes[tick - m_firstTick]; }
+	uint64_t getFirstTick() { return m_firstTick; }
+	uint64_t getTickCount() { return m_hashes.size(); }
+	uint32_t getTicksPerSecond() { return m_ticksPerSecond; }
+	size_t getCommandCount() { return m_commands.size(); }
+
+private:
+	struct sCommandTick
+	{
+		uint64_t tick = 0;
+		uint32_t first = 0; // Into m_commands
+		uint32_t count = 0;
+	};
+
+	uint32_t m_ticksPerSecond = 60;
+	uint64_t m_firstTick = 1;
+	std::vector<sPlayerCommand> m_commands = {};
+	std::vector<sCommandTick> m_commandTicks = {}; // Ascending, only ticks that have commands
+	std::vector<uint64_t> m_hashes = {}; // Index = tick - m_firstTick
+
+
+	static void writeVarint(std::vector<uint8_t>& bytes, uint64_t value);
+	static uint64_t readVarint(const std::vector<uint8_t>& bytes, size_t& offset);
+	static uint64_t zigzag(int32_t value) { return (static_cast<uint64_t>(static_cast<uint32_t>(value)) << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(value) >> 63); }
+	static int32_t unzigzag(uint64_t value) { return static_cast<int32_t>(static_cast<uint32_t>(value >> 1) ^ (0u - static_cast<uint32_t>(value & 1))); }
+};
\ No newline at end of file
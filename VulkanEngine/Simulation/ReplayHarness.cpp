@@ -0,0 +1,109 @@
+#include "ReplayHarness.h"
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+
+
+bool ReplayHarness::run(const std::string& path, sSettings::sSimulationSettings* pSettings)
+{
+	using Clock = std::chrono::steady_clock;
+
+	Replay replay = Replay::load(path);
+	print(std::format("Replaying {} ticks and {} commands from {}...", replay.getTickCount(), replay.getCommandCount(), path));
+
+	// Replays start from an empty factory, so one recorded partway through a session has nothing to start from
+	if (replay.getFirstTick() != 1)
+	{
+		print(std::format("Replay starts at tick {}, without the state before it!", replay.getFirstTick()));
+		return false;
+	}
+
+	// Same settings as the game, but at the tick rate the replay was recorded at
+	sSettings::sSimulationSettings settings = *pSettings;
+	settings.ticksPerSecond = replay.getTicksPerSecond();
+	settings.replayRecordPath = nullptr;
+	Simulation simulation(&settings);
+
+	std::vector<double> tickTimes;
+	tickTimes.reserve(replay.getTickCount());
+	uint64_t mismatches = 0;
+	uint64_t firstMismatch = 0;
+	for (uint64_t tick = 1; tick <= replay.getTickCount(); tick++)
+	{
+		for (const sPlayerCommand& command : replay.getCommands(tick)) simulation.submitCommand(command);
+
+		auto start = Clock::now();
+		simulation.step();
+		tickTimes.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+
+		if (simulation.hashState() != replay.getHash(tick))
+		{
+			if (mismatches == 0) firstMismatch = tick;
+			mismatches++;
+		}
+	}
+	if (tickTimes.empty()) return true;
+
+	double totalTime = 0.0;
+	for (double time : tickTimes) totalTime += time;
+	std::sort(tickTimes.begin(), tickTimes.end());
+	auto percentile = [&tickTimes](double fraction) { return tickTimes[std::min(tickTimes.size() - 1, static_cast<size_t>(fraction * tickTimes.size()))] * 1e3; };
+
+	print(std::format("{:.1f} UPS ({:.1f}x real time)", tickTimes.size() / totalTime, tickTimes.size() / totalTime / replay.getTicksPerSecond()));
+	print(std::format("Tick time: p50 {:.3f} ms, p90 {:.3f} ms, p99 {:.3f} ms, p99.9 {:.3f} ms, max {:.3f} ms", percentile(0.5), percentile(0.9), percentile(0.99), percentile(0.999), tickTimes.back() * 1e3));
+	if (mismatches == 0) print("State hashes match the recording on every tick.");
+	else print(std::format("State hash mismatch on {} ticks, first at tick {}!", mismatches, firstMismatch));
+	return mismatches == 0;
+}
+
+void ReplayHarness::recordSynthetic(const std::string& path, uint64_t ticks, sSettings::sSimulationSettings* pSettings)
+{
+	const uint32_t machineCount = 20000;
+	const int32_t chunksPerSide = 16;
+
+	sSettings::sSimulationSettings settings = *pSettings;
+	settings.replayRecordPath = nullptr;
+	Simulation simulation(&settings);
+	RecipeBook* pRecipes = simulation.getRecipes();
+	std::mt19937 random(1234);
+
+	print(std::format("Recording a synthetic replay of {} ticks to {}...", ticks, path));
+	simulation.startRecording();
+
+	// Machine IDs are handed out in order, so the commands can refer to machines added by earlier ones
+	for (uint32_t machine = 0; machine < machineCount; machine++)
+	{
+		uint32_t chunk = machine % (chunksPerSide * chunksPerSide);
+		glm::ivec3 position((chunk % chunksPerSide) * SimulationLOD::CHUNK_SIZE, (chunk / chunksPerSide) * SimulationLOD::CHUNK_SIZE, 0);
+		simulation.submitCommand({ .type = sPlayerCommand::ADD_MACHINE, .target = machine % pRecipes->getRecipeCount(), .count = (machine % 3 == 0) ? 750u : 1250u, .position = position });
+	}
+
+	for (uint64_t tick = 1; tick <= ticks; tick++)
+	{
+		// Every tick a handful of machines get restocked and emptied, like inserters feeding them
+		for (uint32_t i = 0; i < 20; i++)
+		{
+			uint32_t machine = random() % machineCount;
+			const RecipeBook::sCompiledRecipe& recipe = pRecipes->getRecipe(machine % pRecipes->getRecipeCount());
+			for (uint32_t slot = 0; slot < RecipeBook::MAX_INPUTS; slot++)
+			{
+				if (recipe.inputItems[slot] == RecipeBook::NO_ITEM) continue;
+				simulation.submitCommand({ .type = sPlayerCommand::INSERT_ITEM, .target = machine, .item = recipe.inputItems[slot], .count = 50 });
+			}
+			simulation.submitCommand({ .type = sPlayerCommand::TAKE_OUTPUT, .target = machine, .item = 0, .count = 100 });
+		}
+
+		if (tick % 600 == 0)
+		{
+			glm::ivec3 focus(static_cast<int32_t>(random() % (chunksPerSide * SimulationLOD::CHUNK_SIZE)), static_cast<int32_t>(random() % (chunksPerSide * SimulationLOD::CHUNK_SIZE)), 0);
+			simulation.submitCommand({ .type = sPlayerCommand::SET_FOCUS, .position = focus });
+		}
+
+		simulation.step();
+	}
+
+	simulation.saveRecording(path);
+}
\ No newline at end of file
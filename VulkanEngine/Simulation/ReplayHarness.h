@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+#include "../Utilities/Utilities.h"
+#include "Simulation.h"
+#include "Replay.h"
+
+
+
+// Runs the simulation headlessly, with no window or Vulkan device: the regression benchmark for simulation code.
+// A replay is fed back tick by tick as fast as possible while the state hash is checked against the recording.
+class ReplayHarness
+{
+public:
+	// Prints UPS, tick time percentiles and hash mismatches. Returns false if any tick's hash differed.
+	static bool run(const std::string& path, sSettings::sSimulationSettings* pSettings);
+	// Records a reproducible workload: a factory spread over many chunks, built and then fed and emptied by
+	// player commands while the focus wanders around it.
+	static void recordSynthetic(const std::string& path, uint64_t ticks, sSettings::sSimulationSettings* pSettings);
+
+private:
+	static void print(std::string message) { Utilities::debugPrint(message, std::string("ReplayHarness")); }
+};
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include "Simulation.h"
+
+#include <memory>
+
+
+
+Simulation::Simulation(sSettings::sSimulationSettings* pSettings) : m_pUtilities(Utilities::getInstance()), m_pSettings(pSettings)
+{
+	m_tickDelta = std::chrono::duration<double>(1.0 / m_pSettings->ticksPerSecond);
+
+	m_recipes.registerDefaults();
+	m_recipes.compile();
+
+	m_pThreadPool = new ThreadPool(m_pSettings->workerThreads, 2);
+}
+
+Simulation::~Simulation()
+{
+	stop();
+	delete m_pThreadPool;
+	delete m_pReplay;
+}
+
+void Simulation::start()
+{
+	mDebugPrint(std::format("Starting simulation at {} UPS...", m_pSettings->ticksPerSecond));
+
+	// Publish the initial state so the renderer has something to read before the first tick
+	m_nextTickTime = Clock::now();
+	m_snapshots.getWriteBuffer() = { .tick = 0, .tickTime = m_nextTickTime, .previous = m_state, .current = m_state };
+	m_snapshots.publish();
+
+	mDebugPrint(std::format("Simulation worker threads: {}", m_pThreadPool->getThreadCount()));
+	if (m_pSettings->replayRecordPath != nullptr) startRecording();
+
+	m_running = true;
+	m_thread = std::thread(&Simulation::run, this);
+}
+
+void Simulation::stop()
+{
+	if (!m_running) return;
+
+	mDebugPrint("Stopping simulation...");
+	m_running = false;
+	if (m_thread.joinable()) m_thread.join();
+
+	if (m_pSettings->replayRecordPath == nullptr || m_pReplay == nullptr) return;
+
+	// Also called from the destructor, so a replay that can't be written is reported rather than thrown
+	try
+	{
+		saveRecording(m_pSettings->replayRecordPath);
+	}
+	catch (const std::exception& exception)
+	{
+		mDebugPrint(std::format("Failed to save the replay: {}", exception.what()));
+	}
+}
+
+void Simulation::step()
+{
+	if (m_running) throw std::runtime_error("tried to step a running simulation!");
+	tick();
+}
+
+void Simulation::submitCommand(const sPlayerCommand& command)
+{
+	std::lock_guard<std::mutex> lock(m_commandMutex);
+	m_pendingCommands.push_back(command);
+}
+
+void Simulation::pushInput(const sInputEvent& event)
+{
+	if (!m_inputEvents.push(event)) m_droppedInputs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Simulation::startRecording()
+{
+	delete m_pReplay;
+	m_pReplay = new Replay(m_pSettings->ticksPerSecond, m_tickCount.load(std::memory_order_relaxed) + 1);
+	mDebugPrint("Recording replay...");
+}
+
+void Simulation::saveRecording(const std::string& path)
+{
+	if (m_pReplay == nullptr) throw std::runtime_error("tried to save a replay that was never recorded!");
+
+	mDebugPrint(std::format("Saving replay of {} ticks and {} commands to {}...", m_pReplay->getTickCount(), m_pReplay->getCommandCount(), path));
+	// Recording stops and the replay is freed even if it can't be written
+	std::unique_ptr<Replay> pReplay(m_pReplay);
+	m_pReplay = nullptr;
+	pReplay->save(path);
+}
+
+uint64_t Simulation::hashState()
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * 1099511628211ull; };
+
+	mix(m_machines.hashState());
+	mix(m_belts.hashState());
+	mix(m_electricity.hashState());
+	mix(m_fluids.hashState());
+	mix(m_world.hashState());
+	mix(m_crowd.hashState());
+	return hash;
+}
+
+
+
+void Simulation::run()
+{
+	auto tickDelta = std::chrono::duration_cast<Clock::duration>(m_tickDelta);
+
+	while (m_running)
+	{
+		// Run every tick that is due, but never more than the catch-up limit in one go
+		uint32_t ticksRun = 0;
+		while (Clock::now() >= m_nextTickTime && ticksRun < m_pSettings->maxCatchUpTicks)
+		{
+			auto tickStart = Clock::now();
+			tick();
+			double tickTime = std::chrono::duration<double>(Clock::now() - tickStart).count();
+			m_averageTickTime.store(m_averageTickTime.load(std::memory_order_relaxed) * 0.95 + tickTime * 0.05, std::memory_order_relaxed);
+
+			m_snapshots.getWriteBuffer() = { .tick = m_tickCount.load(std::memory_order_relaxed), .tickTime = m_nextTickTime, .previous = m_previousState, .current = m_state };
+			m_snapshots.publish();
+
+			m_nextTickTime += tickDelta;
+			ticksRun++;
+		}
+
+		// Still behind after catching up: drop the backlog instead of spiralling
+		if (Clock::now() >= m_nextTickTime)
+		{
+			auto behind = Clock::now() - m_nextTickTime;
+			uint64_t dropped = static_cast<uint64_t>(behind / tickDelta) + 1;
+			m_droppedTicks.fetch_add(dropped, std::memory_order_relaxed);
+			m_nextTickTime += tickDelta * dropped;
+		}
+
+		std::this_thread::sleep_until(m_nextTickTime);
+	}
+}
+
+void Simulation::tick()
+{
+	m_previousState = m_state;
+	drainInput();
+	for (const sInputEvent& input : m_tickInput) applyInput(input);
+	uint64_t tickIndex = m_tickCount.load(std::memory_order_relaxed) + 1;
+
+	// Player commands land at the start of the tick, in the order they were submitted
+	{
+		std::lock_guard<std::mutex> lock(m_commandMutex);
+		m_tickCommands.swap(m_pendingCommands);
+	}
+	for (const sPlayerCommand& command : m_tickCommands)
+	{
+		if (m_pReplay != nullptr) m_pReplay->record(tickIndex, command);
+		applyCommand(command);
+	}
+	m_tickCommands.clear();
+	m_pathfinder.update();
+	m_flowFields.update();
+
+	float tickDelta = static_cast<float>(m_tickDelta.count());
+	if (m_modelSpinning) m_state.modelRotation = std::fmod(m_state.modelRotation + tickDelta * glm::radians(120.0f), glm::two_pi<float>());
+	// Keep the angle continuous across the wrap so interpolation doesn't spin backwards
+	if (m_state.modelRotation < m_previousState.modelRotation) m_previousState.modelRotation -= glm::two_pi<float>();
+
+	m_electricity.tick(tickDelta);
+	FactorySystems::updatePower(m_world, m_electricity);
+	FactorySystems::updateCrafters(m_world, tickDelta);
+	m_lod.tick();
+	m_machines.tick();
+	m_belts.tick(m_pThreadPool);
+	m_fluids.tick(m_pThreadPool);
+	m_crowd.tick(tickDelta, m_pThreadPool);
+
+	if (m_pReplay != nullptr) m_pReplay->recordHash(tickIndex, hashState());
+	m_tickCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Simulation::drainInput()
+{
+	m_tickInput.clear();
+	sInputEvent event;
+	while (m_inputEvents.pop(event)) m_tickInput.push_back(event);
+	if (m_tickInput.empty()) return;
+
+	auto now = Clock::now();
+	double average = m_averageInputLatency.load(std::memory_order_relaxed);
+	double worst = 0.0;
+	for (const sInputEvent& input : m_tickInput)
+	{
+		double latency = std::chrono::duration<double>(now - input.time).count();
+		average = average * 0.95 + latency * 0.05;
+		worst = std::max(worst, latency);
+	}
+	m_averageInputLatency.store(average, std::memory_order_relaxed);
+	// Only raise it, the render thread resets it when it reads it
+	double previous = m_maxInputLatency.load(std::memory_order_relaxed);
+	while (previous < worst && !m_maxInputLatency.compare_exchange_weak(previous, worst, std::memory_order_relaxed));
+}
+
+void Simulation::applyInput(const sInputEvent& input)
+{
+	// Raw input isn't recorded in replays, so it only steers presentation state. Factory changes go through player commands.
+	if (input.type == sInputEvent::KEY && input.code == GLFW_KEY_SPACE && input.action == GLFW_PRESS) m_modelSpinning = !m_modelSpinning;
+}
+
+void Simulation::applyCommand(const sPlayerCommand& command)
+{
+	// Commands come from players and replay files, so anything that doesn't refer to a live target is dropped
+	switch (command.type)
+	{
+	case sPlayerCommand::ADD_MACHINE:
+	{
+		if (command.target >= m_recipes.getRecipeCount() || command.count == 0) break;
+		uint32_t machine = m_machines.addMachine(command.target, static_cast<float>(command.count) / 1000.0f);
+		m_lod.addMachine(machine, command.position);
+		break;
+	}
+	case sPlayerCommand::REMOVE_MACHINE:
+		if (!m_machines.isMachine(command.target)) break;
+		m_lod.removeMachine(command.target);
+		m_machines.removeMachine(command.target);
+		break;
+	case sPlayerCommand::INSERT_ITEM:
+		if (!m_machines.isMachine(command.target) || command.item >= RecipeBook::NO_ITEM) break;
+		m_machines.insertItem(command.target, static_cast<uint16_t>(command.item), static_cast<uint16_t>(std::min<uint32_t>(command.count, UINT16_MAX)));
+		break;
+	case sPlayerCommand::TAKE_OUTPUT:
+		if (!m_machines.isMachine(command.target) || command.item >= RecipeBook::MAX_OUTPUTS) break;
+		m_machines.takeOutput(command.target, command.item, static_cast<uint16_t>(std::min<uint32_t>(command.count, UINT16_MAX)));
+		break;
+	case sPlayerCommand::SET_FOCUS:
+		m_lod.setFocus(command.position);
+		break;
+	default:
+		break;
+	}
+}
+
+
+
+Simulation::sSimulationState Simulation::getInterpolatedState(Clock::time_point renderTime)
+{
+	m_snapshots.acquire();
+	const sRenderSnapshot& snapshot = m_snapshots.getReadBuffer();
+
+	// Rendering runs one tick behind the simulation, blending from the previous tick towards the current one
+	float alpha = static_cast<float>(std::chrono::duration<double>(renderTime - snapshot.tickTime) / m_tickDelta);
+	alpha = std::clamp(alpha, 0.0f, 1.0f);
+
+	return sSimulationState{
+		.modelRotation = interpolate(snapshot.previous.modelRotation, snapshot.current.modelRotation, alpha)
+	};
+}
\ No newline at end of file
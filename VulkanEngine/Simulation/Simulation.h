@@ -0,0 +1,173 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "../Utilities/Utilities.h"
+#include "../Utilities/TripleBuffer.h"
+#include "../Utilities/SPSCRing.h"
+#include "../Utilities/ThreadPool.h"
+#include "ECS.h"
+#include "Factory.h"
+#include "Belts.h"
+#include "Fluids.h"
+#include "Recipes.h"
+#include "LOD.h"
+#include "Replay.h"
+#include "Navigation.h"
+#include "Pathfinding.h"
+#include "FlowFields.h"
+
+
+
+// Runs game logic on its own thread at a fixed tick rate, independent of the render frame rate.
+// After every tick an immutable snapshot of the state is published through a lock-free triple buffer;
+// the render thread picks up the newest one and interpolates between its previous and current state.
+class Simulation
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// Everything the renderer needs from the simulation. Must be cheap to copy and interpolate.
+	struct sSimulationState
+	{
+		float modelRotation = 0.0f; // Radians
+	};
+
+	struct sRenderSnapshot
+	{
+		uint64_t tick = 0;
+		Clock::time_point tickTime = {}; // Scheduled time of the tick that produced `current`
+		sSimulationState previous = {};
+		sSimulationState current = {};
+	};
+
+	// A raw window input, stamped when the window thread received it. Codes are GLFW's.
+	struct sInputEvent
+	{
+		enum eType : uint8_t
+		{
+			KEY,
+			MOUSE_BUTTON,
+			CURSOR,
+			SCROLL
+		};
+
+		eType type = KEY;
+		int32_t code = 0; // Key or mouse button
+		int32_t action = 0; // Press, release or repeat
+		int32_t mods = 0;
+		glm::dvec2 value = {}; // Cursor position or scroll offset
+		Clock::time_point time = {};
+	};
+
+	Simulation(sSettings::sSimulationSettings* pSettings);
+	~Simulation();
+
+	void start();
+	// Saves the replay being recorded to replayRecordPath, if set. Failing to save is logged, not thrown.
+	void stop();
+	// Runs one tick on the calling thread. For headless runs only, never while started.
+	void step();
+
+	// Any thread. Queues a player command for the start of the next tick.
+	void submitCommand(const sPlayerCommand& command);
+	// Window thread only. Queues an input for the next tick without blocking; drops it if the queue is full.
+	void pushInput(const sInputEvent& event);
+	// Records every tick's commands and resulting state hash from the next tick on.
+	void startRecording();
+	// Writes the recording to a file and stops recording. Throws on I/O errors.
+	void saveRecording(const std::string& path);
+	// Simulation thread only, or while stopped. Hash of everything the commands can affect.
+	uint64_t hashState();
+
+	// Render thread only. Returns the state interpolated between the last two ticks at the given time.
+	sSimulationState getInterpolatedState(Clock::time_point renderTime);
+
+	double getTickDelta() { return m_tickDelta.count(); }
+	double getAverageTickTime() { return m_averageTickTime.load(std::memory_order_relaxed); }
+	uint64_t getTickCount() { return m_tickCount.load(std::memory_order_relaxed); }
+	uint64_t getDroppedTickCount() { return m_droppedTicks.load(std::memory_order_relaxed); }
+	// Time from the window receiving an input to the tick that handles it, in seconds.
+	double getAverageInputLatency() { return m_averageInputLatency.load(std::memory_order_relaxed); }
+	// Worst input latency since the last call, in seconds.
+	double takeMaxInputLatency() { return m_maxInputLatency.exchange(0.0, std::memory_order_relaxed); }
+	uint64_t getDroppedInputCount() { return m_droppedInputs.load(std::memory_order_relaxed); }
+
+	// Simulation thread only, or before start().
+	World* getWorld() { return &m_world; }
+	BeltNetwork* getBelts() { return &m_belts; }
+	ElectricNetwork* getElectricity() { return &m_electricity; }
+	FluidNetwork* getFluids() { return &m_fluids; }
+	RecipeBook* getRecipes() { return &m_recipes; }
+	CraftingMachines* getMachines() { return &m_machines; }
+	SimulationLOD* getLOD() { return &m_lod; }
+	NavigationGrid* getNavigation() { return &m_navigation; }
+	HierarchicalPathfinder* getPathfinder() { return &m_pathfinder; }
+	Crowd* getCrowd() { return &m_crowd; }
+	// Inputs handled this tick, oldest first.
+	const std::vector<sInputEvent>& getTickInput() { return m_tickInput; }
+	ThreadPool* getThreadPool() { return m_pThreadPool; }
+
+private:
+	Utilities* m_pUtilities = nullptr;
+	sSettings::sSimulationSettings* m_pSettings = nullptr;
+
+	std::thread m_thread;
+	ThreadPool* m_pThreadPool = nullptr;
+	std::atomic<bool> m_running = false;
+
+	std::mutex m_commandMutex;
+	std::vector<sPlayerCommand> m_pendingCommands = {}; // Guarded by m_commandMutex
+	std::vector<sPlayerCommand> m_tickCommands = {};
+	Replay* m_pReplay = nullptr;
+
+	SPSCRing<sInputEvent, 1024> m_inputEvents = {}; // Window thread to simulation thread
+	std::vector<sInputEvent> m_tickInput = {};
+
+	std::chrono::duration<double> m_tickDelta = {};
+	Clock::time_point m_nextTickTime = {};
+
+	// Simulation thread state
+	World m_world = {};
+	BeltNetwork m_belts = {};
+	ElectricNetwork m_electricity = {};
+	FluidNetwork m_fluids = {};
+	RecipeBook m_recipes = {};
+	CraftingMachines m_machines = CraftingMachines(&m_recipes, 1.0f / m_pSettings->ticksPerSecond);
+	SimulationLOD m_lod = SimulationLOD(&m_machines, m_pSettings->lodRadius);
+	NavigationGrid m_navigation = NavigationGrid(m_pSettings->navigationChunks, m_pSettings->navigationChunks);
+	HierarchicalPathfinder m_pathfinder = HierarchicalPathfinder(&m_navigation);
+	FlowFields m_flowFields = FlowFields(&m_navigation);
+	Crowd m_crowd = Crowd(&m_flowFields);
+	sSimulationState m_state = {};
+	sSimulationState m_previousState = {};
+	bool m_modelSpinning = true; // Toggled with space
+
+	TripleBuffer<sRenderSnapshot> m_snapshots = {};
+
+	// Statistics, written by the simulation thread
+	std::atomic<uint64_t> m_tickCount = 0;
+	std::atomic<uint64_t> m_droppedTicks = 0;
+	std::atomic<double> m_averageTickTime = 0.0; // Seconds, exponential moving average
+	std::atomic<double> m_averageInputLatency = 0.0; // Seconds, exponential moving average
+	std::atomic<double> m_maxInputLatency = 0.0;
+	std::atomic<uint64_t> m_droppedInputs = 0;
+
+
+	void run();
+	void tick();
+	void drainInput();
+	void applyInput(const sInputEvent& input);
+	void applyCommand(const sPlayerCommand& command);
+	static float interpolate(float previous, float current, float alpha) { return previous + (current - previous) * alpha; }
+};
\ No newline at end of file
@@ -0,0 +1,668 @@
+#include "SimulationBenchmarks.h"
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <queue>
+
+#include "ECS.h"
+#include "Factory.h"
+#include "Belts.h"
+#include "Electric.h"
+#include "Fluids.h"
+#include "Recipes.h"
+#include "LOD.h"
+#include "Navigation.h"
+#include "Pathfinding.h"
+#include "FlowFields.h"
+#include "../Utilities/ThreadPool.h"
+
+
+
+// The object-per-machine layout the ECS replaces: one heap allocation per machine, a vtable, and every
+// field of the machine pulled into cache even when the tick only needs two of them.
+class LegacyMachine
+{
+public:
+	virtual ~LegacyMachine() = default;
+
+	virtual void tick(float tickDelta)
+	{
+		m_crafter.progress += m_crafter.speed * m_power.satisfaction * tickDelta;
+		if (m_crafter.progress >= 1.0f)
+		{
+			m_crafter.progress -= 1.0f;
+			m_crafter.craftsCompleted++;
+		}
+	}
+
+	sTransform m_transform = {};
+	std::string m_name = "Assembler";
+	float m_inventory[16] = {};
+	sCrafter m_crafter = {};
+	sPowerConsumer m_power = {};
+};
+
+
+
+void SimulationBenchmarks::runAll()
+{
+	print("Running simulation benchmarks...");
+	benchmarkECS(100000, 200);
+	benchmarkBelts(1000000, 600);
+	benchmarkElectric(100000, 600);
+	benchmarkFluids(5000, 600);
+	benchmarkCrafting(100000, 600);
+	benchmarkScheduler(10000, 600);
+	benchmarkLOD(100000, 3600);
+	benchmarkPathfinding(10000);
+	benchmarkFlowFields(10000, 600);
+}
+
+void SimulationBenchmarks::benchmarkECS(uint32_t entityCount, uint32_t ticks)
+{
+	using Clock = std::chrono::steady_clock;
+	const float tickDelta = 1.0f / 60.0f;
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> speedDistribution(0.5f, 2.0f);
+
+	// Build both layouts with identical data
+	World world;
+	std::vector<std::unique_ptr<LegacyMachine>> machines;
+	std::vector<std::unique_ptr<char[]>> heapNoise; // Interleaved allocations so the machines don't end up contiguous by luck
+	machines.reserve(entityCount);
+	for (uint32_t i = 0; i < entityCount; i++)
+	{
+		float speed = speedDistribution(random);
+		sTransform transform{ .position = glm::ivec3(i % 1000, i / 1000, 0) };
+		sCrafter crafter{ .speed = speed };
+		sPowerConsumer power{ .demand = 75000.0f, .satisfaction = (i % 7 == 0) ? 0.5f : 1.0f };
+
+		world.createEntity(transform, crafter, power);
+
+		auto machine = std::make_unique<LegacyMachine>();
+		machine->m_transform = transform;
+		machine->m_crafter = crafter;
+		machine->m_power = power;
+		machines.push_back(std::move(machine));
+		heapNoise.push_back(std::make_unique<char[]>(64 + random() % 256));
+	}
+	// Entities get created and destroyed in arbitrary order over a session, so visit objects in a scattered order
+	std::shuffle(machines.begin(), machines.end(), random);
+	heapNoise.clear();
+
+	auto start = Clock::now();
+	for (uint32_t t = 0; t < ticks; t++) FactorySystems::updateCrafters(world, tickDelta);
+	double ecsTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	start = Clock::now();
+	for (uint32_t t = 0; t < ticks; t++)
+		for (auto& machine : machines) machine->tick(tickDelta);
+	double objectTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	// Checksums keep both loops from being optimised away and show the results agree
+	uint64_t ecsCrafts = 0, objectCrafts = 0;
+	world.each<sCrafter>([&ecsCrafts](sCrafter& crafter) { ecsCrafts += crafter.craftsCompleted; });
+	for (auto& machine : machines) objectCrafts += machine->m_crafter.craftsCompleted;
+
+	double ecsNs = ecsTime * 1e9 / (static_cast<double>(entityCount) * ticks);
+	double objectNs = objectTime * 1e9 / (static_cast<double>(entityCount) * ticks);
+	print(std::format("ECS: {} entities x {} ticks, {:.2f} ns/entity/tick ({} crafts)", entityCount, ticks, ecsNs, ecsCrafts));
+	print(std::format("Heap objects: {} entities x {} ticks, {:.2f} ns/entity/tick ({} crafts)", entityCount, ticks, objectNs, objectCrafts));
+	print(std::format("ECS speedup: {:.2f}x", objectNs / ecsNs));
+}
+
+void SimulationBenchmarks::benchmarkBelts(uint32_t itemCount, uint32_t ticks)
+{
+	using Clock = std::chrono::steady_clock;
+	const uint32_t lineTiles = 100;
+	const uint32_t itemsPerLine = 100; // Loosely packed so lines keep moving, with some compressing behind merges
+	const uint32_t linesPerRing = 4;
+	uint32_t ringCount = std::max(1u, itemCount / (itemsPerLine * linesPerRing));
+
+	// Rings of four lines: 0 -> 1 -> splitter -> (2, 3) -> 3 side-loads onto 0, 2 merges into 0's start.
+	// Every ring is its own island.
+	auto buildNetwork = [&](BeltNetwork& belts)
+	{
+		for (uint32_t ring = 0; ring < ringCount; ring++)
+		{
+			uint32_t lines[linesPerRing];
+			for (uint32_t& line : lines) line = belts.createLine(lineTiles, 8);
+
+			belts.connect(lines[0], lines[1]);
+			belts.createSplitter(lines[1], BeltNetwork::INVALID, lines[2], lines[3]);
+			belts.connect(lines[2], lines[0]);
+			belts.sideLoad(lines[3], lines[0], lineTiles * BeltNetwork::TILE_LENGTH / 2);
+
+			for (uint32_t line : lines)
+				for (uint32_t i = 0; i < itemsPerLine; i++)
+					belts.insertItemAt(line, static_cast<uint16_t>(i % 8), i * lineTiles * BeltNetwork::TILE_LENGTH / itemsPerLine);
+		}
+	};
+
+	auto run = [&](BeltNetwork& belts, ThreadPool* pThreadPool, uint64_t& itemMoves)
+	{
+		itemMoves = 0;
+		auto start = Clock::now();
+		for (uint32_t t = 0; t < ticks; t++)
+		{
+			belts.tick(pThreadPool);
+			itemMoves += belts.getItemsMovedLastTick();
+		}
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	};
+
+	BeltNetwork serialBelts, parallelBelts;
+	buildNetwork(serialBelts);
+	buildNetwork(parallelBelts);
+
+	ThreadPool threadPool(0, 1);
+	uint64_t serialMoves = 0, parallelMoves = 0;
+	double serialTime = run(serialBelts, nullptr, serialMoves);
+	double parallelTime = run(parallelBelts, &threadPool, parallelMoves);
+
+	print(std::format("Belts: {} items on {} lines in {} islands x {} ticks", serialBelts.getItemCount(), ringCount * linesPerRing, serialBelts.getIslandCount(), ticks));
+	print(std::format("Belts (1 thread): {:.3f} ms/tick, {:.1f} million item-moves per second ({:.1f}% of items moving)", serialTime * 1000.0 / ticks, serialMoves / serialTime / 1e6, 100.0 * serialMoves / (static_cast<double>(serialBelts.getItemCount()) * ticks)));
+	print(std::format("Belts ({} threads): {:.3f} ms/tick, {:.1f} million item-moves per second, {:.2f}x", threadPool.getThreadCount() + 1, parallelTime * 1000.0 / ticks, parallelMoves / parallelTime / 1e6, serialTime / parallelTime));
+	print(std::format("Belts: serial and parallel results {}", serialBelts.hashState() == parallelBelts.hashState() ? "match" : "DIFFER"));
+}
+
+void SimulationBenchmarks::benchmarkElectric(uint32_t consumerCount, uint32_t ticks)
+{
+	using Clock = std::chrono::steady_clock;
+	const uint32_t polesPerNetwork = 50;
+	const uint32_t consumersPerNetwork = 100;
+	uint32_t networkCount = std::max(1u, consumerCount / consumersPerNetwork);
+
+	// Each network is a chain of poles with consumers along it, a generator per 10 consumers and a couple of accumulators.
+	// Generation is slightly short, so accumulators drain and some networks brown out.
+	ElectricNetwork electricity;
+	std::vector<uint32_t> chainMiddles;
+	for (uint32_t network = 0; network < networkCount; network++)
+	{
+		uint32_t firstPole = electricity.addPole();
+		for (uint32_t i = 1; i < polesPerNetwork; i++) electricity.connect(firstPole + i - 1, electricity.addPole());
+		chainMiddles.push_back(firstPole + polesPerNetwork / 2);
+
+		for (uint32_t i = 0; i < consumersPerNetwork; i++)
+		{
+			uint32_t pole = firstPole + i % polesPerNetwork;
+			electricity.addConsumer(pole, 90000.0f + 1000.0f * (i % 20));
+			if (i % 10 == 0) electricity.addGenerator(pole, 900000.0f);
+		}
+		electricity.addAccumulator(firstPole, 5e6f, 300000.0f);
+		electricity.addAccumulator(firstPole + polesPerNetwork - 1, 5e6f, 300000.0f);
+	}
+
+	const float tickDelta = 1.0f / 60.0f;
+	electricity.tick(tickDelta);
+
+	auto start = Clock::now();
+	for (uint32_t t = 0; t < ticks; t++) electricity.tick(tickDelta);
+	double steadyTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	// Cut a network in half and splice it back together every tick
+	start = Clock::now();
+	for (uint32_t t = 0; t < ticks; t++)
+	{
+		uint32_t pole = chainMiddles[(t / 2) % networkCount];
+		if (t % 2 == 0) electricity.disconnect(pole, pole + 1);
+		else electricity.connect(pole, pole + 1);
+		electricity.tick(tickDelta);
+	}
+	double churnTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	ElectricNetwork::sNetworkStats stats = electricity.getNetworkStats(0);
+	print(std::format("Electric: {} networks, {} consumers, {} generators", electricity.getNetworkCount(), networkCount * consumersPerNetwork, networkCount * consumersPerNetwork / 10));
+	print(std::format("Electric: {:.3f} ms/tick steady, {:.3f} ms/tick with a wire cut or spliced every tick", steadyTime * 1000.0 / ticks, churnTime * 1000.0 / ticks));
+	print(std::format("Electric: first network at {:.1f}% satisfaction, {:.1f}% load", stats.satisfaction * 100.0f, stats.load * 100.0f));
+}
+
+void SimulationBenchmarks::benchmarkFluids(uint32_t segmentCount, uint32_t ticks)
+{
+	using Clock = std::chrono::steady_clock;
+
+	// Source -> pipes -> pump -> tank -> pipes -> two machines
+	FluidNetwork fluids;
+	uint32_t first = fluids.addSegment();
+	for (uint32_t i = 1; i < segmentCount; i++)
+	{
+		uint32_t segment = (i == segmentCount / 2) ? fluids.addSegment(25000.0f) : fluids.addSegment();
+		if (i == segmentCount / 2) fluids.addPump(segment - 1, segment, 200.0f);
+		else fluids.connect(segment - 1, segment);
+	}
+	uint32_t last = first + segmentCount - 1;
+	uint32_t source = fluids.addSource(first, 1, 1200.0f / 60.0f);
+	uint32_t machineA = fluids.addConsumer(last, 5.0f);
+	uint32_t machineB = fluids.addConsumer(last - 10, 5.0f);
+
+	auto start = Clock::now();
+	for (uint32_t t = 0; t < ticks; t++) fluids.tick();
+	double activeTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	// Shut everything off and let the system settle
+	fluids.setSourceRate(source, 0.0f);
+	fluids.setConsumerRate(machineA, 0.0f);
+	fluids.setConsumerRate(machineB, 0.0f);
+	uint32_t settleTicks = 0;
+	while (fluids.getAwakeSystemCount() > 0 && settleTicks < 1000000)
+	{
+		fluids.tick();
+		settleTicks++;
+	}
+
+	start = Clock::now();
+	for (uint32_t t = 0; t < ticks; t++) fluids.tick();
+	double asleepTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	// Piping a separate system must leave the settled one asleep
+	uint32_t spareA = fluids.addSegment();
+	uint32_t spareB = fluids.addSegment();
+	fluids.connect(spareA, spareB);
+	fluids.tick();
+	size_t wokenSystems = fluids.getAwakeSystemCount();
+
+	print(std::format("Fluids: {} segments, {:.2f} us/tick flowing ({:.1f} ns/segment)", segmentCount, activeTime * 1e6 / ticks, activeTime * 1e9 / (static_cast<double>(ticks) * segmentCount)));
+	print(std::format("Fluids: settled and slept after {} ticks, {:.3f} us/tick asleep", settleTicks, asleepTime * 1e6 / ticks));
+	print(std::format("Fluids: piping a second system woke {} of {} systems{}", wokenSystems, fluids.getSystemCount(), wokenSystems == 1 ? "" : " - EXPECTED 1"));
+}
+
+void SimulationBenchmarks::benchmarkCrafting(uint32_t machineCount, uint32_t ticks)
+{
+	using Clock = std::chrono::steady_clock;
+
+	// Same recipes as the game, but with stacks big enough that no machine runs dry during the run
+	RecipeBook bulkRecipes;
+	bulkRecipes.registerDefaults(60000);
+	bulkRecipes.compile();
+
+	CraftingMachines machines(&bulkRecipes, 1.0f / 60.0f);
+	for (uint32_t i = 0; i < machineCount; i++)
+	{
+		uint32_t recipe = i % bulkRecipes.getRecipeCount();
+		uint32_t machine = machines.addMachine(recipe, (i % 3 == 0) ? 0.75f : 1.25f);
+		const RecipeBook::sCompiledRecipe& definition = bulkRecipes.getRecipe(recipe);
+		for (uint32_t slot = 0; slot < RecipeBook::MAX_INPUTS; slot++)
+			if (definition.inputItems[slot] != RecipeBook::NO_ITEM) machines.insertItem(machine, definition.inputItems[slot], 50000);
+	}
+
+	uint64_t crafts = 0;
+	auto start = Clock::now();
+	for (uint32_t t = 0; t < ticks; t++)
+	{
+		machines.tick();
+		crafts += machines.getCraftsCompletedLastTick();
+	}
+	double time = std::chrono::duration<double>(Clock::now() - start).count();
+
+	print(std::format("Crafting: {} machines over {} recipes x {} ticks, {:.2f} ns/machine/tick ({} crafts)", machineCount, bulkRecipes.getRecipeCount(), ticks, time * 1e9 / (static_cast<double>(machineCount) * ticks), crafts));
+
+	// Regression: a machine with no crafting speed used to be accepted, and its finish tick divided by a zero rate
+	bool rejected = false;
+	try { machines.addMachine(0, 0.0f); }
+	catch (const std::runtime_error&) { rejected = true; }
+	print(std::format("Crafting: machine with zero crafting speed {}", rejected ? "rejected" : "accepted!"));
+}
+
+void SimulationBenchmarks::benchmarkScheduler(uint32_t activeCount, uint32_t ticks)
+{
+	using Clock = std::chrono::steady_clock;
+
+	RecipeBook bulkRecipes;
+	bulkRecipes.registerDefaults(60000);
+	bulkRecipes.compile();
+
+	// The same number of working machines each time, buried in ever more idle ones waiting for inputs
+	for (uint32_t idleFactor : { 0u, 10u, 100u })
+	{
+		uint32_t machineCount = activeCount * (idleFactor + 1);
+		CraftingMachines machines(&bulkRecipes, 1.0f / 60.0f);
+		for (uint32_t i = 0; i < machineCount; i++)
+		{
+			uint32_t recipe = i % bulkRecipes.getRecipeCount();
+			uint32_t machine = machines.addMachine(recipe, (i % 3 == 0) ? 0.75f : 1.25f);
+			if (i % (idleFactor + 1) != 0) continue;
+
+			const RecipeBook::sCompiledRecipe& definition = bulkRecipes.getRecipe(recipe);
+			for (uint32_t slot = 0; slot < RecipeBook::MAX_INPUTS; slot++)
+				if (definition.inputItems[slot] != RecipeBook::NO_ITEM) machines.insertItem(machine, definition.inputItems[slot], 50000);
+		}
+
+		uint64_t crafts = 0;
+		auto start = Clock::now();
+		for (uint32_t t = 0; t < ticks; t++)
+		{
+			machines.tick();
+			crafts += machines.getCraftsCompletedLastTick();
+		}
+		double time = std::chrono::duration<double>(Clock::now() - start).count();
+
+		print(std::format("Scheduler: {} machines, {} crafting, {:.2f} us/tick ({} crafts)", machineCount, machines.getCraftingMachineCount(), time * 1e6 / ticks, crafts));
+	}
+}
+
+void SimulationBenchmarks::benchmarkLOD(uint32_t machineCount, uint32_t ticks)
+{
+	using Clock = std::chrono::steady_clock;
+	const int32_t chunksPerSide = 32;
+
+	RecipeBook bulkRecipes;
+	bulkRecipes.registerDefaults(60000);
+	bulkRecipes.compile();
+
+	// Identical factories spread over a grid of chunks, one fully simulated and one with LOD around a corner.
+	// Some machines are stocked for only part of the run, so suspended ones have to stop at empty buffers. Others
+	// start empty and are fed and drained like a belt would, and some of those are fed faster halfway through, so
+	// their chunks have to leave the modelled flow band and resume.
+	auto build = [&](CraftingMachines& machines, SimulationLOD* pLOD) {
+		for (uint32_t i = 0; i < machineCount; i++)
+		{
+			uint32_t recipe = i % bulkRecipes.getRecipeCount();
+			uint32_t machine = machines.addMachine(recipe, (i % 3 == 0) ? 0.75f : 1.25f);
+			const RecipeBook::sCompiledRecipe& definition = bulkRecipes.getRecipe(recipe);
+			uint16_t stock = (i % 5 == 1) ? 0 : (i % 7 == 0) ? 40 : 50000;
+			for (uint32_t slot = 0; slot < RecipeBook::MAX_INPUTS; slot++)
+				if (definition.inputItems[slot] != RecipeBook::NO_ITEM) machines.insertItem(machine, definition.inputItems[slot], stock);
+
+			uint32_t chunk = i % (chunksPerSide * chunksPerSide);
+			if (pLOD != nullptr) pLOD->addMachine(machine, glm::ivec3((chunk % chunksPerSide) * SimulationLOD::CHUNK_SIZE, (chunk / chunksPerSide) * SimulationLOD::CHUNK_SIZE, 0));
+		}
+	};
+
+	const uint32_t feedTicks = 150;
+	auto feed = [&](CraftingMachines& machines, uint32_t tick) {
+		if (tick % (feedTicks / 2) != 0) return;
+		for (uint32_t machine = 1; machine < machineCount; machine += 5)
+		{
+			bool faster = machine % 25 == 1 && tick >= ticks / 2;
+			if (tick % feedTicks != 0 && !faster) continue;
+
+			const RecipeBook::sCompiledRecipe& definition = bulkRecipes.getRecipe(machine % bulkRecipes.getRecipeCount());
+			for (uint32_t slot = 0; slot < RecipeBook::MAX_INPUTS; slot++)
+				if (definition.inputItems[slot] != RecipeBook::NO_ITEM) machines.insertItem(machine, definition.inputItems[slot], definition.inputCounts[slot]);
+			for (uint32_t slot = 0; slot < RecipeBook::MAX_OUTPUTS; slot++)
+				if (definition.outputItems[slot] != RecipeBook::NO_ITEM) machines.takeOutput(machine, slot, UINT16_MAX);
+		}
+	};
+
+	CraftingMachines fullMachines(&bulkRecipes, 1.0f / 60.0f);
+	build(fullMachines, nullptr);
+	auto start = Clock::now();
+	for (uint32_t t = 0; t < ticks; t++)
+	{
+		feed(fullMachines, t);
+		fullMachines.tick();
+	}
+	double fullTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	CraftingMachines lodMachines(&bulkRecipes, 1.0f / 60.0f);
+	SimulationLOD lod(&lodMachines, 4);
+	build(lodMachines, &lod);
+	start = Clock::now();
+	for (uint32_t t = 0; t < ticks; t++)
+	{
+		feed(lodMachines, t);
+		lod.tick();
+		lodMachines.tick();
+	}
+	double lodTime = std::chrono::duration<double>(Clock::now() - start).count();
+	uint32_t suspendedChunks = lod.getSuspendedChunkCount();
+	lod.resumeAll();
+
+	// Compare what each machine produced
+	uint64_t fullCrafts = 0;
+	uint64_t lodCrafts = 0;
+	uint64_t worstDifference = 0;
+	for (uint32_t machine = 0; machine < machineCount; machine++)
+	{
+		uint64_t full = fullMachines.getCraftsCompleted(machine);
+		uint64_t reduced = lodMachines.getCraftsCompleted(machine);
+		fullCrafts += full;
+		lodCrafts += reduced;
+		worstDifference = std::max(worstDifference, full > reduced ? full - reduced : reduced - full);
+	}
+
+	print(std::format("LOD: {} machines in {} chunks x {} ticks, {:.2f} us/tick full, {:.2f} us/tick with {} chunks suspended at the end",
+		machineCount, lod.getChunkCount(), ticks, fullTime * 1e6 / ticks, lodTime * 1e6 / ticks, suspendedChunks));
+	print(std::format("LOD: {} crafts full, {} with LOD, worst machine off by {}", fullCrafts, lodCrafts, worstDifference));
+
+	// A suspended machine is only brought up to date when it's touched. Feed and drain one through that lazy catch-up
+	// and an identical one on the timer wheel, with stock running out in between, and they have to agree on every craft
+	const RecipeBook::sCompiledRecipe& catchUpRecipe = bulkRecipes.getRecipe(0);
+	CraftingMachines catchUpMachines(&bulkRecipes, 1.0f / 60.0f);
+	uint32_t tickingMachine = catchUpMachines.addMachine(0, 2.0f);
+	uint32_t suspendedMachine = catchUpMachines.addMachine(0, 2.0f);
+	catchUpMachines.suspend(suspendedMachine);
+	uint32_t mismatchedReads = 0;
+	for (uint32_t t = 0; t < 3000; t++)
+	{
+		for (uint32_t machine : { tickingMachine, suspendedMachine })
+		{
+			if (t % 400 == 0)
+				for (uint32_t slot = 0; slot < RecipeBook::MAX_INPUTS; slot++)
+					if (catchUpRecipe.inputItems[slot] != RecipeBook::NO_ITEM) catchUpMachines.insertItem(machine, catchUpRecipe.inputItems[slot], catchUpRecipe.inputCounts[slot] * 3);
+			if (t % 250 == 0)
+				for (uint32_t slot = 0; slot < RecipeBook::MAX_OUTPUTS; slot++)
+					if (catchUpRecipe.outputItems[slot] != RecipeBook::NO_ITEM) catchUpMachines.takeOutput(machine, slot, UINT16_MAX);
+		}
+		if (t % 97 == 0 && catchUpMachines.getCraftsCompleted(tickingMachine) != catchUpMachines.getCraftsCompleted(suspendedMachine)) mismatchedReads++;
+		catchUpMachines.tick();
+	}
+	uint64_t tickingCrafts = catchUpMachines.getCraftsCompleted(tickingMachine);
+	uint64_t suspendedCrafts = catchUpMachines.getCraftsCompleted(suspendedMachine);
+
+	// Touching a suspended machine catches it up. Removing it in the same tick must leave nothing behind for the
+	// machine that reuses its ID, whose timer would otherwise fire for the old craft
+	catchUpMachines.insertItem(suspendedMachine, catchUpRecipe.inputItems[0], catchUpRecipe.inputCounts[0]);
+	catchUpMachines.removeMachine(suspendedMachine);
+	uint32_t reusedMachine = catchUpMachines.addMachine(0, 1.25f);
+	for (uint32_t t = 0; t < 600; t++) catchUpMachines.tick();
+
+	print(std::format("LOD: lazy catch-up made {} crafts, the ticking machine {}, {} mismatched reads{}; reused ID made {} crafts without inputs{}", suspendedCrafts, tickingCrafts,
+		mismatchedReads, (suspendedCrafts == tickingCrafts && mismatchedReads == 0) ? "" : "!", catchUpMachines.getCraftsCompleted(reusedMachine),
+		catchUpMachines.getCraftsCompleted(reusedMachine) == 0 ? "" : "!"));
+}
+
+void SimulationBenchmarks::benchmarkPathfinding(uint32_t queryCount)
+{
+	using Clock = std::chrono::steady_clock;
+	std::mt19937 random(1234);
+
+	// A 1024x1024 tile floor scattered with factory-sized blocked rectangles
+	NavigationGrid grid(32, 32);
+	for (uint32_t i = 0; i < 12000; i++)
+	{
+		glm::ivec2 corner(static_cast<int32_t>(random() % grid.getWidth()), static_cast<int32_t>(random() % grid.getHeight()));
+		glm::ivec2 size(static_cast<int32_t>(2 + random() % 8), static_cast<int32_t>(2 + random() % 8));
+		for (int32_t y = corner.y; y < std::min(corner.y + size.y, grid.getHeight()); y++)
+			for (int32_t x = corner.x; x < std::min(corner.x + size.x, grid.getWidth()); x++) grid.setBlocked(glm::ivec2(x, y), true);
+	}
+
+	auto start = Clock::now();
+	HierarchicalPathfinder pathfinder(&grid);
+	double buildTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	auto randomOpenTile = [&]() {
+		glm::ivec2 tile;
+		do tile = glm::ivec2(static_cast<int32_t>(random() % grid.getWidth()), static_cast<int32_t>(random() % grid.getHeight()));
+		while (grid.isBlocked(tile));
+		return tile;
+	};
+	std::vector<HierarchicalPathfinder::sPathRequest> requests(queryCount);
+	for (HierarchicalPathfinder::sPathRequest& request : requests) request = { .start = randomOpenTile(), .goal = randomOpenTile() };
+
+	// Plain A* over tiles on a sample of the same queries, as the baseline
+	uint32_t baselineCount = std::min<uint32_t>(queryCount, 50);
+	std::vector<uint32_t> bestCost(static_cast<size_t>(grid.getWidth()) * grid.getHeight());
+	uint64_t baselineLength = 0;
+	start = Clock::now();
+	for (uint32_t i = 0; i < baselineCount; i++)
+	{
+		glm::ivec2 goal = requests[i].goal;
+		auto heuristic = [goal](glm::ivec2 tile) { return static_cast<uint32_t>(std::abs(tile.x - goal.x) + std::abs(tile.y - goal.y)); };
+		std::fill(bestCost.begin(), bestCost.end(), UINT32_MAX);
+		std::priority_queue<std::pair<uint32_t, uint32_t>, std::vector<std::pair<uint32_t, uint32_t>>, std::greater<>> open;
+		bestCost[grid.getTileIndex(requests[i].start)] = 0;
+		open.push({ heuristic(requests[i].start), grid.getTileIndex(requests[i].start) });
+		while (!open.empty())
+		{
+			auto [estimate, index] = open.top();
+			open.pop();
+			glm::ivec2 tile(static_cast<int32_t>(index % grid.getWidth()), static_cast<int32_t>(index / grid.getWidth()));
+			if (tile == goal)
+			{
+				baselineLength += bestCost[index];
+				break;
+			}
+			if (estimate > bestCost[index] + heuristic(tile)) continue;
+			for (glm::ivec2 direction : { glm::ivec2(1, 0), glm::ivec2(-1, 0), glm::ivec2(0, 1), glm::ivec2(0, -1) })
+			{
+				glm::ivec2 next = tile + direction;
+				if (grid.isBlocked(next) || bestCost[grid.getTileIndex(next)] <= bestCost[index] + 1) continue;
+				bestCost[grid.getTileIndex(next)] = bestCost[index] + 1;
+				open.push({ bestCost[index] + 1 + heuristic(next), grid.getTileIndex(next) });
+			}
+		}
+	}
+	double baselineTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	start = Clock::now();
+	pathfinder.findPaths(requests);
+	double serialTime = std::chrono::duration<double>(Clock::now() - start).count();
+	uint64_t hierarchicalLength = 0;
+	uint32_t found = 0;
+	for (uint32_t i = 0; i < queryCount; i++)
+	{
+		if (requests[i].path.empty()) continue;
+		found++;
+		if (i < baselineCount) hierarchicalLength += requests[i].path.size() - 1;
+	}
+
+	pathfinder.clearCache();
+	ThreadPool pool(0);
+	start = Clock::now();
+	pathfinder.findPaths(requests, &pool);
+	double parallelTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	// Popular pairs: the same few hundred requests over and over
+	std::span<HierarchicalPathfinder::sPathRequest> popular(requests.data(), std::min<size_t>(requests.size(), 500));
+	pathfinder.findPaths(popular, &pool);
+	start = Clock::now();
+	for (uint32_t repeat = 0; repeat < 10; repeat++) pathfinder.findPaths(popular, &pool);
+	double cachedTime = std::chrono::duration<double>(Clock::now() - start).count() / (10.0 * popular.size()) * queryCount;
+
+	// Knock a hole in a wall and catch up
+	glm::ivec2 changed = randomOpenTile();
+	grid.setBlocked(changed, true);
+	start = Clock::now();
+	pathfinder.update();
+	double updateTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	print(std::format("Pathfinding: {} portal nodes built in {:.2f} ms, one-tile change rebuilt in {:.3f} ms", pathfinder.getNodeCount(), buildTime * 1e3, updateTime * 1e3));
+	print(std::format("Pathfinding: tile A* {:.1f} us/query, HPA* {:.1f} us/query, {:.1f} us/query on {} threads, {:.2f} us/query cached ({} of {} found)",
+		baselineTime * 1e6 / baselineCount, serialTime * 1e6 / queryCount, parallelTime * 1e6 / queryCount, pool.getThreadCount(), cachedTime * 1e6 / queryCount, found, queryCount));
+	print(std::format("Pathfinding: HPA* paths {:.1f}% longer than optimal on the A* sample", baselineLength > 0 ? (static_cast<double>(hierarchicalLength) / baselineLength - 1.0) * 100.0 : 0.0));
+
+	// The cache evicts the least recently used path, so one asked for between every other query has to survive
+	// more distinct queries than the cache holds
+	auto hot = std::find_if(requests.begin(), requests.end(), [](const HierarchicalPathfinder::sPathRequest& request) { return !request.path.empty(); });
+	if (hot == requests.end()) return;
+	pathfinder.clearCache();
+	std::vector<glm::ivec2> cachePath;
+	pathfinder.findPath(hot->start, hot->goal, cachePath);
+	uint32_t hotMisses = 0;
+	for (size_t i = 0; i < HierarchicalPathfinder::CACHE_CAPACITY * 2; i++)
+	{
+		pathfinder.findPath(randomOpenTile(), randomOpenTile(), cachePath);
+		uint64_t hits = pathfinder.getCacheHits();
+		pathfinder.findPath(hot->start, hot->goal, cachePath);
+		if (pathfinder.getCacheHits() == hits) hotMisses++;
+	}
+	print(std::format("Pathfinding: frequently used path missed the cache {} times in {} other queries{}", hotMisses, HierarchicalPathfinder::CACHE_CAPACITY * 2, hotMisses == 0 ? "" : "!"));
+}
+
+void SimulationBenchmarks::benchmarkFlowFields(uint32_t unitCount, uint32_t ticks)
+{
+	using Clock = std::chrono::steady_clock;
+	const float tickDelta = 1.0f / 60.0f;
+	const uint32_t targetCount = 4;
+	std::mt19937 random(1234);
+
+	// The same cluttered 1024x1024 floor as the pathfinding benchmark
+	NavigationGrid grid(32, 32);
+	for (uint32_t i = 0; i < 12000; i++)
+	{
+		glm::ivec2 corner(static_cast<int32_t>(random() % grid.getWidth()), static_cast<int32_t>(random() % grid.getHeight()));
+		glm::ivec2 size(static_cast<int32_t>(2 + random() % 8), static_cast<int32_t>(2 + random() % 8));
+		for (int32_t y = corner.y; y < std::min(corner.y + size.y, grid.getHeight()); y++)
+			for (int32_t x = corner.x; x < std::min(corner.x + size.x, grid.getWidth()); x++) grid.setBlocked(glm::ivec2(x, y), true);
+	}
+	auto randomOpenTile = [&]() {
+		glm::ivec2 tile;
+		do tile = glm::ivec2(static_cast<int32_t>(random() % grid.getWidth()), static_cast<int32_t>(random() % grid.getHeight()));
+		while (grid.isBlocked(tile));
+		return tile;
+	};
+
+	// One 8x8 target per quarter of the map, standing in for the factory parts under attack
+	FlowFields fields(&grid);
+	glm::ivec2 targets[targetCount];
+	for (uint32_t i = 0; i < targetCount; i++) targets[i] = glm::ivec2(256 + 512 * (i % 2), 256 + 512 * (i / 2));
+
+	auto start = Clock::now();
+	for (glm::ivec2 target : targets) fields.acquireField(target, target + glm::ivec2(7));
+	double buildTime = std::chrono::duration<double>(Clock::now() - start).count() / targetCount;
+
+	// Every unit shares one of the four fields, so adding them builds nothing new
+	auto spawn = [&](Crowd& crowd) {
+		std::mt19937 spawnRandom(5678);
+		for (uint32_t i = 0; i < unitCount; i++)
+		{
+			glm::ivec2 tile;
+			do tile = glm::ivec2(static_cast<int32_t>(spawnRandom() % grid.getWidth()), static_cast<int32_t>(spawnRandom() % grid.getHeight()));
+			while (grid.isBlocked(tile));
+			glm::ivec2 target = targets[i % targetCount];
+			crowd.addUnit(glm::vec2(tile.x + 0.5f, tile.y + 0.5f), target, target + glm::ivec2(7), 4.0f);
+		}
+	};
+	Crowd serialCrowd(&fields), parallelCrowd(&fields);
+	spawn(serialCrowd);
+	spawn(parallelCrowd);
+
+	start = Clock::now();
+	for (uint32_t t = 0; t < ticks; t++) serialCrowd.tick(tickDelta);
+	double serialTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	ThreadPool pool(0);
+	start = Clock::now();
+	for (uint32_t t = 0; t < ticks; t++) parallelCrowd.tick(tickDelta, &pool);
+	double parallelTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	// Put up walls across the map, then check the repaired fields against ones built from scratch
+	for (uint32_t i = 0; i < 20; i++)
+	{
+		glm::ivec2 corner = randomOpenTile();
+		for (int32_t x = corner.x; x < std::min(corner.x + 24, grid.getWidth()); x++) grid.setBlocked(glm::ivec2(x, corner.y), true);
+	}
+	start = Clock::now();
+	fields.update();
+	double repairTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	FlowFields rebuilt(&grid);
+	uint64_t mismatches = 0;
+	for (uint32_t i = 0; i < targetCount; i++)
+	{
+		uint32_t field = rebuilt.acquireField(targets[i], targets[i] + glm::ivec2(7));
+		for (int32_t y = 0; y < grid.getHeight(); y++)
+			for (int32_t x = 0; x < grid.getWidth(); x++)
+				mismatches += fields.getDistance(i, glm::ivec2(x, y)) != rebuilt.getDistance(field, glm::ivec2(x, y));
+	}
+
+	double unitTicks = static_cast<double>(unitCount) * ticks;
+	print(std::format("Flow fields: {} fields over {}x{} tiles, {:.2f} ms/build", fields.getFieldCount(), grid.getWidth(), grid.getHeight(), buildTime * 1e3));
+	print(std::format("Crowd: {} units x {} ticks, {:.2f} ns/unit/tick serial, {:.2f} ns/unit/tick on {} threads ({})", unitCount, ticks,
+		serialTime * 1e9 / unitTicks, parallelTime * 1e9 / unitTicks, pool.getThreadCount(), serialCrowd.hashState() == parallelCrowd.hashState() ? "identical" : "DIVERGED"));
+	print(std::format("Repair after 20 walls: {:.2f} ms for {} tiles over {} fields vs {:.2f} ms rebuilding ({} mismatches)",
+		repairTime * 1e3, fields.getRepairedTileCount(), targetCount, buildTime * targetCount * 1e3, mismatches));
+}
\ No newline at end of file
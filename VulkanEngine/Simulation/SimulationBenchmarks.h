@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+
+#include "../Utilities/Utilities.h"
+
+
+
+// Micro-benchmarks for the simulation data structures, run at startup when debugSettings.runSimulationBenchmarks is set.
+class SimulationBenchmarks
+{
+public:
+	static void runAll();
+
+	// Ticks the same crafters stored in ECS tables and as individually heap-allocated objects reached through pointers.
+	static void benchmarkECS(uint32_t entityCount, uint32_t ticks);
+	// Circulates items around rings of belt lines, with merges and splitters, and reports item-moves per second
+	// single-threaded and with islands ticked on a thread pool.
+	static void benchmarkBelts(uint32_t itemCount, uint32_t ticks);
+	// Ticks electric networks with a steady topology, then again while a wire is cut and reconnected every tick.
+	static void benchmarkElectric(uint32_t consumerCount, uint32_t ticks);
+	// Pumps fluid through one long pipeline, then lets it settle and measures the cost once it's asleep.
+	static void benchmarkFluids(uint32_t segmentCount, uint32_t ticks);
+	// Ticks crafting machines spread over every default recipe, with inputs stocked so they keep running.
+	static void benchmarkCrafting(uint32_t machineCount, uint32_t ticks);
+	// Ticks a fixed number of working machines alongside 0, 10 and 100 times as many idle ones, to show
+	// that idle machines cost nothing per tick.
+	static void benchmarkScheduler(uint32_t activeCount, uint32_t ticks);
+	// Runs the same spread-out factory with and without LOD, comparing tick cost and how far the results drift.
+	static void benchmarkLOD(uint32_t machineCount, uint32_t ticks);
+	// Finds paths between random tiles of a cluttered floor with plain A* and the hierarchical pathfinder,
+	// serially, on the pool and from the cache, and times an incremental update.
+	static void benchmarkPathfinding(uint32_t queryCount);
+	// Sends units across a cluttered floor towards a few shared targets, timing field builds, per-unit steering
+	// and repairing the fields after walls go up.
+	static void benchmarkFlowFields(uint32_t unitCount, uint32_t ticks);
+
+private:
+	static void print(std::string message) { Utilities::debugPrint(message, std::string("SimulationBenchmarks")); }
+};
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "TimerWheel.h"
+
+#include <algorithm>
+#include <bit>
+
+
+
+void TimerWheel::schedule(uint64_t dueTick, uint32_t id, uint32_t ticket)
+{
+	place({ .dueTick = std::max(dueTick, m_currentTick + 1), .id = id, .ticket = ticket });
+	m_pendingCount++;
+}
+
+void TimerWheel::advance(std::vector<sTimer>& due)
+{
+	m_currentTick++;
+
+	// Entering a new block of a level: pull its slot down into the finer levels, coarsest first
+	for (uint32_t level = LEVELS - 1; level > 0; level--)
+	{
+		if ((m_currentTick & ((1ull << (SLOT_BITS * level)) - 1)) != 0) continue;
+
+		std::vector<sTimer> cascading;
+		cascading.swap(m_slots[level][(m_currentTick >> (SLOT_BITS * level)) & (SLOTS - 1)]);
+		for (const sTimer& timer : cascading) place(timer);
+	}
+
+	std::vector<sTimer>& slot = m_slots[0][m_currentTick & (SLOTS - 1)];
+	m_pendingCount -= slot.size();
+	due.insert(due.end(), slot.begin(), slot.end());
+	slot.clear();
+}
+
+void TimerWheel::place(const sTimer& timer)
+{
+	// The level is the highest group of bits where the due tick differs from now. Anything further away than
+	// the wheel covers waits in the top level and is re-placed each time that slot cascades.
+	uint64_t difference = timer.dueTick ^ m_currentTick;
+	uint32_t level = difference == 0 ? 0 : static_cast<uint32_t>(std::bit_width(difference) - 1) / SLOT_BITS;
+	if (level >= LEVELS)
+	{
+		uint64_t cascadeTick = ((m_currentTick >> (SLOT_BITS * (LEVELS - 1))) + SLOTS - 1) << (SLOT_BITS * (LEVELS - 1));
+		m_slots[LEVELS - 1][(cascadeTick >> (SLOT_BITS * (LEVELS - 1))) & (SLOTS - 1)].push_back(timer);
+		return;
+	}
+
+	m_slots[level][(timer.dueTick >> (SLOT_BITS * level)) & (SLOTS - 1)].push_back(timer);
+}
\ No newline at end of file
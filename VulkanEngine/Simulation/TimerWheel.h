@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+
+// Hierarchical timer wheel. Level 0 has one slot per tick for the next 256 ticks; every higher level covers
+// 256 times the range of the one below with the same number of slots. Timers sit in the coarsest level
+// that still tells them apart from the current tick and cascade down as it approaches, so scheduling is
+// O(1) and a tick only touches the timers that are due (plus an occasional cascade).
+class TimerWheel
+{
+public:
+	static constexpr uint32_t LEVELS = 4;
+	static constexpr uint32_t SLOT_BITS = 8;
+	static constexpr uint32_t SLOTS = 1 << SLOT_BITS;
+
+	struct sTimer
+	{
+		uint64_t dueTick = 0;
+		uint32_t id = 0;
+		uint32_t ticket = 0; // Owner-defined, lets the owner ignore timers it has since cancelled
+	};
+
+	// Timers due now or in the past fire on the next advance().
+	void schedule(uint64_t dueTick, uint32_t id, uint32_t ticket);
+	// Moves to the next tick and appends every timer due on it to `due`, in the order they were scheduled.
+	void advance(std::vector<sTimer>& due);
+
+	uint64_t getCurrentTick() { return m_currentTick; }
+	size_t getPendingCount() { return m_pendingCount; }
+
+private:
+	std::array<std::array<std::vector<sTimer>, SLOTS>, LEVELS> m_slots = {};
+	uint64_t m_currentTick = 0;
+	size_t m_pendingCount = 0;
+
+
+	void place(const sTimer& timer);
+};
\ No newline at end of file
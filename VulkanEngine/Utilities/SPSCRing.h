@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+
+
+// Lock-free bounded single-producer, single-consumer queue.
+// Each side owns one index and keeps a cached copy of the other's, only reloading it when the ring looks full
+// or empty, so in the common case a push or pop touches no cache line the other thread is writing.
+template<typename T, uint32_t CAPACITY>
+class SPSCRing
+{
+	static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "SPSCRing capacity must be a power of two");
+
+public:
+	// Producer: returns false without blocking if the ring is full.
+	bool push(const T& value)
+	{
+		uint32_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_cachedHead == CAPACITY)
+		{
+			m_cachedHead = m_head.load(std::memory_order_acquire);
+			if (tail - m_cachedHead == CAPACITY) return false;
+		}
+
+		m_buffer[tail & MASK] = value;
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer: returns false without blocking if the ring is empty.
+	bool pop(T& value)
+	{
+		uint32_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_cachedTail)
+		{
+			m_cachedTail = m_tail.load(std::memory_order_acquire);
+			if (head == m_cachedTail) return false;
+		}
+
+		value = m_buffer[head & MASK];
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	static constexpr uint32_t MASK = CAPACITY - 1;
+
+	// Indices only ever increase and wrap at 2^32, which CAPACITY divides
+	alignas(64) std::atomic<uint32_t> m_head = 0; // Written by the consumer
+	uint32_t m_cachedTail = 0; // Owned by the consumer
+	alignas(64) std::atomic<uint32_t> m_tail = 0; // Written by the producer
+	uint32_t m_cachedHead = 0; // Owned by the producer
+	alignas(64) T m_buffer[CAPACITY] = {};
+};
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include "TaskGraph.h"
+
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+#include "Utilities.h"
+
+
+
+TaskGraph::TaskHandle TaskGraph::addTask(const std::string& name, Task task, const std::vector<TaskHandle>& dependencies, eThread thread)
+{
+	TaskHandle handle = static_cast<TaskHandle>(m_tasks.size());
+
+	for (TaskHandle dependency : dependencies)
+	{
+		if (dependency >= handle) throw std::runtime_error("task " + name + " depends on a task that hasn't been added!");
+		m_tasks[dependency].dependents.push_back(handle);
+	}
+
+	m_tasks.push_back(sTask{
+		.name = name,
+		.task = std::move(task),
+		.thread = thread,
+		.dependencies = dependencies,
+		.remainingDependencies = static_cast<uint32_t>(dependencies.size())
+	});
+
+	return handle;
+}
+
+
+
+void TaskGraph::run(ThreadPool* pThreadPool)
+{
+	m_pThreadPool = (pThreadPool != nullptr && pThreadPool->getThreadCount() > 0) ? pThreadPool : nullptr;
+	m_start = Clock::now();
+	m_callerQueue.clear();
+	m_inFlight = 0;
+	m_finished = 0;
+	m_exception = nullptr;
+
+	// Counters are used up as tasks finish, so every run starts again from the whole graph
+	std::vector<TaskHandle> ready;
+	for (TaskHandle task = 0; task < m_tasks.size(); task++)
+	{
+		m_tasks[task].remainingDependencies = static_cast<uint32_t>(m_tasks[task].dependencies.size());
+		m_tasks[task].timing = {};
+		if (m_tasks[task].remainingDependencies == 0) ready.push_back(task);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_inFlight = static_cast<uint32_t>(ready.size());
+	}
+	dispatch(ready);
+
+	// Run the tasks that belong to this thread until nothing is left in flight
+	while (true)
+	{
+		TaskHandle task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this] { return !m_callerQueue.empty() || m_inFlight == 0; });
+			if (m_callerQueue.empty()) break;
+
+			task = m_callerQueue.front();
+			m_callerQueue.erase(m_callerQueue.begin());
+		}
+
+		runTask(task);
+	}
+
+	m_wallTime = elapsed();
+
+	if (m_exception) std::rethrow_exception(m_exception);
+}
+
+void TaskGraph::dispatch(const std::vector<TaskHandle>& ready)
+{
+	for (TaskHandle task : ready)
+	{
+		if (m_pThreadPool != nullptr && m_tasks[task].thread == eThread::ANY)
+		{
+			m_pThreadPool->submit([this, task] { runTask(task); });
+		}
+		else
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_callerQueue.push_back(task);
+			m_condition.notify_all();
+		}
+	}
+}
+
+void TaskGraph::runTask(TaskHandle task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		// After a failure, tasks already queued or handed to the pool are dropped rather than run
+		if (m_exception)
+		{
+			m_inFlight--;
+			m_condition.notify_all();
+			return;
+		}
+	}
+
+	sTask& current = m_tasks[task];
+	current.timing.worker = ThreadPool::getWorkerIndex();
+	current.timing.start = elapsed();
+
+	std::exception_ptr exception = nullptr;
+	try
+	{
+		current.task();
+	}
+	catch (...)
+	{
+		exception = std::current_exception();
+	}
+
+	current.timing.end = elapsed();
+
+	std::vector<TaskHandle> ready;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		// Handed over under the lock so nothing here touches the exception once run() can see it
+		if (exception && !m_exception) m_exception = std::move(exception);
+		exception = nullptr;
+
+		if (!m_exception)
+		{
+			for (TaskHandle dependent : current.dependents)
+				if (--m_tasks[dependent].remainingDependencies == 0) ready.push_back(dependent);
+		}
+
+		m_inFlight += static_cast<uint32_t>(ready.size());
+		m_inFlight--;
+		m_finished++;
+
+		// The calling thread may be waiting on the last task to finish. Notified under the lock because run() can
+		// return, and the graph go away, as soon as it sees nothing in flight
+		m_condition.notify_all();
+	}
+
+	dispatch(ready);
+}
+
+double TaskGraph::elapsed()
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - m_start).count();
+}
+
+
+
+double TaskGraph::getTaskTime()
+{
+	double total = 0.0;
+	for (const sTask& task : m_tasks) total += task.timing.end - task.timing.start;
+	return total;
+}
+
+double TaskGraph::getCriticalPath()
+{
+	// Dependencies always come before their dependents, so one pass in order is enough
+	std::vector<double> pathEnd(m_tasks.size(), 0.0);
+	double longest = 0.0;
+
+	for (TaskHandle task = 0; task < m_tasks.size(); task++)
+	{
+		double start = 0.0;
+		for (TaskHandle dependency : m_tasks[task].dependencies) start = std::max(start, pathEnd[dependency]);
+
+		pathEnd[task] = start + (m_tasks[task].timing.end - m_tasks[task].timing.start);
+		longest = std::max(longest, pathEnd[task]);
+	}
+
+	return longest;
+}
+
+void TaskGraph::printTimings(const std::string& title)
+{
+	std::vector<TaskHandle> order(m_tasks.size());
+	for (TaskHandle task = 0; task < m_tasks.size(); task++) order[task] = task;
+	std::sort(order.begin(), order.end(), [this](TaskHandle a, TaskHandle b) { return m_tasks[a].timing.start < m_tasks[b].timing.start; });
+
+	std::string report = title + " timings:\n";
+	for (TaskHandle task : order)
+	{
+		const sTiming& timing = m_tasks[task].timing;
+		std::string thread = timing.worker < 0 ? std::string("main") : std::format("worker {}", timing.worker);
+
+		report += std::format("  {:<24} {:>8.2f} ms -> {:>8.2f} ms  {:>8.2f} ms  ({})\n", m_tasks[task].name, timing.start, timing.end, timing.end - timing.start, thread);
+	}
+	report += std::format("  Wall time {:.2f} ms, task time {:.2f} ms, critical path {:.2f} ms", m_wallTime, getTaskTime(), getCriticalPath());
+
+	Utilities::debugPrint(report, std::string("TaskGraph"));
+}
\ No newline at end of file
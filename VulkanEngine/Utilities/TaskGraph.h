@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ThreadPool.h"
+
+
+
+// Work split into named tasks with dependencies, run on a thread pool as soon as everything each task depends on
+// has finished. Tasks pinned to the calling thread run on whichever thread calls run(), which is where anything
+// that isn't safe off it belongs: the window, the queue and the shared command pool. Every task is timed, so
+// printTimings() shows where the time went and how much running in parallel saved.
+class TaskGraph
+{
+public:
+	using TaskHandle = uint32_t;
+	using Task = std::function<void()>;
+
+	enum class eThread : uint8_t
+	{
+		ANY, // A pool worker, or the calling thread when there is no pool
+		CALLER // The thread that calls run()
+	};
+
+	// Milliseconds since run() started.
+	struct sTiming
+	{
+		double start = 0.0;
+		double end = 0.0;
+		int32_t worker = -1; // Pool worker that ran the task, -1 for the calling thread
+	};
+
+	// Dependencies must already have been added, so the graph can't have cycles.
+	TaskHandle addTask(const std::string& name, Task task, const std::vector<TaskHandle>& dependencies = {}, eThread thread = eThread::ANY);
+
+	// Returns once every task has run. Without a pool, or with an empty one, everything runs on the calling thread in
+	// the order it becomes ready. If a task throws, no task that hasn't started yet runs, even one already handed to the
+	// pool, and the first exception is rethrown once the tasks already running have finished. Can be run again.
+	void run(ThreadPool* pThreadPool);
+
+	const sTiming& getTiming(TaskHandle task) { return m_tasks[task].timing; }
+	double getWallTime() { return m_wallTime; }
+	// Sum of every task's time, what running them one after another would have taken.
+	double getTaskTime();
+	// Longest chain of dependent tasks, the least the wall time can be however many threads there are.
+	double getCriticalPath();
+	void printTimings(const std::string& title);
+
+private:
+	struct sTask
+	{
+		std::string name = "";
+		Task task = {};
+		eThread thread = eThread::ANY;
+		std::vector<TaskHandle> dependencies = {};
+		std::vector<TaskHandle> dependents = {};
+		uint32_t remainingDependencies = 0;
+		sTiming timing = {};
+	};
+
+	using Clock = std::chrono::steady_clock;
+
+	std::vector<sTask> m_tasks = {};
+	ThreadPool* m_pThreadPool = nullptr; // nullptr while running without workers
+	Clock::time_point m_start = {};
+	double m_wallTime = 0.0;
+
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::vector<TaskHandle> m_callerQueue = {}; // Ready tasks waiting for the calling thread
+	uint32_t m_inFlight = 0; // Submitted or queued and not yet finished
+	uint32_t m_finished = 0;
+	std::exception_ptr m_exception = nullptr;
+
+
+	double elapsed();
+	// Queues tasks that have become ready. Call without holding m_mutex, a pool may run tasks inline.
+	void dispatch(const std::vector<TaskHandle>& ready);
+	void runTask(TaskHandle task);
+};
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+
+
+thread_local int32_t ThreadPool::sm_workerIndex = -1;
+
+ThreadPool::ThreadPool(uint32_t threadCount, uint32_t reservedThreads)
+{
+	if (threadCount == 0)
+	{
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = hardwareThreads > reservedThreads ? hardwareThreads - reservedThreads : 0;
+	}
+
+	for (uint32_t i = 0; i < threadCount; i++) m_queues.push_back(std::make_unique<sWorkerQueue>());
+	for (uint32_t i = 0; i < threadCount; i++) m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_running = false;
+	}
+	m_wakeCondition.notify_all();
+
+	for (std::thread& thread : m_threads) thread.join();
+}
+
+
+
+void ThreadPool::submit(Task task)
+{
+	// No workers: run inline so callers don't need a separate single-threaded path
+	if (m_queues.empty())
+	{
+		task();
+		return;
+	}
+
+	// Workers keep their own tasks local, other threads spread them round-robin
+	uint32_t queueIndex = sm_workerIndex >= 0 ? static_cast<uint32_t>(sm_workerIndex) : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+	// Count the task before it's visible so the counter can't drop below zero when it's taken straight away
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_pendingTasks.fetch_add(1, std::memory_order_release);
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_queues[queueIndex]->mutex);
+		m_queues[queueIndex]->tasks.push_back(std::move(task));
+	}
+	m_wakeCondition.notify_one();
+}
+
+void ThreadPool::parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& function)
+{
+	if (count == 0) return;
+	if (grainSize == 0) grainSize = 1;
+
+	uint32_t chunkCount = (count + grainSize - 1) / grainSize;
+	if (m_queues.empty() || chunkCount == 1)
+	{
+		function(0, count);
+		return;
+	}
+
+	std::atomic<uint32_t> remaining = chunkCount;
+	for (uint32_t chunk = 1; chunk < chunkCount; chunk++)
+	{
+		uint32_t begin = chunk * grainSize;
+		uint32_t end = std::min(begin + grainSize, count);
+		submit([&function, &remaining, begin, end]() {
+			function(begin, end);
+			remaining.fetch_sub(1, std::memory_order_release);
+		});
+	}
+
+	// Do the first chunk here, then help with whatever is queued until every chunk has finished
+	function(0, std::min(grainSize, count));
+	remaining.fetch_sub(1, std::memory_order_release);
+
+	while (remaining.load(std::memory_order_acquire) > 0)
+	{
+		if (!runPendingTask(sm_workerIndex)) std::this_thread::yield();
+	}
+}
+
+
+
+void ThreadPool::workerLoop(uint32_t index)
+{
+	sm_workerIndex = static_cast<int32_t>(index);
+
+	while (true)
+	{
+		if (runPendingTask(sm_workerIndex)) continue;
+
+		std::unique_lock<std::mutex> lock(m_wakeMutex);
+		m_wakeCondition.wait(lock, [this]() { return m_pendingTasks.load(std::memory_order_acquire) > 0 || !m_running; });
+		if (!m_running) return;
+	}
+}
+
+bool ThreadPool::runPendingTask(int32_t workerIndex)
+{
+	Task task;
+	uint32_t queueCount = static_cast<uint32_t>(m_queues.size());
+	uint32_t start = workerIndex >= 0 ? static_cast<uint32_t>(workerIndex) : 0;
+
+	// Own deque from the back (most recent, still in cache), everyone else's from the front
+	for (uint32_t i = 0; i < queueCount && !task; i++)
+	{
+		uint32_t queueIndex = (start + i) % queueCount;
+		bool ownQueue = static_cast<int32_t>(queueIndex) == workerIndex;
+
+		std::lock_guard<std::mutex> lock(m_queues[queueIndex]->mutex);
+		std::deque<Task>& tasks = m_queues[queueIndex]->tasks;
+		if (tasks.empty()) continue;
+
+		if (ownQueue) { task = std::move(tasks.back()); tasks.pop_back(); }
+		else { task = std::move(tasks.front()); tasks.pop_front(); }
+	}
+
+	if (!task) return false;
+
+	m_pendingTasks.fetch_sub(1, std::memory_order_acq_rel);
+	task();
+	return true;
+}
\ No newline at end of file
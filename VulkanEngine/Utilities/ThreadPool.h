@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+
+// Work-stealing thread pool. Every worker owns a task deque: it pushes and pops its own work at the back
+// and, when it runs dry, steals from the front of the other workers' deques. Threads that wait on a
+// parallelFor help run tasks instead of blocking, so nested parallelism can't deadlock the pool.
+class ThreadPool
+{
+public:
+	using Task = std::function<void()>;
+
+	// threadCount is the number of worker threads, 0 to use one per hardware thread minus `reservedThreads`.
+	ThreadPool(uint32_t threadCount, uint32_t reservedThreads = 0);
+	~ThreadPool();
+
+	void submit(Task task);
+
+	// Calls function(begin, end) over [0, count) in chunks of grainSize and returns once all of them have run.
+	void parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& function);
+
+	uint32_t getThreadCount() { return static_cast<uint32_t>(m_threads.size()); }
+	// Index of the calling thread among its pool's workers, -1 if it isn't a pool worker.
+	static int32_t getWorkerIndex() { return sm_workerIndex; }
+
+private:
+	struct sWorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<std::thread> m_threads = {};
+	std::vector<std::unique_ptr<sWorkerQueue>> m_queues = {};
+	std::atomic<bool> m_running = true;
+	std::atomic<uint32_t> m_pendingTasks = 0;
+	std::atomic<uint32_t> m_nextQueue = 0;
+
+	std::mutex m_wakeMutex;
+	std::condition_variable m_wakeCondition;
+
+	static thread_local int32_t sm_workerIndex; // -1 on threads that don't belong to the pool
+
+
+	void workerLoop(uint32_t index);
+	// Runs one task from the given worker's deque, or stolen from another. Returns false if there was nothing to run.
+	bool runPendingTask(int32_t workerIndex);
+};
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+
+
+// Lock-free single-producer, single-consumer triple buffer.
+// The writer always has a private back slot to fill and the reader a private front slot to read, the third
+// slot is exchanged between them through one atomic. Neither side ever blocks, and the reader always sees
+// the most recently published value.
+template<typename T>
+class TripleBuffer
+{
+public:
+	// Writer: slot to fill before calling publish().
+	T& getWriteBuffer() { return m_buffers[m_backIndex]; }
+
+	// Writer: hands the filled slot to the reader and takes the shared one back for the next write.
+	void publish()
+	{
+		uint32_t previous = m_sharedState.exchange(m_backIndex | DIRTY_BIT, std::memory_order_acq_rel);
+		m_backIndex = previous & INDEX_MASK;
+	}
+
+	// Reader: picks up the newest published slot if there is one. Returns whether the read buffer changed.
+	bool acquire()
+	{
+		if ((m_sharedState.load(std::memory_order_relaxed) & DIRTY_BIT) == 0) return false;
+
+		uint32_t previous = m_sharedState.exchange(m_frontIndex, std::memory_order_acq_rel);
+		m_frontIndex = previous & INDEX_MASK;
+		return true;
+	}
+
+	// Reader: the most recently acquired value.
+	const T& getReadBuffer() const { return m_buffers[m_frontIndex]; }
+
+private:
+	static constexpr uint32_t DIRTY_BIT = 0x4;
+	static constexpr uint32_t INDEX_MASK = 0x3;
+
+	T m_buffers[3] = {};
+	uint32_t m_backIndex = 0; // Owned by the writer
+	uint32_t m_frontIndex = 1; // Owned by the reader
+	std::atomic<uint32_t> m_sharedState = 2; // Index of the exchanged slot, plus DIRTY_BIT when it holds unread data
+};
\ No newline at end of file
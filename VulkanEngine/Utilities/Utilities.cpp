@@ -18,6 +18,7 @@ Utilities::Utilities() {};
 
 std::string Utilities::m_lastClassPrinted = "";
 std::string Utilities::m_lastMessagePrinted = "";
+std::mutex Utilities::m_printMutex;
 
 
 std::string Utilities::generateTimestamp_HH_MM_SS_mmm()
@@ -10,6 +10,7 @@
 #include <format>
 #include <fstream>
 #include <iterator>
+#include <mutex>
 
 // Macro to print debug messages with class name argument autofilled
 #define mDebugPrint(x) m_pUtilities->debugPrint(x, this)
@@ -31,12 +32,20 @@ struct sSettings {
 			"VK_LAYER_KHRONOS_validation"
 		};
 		bool enableValidationLayers = true; // Enable validation layers.
+		bool runSimulationBenchmarks = false; // Run the simulation benchmarks at startup and print the results.
+		bool runFramesInFlightBenchmark = false; // Render a burst of frames with one and then every frame in flight at startup, and print the throughput of each.
+		bool runPresentModeBenchmark = false; // Render a burst of frames in each present mode at startup, and print the frame rate and CPU-to-present latency of each.
+		bool runTerrainBenchmark = false; // Render a burst of frames with the terrain chunk face-instanced and then as a Vertex mesh, and print the frame time of each (needs faceInstancedTerrain).
+		bool runRecordingBenchmark = false; // Render a burst of frames with thousands of per-chunk terrain draws, recorded on one thread and then in parallel, and print the recording time of each (needs faceInstancedTerrain).
+		bool parallelStartup = true; // Run startup tasks on worker threads. Off runs them one at a time on the main thread, for comparing the logged timings.
+		bool headless = false; // Render offscreen without a window, surface or swapchain, for benchmarks and CI. Works on software implementations such as lavapipe.
+		uint32_t headlessFrames = 1000; // Frames to render unpaced in headless mode before exiting and printing the frame time statistics.
 	} debugSettings;
 	struct sGraphicsSettings {
-		int maxFramesInFlight = 2; // How many frames the CPU can queue for rendering at once.
+		int maxFramesInFlight = 2; // Most frames the CPU can queue for rendering at once. The present mode may use fewer.
 		VkPhysicalDeviceFeatures enabledFeatures = {}; // Physical device features to enable.
-		bool tripleBuffering = true; // Enable Triple buffering.
-		bool vsync = true; // Enable VSync.
+		bool tripleBuffering = true; // With VSync, add a swapchain image and use every frame in flight for throughput. Off keeps the present queue short for lower latency.
+		bool vsync = true; // Enable VSync. Off presents immediately with one frame in flight, for the lowest latency.
 		int maxFramerate = 0; // Maximum frame rate of the engine (0 for unlimited).
 		bool rasterizerDepthClamp = false; // Enable depth clamping.
 		bool wireframe = true; // Enable Wireframe rendering.
@@ -45,7 +54,21 @@ struct sSettings {
 		VkBool32 anisotropicFiltering = false; // Enable Anisotropic filtering.
 		float anisotropyLevel = 4.0f; // Anisotropy level (1.0f = no anisotropy).
 		bool colorBlendTexture = true; // Blend the texture with the color of the fragment.
+		bool bindlessTextures = true; // Index model, item and UI textures from one descriptor-indexed array (requires Vulkan 1.2).
+		uint32_t maxBindlessTextures = 4096; // Number of bindless texture slots (clamped to the device limit).
+		bool vertexPulling = false; // Fetch vertices in the shader through buffer device addresses instead of binding vertex/index buffers (requires Vulkan 1.2).
+		bool indirectDraws = false; // Merge consecutive vertex-pulled draws with the same pipeline and texture into vkCmdDrawIndirect calls (requires vertexPulling).
+		bool faceInstancedTerrain = false; // Render terrain from packed per-face instances instead of the Vertex/index mesh.
+		uint32_t recordingThreads = 0; // Threads recording draw batches into secondary command buffers in parallel (0 = one per core, minus the render and simulation threads).
 	} graphicsSettings;
+	struct sSimulationSettings {
+		uint32_t ticksPerSecond = 60; // Fixed simulation tick rate (UPS), independent of the frame rate.
+		uint32_t maxCatchUpTicks = 5; // Most ticks run back-to-back after a stall before the backlog is dropped.
+		uint32_t workerThreads = 0; // Threads that tick independent factory islands in parallel (0 = one per core, minus the render and simulation threads).
+		int32_t lodRadius = 4; // Chunks around the player that always run the full simulation; chunks further out are suspended while their flow stays steady.
+		uint32_t navigationChunks = 32; // Width and height of the navigable world, in chunks.
+		const char* replayRecordPath = nullptr; // Records every tick's player commands and state hash to this file while running (nullptr = off).
+	} simulationSettings;
 };
 
 
@@ -58,7 +81,7 @@ public:
 	template<typename CLASSNAME>
 	// Prints a debug message with the class name and timestamp.
 	inline void debugPrint(std::string message, CLASSNAME* that) { iDebugPrint(message, std::string(typeid(that).name())); };
-	inline static void debugPrint(std::string message, std::string className) { m_pInstance->iDebugPrint(message, className); };
+	inline static void debugPrint(std::string message, std::string className) { getInstance()->iDebugPrint(message, className); };
 
 	inline std::string getVkAPIVersionString(uint32_t version)
 	{
@@ -82,12 +105,15 @@ private:
 
 	static std::string m_lastClassPrinted;
 	static std::string m_lastMessagePrinted;
+	static std::mutex m_printMutex; // Worker threads print too
 
 
 	inline void iDebugPrint(std::string message, std::string className)
 	{
 		using std::string, std::format, std::cerr, std::setw;
 
+		std::lock_guard<std::mutex> lock(m_printMutex);
+
 		string timestamp = generateTimestamp_HH_MM_SS_mmm();
 
 		// Truncate the "* __ptr64" at the end of the class name
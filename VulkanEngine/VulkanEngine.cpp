@@ -22,11 +22,11 @@ void VulkanEngine::destroyInstance()
 	if (m_pInstance != nullptr)
 	{
 		nativeDebugPrint("Cleaning up...");
-		m_pInstance->m_state = VkEngineState::CLEANUP;
+		m_pInstance->setState(VkEngineState::CLEANUP);
 		m_pInstance->cleanup();
 
 		nativeDebugPrint("Exiting...", true);
-		m_pInstance->m_state = VkEngineState::EXIT;
+		m_pInstance->setState(VkEngineState::EXIT);
 		//delete m_pInstance;
 		//m_pInstance = nullptr;
 		//nativeDebugPrint("Instance destroyed");
@@ -36,18 +36,40 @@ void VulkanEngine::destroyInstance()
 
 VulkanEngine::VulkanEngine() {}
 
-void enableInputProcessing() {}
-
 DebugMessenger* VulkanEngine::m_pDebugMessenger = nullptr;
 
 
+void VulkanEngine::waitForState(VkEngineState state)
+{
+	// States only move forward, so anything past the one asked for means it has been and gone
+	VkEngineState current = m_state.load();
+	while (current < state)
+	{
+		m_state.wait(current);
+		current = m_state.load();
+	}
+}
+
+void VulkanEngine::setState(VkEngineState state)
+{
+	m_state.store(state);
+	m_state.notify_all();
+}
+
+double VulkanEngine::getStartupTime()
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startupBegin).count();
+}
+
+
 
 void VulkanEngine::run(std::map<std::string, uint32_t> versions, sSettings* settings)
 {
+	m_startupBegin = std::chrono::steady_clock::now();
 	m_pUtilities = Utilities::getInstance();
 
 	mDebugPrint("Initialising...");
-	m_state = VkEngineState::INIT;
+	setState(VkEngineState::INIT);
 
 	m_versions = versions;
 	mDebugPrint("Engine version: " + m_pUtilities->getVkAPIVersionString(m_versions["engineVersion"]));
@@ -61,14 +83,20 @@ void VulkanEngine::run(std::map<std::string, uint32_t> versions, sSettings* sett
 
 	Image::m_pGraphicsSettings = &m_settings->graphicsSettings;
 
+	if (m_settings->debugSettings.runSimulationBenchmarks) SimulationBenchmarks::runAll();
+
+	mDebugPrint("Creating simulation...");
+	m_pSimulation = new Simulation(&m_settings->simulationSettings);
+
 	mDebugPrint("Creating window...");
 	m_pWindow = new Window();
 
 	mDebugPrint("Initialising Vulkan...");
 	initVulkan();
 
-	mDebugPrint("Initialisation successful, running...\n");
-	m_state = VkEngineState::RUNNING;
+	mDebugPrint(std::format("Initialisation successful after {:.2f} ms, running...\n", getStartupTime()));
+	setState(VkEngineState::RUNNING);
+	m_pSimulation->start();
 	mainLoop();
 }
 
@@ -76,101 +104,196 @@ void VulkanEngine::run(std::map<std::string, uint32_t> versions, sSettings* sett
 
 void VulkanEngine::initVulkan()
 {
-	createInstance();
+	// Startup runs as a graph of tasks. Anything that touches the window, the queue or the shared command pool stays on
+	// this thread, while meshes, texture decoding and pipeline creation run on workers alongside it. Every upload is
+	// recorded into one batch and submitted once at the end.
+	using eThread = TaskGraph::eThread;
+	TaskGraph startup;
+
+	std::vector<Vertex> loadedVertices;
+	std::vector<uint32_t> loadedIndices;
 
-	// Debug messenger
-	mDebugPrint("Creating debug messenger...");
-	m_pDebugMessenger = new DebugMessenger();
-	m_pDebugMessenger->setupDebugMessenger(&m_vkInstance, m_settings->debugSettings.debugMode);
+	TaskGraph::TaskHandle instance = startup.addTask("Instance", [this] {
+		createInstance();
 
-	// Surface
-	m_pWindow->createSurface();
-	m_pVkSurface = m_pWindow->getSurface();
+		// Debug messenger
+		mDebugPrint("Creating debug messenger...");
+		m_pDebugMessenger = new DebugMessenger();
+		m_pDebugMessenger->setupDebugMessenger(&m_vkInstance, m_settings->debugSettings.debugMode);
+	}, {}, eThread::CALLER);
 
-	// Devices
-	m_pPhysicalDevice = new PhysicalDevice();
-	m_pVkPhysicalDevice = m_pPhysicalDevice->getVkPhysicalDevice();
+	TaskGraph::TaskHandle devices = startup.addTask("Devices", [this] {
+		// Surface
+		m_pWindow->createSurface();
+		m_pVkSurface = m_pWindow->getSurface();
 
-	validateSettings(); // Ensure device supports current settings
+		// Devices
+		m_pPhysicalDevice = new PhysicalDevice();
+		m_pVkPhysicalDevice = m_pPhysicalDevice->getVkPhysicalDevice();
 
-	m_pLogicalDevice = new LogicalDevice();
-	m_pVkDevice = m_pLogicalDevice->getVkDevice();
-	Image::m_pLogicalDevice = m_pVkDevice;
+		validateSettings(); // Ensure device supports current settings
 
-	// Buffer Manager
-	m_pBufferManager = new BufferManager();
-	Image::m_pBufferManager = m_pBufferManager;
+		m_pLogicalDevice = new LogicalDevice();
+		m_pVkDevice = m_pLogicalDevice->getVkDevice();
+		Image::m_pLogicalDevice = m_pVkDevice;
 
+		// Buffer Manager
+		m_pBufferManager = new BufferManager();
+		Image::m_pBufferManager = m_pBufferManager;
+		m_pBufferManager->m_pDeletionQueue = new DeletionQueue(m_pVkDevice);
 
-	// Command buffer
-	m_pBufferManager->m_pCommandBuffer = new CommandBuffer(m_pBufferManager);
+
+		// Command buffer
+		m_pBufferManager->m_pCommandBuffer = new CommandBuffer(m_pBufferManager);
+	}, { instance }, eThread::CALLER);
 
 	// Create blocks
-	std::vector<Vertex> loadedVertices;
-	std::vector<uint32_t> loadedIndices;
-	for (size_t i = 1; i < 4; i++) {
-		glm::vec3 newPos = {};
-		newPos.x = 1.0f * i;
-		newPos.y = 1.0f * i;
-		mDebugPrint(std::format("Creating block at position ({}, {}, {})", newPos.x, newPos.y, newPos.z));
-
-		Block* newBlock = new Block(newPos, "textures/image.png");
-		newBlock->buildModel();
-		m_pLoadedBlocks.push_back(newBlock);
-		
-		std::vector<Vertex> blockVertices = newBlock->getVertices();
-		std::vector<uint32_t> blockIndices = newBlock->getIndices();
-
-		loadedVertices.reserve(loadedVertices.size() + blockVertices.size()); // Preallocate memory
-		loadedVertices.insert(loadedVertices.end(), blockVertices.begin(), blockVertices.end());
-		loadedIndices.reserve(loadedIndices.size() + blockIndices.size()); // Preallocate memory
-		loadedIndices.insert(loadedIndices.end(), blockIndices.begin(), blockIndices.end());
-	}
-	//m_pTestModel = new Model("models/DTO_Crate.obj", "textures/DTO_Crate_tex_Diffuse.png");
+	TaskGraph::TaskHandle blocks = startup.addTask("Block meshes", [this, &loadedVertices, &loadedIndices] {
+		for (size_t i = 1; i < 4; i++) {
+			glm::vec3 newPos = {};
+			newPos.x = 1.0f * i;
+			newPos.y = 1.0f * i;
+			mDebugPrint(std::format("Creating block at position ({}, {}, {})", newPos.x, newPos.y, newPos.z));
+
+			Block* newBlock = new Block(newPos, "textures/image.png");
+			newBlock->buildModel();
+			m_pLoadedBlocks.push_back(newBlock);
+
+			std::vector<Vertex> blockVertices = newBlock->getVertices();
+			std::vector<uint32_t> blockIndices = newBlock->getIndices();
+
+			// Offset the block's indices so they point at its own vertices in the merged buffer
+			uint32_t baseVertex = static_cast<uint32_t>(loadedVertices.size());
+			for (auto& index : blockIndices) index += baseVertex;
+
+			loadedVertices.reserve(loadedVertices.size() + blockVertices.size()); // Preallocate memory
+			loadedVertices.insert(loadedVertices.end(), blockVertices.begin(), blockVertices.end());
+			loadedIndices.reserve(loadedIndices.size() + blockIndices.size()); // Preallocate memory
+			loadedIndices.insert(loadedIndices.end(), blockIndices.begin(), blockIndices.end());
+		}
+		//m_pTestModel = new Model("models/DTO_Crate.obj", "textures/DTO_Crate_tex_Diffuse.png");
 
 
-	if (loadedVertices.size() == 0) {
-		std::runtime_error("Tried to start without any loaded vertices.");
-	}
-	if (loadedIndices.size() == 0) {
-		std::runtime_error("Tried to start with empty vertex index array.");
+		if (loadedVertices.size() == 0) {
+			std::runtime_error("Tried to start without any loaded vertices.");
+		}
+		if (loadedIndices.size() == 0) {
+			std::runtime_error("Tried to start with empty vertex index array.");
+		}
+	});
+	std::vector<TaskGraph::TaskHandle> meshes = { blocks };
+
+	// Face-instanced terrain test chunk. Registers block textures too, so it waits for the blocks to keep the layer order
+	if (m_settings->graphicsSettings.faceInstancedTerrain)
+	{
+		meshes.push_back(startup.addTask("Terrain chunk", [this] {
+			mDebugPrint("Creating terrain chunk...");
+			m_pTerrainChunk = new Chunk({ -1, -1, -1 });
+
+			// A 16x16 floor with a staircase on top, so the chunk has both hidden faces and ambient occlusion
+			uint16_t blockID = Chunk::blockIDFromTextureLayer(Block::registerTexture("textures/image.png"));
+			for (int x = 16; x < 32; x++)
+				for (int y = 16; y < 32; y++)
+					m_pTerrainChunk->setBlock(x, y, 30, blockID);
+			for (int i = 0; i < 8; i++)
+				for (int z = 31 - i; z < 32; z++)
+					m_pTerrainChunk->setBlock(24 + i, 24, z - 1, blockID);
+
+			m_pTerrainChunk->buildFaceInstances();
+			m_pTerrainChunk->buildVertices();
+			m_pTerrainChunk->printMeshStats();
+		}, { blocks }));
 	}
 
-	// Vertex buffer
-	m_pBufferManager->m_pVertexBuffer = new VertexBuffer(m_pBufferManager, loadedVertices, loadedIndices);
+	// Block texture array, one layer per registered block texture so all terrain shares a single descriptor set.
+	// The layers are only known once every mesh has registered its textures
+	TaskGraph::TaskHandle textureDecode = startup.addTask("Texture decode", [this] {
+		m_pTextureImage = Image::decodeArray(Block::getTexturePaths());
+	}, meshes);
 
-	// Command buffer must be created seperately
-	m_pBufferManager->m_pCommandBuffer->createCommandBuffers();
+	TaskGraph::TaskHandle swapchain = startup.addTask("Swapchain", [this] {
+		// Command buffer must be created seperately
+		m_pBufferManager->m_pCommandBuffer->createCommandBuffers();
 
-	// Swapchain
-	m_pSwapchain = new Swapchain();
-	m_pBufferManager->m_pSwapchain = m_pSwapchain;
+		// Swapchain
+		m_pSwapchain = new Swapchain();
+		m_pBufferManager->m_pSwapchain = m_pSwapchain;
 
-	// Initialise depth buffer
-	m_pBufferManager->m_pDepthBuffer = new DepthBuffer(m_pBufferManager);
+		// Render graph, declares the frame's passes and owns the depth buffer and framebuffers
+		m_pBufferManager->m_pRenderGraph = new RenderGraph();
+		m_pBufferManager->m_pCommandBuffer->buildRenderGraph();
+	}, { devices }, eThread::CALLER);
 
+	// Bindless textures, must exist before the pipeline layout is built
+	TaskGraph::TaskHandle textureRegistry = startup.addTask("Texture registry", [this] {
+		if (m_settings->graphicsSettings.bindlessTextures)
+		{
+			m_pTextureRegistry = new TextureRegistry();
+			m_pBufferManager->m_pBindlessDescriptorSet = m_pTextureRegistry->getDescriptorSet();
+		}
+	}, { devices }, eThread::CALLER);
+
+	// Graphics pipeline. Only creates device objects, which is safe off this thread
+	TaskGraph::TaskHandle pipeline = startup.addTask("Graphics pipeline", [this] {
+		m_pGraphicsPipeline = new GraphicsPipeline();
+		m_pBufferManager->m_pGraphicsPipeline = m_pGraphicsPipeline->getGraphicsPipeline();
+		m_pBufferManager->m_pFaceInstancePipeline = m_pGraphicsPipeline->getFaceInstancePipeline();
+		m_pBufferManager->m_pModelPipeline = m_pGraphicsPipeline->getModelPipeline();
+		m_pBufferManager->m_pDescriptorSetLayout = m_pGraphicsPipeline->getDescriptorSetLayout();
+		m_pBufferManager->m_pPipelineLayout = m_pGraphicsPipeline->getVkPipelineLayout();
+	}, { swapchain, textureRegistry });
+
+	TaskGraph::TaskHandle uploads = startup.addTask("Uploads", [this, &loadedVertices, &loadedIndices] {
+		CommandBuffer* pCommandBuffer = m_pBufferManager->m_pCommandBuffer;
+		pCommandBuffer->beginUploadBatch();
+
+		// Vertex buffer
+		m_pBufferManager->m_pVertexBuffer = new VertexBuffer(m_pBufferManager, loadedVertices, loadedIndices);
+
+		if (m_pTerrainChunk != nullptr)
+		{
+			m_pBufferManager->m_pFaceInstanceBuffer = new FaceInstanceBuffer(m_pBufferManager, m_pTerrainChunk->getFaceInstances(), m_pTerrainChunk->getOrigin());
+			m_pBufferManager->m_pTerrainVertexBuffer = new VertexBuffer(m_pBufferManager, m_pTerrainChunk->getVertices(), m_pTerrainChunk->getIndices());
+		}
+
+		m_pTextureImage->upload();
+
+		// Icon quad beside the blocks, drawn through the model pipeline so its texture comes from the bindless array
+		if (m_pTextureRegistry != nullptr)
+		{
+			m_pIconModel = new Model({
+				{{-3.0f, 0.0f, -1.0f}, {1.0f, 1.0f, 1.0f}, {0.0f, 1.0f}, 0.0f, 0},
+				{{-1.0f, 0.0f, -1.0f}, {1.0f, 1.0f, 1.0f}, {1.0f, 1.0f}, 0.0f, 0},
+				{{-1.0f, 0.0f, 1.0f}, {1.0f, 1.0f, 1.0f}, {1.0f, 0.0f}, 0.0f, 0},
+				{{-3.0f, 0.0f, 1.0f}, {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f}, 0.0f, 0}
+			}, { 0, 1, 2, 2, 3, 0 }, "textures/Electrum_ConceptIcon.png");
+			m_pBufferManager->m_modelMeshes.push_back({
+				.pVertexBuffer = new VertexBuffer(m_pBufferManager, m_pIconModel->getVertices(), m_pIconModel->getIndices()),
+				.textureSlot = m_pIconModel->getTextureSlot()
+			});
+		}
 
-	// Graphics pipeline
-	m_pGraphicsPipeline = new GraphicsPipeline();
-	m_pBufferManager->m_pGraphicsPipeline = m_pGraphicsPipeline->getGraphicsPipeline();
-	m_pBufferManager->m_pRenderPass = m_pGraphicsPipeline->getRenderPass();
-	m_pBufferManager->m_pDescriptorSetLayout = m_pGraphicsPipeline->getDescriptorSetLayout();
-	m_pBufferManager->m_pPipelineLayout = m_pGraphicsPipeline->getVkPipelineLayout();
+		pCommandBuffer->endUploadBatch();
+	}, { devices, textureDecode, textureRegistry }, eThread::CALLER);
 
-	// Initialise other buffers
-	m_pBufferManager->m_pFramebuffer = new Framebuffer(m_pBufferManager);
-	m_pBufferManager->m_pUniformBufferObject = new UniformBufferObject(m_pBufferManager);
-	m_pBufferManager->m_pDescriptorSets = new DescriptorSets(m_pBufferManager);
+	startup.addTask("Descriptor sets", [this] {
+		// Initialise other buffers
+		m_pBufferManager->m_pUniformBufferObject = new UniformBufferObject(m_pBufferManager);
+		m_pBufferManager->m_pDescriptorSets = new DescriptorSets(m_pBufferManager);
 
+		m_pBufferManager->m_pDescriptorSets->createDescriptorSets(m_pTextureImage->getVkTextureImageView(), m_pTextureImage->getVkTextureSampler());
 
-	// Texture Image
-	m_pTextureImage = new Image("textures/image.png");
+		// Sync objects
+		m_pWindow->createSyncObjects();
+	}, { pipeline, uploads }, eThread::CALLER);
 
-	m_pBufferManager->m_pDescriptorSets->createDescriptorSets(m_pTextureImage->getVkTextureImageView(), m_pTextureImage->getVkTextureSampler());
 
-	// Sync objects
-	m_pWindow->createSyncObjects();
+	// Leaves a core for this thread, which has its own share of the tasks
+	ThreadPool* pStartupThreads = m_settings->debugSettings.parallelStartup ? new ThreadPool(0, 1) : nullptr;
+	startup.run(pStartupThreads);
+	delete pStartupThreads;
 
+	startup.printTimings("Vulkan initialisation");
 }
 
 void VulkanEngine::createInstance()
@@ -232,6 +355,10 @@ void VulkanEngine::mainLoop()
 
 void VulkanEngine::cleanup()
 {
+	mDebugPrint("Cleaning up simulation...");
+	m_pSimulation->stop();
+	delete m_pSimulation;
+
 	mDebugPrint("Cleaning up sync objects...");
 	m_pWindow->cleanupSyncObjects();
 
@@ -253,6 +380,24 @@ void VulkanEngine::cleanup()
 	mDebugPrint("Cleaning up swapchain...");
 	m_pSwapchain->cleanup();
 	delete m_pSwapchain;
+	delete m_pBufferManager->m_pRenderGraph;
+
+	if (m_pIconModel != nullptr)
+	{
+		mDebugPrint("Cleaning up models...");
+		for (BufferManager::sModelMesh& mesh : m_pBufferManager->m_modelMeshes)
+		{
+			mesh.pVertexBuffer->cleanup();
+			delete mesh.pVertexBuffer;
+		}
+		m_pBufferManager->m_modelMeshes.clear();
+		m_pIconModel->cleanup();
+		delete m_pIconModel;
+	}
+
+	mDebugPrint("Cleaning up retired objects...");
+	m_pBufferManager->m_pDeletionQueue->flush();
+	delete m_pBufferManager->m_pDeletionQueue;
 
 	mDebugPrint("Cleaning up loaded blocks...");
 	for (size_t i = 3; i > 0; i--) {
@@ -269,9 +414,26 @@ void VulkanEngine::cleanup()
 	m_pBufferManager->m_pDescriptorSets->cleanup();
 	delete m_pBufferManager->m_pDescriptorSets;
 
+	if (m_pTextureRegistry != nullptr)
+	{
+		mDebugPrint("Cleaning up texture registry...");
+		m_pTextureRegistry->cleanup();
+		delete m_pTextureRegistry;
+	}
+
 	mDebugPrint("Cleaning up vertex buffer...");
 	m_pBufferManager->m_pVertexBuffer->cleanup();
 	delete m_pBufferManager->m_pVertexBuffer;
+
+	if (m_pBufferManager->m_pFaceInstanceBuffer != nullptr)
+	{
+		mDebugPrint("Cleaning up terrain chunk...");
+		m_pBufferManager->m_pFaceInstanceBuffer->cleanup();
+		delete m_pBufferManager->m_pFaceInstanceBuffer;
+		m_pBufferManager->m_pTerrainVertexBuffer->cleanup();
+		delete m_pBufferManager->m_pTerrainVertexBuffer;
+		delete m_pTerrainChunk;
+	}
 	delete m_pBufferManager;
 
 	mDebugPrint("Cleaning up logical device...");
@@ -337,11 +499,17 @@ bool VulkanEngine::checkValidationLayerSupport()
 std::vector<const char*> VulkanEngine::getRequiredExtensions()
 {
 	mDebugPrint("Getting required extensions...");
-	uint32_t glfwExtensionCount = 0;
-	const char** glfwExtensions;
-	glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	std::vector<const char*> extensions = {};
 
-	std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	// Surface extensions are only needed with a window, GLFW isn't even initialised headless
+	if (!m_pWindow->isHeadless())
+	{
+		uint32_t glfwExtensionCount = 0;
+		const char** glfwExtensions;
+		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+
+		extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	}
 
 	if (m_settings->debugSettings.debugMode)
 	{
@@ -391,5 +559,67 @@ void VulkanEngine::validateSettings()
 		settingsChanged++;
 	}
 
+	// Check if device supports the descriptor indexing features needed for bindless textures
+	if (m_settings->graphicsSettings.bindlessTextures)
+	{
+		bool bindlessSupported = properties.apiVersion >= VK_API_VERSION_1_2 && m_versions["apiVersion"] >= VK_API_VERSION_1_2;
+		if (bindlessSupported)
+		{
+			VkPhysicalDeviceVulkan12Features features12{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES
+			};
+			VkPhysicalDeviceFeatures2 features2{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+				.pNext = &features12
+			};
+			vkGetPhysicalDeviceFeatures2(*m_pVkPhysicalDevice, &features2);
+
+			bindlessSupported = features12.descriptorIndexing && features12.runtimeDescriptorArray && features12.descriptorBindingPartiallyBound &&
+				features12.descriptorBindingVariableDescriptorCount && features12.descriptorBindingSampledImageUpdateAfterBind &&
+				features12.descriptorBindingUpdateUnusedWhilePending && features12.shaderSampledImageArrayNonUniformIndexing;
+		}
+
+		if (!bindlessSupported)
+		{
+			mDebugPrint("Descriptor indexing is not supported by the device. Disabling bindless textures.");
+			m_settings->graphicsSettings.bindlessTextures = false;
+			settingsChanged++;
+		}
+	}
+
+	// Check if device supports buffer device addresses for vertex pulling
+	if (m_settings->graphicsSettings.vertexPulling)
+	{
+		bool vertexPullingSupported = properties.apiVersion >= VK_API_VERSION_1_2 && m_versions["apiVersion"] >= VK_API_VERSION_1_2;
+		if (vertexPullingSupported)
+		{
+			VkPhysicalDeviceVulkan12Features features12{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES
+			};
+			VkPhysicalDeviceFeatures2 features2{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+				.pNext = &features12
+			};
+			vkGetPhysicalDeviceFeatures2(*m_pVkPhysicalDevice, &features2);
+
+			vertexPullingSupported = features12.bufferDeviceAddress;
+		}
+
+		if (!vertexPullingSupported)
+		{
+			mDebugPrint("Buffer device addresses are not supported by the device. Disabling vertex pulling.");
+			m_settings->graphicsSettings.vertexPulling = false;
+			settingsChanged++;
+		}
+	}
+
+	// Merged draws find their records through buffer addresses, each command selecting its own with firstInstance
+	if (m_settings->graphicsSettings.indirectDraws && (!m_settings->graphicsSettings.vertexPulling || !features.drawIndirectFirstInstance))
+	{
+		mDebugPrint("Indirect draws need vertex pulling and drawIndirectFirstInstance. Disabling indirect draws.");
+		m_settings->graphicsSettings.indirectDraws = false;
+		settingsChanged++;
+	}
+
 	settingsChanged != 1 ? mDebugPrint(std::format("Settings validated with {} changes.", settingsChanged)) : mDebugPrint("Settings validated with 1 change.");
 }
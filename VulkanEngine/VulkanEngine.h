@@ -4,6 +4,8 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <atomic>
+#include <chrono>
 
 
 #define GLFW_INCLUDE_VULKAN
@@ -12,14 +14,20 @@
 
 #include "Utilities/Utilities.h"
 #include "Utilities/DebugMessenger.h"
+#include "Utilities/TaskGraph.h"
 #include "Graphics/Window.h"
 #include "Graphics/Devices.h"
 #include "Graphics/Swapchain.h"
 #include "Graphics/GraphicsPipeline.h"
 #include "Graphics/Buffers.h"
 #include "Graphics/Image.h"
+#include "Graphics/TextureRegistry.h"
+#include "Graphics/RenderGraph.h"
 #include "Models/Model.h"
 #include "Models/Block.h"
+#include "Models/Chunk.h"
+#include "Simulation/Simulation.h"
+#include "Simulation/SimulationBenchmarks.h"
 
 
 enum class VkEngineState
@@ -38,8 +46,13 @@ public:
 	static VulkanEngine* getInstance();
 	static void destroyInstance();
 
-	VkEngineState getState() { return m_state; }
+	VkEngineState getState() { return m_state.load(); }
+	// Blocks until the engine has reached the given state or a later one, without polling.
+	void waitForState(VkEngineState state);
 	Window* getWindow() { return m_pWindow; }
+	TextureRegistry* getTextureRegistry() { return m_pTextureRegistry; }
+	// Milliseconds since run() was called, for tracking time to first frame.
+	double getStartupTime();
 
 	void run(std::map<std::string,uint32_t> versions, sSettings* settings);
 
@@ -52,16 +65,23 @@ private:
 	friend class GraphicsPipeline;
 	friend class Swapchain;
 	friend class Window;
+	friend class TextureRegistry;
+	friend class RenderGraph;
+	friend class Simulation;
+	friend class Model;
 
 	static VulkanEngine* m_pInstance;
-	VkEngineState m_state = VkEngineState::NONE;
+	std::atomic<VkEngineState> m_state = VkEngineState::NONE;
+	std::chrono::steady_clock::time_point m_startupBegin = {};
 
 	Utilities* m_pUtilities = nullptr;
 
 	static DebugMessenger* m_pDebugMessenger;
 
 	std::vector<Block*> m_pLoadedBlocks;
-	Image* m_pTextureImage = nullptr;
+	Chunk* m_pTerrainChunk = nullptr; // Only used when face-instanced terrain is enabled
+	Image* m_pTextureImage = nullptr; // Block texture array
+	Model* m_pIconModel = nullptr; // Only used when bindless textures are enabled
 
 	VkInstance m_vkInstance = VK_NULL_HANDLE;
 	Window* m_pWindow = nullptr;
@@ -73,6 +93,8 @@ private:
 	Swapchain* m_pSwapchain = nullptr;
 	GraphicsPipeline* m_pGraphicsPipeline = nullptr;
 	BufferManager* m_pBufferManager = nullptr;
+	TextureRegistry* m_pTextureRegistry = nullptr; // Only created when bindless textures are enabled
+	Simulation* m_pSimulation = nullptr;
 
 	int m_MAX_FRAMES_IN_FLIGHT = 1;
 	sSettings* m_settings = nullptr;
@@ -80,6 +102,7 @@ private:
 	std::map<std::string, uint32_t> m_versions = {};
 
 
+	void setState(VkEngineState state);
 	void initVulkan();
 	void createInstance();
 	void mainLoop();
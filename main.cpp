@@ -8,15 +8,15 @@
 
 #include <iostream>
 #include <map>
-#include <thread>
 
 #include "VulkanEngine/VulkanEngine.h"
 #include "VulkanEngine/Utilities/Utilities.h"
+#include "VulkanEngine/Simulation/ReplayHarness.h"
 
 const std::map<std::string, uint32_t> versions = {
 	{ "gameVersion", VK_MAKE_API_VERSION(0,0,8,0) },
 	{ "engineVersion", VK_MAKE_API_VERSION(0,0,8,0) },
-	{ "apiVersion", VK_MAKE_API_VERSION(0,1,0,0) }
+	{ "apiVersion", VK_MAKE_API_VERSION(0,1,2,0) }
 };
 
 sSettings settings{
@@ -35,11 +35,19 @@ sSettings settings{
 		.validationLayers = {
 			"VK_LAYER_KHRONOS_validation"
 		},
-		.enableValidationLayers = true
+		.enableValidationLayers = true,
 		#endif
+		.runSimulationBenchmarks = false,
+		.runFramesInFlightBenchmark = false,
+		.runPresentModeBenchmark = false,
+		.runTerrainBenchmark = false,
+		.runRecordingBenchmark = false,
+		.parallelStartup = true,
+		.headless = false,
+		.headlessFrames = 1000,
 	},
 	.graphicsSettings {
-		.maxFramesInFlight = 1,
+		.maxFramesInFlight = 2,
 		.enabledFeatures = {
 			.sampleRateShading = true,
 			.fillModeNonSolid = true,
@@ -56,6 +64,20 @@ sSettings settings{
 		.anisotropicFiltering = true,
 		.anisotropyLevel = 16.0f,
 		.colorBlendTexture = true,
+		.bindlessTextures = true,
+		.maxBindlessTextures = 4096,
+		.vertexPulling = false,
+		.indirectDraws = false,
+		.faceInstancedTerrain = false,
+		.recordingThreads = 0,
+	},
+	.simulationSettings {
+		.ticksPerSecond = 60,
+		.maxCatchUpTicks = 5,
+		.workerThreads = 0,
+		.lodRadius = 4,
+		.navigationChunks = 32,
+		.replayRecordPath = nullptr,
 	}
 };
 
@@ -75,45 +97,40 @@ void runVulkanEngine(VulkanEngine *pVulkanEngine)
 	VulkanEngine::destroyInstance();
 }
 
-void enableInputProcessing(VulkanEngine *pVulkanEngine)
+int runHeadless(int argc, char** argv)
 {
-	Window* pWindow = pVulkanEngine->getWindow();
-
-	while (pVulkanEngine->getState() == VkEngineState::RUNNING) {
-		// Process inputs
-		if (glfwGetKey(pWindow->getWindow(), GLFW_KEY_ESCAPE) == GLFW_PRESS) {
-			glfwSetWindowShouldClose(pWindow->getWindow(), GLFW_TRUE);
+	try
+	{
+		std::string mode = argv[1];
+		if (mode == "--replay" && argc >= 3) return ReplayHarness::run(argv[2], &settings.simulationSettings) ? EXIT_SUCCESS : EXIT_FAILURE;
+		if (mode == "--record-synthetic" && argc >= 4)
+		{
+			ReplayHarness::recordSynthetic(argv[2], std::stoull(argv[3]), &settings.simulationSettings);
+			return EXIT_SUCCESS;
 		}
 
-		// Sleep for a bit to reduce CPU usage
-		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		std::cerr << "Usage: ElectrumGame [--replay <file> | --record-synthetic <file> <ticks>]" << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
 	}
+	return EXIT_FAILURE;
 }
 
 
-int main()
+int main(int argc, char** argv)
 {
+	// Headless simulation runs, for benchmarking and checking determinism without a window or GPU
+	if (argc >= 2) return runHeadless(argc, argv);
+
 	VulkanEngine* pVulkanEngine = VulkanEngine::getInstance();
 
 	// TODO: Compile shaders before running if needed
 
-	std::thread renderThread(runVulkanEngine, pVulkanEngine);
-
-	// Wait for rendering engine to start running
-	while (pVulkanEngine->getState() != VkEngineState::RUNNING) {
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	}
-
-	// Allow inputs to be processed
-	std::thread inputThread(enableInputProcessing, pVulkanEngine);
-
-	// Wait for rendering engine to clean up before exiting
-	while (pVulkanEngine->getState() != VkEngineState::EXIT) {
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	}
-
-	renderThread.join();
-	inputThread.join();
+	// GLFW only allows window and event calls on the main thread, so the engine and its window loop run here.
+	// The simulation runs on its own thread, and input reaches it from the window's callbacks through a ring.
+	runVulkanEngine(pVulkanEngine);
 
 	std::cout << "Program ended successfully.\n";
 	system("pause");
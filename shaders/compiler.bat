@@ -1,3 +1,6 @@
 M:\_lib\VulkanSDK\1.3.280.0\Bin\glslc.exe shader.vert -o vert.spv
 M:\_lib\VulkanSDK\1.3.280.0\Bin\glslc.exe shader.frag -o frag.spv
+M:\_lib\VulkanSDK\1.3.280.0\Bin\glslc.exe --target-env=vulkan1.2 model.frag -o model_frag.spv
+M:\_lib\VulkanSDK\1.3.280.0\Bin\glslc.exe --target-env=vulkan1.2 pulling.vert -o pulling_vert.spv
+M:\_lib\VulkanSDK\1.3.280.0\Bin\glslc.exe face.vert -o face_vert.spv
 pause
\ No newline at end of file
@@ -0,0 +1,46 @@
+#version 450
+
+// Face-instanced terrain. Each instance is one packed FaceInstance and is expanded into a quad
+// (two triangles, 6 vertices) from gl_VertexIndex, so no vertex or index buffer is needed for blocks.
+
+layout(binding = 0) uniform UniformBufferObject {
+	mat4 model;
+	mat4 view;
+	mat4 proj;
+} ubo;
+
+// Matches GraphicsPipeline::sDrawPushConstants
+layout(push_constant) uniform DrawRecord {
+	layout(offset = 32) vec3 chunkOrigin;
+} draw;
+
+layout(location = 0) in uint inPositionFace;
+layout(location = 1) in uint inLayerAO;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out float fragColorBlendTex;
+layout(location = 3) flat out uint fragTexLayer;
+
+// Face directions in Block::eFace order, keep in sync with the tables in Chunk.cpp
+const ivec3 faceNormals[6] = ivec3[](ivec3(0, 0, 1), ivec3(0, 0, -1), ivec3(0, 1, 0), ivec3(0, -1, 0), ivec3(1, 0, 0), ivec3(-1, 0, 0));
+const ivec3 faceU[6] = ivec3[](ivec3(1, 0, 0), ivec3(0, 1, 0), ivec3(0, 0, 1), ivec3(1, 0, 0), ivec3(0, 1, 0), ivec3(0, 0, 1));
+const ivec3 faceV[6] = ivec3[](ivec3(0, 1, 0), ivec3(1, 0, 0), ivec3(1, 0, 0), ivec3(0, 0, 1), ivec3(0, 0, 1), ivec3(0, 1, 0));
+const ivec2 quadCorners[4] = ivec2[](ivec2(0, 0), ivec2(1, 0), ivec2(1, 1), ivec2(0, 1));
+const uint quadIndices[6] = uint[](0, 1, 2, 2, 3, 0);
+
+void main() {
+	ivec3 blockPos = ivec3(inPositionFace & 0x1Fu, (inPositionFace >> 5) & 0x1Fu, (inPositionFace >> 10) & 0x1Fu);
+	uint face = (inPositionFace >> 15) & 0x7u;
+	uint corner = quadIndices[gl_VertexIndex];
+	ivec2 uv = quadCorners[corner];
+
+	ivec3 cornerPos = blockPos + max(faceNormals[face], ivec3(0)) + faceU[face] * uv.x + faceV[face] * uv.y;
+	uint ao = (inLayerAO >> (16 + corner * 2)) & 0x3u;
+
+	gl_Position = ubo.proj * ubo.view * ubo.model * vec4(draw.chunkOrigin + vec3(cornerPos), 1.0);
+	fragColor = vec3(0.4 + 0.2 * float(ao));
+	fragTexCoord = vec2(uv);
+	fragColorBlendTex = 0.5;
+	fragTexLayer = inLayerAO & 0xFFFFu;
+}
\ No newline at end of file
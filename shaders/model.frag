@@ -0,0 +1,22 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Fragment shader for models, items and UI icons. Samples from the bindless texture array (set 1)
+// using the texture slot pushed per draw, so no descriptor sets change between draws.
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+// Matches GraphicsPipeline::sDrawPushConstants, the vertex pulling addresses come first
+layout(push_constant) uniform DrawPushConstants {
+	layout(offset = 16) uint textureIndex;
+} draw;
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) in float fragColorBlendTex;
+layout(location = 3) flat in uint fragTexLayer;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+	outColor = vec4(fragColor * texture(textures[nonuniformEXT(draw.textureIndex)], fragTexCoord).rgb, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#version 450
+#extension GL_EXT_buffer_reference : require
+
+// Vertex pulling variant of shader.vert. There is no vertex input state; the index and vertex data
+// are read through the buffer device addresses in the per-draw record, so a draw can source its
+// mesh from any sub-allocation without binding vertex or index buffers.
+
+// Matches the memory layout of the C++ Vertex struct (40 bytes, 4 byte aligned)
+struct PackedVertex {
+	float pos[3];
+	float color[3];
+	float texCoord[2];
+	float colorBlendTex;
+	uint texLayer;
+};
+
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer VertexData {
+	PackedVertex vertices[];
+};
+
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer IndexData {
+	uint indices[];
+};
+
+// Matches GraphicsPipeline::sIndirectDrawRecord
+struct IndirectDrawRecord {
+	VertexData vertexData;
+	IndexData indexData;
+	uint textureIndex;
+	uint baseVertex;
+};
+
+layout(buffer_reference, std430, buffer_reference_align = 8) readonly buffer IndirectDrawRecords {
+	IndirectDrawRecord records[];
+};
+
+// Set from graphicsSettings.indirectDraws. Merged indirect draws take their record from the frame's indirect buffer,
+// selected by the command's firstInstance, instead of from the push constants.
+layout(constant_id = 0) const bool INDIRECT_DRAWS = false;
+
+layout(binding = 0) uniform UniformBufferObject {
+	mat4 model;
+	mat4 view;
+	mat4 proj;
+} ubo;
+
+// Matches GraphicsPipeline::sDrawPushConstants
+layout(push_constant) uniform DrawRecord {
+	VertexData vertexData;
+	IndexData indexData;
+	uint textureIndex;
+	uint baseVertex;
+	layout(offset = 48) IndirectDrawRecords drawRecords;
+} draw;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out float fragColorBlendTex;
+layout(location = 3) flat out uint fragTexLayer;
+
+void main() {
+	VertexData vertexData = draw.vertexData;
+	IndexData indexData = draw.indexData;
+	uint baseVertex = draw.baseVertex;
+	if (INDIRECT_DRAWS)
+	{
+		IndirectDrawRecord record = draw.drawRecords.records[gl_InstanceIndex];
+		vertexData = record.vertexData;
+		indexData = record.indexData;
+		baseVertex = record.baseVertex;
+	}
+
+	uint index = indexData.indices[gl_VertexIndex] + baseVertex;
+	PackedVertex v = vertexData.vertices[index];
+
+	gl_Position = ubo.proj * ubo.view * ubo.model * vec4(v.pos[0], v.pos[1], v.pos[2], 1.0);
+	fragColor = vec3(v.color[0], v.color[1], v.color[2]);
+	fragTexCoord = vec2(v.texCoord[0], v.texCoord[1]);
+	fragColorBlendTex = v.colorBlendTex;
+	fragTexLayer = v.texLayer;
+}
\ No newline at end of file
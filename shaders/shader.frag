@@ -1,13 +1,14 @@
 #version 450
 
-layout(binding = 1) uniform sampler2D texSampler;
+layout(binding = 1) uniform sampler2DArray texSampler;
 
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
 layout(location = 2) in float fragColorBlendTex;
+layout(location = 3) flat in uint fragTexLayer;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-	outColor = vec4(fragColor * texture(texSampler, fragTexCoord).rgb, 1.0);
+	outColor = vec4(fragColor * texture(texSampler, vec3(fragTexCoord, float(fragTexLayer))).rgb, 1.0);
 }
\ No newline at end of file
@@ -10,14 +10,17 @@ layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
 layout(location = 3) in float inColorBlendTex;
+layout(location = 4) in uint inTexLayer;
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
 layout(location = 2) out float fragColorBlendTex;
+layout(location = 3) flat out uint fragTexLayer;
 
 void main() {
 	gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
 	fragColor = inColor;
 	fragTexCoord = inTexCoord;
 	fragColorBlendTex = inColorBlendTex;
+	fragTexLayer = inTexLayer;
 }
\ No newline at end of file